@@ -0,0 +1,242 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeASMCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/root/repo/cmake/common.cmake"
+  "/root/repo/cmake/ggml-config.cmake.in"
+  "/root/repo/examples/CMakeLists.txt"
+  "/root/repo/examples/gpt-2/CMakeLists.txt"
+  "/root/repo/examples/gpt-j/CMakeLists.txt"
+  "/root/repo/examples/magika/CMakeLists.txt"
+  "/root/repo/examples/mnist/CMakeLists.txt"
+  "/root/repo/examples/sam/CMakeLists.txt"
+  "/root/repo/examples/simple/CMakeLists.txt"
+  "/root/repo/examples/yolo/CMakeLists.txt"
+  "/root/repo/ggml.pc.in"
+  "/root/repo/src/CMakeLists.txt"
+  "/root/repo/src/ggml-blas/CMakeLists.txt"
+  "/root/repo/src/ggml-cpu/CMakeLists.txt"
+  "/root/repo/tests/CMakeLists.txt"
+  "/usr/share/cmake-3.25/Modules/BasicConfigVersion-SameMajorVersion.cmake.in"
+  "/usr/share/cmake-3.25/Modules/CMakeASMCompiler.cmake.in"
+  "/usr/share/cmake-3.25/Modules/CMakeASMInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCCompiler.cmake.in"
+  "/usr/share/cmake-3.25/Modules/CMakeCCompilerABI.c"
+  "/usr/share/cmake-3.25/Modules/CMakeCInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXCompiler.cmake.in"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXCompilerABI.cpp"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCheckCompilerFlagCommonPatterns.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCompilerIdDetection.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeDetermineASMCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeDetermineCCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeDetermineCXXCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeDetermineCompileFeatures.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeDetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeDetermineCompilerABI.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeDetermineCompilerId.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeDetermineSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeFindBinUtils.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakePackageConfigHelpers.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeParseImplicitIncludeInfo.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeParseImplicitLinkInfo.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeParseLibraryArchitecture.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystem.cmake.in"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeTestASMCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeTestCCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeTestCXXCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeTestCompilerCommon.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeUnixFindMake.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCXXCompilerFlag.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCXXSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckFunctionExists.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFile.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFileCXX.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/ADSP-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/ARMCC-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/ARMClang-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/AppleClang-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Borland-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Bruce-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Clang-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Clang-DetermineCompilerInternal.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Comeau-CXX-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Compaq-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Compaq-CXX-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Cray-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Embarcadero-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Fujitsu-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/FujitsuClang-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GHS-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-ASM.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-FindBinUtils.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/HP-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/HP-CXX-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/IAR-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/IBMCPP-C-DetermineVersionInternal.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/IBMCPP-CXX-DetermineVersionInternal.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/IBMClang-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/IBMClang-CXX-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Intel-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/IntelLLVM-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/LCC-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/LCC-CXX-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/MSVC-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/NVHPC-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/NVIDIA-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/OpenWatcom-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/PGI-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/PathScale-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/SCO-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/SDCC-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/SunPro-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/SunPro-CXX-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/TI-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Tasking-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/TinyCC-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/VisualAge-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/VisualAge-CXX-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/Watcom-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/XL-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/XL-CXX-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/XLClang-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/XLClang-CXX-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/zOS-C-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/zOS-CXX-DetermineCompiler.cmake"
+  "/usr/share/cmake-3.25/Modules/FindBLAS.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPkgConfig.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/GNUInstallDirs.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckCompilerFlag.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckFlagCommonConfig.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/FeatureTesting.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-Determine-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  "/usr/share/cmake-3.25/Modules/WriteBasicConfigVersionFile.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeASMCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "ggml.pc"
+  "ggml-config.cmake"
+  "ggml-version.cmake"
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/ggml-cpu/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/ggml-blas/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "examples/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "examples/yolo/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "examples/gpt-2/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "examples/gpt-j/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "examples/mnist/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "examples/sam/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "examples/simple/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "examples/magika/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "src/CMakeFiles/ggml-base.dir/DependInfo.cmake"
+  "src/CMakeFiles/ggml.dir/DependInfo.cmake"
+  "src/CMakeFiles/ggml-cpu.dir/DependInfo.cmake"
+  "src/ggml-blas/CMakeFiles/ggml-blas.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-backend-ops.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-opt.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-quantize-fns.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-quantize-perf.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-node-threads.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-cpu-profile.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-gguf-perf.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-hugepage-perf.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-sched-cost.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-sched-reuse.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-split-buffer.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-reduce-threads.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-top-k.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-flash-attn-quant.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-ssm-scan.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-wkv.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-pool.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-arange.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-timestep_embedding.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-pad-reflect-1d.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-roll.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-conv-transpose.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-conv-transpose-1d.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-dup.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-rel-pos.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-customop.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-conv1d.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-conv1d-dw-c1.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-conv1d-dw-c2.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-conv2d.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-conv2d-dw.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-conv2d-direct.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-conv2d-fused.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-rope-cache.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-win-part.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-cont.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test-interpolate.dir/DependInfo.cmake"
+  "examples/CMakeFiles/common.dir/DependInfo.cmake"
+  "examples/CMakeFiles/common-ggml.dir/DependInfo.cmake"
+  "examples/yolo/CMakeFiles/yolov3-tiny.dir/DependInfo.cmake"
+  "examples/gpt-2/CMakeFiles/gpt-2-ctx.dir/DependInfo.cmake"
+  "examples/gpt-2/CMakeFiles/gpt-2-alloc.dir/DependInfo.cmake"
+  "examples/gpt-2/CMakeFiles/gpt-2-backend.dir/DependInfo.cmake"
+  "examples/gpt-2/CMakeFiles/gpt-2-sched.dir/DependInfo.cmake"
+  "examples/gpt-2/CMakeFiles/gpt-2-quantize.dir/DependInfo.cmake"
+  "examples/gpt-2/CMakeFiles/gpt-2-batched.dir/DependInfo.cmake"
+  "examples/gpt-j/CMakeFiles/gpt-j.dir/DependInfo.cmake"
+  "examples/gpt-j/CMakeFiles/gpt-j-quantize.dir/DependInfo.cmake"
+  "examples/mnist/CMakeFiles/mnist-common.dir/DependInfo.cmake"
+  "examples/mnist/CMakeFiles/mnist-eval.dir/DependInfo.cmake"
+  "examples/mnist/CMakeFiles/mnist-train.dir/DependInfo.cmake"
+  "examples/sam/CMakeFiles/sam.dir/DependInfo.cmake"
+  "examples/simple/CMakeFiles/simple-ctx.dir/DependInfo.cmake"
+  "examples/simple/CMakeFiles/simple-backend.dir/DependInfo.cmake"
+  "examples/magika/CMakeFiles/magika.dir/DependInfo.cmake"
+  )
@@ -0,0 +1,25 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/examples/gpt-2/main-alloc.cpp" "examples/gpt-2/CMakeFiles/gpt-2-alloc.dir/main-alloc.cpp.o" "gcc" "examples/gpt-2/CMakeFiles/gpt-2-alloc.dir/main-alloc.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_blas_build/examples/CMakeFiles/common.dir/DependInfo.cmake"
+  "/root/repo/_blas_build/examples/CMakeFiles/common-ggml.dir/DependInfo.cmake"
+  "/root/repo/_blas_build/src/CMakeFiles/ggml.dir/DependInfo.cmake"
+  "/root/repo/_blas_build/src/CMakeFiles/ggml-cpu.dir/DependInfo.cmake"
+  "/root/repo/_blas_build/src/ggml-blas/CMakeFiles/ggml-blas.dir/DependInfo.cmake"
+  "/root/repo/_blas_build/src/CMakeFiles/ggml-base.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
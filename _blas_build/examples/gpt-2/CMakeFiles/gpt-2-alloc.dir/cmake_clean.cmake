@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/gpt-2-alloc"
+  "../../bin/gpt-2-alloc.pdb"
+  "CMakeFiles/gpt-2-alloc.dir/main-alloc.cpp.o"
+  "CMakeFiles/gpt-2-alloc.dir/main-alloc.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/gpt-2-alloc.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
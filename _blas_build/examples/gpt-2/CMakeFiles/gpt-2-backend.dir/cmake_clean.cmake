@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/gpt-2-backend"
+  "../../bin/gpt-2-backend.pdb"
+  "CMakeFiles/gpt-2-backend.dir/main-backend.cpp.o"
+  "CMakeFiles/gpt-2-backend.dir/main-backend.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/gpt-2-backend.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
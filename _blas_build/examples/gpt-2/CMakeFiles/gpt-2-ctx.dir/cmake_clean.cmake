@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/gpt-2-ctx"
+  "../../bin/gpt-2-ctx.pdb"
+  "CMakeFiles/gpt-2-ctx.dir/main-ctx.cpp.o"
+  "CMakeFiles/gpt-2-ctx.dir/main-ctx.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/gpt-2-ctx.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/magika"
+  "../../bin/magika.pdb"
+  "CMakeFiles/magika.dir/main.cpp.o"
+  "CMakeFiles/magika.dir/main.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/magika.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/mnist-train"
+  "../../bin/mnist-train.pdb"
+  "CMakeFiles/mnist-train.dir/mnist-train.cpp.o"
+  "CMakeFiles/mnist-train.dir/mnist-train.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/mnist-train.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
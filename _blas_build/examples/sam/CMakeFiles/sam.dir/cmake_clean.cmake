@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/sam"
+  "../../bin/sam.pdb"
+  "CMakeFiles/sam.dir/sam.cpp.o"
+  "CMakeFiles/sam.dir/sam.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/sam.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/simple-backend"
+  "../../bin/simple-backend.pdb"
+  "CMakeFiles/simple-backend.dir/simple-backend.cpp.o"
+  "CMakeFiles/simple-backend.dir/simple-backend.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/simple-backend.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/simple-ctx"
+  "../../bin/simple-ctx.pdb"
+  "CMakeFiles/simple-ctx.dir/simple-ctx.cpp.o"
+  "CMakeFiles/simple-ctx.dir/simple-ctx.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/simple-ctx.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
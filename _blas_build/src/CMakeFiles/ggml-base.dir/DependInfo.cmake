@@ -0,0 +1,33 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/ggml-alloc.c" "src/CMakeFiles/ggml-base.dir/ggml-alloc.c.o" "gcc" "src/CMakeFiles/ggml-base.dir/ggml-alloc.c.o.d"
+  "/root/repo/src/ggml-quants.c" "src/CMakeFiles/ggml-base.dir/ggml-quants.c.o" "gcc" "src/CMakeFiles/ggml-base.dir/ggml-quants.c.o.d"
+  "/root/repo/src/ggml.c" "src/CMakeFiles/ggml-base.dir/ggml.c.o" "gcc" "src/CMakeFiles/ggml-base.dir/ggml.c.o.d"
+  "/root/repo/src/ggml-backend.cpp" "src/CMakeFiles/ggml-base.dir/ggml-backend.cpp.o" "gcc" "src/CMakeFiles/ggml-base.dir/ggml-backend.cpp.o.d"
+  "/root/repo/src/ggml-opt.cpp" "src/CMakeFiles/ggml-base.dir/ggml-opt.cpp.o" "gcc" "src/CMakeFiles/ggml-base.dir/ggml-opt.cpp.o.d"
+  "/root/repo/src/ggml-threading.cpp" "src/CMakeFiles/ggml-base.dir/ggml-threading.cpp.o" "gcc" "src/CMakeFiles/ggml-base.dir/ggml-threading.cpp.o.d"
+  "/root/repo/src/ggml.cpp" "src/CMakeFiles/ggml-base.dir/ggml.cpp.o" "gcc" "src/CMakeFiles/ggml-base.dir/ggml.cpp.o.d"
+  "/root/repo/src/gguf.cpp" "src/CMakeFiles/ggml-base.dir/gguf.cpp.o" "gcc" "src/CMakeFiles/ggml-base.dir/gguf.cpp.o.d"
+  )
+
+# Pairs of files generated by the same build rule.
+set(CMAKE_MULTIPLE_OUTPUT_PAIRS
+  "/root/repo/_blas_build/src/libggml-base.so" "/root/repo/_blas_build/src/libggml-base.so.0.9.4"
+  "/root/repo/_blas_build/src/libggml-base.so.0" "/root/repo/_blas_build/src/libggml-base.so.0.9.4"
+  )
+
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,27 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ggml-base.dir/ggml-alloc.c.o"
+  "CMakeFiles/ggml-base.dir/ggml-alloc.c.o.d"
+  "CMakeFiles/ggml-base.dir/ggml-backend.cpp.o"
+  "CMakeFiles/ggml-base.dir/ggml-backend.cpp.o.d"
+  "CMakeFiles/ggml-base.dir/ggml-opt.cpp.o"
+  "CMakeFiles/ggml-base.dir/ggml-opt.cpp.o.d"
+  "CMakeFiles/ggml-base.dir/ggml-quants.c.o"
+  "CMakeFiles/ggml-base.dir/ggml-quants.c.o.d"
+  "CMakeFiles/ggml-base.dir/ggml-threading.cpp.o"
+  "CMakeFiles/ggml-base.dir/ggml-threading.cpp.o.d"
+  "CMakeFiles/ggml-base.dir/ggml.c.o"
+  "CMakeFiles/ggml-base.dir/ggml.c.o.d"
+  "CMakeFiles/ggml-base.dir/ggml.cpp.o"
+  "CMakeFiles/ggml-base.dir/ggml.cpp.o.d"
+  "CMakeFiles/ggml-base.dir/gguf.cpp.o"
+  "CMakeFiles/ggml-base.dir/gguf.cpp.o.d"
+  "libggml-base.pdb"
+  "libggml-base.so"
+  "libggml-base.so.0"
+  "libggml-base.so.0.9.4"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C CXX)
+  include(CMakeFiles/ggml-base.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,42 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/ggml-cpu/arch/x86/quants.c" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/arch/x86/quants.c.o" "gcc" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/arch/x86/quants.c.o.d"
+  "/root/repo/src/ggml-cpu/ggml-cpu.c" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/ggml-cpu.c.o" "gcc" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/ggml-cpu.c.o.d"
+  "/root/repo/src/ggml-cpu/quants.c" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/quants.c.o" "gcc" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/quants.c.o.d"
+  "/root/repo/src/ggml-cpu/amx/amx.cpp" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/amx/amx.cpp.o" "gcc" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/amx/amx.cpp.o.d"
+  "/root/repo/src/ggml-cpu/amx/mmq.cpp" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/amx/mmq.cpp.o" "gcc" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/amx/mmq.cpp.o.d"
+  "/root/repo/src/ggml-cpu/arch/x86/repack.cpp" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/arch/x86/repack.cpp.o" "gcc" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/arch/x86/repack.cpp.o.d"
+  "/root/repo/src/ggml-cpu/binary-ops.cpp" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/binary-ops.cpp.o" "gcc" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/binary-ops.cpp.o.d"
+  "/root/repo/src/ggml-cpu/ggml-cpu.cpp" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/ggml-cpu.cpp.o" "gcc" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/ggml-cpu.cpp.o.d"
+  "/root/repo/src/ggml-cpu/hbm.cpp" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/hbm.cpp.o" "gcc" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/hbm.cpp.o.d"
+  "/root/repo/src/ggml-cpu/hugepage.cpp" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/hugepage.cpp.o" "gcc" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/hugepage.cpp.o.d"
+  "/root/repo/src/ggml-cpu/ops.cpp" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/ops.cpp.o" "gcc" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/ops.cpp.o.d"
+  "/root/repo/src/ggml-cpu/profile.cpp" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/profile.cpp.o" "gcc" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/profile.cpp.o.d"
+  "/root/repo/src/ggml-cpu/repack.cpp" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/repack.cpp.o" "gcc" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/repack.cpp.o.d"
+  "/root/repo/src/ggml-cpu/traits.cpp" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/traits.cpp.o" "gcc" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/traits.cpp.o.d"
+  "/root/repo/src/ggml-cpu/unary-ops.cpp" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/unary-ops.cpp.o" "gcc" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/unary-ops.cpp.o.d"
+  "/root/repo/src/ggml-cpu/vec.cpp" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/vec.cpp.o" "gcc" "src/CMakeFiles/ggml-cpu.dir/ggml-cpu/vec.cpp.o.d"
+  )
+
+# Pairs of files generated by the same build rule.
+set(CMAKE_MULTIPLE_OUTPUT_PAIRS
+  "/root/repo/_blas_build/src/libggml-cpu.so" "/root/repo/_blas_build/src/libggml-cpu.so.0.9.4"
+  "/root/repo/_blas_build/src/libggml-cpu.so.0" "/root/repo/_blas_build/src/libggml-cpu.so.0.9.4"
+  )
+
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_blas_build/src/CMakeFiles/ggml-base.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,43 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/amx/amx.cpp.o"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/amx/amx.cpp.o.d"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/amx/mmq.cpp.o"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/amx/mmq.cpp.o.d"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/arch/x86/quants.c.o"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/arch/x86/quants.c.o.d"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/arch/x86/repack.cpp.o"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/arch/x86/repack.cpp.o.d"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/binary-ops.cpp.o"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/binary-ops.cpp.o.d"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/ggml-cpu.c.o"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/ggml-cpu.c.o.d"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/ggml-cpu.cpp.o"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/ggml-cpu.cpp.o.d"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/hbm.cpp.o"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/hbm.cpp.o.d"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/hugepage.cpp.o"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/hugepage.cpp.o.d"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/ops.cpp.o"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/ops.cpp.o.d"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/profile.cpp.o"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/profile.cpp.o.d"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/quants.c.o"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/quants.c.o.d"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/repack.cpp.o"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/repack.cpp.o.d"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/traits.cpp.o"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/traits.cpp.o.d"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/unary-ops.cpp.o"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/unary-ops.cpp.o.d"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/vec.cpp.o"
+  "CMakeFiles/ggml-cpu.dir/ggml-cpu/vec.cpp.o.d"
+  "libggml-cpu.pdb"
+  "libggml-cpu.so"
+  "libggml-cpu.so.0"
+  "libggml-cpu.so.0.9.4"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C CXX)
+  include(CMakeFiles/ggml-cpu.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
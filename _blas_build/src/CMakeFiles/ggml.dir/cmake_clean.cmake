@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ggml.dir/ggml-backend-reg.cpp.o"
+  "CMakeFiles/ggml.dir/ggml-backend-reg.cpp.o.d"
+  "libggml.pdb"
+  "libggml.so"
+  "libggml.so.0"
+  "libggml.so.0.9.4"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ggml.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
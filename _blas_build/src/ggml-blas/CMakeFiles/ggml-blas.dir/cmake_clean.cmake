@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ggml-blas.dir/ggml-blas.cpp.o"
+  "CMakeFiles/ggml-blas.dir/ggml-blas.cpp.o.d"
+  "libggml-blas.pdb"
+  "libggml-blas.so"
+  "libggml-blas.so.0"
+  "libggml-blas.so.0.9.4"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ggml-blas.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
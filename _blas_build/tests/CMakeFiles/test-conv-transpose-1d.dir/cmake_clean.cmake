@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-conv-transpose-1d"
+  "../bin/test-conv-transpose-1d.pdb"
+  "CMakeFiles/test-conv-transpose-1d.dir/test-conv-transpose-1d.cpp.o"
+  "CMakeFiles/test-conv-transpose-1d.dir/test-conv-transpose-1d.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-conv-transpose-1d.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
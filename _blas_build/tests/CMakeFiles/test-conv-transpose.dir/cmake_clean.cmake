@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-conv-transpose"
+  "../bin/test-conv-transpose.pdb"
+  "CMakeFiles/test-conv-transpose.dir/test-conv-transpose.c.o"
+  "CMakeFiles/test-conv-transpose.dir/test-conv-transpose.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/test-conv-transpose.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
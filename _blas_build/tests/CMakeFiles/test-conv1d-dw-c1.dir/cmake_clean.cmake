@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-conv1d-dw-c1"
+  "../bin/test-conv1d-dw-c1.pdb"
+  "CMakeFiles/test-conv1d-dw-c1.dir/test-conv1d-dw-c1.cpp.o"
+  "CMakeFiles/test-conv1d-dw-c1.dir/test-conv1d-dw-c1.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-conv1d-dw-c1.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-conv1d"
+  "../bin/test-conv1d.pdb"
+  "CMakeFiles/test-conv1d.dir/test-conv1d.cpp.o"
+  "CMakeFiles/test-conv1d.dir/test-conv1d.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-conv1d.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
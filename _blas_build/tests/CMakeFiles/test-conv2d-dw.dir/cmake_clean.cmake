@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-conv2d-dw"
+  "../bin/test-conv2d-dw.pdb"
+  "CMakeFiles/test-conv2d-dw.dir/test-conv2d-dw.cpp.o"
+  "CMakeFiles/test-conv2d-dw.dir/test-conv2d-dw.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-conv2d-dw.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-conv2d-fused"
+  "../bin/test-conv2d-fused.pdb"
+  "CMakeFiles/test-conv2d-fused.dir/test-conv2d-fused.cpp.o"
+  "CMakeFiles/test-conv2d-fused.dir/test-conv2d-fused.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-conv2d-fused.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
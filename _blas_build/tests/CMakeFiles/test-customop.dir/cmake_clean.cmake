@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-customop"
+  "../bin/test-customop.pdb"
+  "CMakeFiles/test-customop.dir/test-customop.c.o"
+  "CMakeFiles/test-customop.dir/test-customop.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/test-customop.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
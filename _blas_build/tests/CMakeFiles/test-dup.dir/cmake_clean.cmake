@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-dup"
+  "../bin/test-dup.pdb"
+  "CMakeFiles/test-dup.dir/test-dup.c.o"
+  "CMakeFiles/test-dup.dir/test-dup.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/test-dup.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-flash-attn-quant"
+  "../bin/test-flash-attn-quant.pdb"
+  "CMakeFiles/test-flash-attn-quant.dir/test-flash-attn-quant.cpp.o"
+  "CMakeFiles/test-flash-attn-quant.dir/test-flash-attn-quant.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-flash-attn-quant.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-hugepage-perf"
+  "../bin/test-hugepage-perf.pdb"
+  "CMakeFiles/test-hugepage-perf.dir/test-hugepage-perf.cpp.o"
+  "CMakeFiles/test-hugepage-perf.dir/test-hugepage-perf.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-hugepage-perf.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
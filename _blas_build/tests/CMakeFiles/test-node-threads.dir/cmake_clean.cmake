@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-node-threads"
+  "../bin/test-node-threads.pdb"
+  "CMakeFiles/test-node-threads.dir/test-node-threads.cpp.o"
+  "CMakeFiles/test-node-threads.dir/test-node-threads.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-node-threads.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
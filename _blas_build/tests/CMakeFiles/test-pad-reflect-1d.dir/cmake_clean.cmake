@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-pad-reflect-1d"
+  "../bin/test-pad-reflect-1d.pdb"
+  "CMakeFiles/test-pad-reflect-1d.dir/test-pad-reflect-1d.cpp.o"
+  "CMakeFiles/test-pad-reflect-1d.dir/test-pad-reflect-1d.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-pad-reflect-1d.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-pool"
+  "../bin/test-pool.pdb"
+  "CMakeFiles/test-pool.dir/test-pool.c.o"
+  "CMakeFiles/test-pool.dir/test-pool.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/test-pool.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
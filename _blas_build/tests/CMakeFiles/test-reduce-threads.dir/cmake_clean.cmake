@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-reduce-threads"
+  "../bin/test-reduce-threads.pdb"
+  "CMakeFiles/test-reduce-threads.dir/test-reduce-threads.cpp.o"
+  "CMakeFiles/test-reduce-threads.dir/test-reduce-threads.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-reduce-threads.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-roll"
+  "../bin/test-roll.pdb"
+  "CMakeFiles/test-roll.dir/test-roll.cpp.o"
+  "CMakeFiles/test-roll.dir/test-roll.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-roll.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
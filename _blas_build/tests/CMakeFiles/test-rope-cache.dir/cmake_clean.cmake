@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-rope-cache"
+  "../bin/test-rope-cache.pdb"
+  "CMakeFiles/test-rope-cache.dir/test-rope-cache.cpp.o"
+  "CMakeFiles/test-rope-cache.dir/test-rope-cache.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-rope-cache.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-sched-cost"
+  "../bin/test-sched-cost.pdb"
+  "CMakeFiles/test-sched-cost.dir/test-sched-cost.cpp.o"
+  "CMakeFiles/test-sched-cost.dir/test-sched-cost.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-sched-cost.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
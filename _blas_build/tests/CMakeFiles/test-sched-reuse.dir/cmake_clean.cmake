@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-sched-reuse"
+  "../bin/test-sched-reuse.pdb"
+  "CMakeFiles/test-sched-reuse.dir/test-sched-reuse.cpp.o"
+  "CMakeFiles/test-sched-reuse.dir/test-sched-reuse.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-sched-reuse.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-split-buffer"
+  "../bin/test-split-buffer.pdb"
+  "CMakeFiles/test-split-buffer.dir/test-split-buffer.cpp.o"
+  "CMakeFiles/test-split-buffer.dir/test-split-buffer.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-split-buffer.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
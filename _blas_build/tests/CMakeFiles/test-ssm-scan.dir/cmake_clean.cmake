@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-ssm-scan"
+  "../bin/test-ssm-scan.pdb"
+  "CMakeFiles/test-ssm-scan.dir/test-ssm-scan.cpp.o"
+  "CMakeFiles/test-ssm-scan.dir/test-ssm-scan.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-ssm-scan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
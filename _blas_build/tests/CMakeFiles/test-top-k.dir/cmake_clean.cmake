@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-top-k"
+  "../bin/test-top-k.pdb"
+  "CMakeFiles/test-top-k.dir/test-top-k.cpp.o"
+  "CMakeFiles/test-top-k.dir/test-top-k.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-top-k.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-wkv"
+  "../bin/test-wkv.pdb"
+  "CMakeFiles/test-wkv.dir/test-wkv.cpp.o"
+  "CMakeFiles/test-wkv.dir/test-wkv.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-wkv.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,80 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/tests
+# Build directory: /root/repo/_blas_build/tests
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(test-backend-ops "/root/repo/_blas_build/bin/test-backend-ops")
+set_tests_properties(test-backend-ops PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-backend-ops.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;168;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-opt "/root/repo/_blas_build/bin/test-opt")
+set_tests_properties(test-opt PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-opt.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;178;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-quantize-fns "/root/repo/_blas_build/bin/test-quantize-fns")
+set_tests_properties(test-quantize-fns PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-quantize-fns.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;187;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-quantize-perf "/root/repo/_blas_build/bin/test-quantize-perf")
+set_tests_properties(test-quantize-perf PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-quantize-perf.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;196;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-node-threads "/root/repo/_blas_build/bin/test-node-threads")
+set_tests_properties(test-node-threads PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-node-threads.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;205;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-cpu-profile "/root/repo/_blas_build/bin/test-cpu-profile")
+set_tests_properties(test-cpu-profile PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-cpu-profile.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;214;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-gguf-perf "/root/repo/_blas_build/bin/test-gguf-perf")
+set_tests_properties(test-gguf-perf PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-gguf-perf.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;223;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-hugepage-perf "/root/repo/_blas_build/bin/test-hugepage-perf" "--size" "16" "--embd" "1024" "--iterations" "1")
+set_tests_properties(test-hugepage-perf PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-hugepage-perf.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;233;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-sched-cost "/root/repo/_blas_build/bin/test-sched-cost")
+set_tests_properties(test-sched-cost PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-sched-cost.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;242;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-sched-reuse "/root/repo/_blas_build/bin/test-sched-reuse")
+set_tests_properties(test-sched-reuse PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-sched-reuse.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;251;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-split-buffer "/root/repo/_blas_build/bin/test-split-buffer")
+set_tests_properties(test-split-buffer PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-split-buffer.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;260;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-reduce-threads "/root/repo/_blas_build/bin/test-reduce-threads")
+set_tests_properties(test-reduce-threads PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-reduce-threads.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;269;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-top-k "/root/repo/_blas_build/bin/test-top-k")
+set_tests_properties(test-top-k PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-top-k.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;278;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-flash-attn-quant "/root/repo/_blas_build/bin/test-flash-attn-quant")
+set_tests_properties(test-flash-attn-quant PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-flash-attn-quant.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;287;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-ssm-scan "/root/repo/_blas_build/bin/test-ssm-scan")
+set_tests_properties(test-ssm-scan PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-ssm-scan.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;296;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-wkv "/root/repo/_blas_build/bin/test-wkv")
+set_tests_properties(test-wkv PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-wkv.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;305;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-pool "/root/repo/_blas_build/bin/test-pool")
+set_tests_properties(test-pool PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-pool.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;317;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-arange "/root/repo/_blas_build/bin/test-arange")
+set_tests_properties(test-arange PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-arange.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;329;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-timestep_embedding "/root/repo/_blas_build/bin/test-timestep_embedding")
+set_tests_properties(test-timestep_embedding PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-timestep_embedding.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;341;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-pad-reflect-1d "/root/repo/_blas_build/bin/test-pad-reflect-1d")
+set_tests_properties(test-pad-reflect-1d PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;350;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-roll "/root/repo/_blas_build/bin/test-roll")
+set_tests_properties(test-roll PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;358;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-conv-transpose "/root/repo/_blas_build/bin/test-conv-transpose")
+set_tests_properties(test-conv-transpose PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;366;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-conv-transpose-1d "/root/repo/_blas_build/bin/test-conv-transpose-1d")
+set_tests_properties(test-conv-transpose-1d PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;373;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-dup "/root/repo/_blas_build/bin/test-dup")
+set_tests_properties(test-dup PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;381;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-rel-pos "/root/repo/_blas_build/bin/test-rel-pos")
+set_tests_properties(test-rel-pos PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;389;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-customop "/root/repo/_blas_build/bin/test-customop")
+set_tests_properties(test-customop PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-customop.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;400;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-conv1d "/root/repo/_blas_build/bin/test-conv1d")
+set_tests_properties(test-conv1d PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-conv1d.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;409;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-conv1d-dw-c1 "/root/repo/_blas_build/bin/test-conv1d-dw-c1")
+set_tests_properties(test-conv1d-dw-c1 PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-conv1d-dw-c1.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;418;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-conv1d-dw-c2 "/root/repo/_blas_build/bin/test-conv1d-dw-c2")
+set_tests_properties(test-conv1d-dw-c2 PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-conv1d-dw-c2.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;427;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-conv2d "/root/repo/_blas_build/bin/test-conv2d")
+set_tests_properties(test-conv2d PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-conv2d.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;436;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-conv2d-dw "/root/repo/_blas_build/bin/test-conv2d-dw")
+set_tests_properties(test-conv2d-dw PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-conv2d-dw.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;445;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-conv2d-direct "/root/repo/_blas_build/bin/test-conv2d-direct")
+set_tests_properties(test-conv2d-direct PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-conv2d-direct.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;454;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-conv2d-fused "/root/repo/_blas_build/bin/test-conv2d-fused")
+set_tests_properties(test-conv2d-fused PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-conv2d-fused.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;463;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-rope-cache "/root/repo/_blas_build/bin/test-rope-cache")
+set_tests_properties(test-rope-cache PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-rope-cache.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;472;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-win-part "/root/repo/_blas_build/bin/test-win-part")
+set_tests_properties(test-win-part PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-win-part.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;481;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-cont "/root/repo/_blas_build/bin/test-cont")
+set_tests_properties(test-cont PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-cont.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;490;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test-interpolate "/root/repo/_blas_build/bin/test-interpolate")
+set_tests_properties(test-interpolate PROPERTIES  ENVIRONMENT "LLVM_PROFILE_FILE=test-interpolate.profraw" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;499;add_test;/root/repo/tests/CMakeLists.txt;0;")
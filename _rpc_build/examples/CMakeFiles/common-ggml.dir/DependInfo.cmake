@@ -0,0 +1,23 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/examples/common-ggml.cpp" "examples/CMakeFiles/common-ggml.dir/common-ggml.cpp.o" "gcc" "examples/CMakeFiles/common-ggml.dir/common-ggml.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_rpc_build/src/CMakeFiles/ggml.dir/DependInfo.cmake"
+  "/root/repo/_rpc_build/src/CMakeFiles/ggml-cpu.dir/DependInfo.cmake"
+  "/root/repo/_rpc_build/src/ggml-rpc/CMakeFiles/ggml-rpc.dir/DependInfo.cmake"
+  "/root/repo/_rpc_build/src/CMakeFiles/ggml-base.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
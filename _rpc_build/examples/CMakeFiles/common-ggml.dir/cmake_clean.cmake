@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/common-ggml.dir/common-ggml.cpp.o"
+  "CMakeFiles/common-ggml.dir/common-ggml.cpp.o.d"
+  "libcommon-ggml.a"
+  "libcommon-ggml.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/common-ggml.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
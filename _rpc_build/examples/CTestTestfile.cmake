@@ -0,0 +1,13 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/examples
+# Build directory: /root/repo/_rpc_build/examples
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+subdirs("yolo")
+subdirs("gpt-2")
+subdirs("gpt-j")
+subdirs("mnist")
+subdirs("sam")
+subdirs("simple")
+subdirs("magika")
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/gpt-2-batched"
+  "../../bin/gpt-2-batched.pdb"
+  "CMakeFiles/gpt-2-batched.dir/main-batched.cpp.o"
+  "CMakeFiles/gpt-2-batched.dir/main-batched.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/gpt-2-batched.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
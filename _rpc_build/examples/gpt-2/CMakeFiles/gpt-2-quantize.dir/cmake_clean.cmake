@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/gpt-2-quantize"
+  "../../bin/gpt-2-quantize.pdb"
+  "CMakeFiles/gpt-2-quantize.dir/quantize.cpp.o"
+  "CMakeFiles/gpt-2-quantize.dir/quantize.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/gpt-2-quantize.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/gpt-2-sched"
+  "../../bin/gpt-2-sched.pdb"
+  "CMakeFiles/gpt-2-sched.dir/main-sched.cpp.o"
+  "CMakeFiles/gpt-2-sched.dir/main-sched.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/gpt-2-sched.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/gpt-j-quantize"
+  "../../bin/gpt-j-quantize.pdb"
+  "CMakeFiles/gpt-j-quantize.dir/quantize.cpp.o"
+  "CMakeFiles/gpt-j-quantize.dir/quantize.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/gpt-j-quantize.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/gpt-j"
+  "../../bin/gpt-j.pdb"
+  "CMakeFiles/gpt-j.dir/main.cpp.o"
+  "CMakeFiles/gpt-j.dir/main.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/gpt-j.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
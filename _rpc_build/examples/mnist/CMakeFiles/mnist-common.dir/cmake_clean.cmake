@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/mnist-common.dir/mnist-common.cpp.o"
+  "CMakeFiles/mnist-common.dir/mnist-common.cpp.o.d"
+  "libmnist-common.a"
+  "libmnist-common.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/mnist-common.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/mnist-eval"
+  "../../bin/mnist-eval.pdb"
+  "CMakeFiles/mnist-eval.dir/mnist-eval.cpp.o"
+  "CMakeFiles/mnist-eval.dir/mnist-eval.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/mnist-eval.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
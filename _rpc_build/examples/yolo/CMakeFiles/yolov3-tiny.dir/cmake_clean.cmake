@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "../../bin/yolov3-tiny"
+  "../../bin/yolov3-tiny.pdb"
+  "CMakeFiles/yolov3-tiny.dir/yolo-image.cpp.o"
+  "CMakeFiles/yolov3-tiny.dir/yolo-image.cpp.o.d"
+  "CMakeFiles/yolov3-tiny.dir/yolov3-tiny.cpp.o"
+  "CMakeFiles/yolov3-tiny.dir/yolov3-tiny.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/yolov3-tiny.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
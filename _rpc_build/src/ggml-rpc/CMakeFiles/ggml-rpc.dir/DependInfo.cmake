@@ -0,0 +1,27 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/ggml-rpc/ggml-rpc.cpp" "src/ggml-rpc/CMakeFiles/ggml-rpc.dir/ggml-rpc.cpp.o" "gcc" "src/ggml-rpc/CMakeFiles/ggml-rpc.dir/ggml-rpc.cpp.o.d"
+  )
+
+# Pairs of files generated by the same build rule.
+set(CMAKE_MULTIPLE_OUTPUT_PAIRS
+  "/root/repo/_rpc_build/src/ggml-rpc/libggml-rpc.so" "/root/repo/_rpc_build/src/ggml-rpc/libggml-rpc.so.0.9.4"
+  "/root/repo/_rpc_build/src/ggml-rpc/libggml-rpc.so.0" "/root/repo/_rpc_build/src/ggml-rpc/libggml-rpc.so.0.9.4"
+  )
+
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_rpc_build/src/CMakeFiles/ggml-base.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ggml-rpc.dir/ggml-rpc.cpp.o"
+  "CMakeFiles/ggml-rpc.dir/ggml-rpc.cpp.o.d"
+  "libggml-rpc.pdb"
+  "libggml-rpc.so"
+  "libggml-rpc.so.0"
+  "libggml-rpc.so.0.9.4"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ggml-rpc.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
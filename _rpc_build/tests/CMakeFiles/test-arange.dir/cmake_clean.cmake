@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-arange"
+  "../bin/test-arange.pdb"
+  "CMakeFiles/test-arange.dir/test-arange.cpp.o"
+  "CMakeFiles/test-arange.dir/test-arange.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-arange.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-backend-ops"
+  "../bin/test-backend-ops.pdb"
+  "CMakeFiles/test-backend-ops.dir/test-backend-ops.cpp.o"
+  "CMakeFiles/test-backend-ops.dir/test-backend-ops.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-backend-ops.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-cont"
+  "../bin/test-cont.pdb"
+  "CMakeFiles/test-cont.dir/test-cont.c.o"
+  "CMakeFiles/test-cont.dir/test-cont.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/test-cont.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-conv2d-direct"
+  "../bin/test-conv2d-direct.pdb"
+  "CMakeFiles/test-conv2d-direct.dir/test-conv2d-direct.cpp.o"
+  "CMakeFiles/test-conv2d-direct.dir/test-conv2d-direct.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-conv2d-direct.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
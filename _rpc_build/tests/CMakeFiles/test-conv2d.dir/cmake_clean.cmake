@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-conv2d"
+  "../bin/test-conv2d.pdb"
+  "CMakeFiles/test-conv2d.dir/test-conv2d.cpp.o"
+  "CMakeFiles/test-conv2d.dir/test-conv2d.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-conv2d.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
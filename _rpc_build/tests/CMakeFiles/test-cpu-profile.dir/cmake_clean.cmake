@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-cpu-profile"
+  "../bin/test-cpu-profile.pdb"
+  "CMakeFiles/test-cpu-profile.dir/test-cpu-profile.cpp.o"
+  "CMakeFiles/test-cpu-profile.dir/test-cpu-profile.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-cpu-profile.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
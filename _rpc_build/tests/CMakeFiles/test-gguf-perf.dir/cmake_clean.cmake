@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-gguf-perf"
+  "../bin/test-gguf-perf.pdb"
+  "CMakeFiles/test-gguf-perf.dir/test-gguf-perf.cpp.o"
+  "CMakeFiles/test-gguf-perf.dir/test-gguf-perf.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-gguf-perf.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-interpolate"
+  "../bin/test-interpolate.pdb"
+  "CMakeFiles/test-interpolate.dir/test-interpolate.cpp.o"
+  "CMakeFiles/test-interpolate.dir/test-interpolate.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-interpolate.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-opt"
+  "../bin/test-opt.pdb"
+  "CMakeFiles/test-opt.dir/test-opt.cpp.o"
+  "CMakeFiles/test-opt.dir/test-opt.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-opt.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
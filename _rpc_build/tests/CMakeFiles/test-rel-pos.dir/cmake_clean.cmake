@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-rel-pos"
+  "../bin/test-rel-pos.pdb"
+  "CMakeFiles/test-rel-pos.dir/test-rel-pos.c.o"
+  "CMakeFiles/test-rel-pos.dir/test-rel-pos.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/test-rel-pos.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
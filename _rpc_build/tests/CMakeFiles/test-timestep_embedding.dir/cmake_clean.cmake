@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-timestep_embedding"
+  "../bin/test-timestep_embedding.pdb"
+  "CMakeFiles/test-timestep_embedding.dir/test-timestep_embedding.cpp.o"
+  "CMakeFiles/test-timestep_embedding.dir/test-timestep_embedding.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-timestep_embedding.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
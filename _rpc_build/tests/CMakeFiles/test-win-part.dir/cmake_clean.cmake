@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test-win-part"
+  "../bin/test-win-part.pdb"
+  "CMakeFiles/test-win-part.dir/test-win-part.cpp.o"
+  "CMakeFiles/test-win-part.dir/test-win-part.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-win-part.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
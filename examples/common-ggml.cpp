@@ -1,7 +1,9 @@
 #include "common-ggml.h"
 
+#include <algorithm>
 #include <regex>
 #include <map>
+#include <thread>
 
 static const std::map<std::string, enum ggml_ftype> GGML_FTYPE_MAP = {
     {"q4_0", GGML_FTYPE_MOSTLY_Q4_0},
@@ -73,6 +75,8 @@ bool ggml_common_quantize_0(
         case GGML_FTYPE_MOSTLY_IQ1_M:
         case GGML_FTYPE_MOSTLY_BF16:
         case GGML_FTYPE_MOSTLY_MXFP4:
+        case GGML_FTYPE_MOSTLY_F8_E4M3:
+        case GGML_FTYPE_MOSTLY_F8_E5M2:
                 {
                     fprintf(stderr, "%s: invalid model type %d\n", __func__, ftype);
                     return false;
@@ -87,6 +91,8 @@ bool ggml_common_quantize_0(
     size_t total_size_org = 0;
     size_t total_size_new = 0;
 
+    const int n_threads = (int) std::max(1u, std::thread::hardware_concurrency());
+
     std::vector<float> work;
 
     std::vector<uint8_t>     data_u8;
@@ -189,7 +195,7 @@ bool ggml_common_quantize_0(
                 case GGML_TYPE_Q5_K:
                 case GGML_TYPE_Q6_K:
                     {
-                        cur_size = ggml_quantize_chunk((ggml_type) ttype, data_f32.data(), work.data(), 0, nelements/ne[0], ne[0], nullptr);
+                        cur_size = ggml_quantize_chunk_mt((ggml_type) ttype, data_f32.data(), work.data(), 0, nelements/ne[0], ne[0], nullptr, n_threads);
                     } break;
                 case GGML_TYPE_F32:
                 case GGML_TYPE_F16:
@@ -213,6 +219,8 @@ bool ggml_common_quantize_0(
                 case GGML_TYPE_TQ1_0:
                 case GGML_TYPE_TQ2_0:
                 case GGML_TYPE_MXFP4:
+                case GGML_TYPE_F8_E4M3:
+                case GGML_TYPE_F8_E5M2:
                 case GGML_TYPE_COUNT:
                     {
                         fprintf(stderr, "%s: unsupported quantization type %d (%s)\n", __func__, ttype, ggml_type_name((ggml_type) ttype));
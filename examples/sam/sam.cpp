@@ -20,6 +20,7 @@
 #include <string>
 #include <vector>
 #include <thread>
+#include <future>
 #include <cinttypes>
 
 #if defined(_MSC_VER)
@@ -236,6 +237,7 @@ struct sam_decoder_mask {
 
 struct sam_state {
     struct ggml_tensor * embd_img;
+    struct ggml_tensor * embd_imgs; // image embeddings of the current batch
 
     struct ggml_tensor * low_res_masks;
     struct ggml_tensor * iou_predictions;
@@ -316,10 +318,11 @@ struct sam_prompt {
 
 struct sam_params {
     int32_t seed      = -1; // RNG seed
-    int32_t n_threads = std::min(4, (int32_t) std::thread::hardware_concurrency());
+    int32_t n_threads = std::max(1, (int32_t) std::thread::hardware_concurrency());
+    int32_t n_batch   = 1;  // number of images encoded together
 
     std::string model     = "models/sam-vit-b/ggml-model-f16.bin"; // model path
-    std::string fname_inp = "img.jpg";
+    std::vector<std::string> fname_inp; // input images, "img.jpg" if none are given
     std::string fname_out = "img.out";
     float   mask_threshold            = 0.f;
     float   iou_threshold             = 0.88f;
@@ -1187,10 +1190,11 @@ struct ggml_tensor* sam_layer_norm_2d(
     return layer;
 }
 
+// encodes the images of a batch into the first imgs.size() images of state.embd_imgs
 struct ggml_cgraph  * sam_encode_image(
-            const sam_model & model,
-                  sam_state & state,
-        const sam_image_f32 & img) {
+                          const sam_model & model,
+                                sam_state & state,
+        const std::vector<sam_image_f32> & imgs) {
 
     const auto & hparams = model.hparams;
     const auto & enc     = model.enc_img;
@@ -1212,11 +1216,17 @@ struct ggml_cgraph  * sam_encode_image(
     struct ggml_context * ctx0   = ggml_init(ggml_params);
     struct ggml_cgraph  * gf     = ggml_new_graph(ctx0);
 
-    struct ggml_tensor * inp = ggml_new_tensor_4d(ctx0, GGML_TYPE_F32, n_img_size, n_img_size, 3, 1);
+    const int n_imgs = (int) imgs.size();
+    GGML_ASSERT(n_imgs > 0 && n_imgs <= state.embd_imgs->ne[3]);
+
+    // the images are stacked along the batch dimension, the windows of the local attention layers are
+    // stacked along the same dimension
+    struct ggml_tensor * inp = ggml_new_tensor_4d(ctx0, GGML_TYPE_F32, n_img_size, n_img_size, 3, n_imgs);
     ggml_set_name(inp, "inp");
     ggml_set_input(inp);
 
     // ref: https://github.com/facebookresearch/segment-anything/blob/main/segment_anything/modeling/image_encoder.py#L392
+    // im2col + mul_mat is faster than CONV_2D for the 3 input channels of the patch embedding
     struct ggml_tensor * cur = ggml_conv_2d_sk_p0(ctx0, enc.proj_w, inp);
     cur = ggml_add_inplace(ctx0,
             cur,
@@ -1367,18 +1377,20 @@ struct ggml_cgraph  * sam_encode_image(
 
     cur = ggml_cont(ctx0, ggml_permute(ctx0, inpL, 2, 0, 1, 3));
 
-    cur = ggml_conv_2d_sk_p0(ctx0, enc.neck_conv_0, cur);
+    cur = ggml_conv_2d_direct(ctx0, enc.neck_conv_0, cur, 1, 1, 0, 0, 1, 1);
 
     cur = sam_layer_norm_2d(ctx0, cur, n_enc_out_chans, enc.neck_norm_0_w, enc.neck_norm_0_b, hparams.eps);
 
-    cur = ggml_conv_2d_s1_ph(ctx0, enc.neck_conv_1, cur);
+    cur = ggml_conv_2d_direct(ctx0, enc.neck_conv_1, cur, 1, 1, enc.neck_conv_1->ne[0]/2, enc.neck_conv_1->ne[1]/2, 1, 1);
 
     cur = sam_layer_norm_2d(ctx0, cur, n_enc_out_chans, enc.neck_norm_1_w, enc.neck_norm_1_b, hparams.eps);
 
-    cur = ggml_cpy(ctx0, cur, state.embd_img);
+    cur = ggml_cpy(ctx0, cur, ggml_view_4d(ctx0, state.embd_imgs,
+                state.embd_imgs->ne[0], state.embd_imgs->ne[1], state.embd_imgs->ne[2], n_imgs,
+                state.embd_imgs->nb[1], state.embd_imgs->nb[2], state.embd_imgs->nb[3], 0));
 
     ggml_build_forward_expand(gf, cur);
-    ggml_disconnect_node_from_graph(state.embd_img);
+    ggml_disconnect_node_from_graph(state.embd_imgs);
 
     //ggml_graph_print(&gf);
 
@@ -1388,18 +1400,23 @@ struct ggml_cgraph  * sam_encode_image(
 
     {
         struct ggml_tensor * inp = ggml_graph_get_tensor(gf, "inp");
-        float * data = (float *) ggml_get_data(inp);
 
-        const int nx = img.nx;
-        const int ny = img.ny;
-        const int n  = nx*ny;
+        for (int b = 0; b < n_imgs; b++) {
+            const sam_image_f32 & img = imgs[b];
+
+            float * data = (float *) ((char *) ggml_get_data(inp) + b*inp->nb[3]);
 
-        GGML_ASSERT(nx == n_img_size && ny == n_img_size);
+            const int nx = img.nx;
+            const int ny = img.ny;
+            const int n  = nx*ny;
 
-        for (int k = 0; k < 3; k++) {
-            for (int y = 0; y < ny; y++) {
-                for (int x = 0; x < nx; x++) {
-                    data[k*n + y*nx + x] = img.data[3*(y*nx + x) + k];
+            GGML_ASSERT(nx == n_img_size && ny == n_img_size);
+
+            for (int k = 0; k < 3; k++) {
+                for (int y = 0; y < ny; y++) {
+                    for (int x = 0; x < nx; x++) {
+                        data[k*n + y*nx + x] = img.data[3*(y*nx + x) + k];
+                    }
                 }
             }
         }
@@ -2100,12 +2117,14 @@ void sam_print_usage(int argc, char ** argv, const sam_params & params) {
     fprintf(stderr, "  -h, --help            show this help message and exit\n");
     fprintf(stderr, "  -s SEED, --seed SEED  RNG seed (default: -1)\n");
     fprintf(stderr, "  -t N, --threads N     number of threads to use during computation (default: %d)\n", params.n_threads);
+    fprintf(stderr, "  -bs N, --batch-size N number of images encoded together (default: %d)\n", params.n_batch);
     fprintf(stderr, "  -m FNAME, --model FNAME\n");
     fprintf(stderr, "                        model path (default: %s)\n", params.model.c_str());
     fprintf(stderr, "  -i FNAME, --inp FNAME\n");
-    fprintf(stderr, "                        input file (default: %s)\n", params.fname_inp.c_str());
+    fprintf(stderr, "                        input file, can be repeated (default: img.jpg)\n");
     fprintf(stderr, "  -o FNAME, --out FNAME\n");
-    fprintf(stderr, "                        mask file name prefix (default: %s)\n", params.fname_out.c_str());
+    fprintf(stderr, "                        mask file name prefix, followed by the index of the image when\n");
+    fprintf(stderr, "                        there are several input files (default: %s)\n", params.fname_out.c_str());
     fprintf(stderr, "  -sm, --single-mask\n");
     fprintf(stderr, "                        single mask output (default multi mask output)\n");
     fprintf(stderr, "SAM hyperparameters:\n");
@@ -2142,10 +2161,12 @@ bool sam_params_parse(int argc, char ** argv, sam_params & params) {
             params.seed = std::stoi(argv[++i]);
         } else if (arg == "-t" || arg == "--threads") {
             params.n_threads = std::stoi(argv[++i]);
+        } else if (arg == "-bs" || arg == "--batch-size") {
+            params.n_batch = std::max(1, std::stoi(argv[++i]));
         } else if (arg == "-m" || arg == "--model") {
             params.model = argv[++i];
         } else if (arg == "-i" || arg == "--inp") {
-            params.fname_inp = argv[++i];
+            params.fname_inp.push_back(argv[++i]);
         } else if (arg == "-o" || arg == "--out") {
             params.fname_out = argv[++i];
         } else if (arg == "-sm" || arg == "--single-mask") {
@@ -2225,9 +2246,45 @@ bool sam_params_parse(int argc, char ** argv, sam_params & params) {
         params.prompt.prompt_type = SAM_PROMPT_TYPE_BOX;
     }
 
+    if (params.fname_inp.empty()) {
+        params.fname_inp.push_back("img.jpg");
+    }
+
     return true;
 }
 
+// images of a batch, loaded and preprocessed to f32
+struct sam_batch {
+    bool ok = true;
+
+    std::vector<sam_image_u8>  imgs_u8;
+    std::vector<sam_image_f32> imgs_f32;
+};
+
+static sam_batch sam_batch_load(const std::vector<std::string> & fnames, size_t i0, size_t n) {
+    sam_batch batch;
+
+    batch.imgs_u8.resize(n);
+    batch.imgs_f32.resize(n);
+
+    for (size_t i = 0; i < n; ++i) {
+        const std::string & fname = fnames[i0 + i];
+
+        if (!sam_image_load_from_file(fname, batch.imgs_u8[i])) {
+            fprintf(stderr, "%s: failed to load image from '%s'\n", __func__, fname.c_str());
+            batch.ok = false;
+            break;
+        }
+        if (!sam_image_preprocess(batch.imgs_u8[i], batch.imgs_f32[i])) {
+            fprintf(stderr, "%s: failed to preprocess image '%s'\n", __func__, fname.c_str());
+            batch.ok = false;
+            break;
+        }
+    }
+
+    return batch;
+}
+
 
 int main(int argc, char ** argv) {
     const int64_t t_main_start_us = ggml_time_us();
@@ -2248,22 +2305,8 @@ int main(int argc, char ** argv) {
     }
     fprintf(stderr, "%s: seed = %d\n", __func__, params.seed);
 
-    // load the image
-    sam_image_u8 img0;
-    if (!sam_image_load_from_file(params.fname_inp, img0)) {
-        fprintf(stderr, "%s: failed to load image from '%s'\n", __func__, params.fname_inp.c_str());
-        return 1;
-    }
-    fprintf(stderr, "%s: loaded image '%s' (%d x %d)\n", __func__, params.fname_inp.c_str(), img0.nx, img0.ny);
-
-    // preprocess to f32
-    sam_image_f32 img1;
-    if (!sam_image_preprocess(img0, img1)) {
-        fprintf(stderr, "%s: failed to preprocess image\n", __func__);
-        return 1;
-    }
-    fprintf(stderr, "%s: preprocessed image (%d x %d)\n", __func__, img1.nx, img1.ny);
-
+    const int n_imgs  = (int) params.fname_inp.size();
+    const int n_batch = std::min(params.n_batch, n_imgs);
 
     // load the model
     {
@@ -2278,7 +2321,8 @@ int main(int argc, char ** argv) {
     }
 
     {
-        static size_t buf_size = 256u*1024*1024;
+        const size_t buf_size = 256u*1024*1024 +
+            (size_t) n_batch*model.hparams.n_img_embd()*model.hparams.n_img_embd()*model.hparams.n_enc_out_chans*sizeof(float);
 
         struct ggml_init_params ggml_params = {
             /*.mem_size   =*/ buf_size,
@@ -2291,75 +2335,120 @@ int main(int argc, char ** argv) {
         state.embd_img = ggml_new_tensor_3d(state.ctx, GGML_TYPE_F32,
                 model.hparams.n_img_embd(), model.hparams.n_img_embd(), model.hparams.n_enc_out_chans);
 
+        state.embd_imgs = ggml_new_tensor_4d(state.ctx, GGML_TYPE_F32,
+                model.hparams.n_img_embd(), model.hparams.n_img_embd(), model.hparams.n_enc_out_chans, n_batch);
+
         state.low_res_masks = ggml_new_tensor_3d(state.ctx, GGML_TYPE_F32,
                 model.hparams.n_enc_out_chans, model.hparams.n_enc_out_chans, 3);
 
         state.iou_predictions = ggml_new_tensor_1d(state.ctx, GGML_TYPE_F32, 3);
     }
 
-    // Encode image
-    {
-        state.buf_compute_img_enc.resize(ggml_tensor_overhead()*GGML_DEFAULT_GRAPH_SIZE + ggml_graph_overhead());
-        state.allocr = ggml_gallocr_new(ggml_backend_cpu_buffer_type());
+    switch (params.prompt.prompt_type) {
+    case SAM_PROMPT_TYPE_POINT:
+        fprintf(stderr, "Using point prompt: (%f, %f)\n", params.prompt.pt.x, params.prompt.pt.y);
+        break;
+    case SAM_PROMPT_TYPE_BOX:
+        fprintf(stderr, "Using box prompt: (%f, %f, %f, %f)\n",
+            params.prompt.box.x1,
+            params.prompt.box.y1,
+            params.prompt.box.x2,
+            params.prompt.box.y2);
+        break;
+    }
+
+    state.buf_compute_img_enc.resize(ggml_tensor_overhead()*GGML_DEFAULT_GRAPH_SIZE + ggml_graph_overhead());
+    state.buf_compute_fast.resize(ggml_tensor_overhead()*GGML_DEFAULT_GRAPH_SIZE + ggml_graph_overhead());
+
+    const int64_t t_run_start_us = ggml_time_us();
+
+    int64_t t_enc_us = 0;
 
-        struct ggml_cgraph  * gf = sam_encode_image(model, state, img1);
-        if (!gf) {
-            fprintf(stderr, "%s: failed to encode image\n", __func__);
+    // the images of the next batch are loaded and preprocessed while the current batch is computed
+    std::future<sam_batch> next = std::async(std::launch::async, sam_batch_load, std::cref(params.fname_inp), 0, n_batch);
+
+    for (int i0 = 0; i0 < n_imgs; i0 += n_batch) {
+        const int n = std::min(n_batch, n_imgs - i0);
+
+        sam_batch batch = next.get();
+        if (!batch.ok) {
             return 1;
         }
 
-        ggml_graph_compute_helper(state.work_buffer, gf, params.n_threads);
+        if (i0 + n < n_imgs) {
+            next = std::async(std::launch::async, sam_batch_load, std::cref(params.fname_inp), i0 + n, std::min(n_batch, n_imgs - i0 - n));
+        }
 
-        // print_t_f32("embd_img", state.embd_img);
+        for (int b = 0; b < n; ++b) {
+            fprintf(stderr, "%s: loaded image '%s' (%d x %d)\n", __func__, params.fname_inp[i0 + b].c_str(), batch.imgs_u8[b].nx, batch.imgs_u8[b].ny);
+        }
 
-        ggml_gallocr_free(state.allocr);
-        state.allocr = NULL;
-        state.work_buffer.clear();
-    }
+        // Encode images
+        {
+            const int64_t t_start_us = ggml_time_us();
 
-    // Encode prompt and decode mask
-    {
-        state.buf_compute_fast.resize(ggml_tensor_overhead()*GGML_DEFAULT_GRAPH_SIZE + ggml_graph_overhead());
-        state.allocr = ggml_gallocr_new(ggml_backend_cpu_buffer_type());
+            state.allocr = ggml_gallocr_new(ggml_backend_cpu_buffer_type());
 
-        switch (params.prompt.prompt_type) {
-        case SAM_PROMPT_TYPE_POINT:
-            fprintf(stderr, "Using point prompt: (%f, %f)\n", params.prompt.pt.x, params.prompt.pt.y);
-            break;
-        case SAM_PROMPT_TYPE_BOX:
-            fprintf(stderr, "Using box prompt: (%f, %f, %f, %f)\n",
-                params.prompt.box.x1,
-                params.prompt.box.y1,
-                params.prompt.box.x2,
-                params.prompt.box.y2);
-            break;
-        }
+            struct ggml_cgraph  * gf = sam_encode_image(model, state, batch.imgs_f32);
+            if (!gf) {
+                fprintf(stderr, "%s: failed to encode image\n", __func__);
+                return 1;
+            }
 
-        struct ggml_cgraph * gf = sam_build_fast_graph(model, state, img0.nx, img0.ny, params.prompt, params.multimask_output);
-        if (!gf) {
-            fprintf(stderr, "%s: failed to build fast graph\n", __func__);
-            return 1;
+            ggml_graph_compute_helper(state.work_buffer, gf, params.n_threads);
+
+            // print_t_f32("embd_imgs", state.embd_imgs);
+
+            ggml_gallocr_free(state.allocr);
+            state.allocr = NULL;
+            state.work_buffer.clear();
+
+            t_enc_us += ggml_time_us() - t_start_us;
         }
 
-        ggml_graph_compute_helper(state.work_buffer, gf, params.n_threads);
+        // Encode prompt and decode mask of each image
+        state.allocr = ggml_gallocr_new(ggml_backend_cpu_buffer_type());
+
+        for (int b = 0; b < n; ++b) {
+            const sam_image_u8 & img0 = batch.imgs_u8[b];
+
+            memcpy(state.embd_img->data, (const char *) state.embd_imgs->data + b*state.embd_imgs->nb[3], ggml_nbytes(state.embd_img));
+
+            struct ggml_cgraph * gf = sam_build_fast_graph(model, state, img0.nx, img0.ny, params.prompt, params.multimask_output);
+            if (!gf) {
+                fprintf(stderr, "%s: failed to build fast graph\n", __func__);
+                return 1;
+            }
+
+            ggml_graph_compute_helper(state.work_buffer, gf, params.n_threads);
+
+            //print_t_f32("iou_predictions", state.iou_predictions);
+            //print_t_f32("low_res_masks", state.low_res_masks);
+
+            std::string fname_out = params.fname_out;
+            if (n_imgs > 1) {
+                fname_out += "." + std::to_string(i0 + b) + (params.multimask_output ? "." : "");
+            }
+
+            if (!sam_write_masks(model.hparams, img0.nx, img0.ny, state, fname_out, params.multimask_output)) {
+                fprintf(stderr, "%s: failed to write masks\n", __func__);
+                return 1;
+            }
+        }
 
-        //print_t_f32("iou_predictions", state.iou_predictions);
-        //print_t_f32("low_res_masks", state.low_res_masks);
         ggml_gallocr_free(state.allocr);
         state.allocr = NULL;
     }
 
-    if (!sam_write_masks(model.hparams, img0.nx, img0.ny, state, params.fname_out, params.multimask_output)) {
-        fprintf(stderr, "%s: failed to write masks\n", __func__);
-        return 1;
-    }
-
     // report timing
     {
         const int64_t t_main_end_us = ggml_time_us();
+        const float   t_run_s       = (t_main_end_us - t_run_start_us)/1e6f;
 
         fprintf(stderr, "\n\n");
         fprintf(stderr, "%s:     load time = %8.2f ms\n", __func__, t_load_us/1000.0f);
+        fprintf(stderr, "%s:   encode time = %8.2f ms / %.2f ms per image (batch size = %d)\n", __func__, t_enc_us/1000.0f, t_enc_us/1000.0f/n_imgs, n_batch);
+        fprintf(stderr, "%s:    throughput = %8.2f images/s (%d images)\n", __func__, n_imgs/t_run_s, n_imgs);
         fprintf(stderr, "%s:    total time = %8.2f ms\n", __func__, (t_main_end_us - t_main_start_us)/1000.0f);
     }
 
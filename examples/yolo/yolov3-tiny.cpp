@@ -14,6 +14,7 @@
 #include <algorithm>
 #include <fstream>
 #include <algorithm>
+#include <future>
 #include <thread>
 
 #if defined(_MSC_VER)
@@ -23,9 +24,7 @@
 struct conv2d_layer {
     struct ggml_tensor * weights;
     struct ggml_tensor * biases;
-    struct ggml_tensor * scales;
-    struct ggml_tensor * rolling_mean;
-    struct ggml_tensor * rolling_variance;
+    struct ggml_tensor * scales; // batch normalization folded into scales and biases, see fold_batch_norm
     int padding = 1;
     bool batch_normalize = true;
     bool activate = true; // true for leaky relu, false for linear
@@ -48,13 +47,14 @@ struct yolo_layer {
     int w;
     int h;
 
-    yolo_layer(int classes, const std::vector<int> & mask, const std::vector<float> & anchors, struct ggml_tensor * prev_layer)
+    // predictions of image b of the batch
+    yolo_layer(int classes, const std::vector<int> & mask, const std::vector<float> & anchors, struct ggml_tensor * prev_layer, int b)
         : classes(classes), mask(mask), anchors(anchors)
     {
         w = prev_layer->ne[0];
         h = prev_layer->ne[1];
-        predictions.resize(ggml_nbytes(prev_layer)/sizeof(float));
-        ggml_backend_tensor_get(prev_layer, predictions.data(), 0, ggml_nbytes(prev_layer));
+        predictions.resize(prev_layer->nb[3]/sizeof(float));
+        ggml_backend_tensor_get(prev_layer, predictions.data(), b*prev_layer->nb[3], prev_layer->nb[3]);
     }
 
     int entry_index(int location, int entry) const {
@@ -74,6 +74,32 @@ struct detection {
     float objectness;
 };
 
+// (x - mean) / sqrt(variance) * scale + bias = x * scale' + bias', so that a layer is conv -> mul -> add -> leaky_relu
+// whose element-wise nodes the CPU backend computes as part of the convolution
+static void fold_batch_norm(struct ggml_context * ctx, int layer) {
+    char name[256];
+    snprintf(name, sizeof(name), "l%d_rolling_mean", layer);
+    struct ggml_tensor * mean = ggml_get_tensor(ctx, name);
+    snprintf(name, sizeof(name), "l%d_rolling_variance", layer);
+    struct ggml_tensor * variance = ggml_get_tensor(ctx, name);
+    snprintf(name, sizeof(name), "l%d_scales", layer);
+    struct ggml_tensor * scales = ggml_get_tensor(ctx, name);
+    snprintf(name, sizeof(name), "l%d_biases", layer);
+    struct ggml_tensor * biases = ggml_get_tensor(ctx, name);
+
+    GGML_ASSERT(mean->type == GGML_TYPE_F32 && variance->type == GGML_TYPE_F32);
+    GGML_ASSERT(scales->type == GGML_TYPE_F32 && biases->type == GGML_TYPE_F32);
+
+    float * m = (float *) mean->data;
+    float * v = (float *) variance->data;
+    float * s = (float *) scales->data;
+    float * b = (float *) biases->data;
+    for (int64_t i = 0; i < ggml_nelements(scales); i++) {
+        s[i] = s[i] / sqrtf(v[i]);
+        b[i] = b[i] - m[i] * s[i];
+    }
+}
+
 static bool load_model(const std::string & fname, yolo_model & model) {
     struct ggml_context * tmp_ctx = nullptr;
     struct gguf_init_params gguf_params = {
@@ -86,6 +112,21 @@ static bool load_model(const std::string & fname, yolo_model & model) {
         return false;
     }
 
+    model.conv2d_layers.resize(13);
+    model.conv2d_layers[7].padding = 0;
+    model.conv2d_layers[9].padding = 0;
+    model.conv2d_layers[9].batch_normalize = false;
+    model.conv2d_layers[9].activate = false;
+    model.conv2d_layers[10].padding = 0;
+    model.conv2d_layers[12].padding = 0;
+    model.conv2d_layers[12].batch_normalize = false;
+    model.conv2d_layers[12].activate = false;
+    for (int i = 0; i < (int)model.conv2d_layers.size(); i++) {
+        if (model.conv2d_layers[i].batch_normalize) {
+            fold_batch_norm(tmp_ctx, i);
+        }
+    }
+
     int num_tensors = gguf_get_n_tensors(gguf_ctx);
     struct ggml_init_params params {
             /*.mem_size   =*/ ggml_tensor_overhead() * num_tensors,
@@ -110,15 +151,6 @@ static bool load_model(const std::string & fname, yolo_model & model) {
 
     model.width  = 416;
     model.height = 416;
-    model.conv2d_layers.resize(13);
-    model.conv2d_layers[7].padding = 0;
-    model.conv2d_layers[9].padding = 0;
-    model.conv2d_layers[9].batch_normalize = false;
-    model.conv2d_layers[9].activate = false;
-    model.conv2d_layers[10].padding = 0;
-    model.conv2d_layers[12].padding = 0;
-    model.conv2d_layers[12].batch_normalize = false;
-    model.conv2d_layers[12].activate = false;
     for (int i = 0; i < (int)model.conv2d_layers.size(); i++) {
         char name[256];
         snprintf(name, sizeof(name), "l%d_weights", i);
@@ -128,10 +160,6 @@ static bool load_model(const std::string & fname, yolo_model & model) {
         if (model.conv2d_layers[i].batch_normalize) {
             snprintf(name, sizeof(name), "l%d_scales", i);
             model.conv2d_layers[i].scales = ggml_get_tensor(model.ctx, name);
-            snprintf(name, sizeof(name), "l%d_rolling_mean", i);
-            model.conv2d_layers[i].rolling_mean = ggml_get_tensor(model.ctx, name);
-            snprintf(name, sizeof(name), "l%d_rolling_variance", i);
-            model.conv2d_layers[i].rolling_variance = ggml_get_tensor(model.ctx, name);
         }
     }
     return true;
@@ -169,13 +197,12 @@ static bool load_alphabet(std::vector<yolo_image> & alphabet)
 
 static ggml_tensor * apply_conv2d(ggml_context * ctx, ggml_tensor * input, const conv2d_layer & layer)
 {
-    struct ggml_tensor * result = ggml_conv_2d(ctx, layer.weights, input, 1, 1, layer.padding, layer.padding, 1, 1);
+    const int64_t n_out = layer.weights->ne[3];
+    struct ggml_tensor * result = ggml_conv_2d_direct(ctx, layer.weights, input, 1, 1, layer.padding, layer.padding, 1, 1);
     if (layer.batch_normalize) {
-        result = ggml_sub(ctx, result, ggml_repeat(ctx, layer.rolling_mean, result));
-        result = ggml_div(ctx, result, ggml_sqrt(ctx, ggml_repeat(ctx, layer.rolling_variance, result)));
-        result = ggml_mul(ctx, result, ggml_repeat(ctx, layer.scales, result));
+        result = ggml_mul(ctx, result, ggml_reshape_4d(ctx, layer.scales, 1, 1, n_out, 1));
     }
-    result = ggml_add(ctx, result, ggml_repeat(ctx, layer.biases, result));
+    result = ggml_add(ctx, result, ggml_reshape_4d(ctx, layer.biases, 1, 1, n_out, 1));
     if (layer.activate) {
         result = ggml_leaky_relu(ctx, result, 0.1f, true);
     }
@@ -390,10 +417,11 @@ static void print_shape(int layer, const ggml_tensor * t)
     printf("Layer %2d output shape:  %3d x %3d x %4d x %3d\n", layer, (int)t->ne[0], (int)t->ne[1], (int)t->ne[2], (int)t->ne[3]);
 }
 
-static struct ggml_cgraph * build_graph(struct ggml_context * ctx_cgraph, const yolo_model & model) {
+// the images of a batch are stacked along the last dimension of the input
+static struct ggml_cgraph * build_graph(struct ggml_context * ctx_cgraph, const yolo_model & model, int n_batch) {
     struct ggml_cgraph * gf = ggml_new_graph(ctx_cgraph);
 
-    struct ggml_tensor * input = ggml_new_tensor_4d(ctx_cgraph, GGML_TYPE_F32, model.width, model.height, 3, 1);
+    struct ggml_tensor * input = ggml_new_tensor_4d(ctx_cgraph, GGML_TYPE_F32, model.width, model.height, 3, n_batch);
     ggml_set_name(input, "input");
     struct ggml_tensor * result = apply_conv2d(ctx_cgraph, input, model.conv2d_layers[0]);
     print_shape(0, result);
@@ -452,12 +480,36 @@ static struct ggml_cgraph * build_graph(struct ggml_context * ctx_cgraph, const
     return gf;
 }
 
-void detect(yolo_image & img, struct ggml_cgraph * gf, const yolo_model & model, float thresh, const std::vector<std::string> & labels, const std::vector<yolo_image> & alphabet)
+// letterboxed images of a batch, see load_batch
+struct yolo_batch {
+    bool ok = true;
+    std::vector<yolo_image> imgs;
+    std::vector<yolo_image> sized;
+};
+
+static yolo_batch load_batch(const std::vector<std::string> & fnames, size_t i0, size_t n, const yolo_model & model)
+{
+    yolo_batch batch;
+    batch.imgs.resize(n);
+    batch.sized.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        if (!load_image(fnames[i0 + i].c_str(), batch.imgs[i])) {
+            fprintf(stderr, "%s: failed to load image from '%s'\n", __func__, fnames[i0 + i].c_str());
+            batch.ok = false;
+            break;
+        }
+        batch.sized[i] = letterbox_image(batch.imgs[i], model.width, model.height);
+    }
+    return batch;
+}
+
+void detect(yolo_batch & batch, struct ggml_cgraph * gf, const yolo_model & model, float thresh, const std::vector<std::string> & labels, const std::vector<yolo_image> & alphabet)
 {
-    std::vector<detection> detections;
-    yolo_image sized = letterbox_image(img, model.width, model.height);
     struct ggml_tensor * input = ggml_graph_get_tensor(gf, "input");
-    ggml_backend_tensor_set(input, sized.data.data(), 0, ggml_nbytes(input));
+    GGML_ASSERT(input->ne[3] == (int64_t) batch.sized.size());
+    for (size_t b = 0; b < batch.sized.size(); b++) {
+        ggml_backend_tensor_set(input, batch.sized[b].data.data(), b*input->nb[3], input->nb[3]);
+    }
 
     if (ggml_backend_graph_compute(model.backend, gf) != GGML_STATUS_SUCCESS) {
         fprintf(stderr, "%s: ggml_backend_graph_compute() failed\n", __func__);
@@ -465,25 +517,45 @@ void detect(yolo_image & img, struct ggml_cgraph * gf, const yolo_model & model,
     }
 
     struct ggml_tensor * layer_15 = ggml_graph_get_tensor(gf, "layer_15");
-    yolo_layer yolo16{ 80, {3, 4, 5}, {10, 14, 23, 27, 37,58, 81, 82, 135, 169, 344, 319}, layer_15};
-    apply_yolo(yolo16);
-    get_yolo_detections(yolo16, detections, img.w, img.h, model.width, model.height, thresh);
-
     struct ggml_tensor * layer_22 = ggml_graph_get_tensor(gf, "layer_22");
-    yolo_layer yolo23{ 80, {0, 1, 2}, {10, 14, 23, 27, 37,58, 81, 82, 135, 169, 344, 319}, layer_22};
-    apply_yolo(yolo23);
-    get_yolo_detections(yolo23, detections, img.w, img.h, model.width, model.height, thresh);
 
-    do_nms_sort(detections, yolo23.classes, .45);
-    draw_detections(img, detections, thresh, labels, alphabet);
+    for (size_t b = 0; b < batch.imgs.size(); b++) {
+        yolo_image & img = batch.imgs[b];
+        std::vector<detection> detections;
+
+        yolo_layer yolo16{ 80, {3, 4, 5}, {10, 14, 23, 27, 37,58, 81, 82, 135, 169, 344, 319}, layer_15, (int) b};
+        apply_yolo(yolo16);
+        get_yolo_detections(yolo16, detections, img.w, img.h, model.width, model.height, thresh);
+
+        yolo_layer yolo23{ 80, {0, 1, 2}, {10, 14, 23, 27, 37,58, 81, 82, 135, 169, 344, 319}, layer_22, (int) b};
+        apply_yolo(yolo23);
+        get_yolo_detections(yolo23, detections, img.w, img.h, model.width, model.height, thresh);
+
+        do_nms_sort(detections, yolo23.classes, .45);
+        draw_detections(img, detections, thresh, labels, alphabet);
+    }
+}
+
+// output file of image i, the index is inserted before the extension when there are several input files
+static std::string output_fname(const std::string & fname_out, int i, int n)
+{
+    if (n == 1) {
+        return fname_out;
+    }
+    const size_t pos = fname_out.find_last_of('.');
+    if (pos == std::string::npos) {
+        return fname_out + "." + std::to_string(i);
+    }
+    return fname_out.substr(0, pos) + "." + std::to_string(i) + fname_out.substr(pos);
 }
 
 struct yolo_params {
     float thresh          = 0.5;
     std::string model     = "yolov3-tiny.gguf";
-    std::string fname_inp = "input.jpg";
+    std::vector<std::string> fname_inp; // "input.jpg" if none are given
     std::string fname_out = "predictions.jpg";
     int         n_threads  = std::max(1U, std::thread::hardware_concurrency()/2);
+    int         n_batch    = 1;
     std::string device;
 };
 
@@ -496,8 +568,10 @@ void yolo_print_usage(int argc, char ** argv, const yolo_params & params) {
     fprintf(stderr, "  -t,  --threads N           number of threads for the CPU backend (default: %d)\n", params.n_threads);
     fprintf(stderr, "  -th, --thresh T            detection threshold (default: %.2f)\n", params.thresh);
     fprintf(stderr, "  -m,  --model FNAME         model path (default: %s)\n", params.model.c_str());
-    fprintf(stderr, "  -i,  --inp FNAME           input file (default: %s)\n", params.fname_inp.c_str());
-    fprintf(stderr, "  -o,  --out FNAME           output file (default: %s)\n", params.fname_out.c_str());
+    fprintf(stderr, "  -bs, --batch-size N        number of images computed together (default: %d)\n", params.n_batch);
+    fprintf(stderr, "  -i,  --inp FNAME           input file, can be repeated (default: input.jpg)\n");
+    fprintf(stderr, "  -o,  --out FNAME           output file, the index of the image is inserted before the\n");
+    fprintf(stderr, "                             extension when there are several input files (default: %s)\n", params.fname_out.c_str());
     fprintf(stderr, "\n");
 }
 
@@ -513,7 +587,7 @@ bool yolo_params_parse(int argc, char ** argv, yolo_params & params) {
         } else if (arg == "-m" || arg == "--model") {
             params.model = argv[++i];
         } else if (arg == "-i" || arg == "--inp") {
-            params.fname_inp = argv[++i];
+            params.fname_inp.push_back(argv[++i]);
         } else if (arg == "-o" || arg == "--out") {
             params.fname_out = argv[++i];
         } else if (arg == "-t" || arg == "--threads") {
@@ -525,6 +599,15 @@ bool yolo_params_parse(int argc, char ** argv, yolo_params & params) {
                 fprintf(stderr, "error: invalid number of threads: %d\n", params.n_threads);
                 return false;
             }
+        } else if (arg == "-bs" || arg == "--batch-size") {
+            if (++i >= argc) {
+                return false;
+            }
+            params.n_batch = std::stoi(argv[i]);
+            if (params.n_batch <= 0) {
+                fprintf(stderr, "error: invalid batch size: %d\n", params.n_batch);
+                return false;
+            }
         } else if (arg == "-d" || arg == "--device") {
             if (++i >= argc) {
                 return false;
@@ -551,6 +634,10 @@ bool yolo_params_parse(int argc, char ** argv, yolo_params & params) {
         }
     }
 
+    if (params.fname_inp.empty()) {
+        params.fname_inp.push_back("input.jpg");
+    }
+
     return true;
 }
 
@@ -615,11 +702,6 @@ int main(int argc, char *argv[])
         fprintf(stderr, "%s: failed to load model from '%s'\n", __func__, params.model.c_str());
         return 1;
     }
-    yolo_image img(0,0,0);
-    if (!load_image(params.fname_inp.c_str(), img)) {
-        fprintf(stderr, "%s: failed to load image from '%s'\n", __func__, params.fname_inp.c_str());
-        return 1;
-    }
     std::vector<std::string> labels;
     if (!load_labels("data/coco.names", labels)) {
         fprintf(stderr, "%s: failed to load labels from 'data/coco.names'\n", __func__);
@@ -631,25 +713,62 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    const int n_imgs  = (int) params.fname_inp.size();
+    const int n_batch = std::min(params.n_batch, n_imgs);
+
     struct ggml_init_params params0 = {
         /*.mem_size   =*/ ggml_tensor_overhead()*GGML_DEFAULT_GRAPH_SIZE + ggml_graph_overhead(),
         /*.mem_buffer =*/ NULL,
         /*.no_alloc   =*/ true, // the tensors will be allocated later by ggml_gallocr_alloc_graph()
     };
-    struct ggml_context * ctx_cgraph = ggml_init(params0);
-    struct ggml_cgraph * gf = build_graph(ctx_cgraph, model);
+    struct ggml_context * ctx_cgraph = nullptr;
+    struct ggml_cgraph * gf = nullptr;
 
     ggml_gallocr_t allocr = ggml_gallocr_new(ggml_backend_get_default_buffer_type(model.backend));
-    ggml_gallocr_alloc_graph(allocr, gf);
 
     const int64_t t_start_ms = ggml_time_ms();
-    detect(img, gf, model, params.thresh, labels, alphabet);
-    const int64_t t_detect_ms = ggml_time_ms() - t_start_ms;
-    if (!save_image(img, params.fname_out.c_str(), 80)) {
-        fprintf(stderr, "%s: failed to save image to '%s'\n", __func__, params.fname_out.c_str());
-        return 1;
+    int64_t t_detect_ms = 0;
+
+    // the images of the next batch are loaded and letterboxed while the current batch is computed
+    std::future<yolo_batch> next = std::async(std::launch::async, load_batch, std::cref(params.fname_inp), 0, n_batch, std::cref(model));
+
+    for (int i0 = 0; i0 < n_imgs; i0 += n_batch) {
+        const int n = std::min(n_batch, n_imgs - i0);
+
+        yolo_batch batch = next.get();
+        if (!batch.ok) {
+            return 1;
+        }
+
+        if (i0 + n < n_imgs) {
+            next = std::async(std::launch::async, load_batch, std::cref(params.fname_inp), i0 + n, std::min(n_batch, n_imgs - i0 - n), std::cref(model));
+        }
+
+        // the graph is rebuilt only for a smaller last batch
+        if (!gf || ggml_graph_get_tensor(gf, "input")->ne[3] != n) {
+            ggml_free(ctx_cgraph);
+            ctx_cgraph = ggml_init(params0);
+            gf = build_graph(ctx_cgraph, model, n);
+            ggml_gallocr_alloc_graph(allocr, gf);
+        }
+
+        const int64_t t_batch_start_ms = ggml_time_ms();
+        detect(batch, gf, model, params.thresh, labels, alphabet);
+        t_detect_ms += ggml_time_ms() - t_batch_start_ms;
+
+        for (int b = 0; b < n; b++) {
+            const std::string fname_out = output_fname(params.fname_out, i0 + b, n_imgs);
+            if (!save_image(batch.imgs[b], fname_out.c_str(), 80)) {
+                fprintf(stderr, "%s: failed to save image to '%s'\n", __func__, fname_out.c_str());
+                return 1;
+            }
+            printf("Detected objects in '%s' saved in '%s'\n", params.fname_inp[i0 + b].c_str(), fname_out.c_str());
+        }
     }
-    printf("Detected objects saved in '%s' (time: %f sec.)\n", params.fname_out.c_str(), t_detect_ms / 1000.0f);
+
+    const int64_t t_total_ms = ggml_time_ms() - t_start_ms;
+    printf("Detection time: %f sec. (batch size: %d), throughput: %.2f images/s (%d images)\n",
+        t_detect_ms / 1000.0f, n_batch, n_imgs / std::max(t_total_ms / 1000.0f, 1e-3f), n_imgs);
 
     ggml_free(ctx_cgraph);
     ggml_gallocr_free(allocr);
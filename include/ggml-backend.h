@@ -246,6 +246,18 @@ extern "C" {
     GGML_API void               ggml_backend_load_all(void);
     GGML_API void               ggml_backend_load_all_from_path(const char * dir_path);
 
+    //
+    // Split buffer type (tensor parallelism)
+    //
+
+    // the rows of the tensors are split between the buffer types of several backends, in proportion to tensor_split (NULL for an even split)
+    // the scheduler replaces the matrix multiplications with these weights by partial products on the backend of each part,
+    // computed concurrently, and a concatenation of the results; other ops can only use tensors that fit in a single part
+    // each part is computed on the first unused backend of the scheduler with the same buffer type, or else on the first backend that supports it
+    // note: the matrix multiplication nodes of the graph become the concatenations, the graph must be built again to be used without the scheduler
+    GGML_API ggml_backend_buffer_type_t ggml_backend_split_buffer_type(ggml_backend_buffer_type_t * bufts, const float * tensor_split, int n_parts);
+    GGML_API bool                       ggml_backend_buft_is_split(ggml_backend_buffer_type_t buft);
+
     //
     // Backend scheduler
     //
@@ -339,6 +351,31 @@ extern "C" {
     // Set a callback to be called for each resulting node during graph compute
     GGML_API void                 ggml_backend_sched_set_eval_callback(ggml_backend_sched_t sched, ggml_backend_sched_eval_callback callback, void * user_data);
 
+    //
+    // Cost model placement (optional)
+    //
+    // by default the ops are assigned to the backends with fixed rules (location of the weights, op_offload)
+    // once op costs are available, from a callback or from ggml_backend_sched_calibrate, this assignment is refined
+    // to minimize the estimated time of the graph: the sum of the op costs and of the copies between the backends
+    // ops may be moved to a different backend, or split off into a new split, whenever the model predicts a gain
+    // user assignments and ops on pre-allocated tensors are never moved
+    //
+
+    // Estimated time in microseconds of computing op on backend, negative if unknown
+    typedef double (*ggml_backend_sched_op_cost_t)(ggml_backend_t backend, const struct ggml_tensor * op, void * user_data);
+
+    // Set a callback that estimates the cost of the ops, it takes precedence over the calibrated costs
+    GGML_API void                 ggml_backend_sched_set_op_cost(ggml_backend_sched_t sched, ggml_backend_sched_op_cost_t op_cost, void * user_data);
+    // Set the cost of the copies from src to dst: latency_us + nbytes/bytes_per_us
+    GGML_API void                 ggml_backend_sched_set_copy_cost(ggml_backend_sched_t sched, ggml_backend_t src, ggml_backend_t dst, double latency_us, double bytes_per_us);
+    // Measure the cost of the ops of graph on every backend and of the copies between the backends
+    // the data of the graph is not used, the ops are run on zero-initialized copies of their inputs
+    GGML_API bool                 ggml_backend_sched_calibrate(ggml_backend_sched_t sched, struct ggml_cgraph * graph, int n_iter); // returns success
+    // Enable or disable the cost model, enabled by ggml_backend_sched_set_op_cost and ggml_backend_sched_calibrate
+    GGML_API void                 ggml_backend_sched_set_cost_model(ggml_backend_sched_t sched, bool enable);
+    // Estimated time in microseconds of the last graph, negative if the cost model is disabled
+    GGML_API double               ggml_backend_sched_get_estimated_time(ggml_backend_sched_t sched);
+
     //
     // Utils
     //
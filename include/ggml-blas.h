@@ -17,6 +17,13 @@ GGML_BACKEND_API bool ggml_backend_is_blas(ggml_backend_t backend);
 // for openblas and blis, this will also set the number of threads used for blas operations
 GGML_BACKEND_API void ggml_backend_blas_set_n_threads(ggml_backend_t backend_blas, int n_threads);
 
+// buffer type for weights that keeps a copy of the non-F32 tensors converted to F32
+// the conversion is done once in ggml_backend_tensor_set instead of in every matrix multiplication, at the cost of the memory of the copy
+// the tensors must not be modified by the computation of a graph
+// the buffer is not a host buffer: every MUL_MAT with these weights runs on the BLAS backend, including the small batches,
+// and the other ops that read them (e.g. GET_ROWS) get a copy of the tensor from the scheduler
+GGML_BACKEND_API ggml_backend_buffer_type_t ggml_backend_blas_buffer_type(void);
+
 GGML_BACKEND_API ggml_backend_reg_t ggml_backend_blas_reg(void);
 
 
@@ -19,6 +19,15 @@ extern "C" {
         // abort ggml_graph_compute when true
         ggml_abort_callback abort_callback;
         void *              abort_callback_data;
+
+        // optional, record per-node timings of ggml_graph_compute when not NULL
+        struct ggml_cpu_profile * profile;
+
+        // minimum amount of work per thread of a node, in element-wise operations
+        // nodes with less work are computed by fewer threads, while the others skip ahead to the next barrier
+        // -1 (the default set by ggml_graph_plan) - GGML_CPU_NODE_MIN_WORK from the environment, or 0 if it is not set
+        //  0 - all threads work on every node
+        int64_t node_min_work;
     };
 
     // numa strategies
@@ -70,6 +79,44 @@ extern "C" {
     // note: the drawback of this API is that you must have ensured that the context has enough memory for the work data
     GGML_BACKEND_API enum ggml_status  ggml_graph_compute_with_ctx(struct ggml_context * ctx, struct ggml_cgraph * cgraph, int n_threads);
 
+    //
+    // profiling
+    //
+
+    // records, for every graph computed with the profile set in the cplan:
+    //   - the compute time of each node on each thread
+    //   - the time each thread spends waiting in the barrier that follows the node
+    //   - an estimate of the FLOPs and of the bytes read and written by each node
+    // a profile must not be used by multiple graph computations at the same time
+    struct ggml_cpu_profile;
+
+    struct ggml_cpu_profile_op_stats {
+        const char * op;        // see ggml_op_desc()
+        int64_t      n_nodes;   // number of recorded nodes
+        int64_t      t_wall_ns; // sum of the node wall times, from the first thread starting to the last thread finishing
+        int64_t      t_busy_ns; // sum of the per-thread compute times
+        int64_t      t_wait_ns; // sum of the per-thread barrier wait times
+        int64_t      flops;
+        int64_t      bytes;
+    };
+
+    GGML_BACKEND_API struct ggml_cpu_profile * ggml_cpu_profile_init (void);
+    GGML_BACKEND_API void                      ggml_cpu_profile_free (struct ggml_cpu_profile * profile);
+    GGML_BACKEND_API void                      ggml_cpu_profile_reset(struct ggml_cpu_profile * profile);
+
+    // number of graph computations recorded since the last reset
+    GGML_BACKEND_API int  ggml_cpu_profile_n_graphs(const struct ggml_cpu_profile * profile);
+
+    // aggregate the recorded nodes per op, sorted by decreasing wall time
+    // returns the total number of ops, at most n_stats_max are written to stats
+    GGML_BACKEND_API int  ggml_cpu_profile_get_op_stats(const struct ggml_cpu_profile * profile, struct ggml_cpu_profile_op_stats * stats, int n_stats_max);
+
+    // print the per-op statistics as a table
+    GGML_BACKEND_API void ggml_cpu_profile_print(const struct ggml_cpu_profile * profile);
+
+    // write the recorded nodes in the Chrome trace event format, viewable in chrome://tracing or https://ui.perfetto.dev
+    GGML_BACKEND_API bool ggml_cpu_profile_write_trace(const struct ggml_cpu_profile * profile, const char * fname);
+
     //
     // system info
     //
@@ -120,6 +167,30 @@ extern "C" {
 
     GGML_BACKEND_API void ggml_cpu_init(void);
 
+    // CPU topology, read from sysfs by ggml_cpu_init on Linux
+    struct ggml_cpu_topo_cpu {
+        bool    online;
+        bool    perf;     // performance core, all the cores are performance cores on non-hybrid CPUs
+        int32_t core;     // index of the physical core
+        int32_t smt;      // index of the hardware thread within its core
+        int32_t l3;       // id of the L3 cache domain
+        int32_t capacity; // relative performance, 1024 for the fastest CPUs
+    };
+
+    struct ggml_cpu_topology {
+        int32_t n_cpus; // number of CPU ids, 0 if the topology is unknown
+        int32_t n_cores;
+        bool    hybrid;
+        struct ggml_cpu_topo_cpu cpus[GGML_MAX_N_THREADS];
+    };
+
+    // placement of n_threads threads on topo as done by ggml_threadpool_new, ignoring the affinity of the process
+    // cpus[j] is the CPU of thread j, capacity[0..n_threads] are the prefix sums of the relative capacity of the threads
+    // used to split the rows, or all zeros if the rows are split evenly
+    // returns false if the topology has no online CPU
+    GGML_BACKEND_API bool ggml_cpu_topology_place(const struct ggml_cpu_topology * topo, enum ggml_threadpool_placement placement,
+                                                  int n_threads, int * cpus, float * capacity);
+
     //
     // CPU backend
     //
@@ -130,9 +201,15 @@ extern "C" {
     GGML_BACKEND_API void ggml_backend_cpu_set_n_threads     (ggml_backend_t backend_cpu, int n_threads);
     GGML_BACKEND_API void ggml_backend_cpu_set_threadpool    (ggml_backend_t backend_cpu, ggml_threadpool_t threadpool);
     GGML_BACKEND_API void ggml_backend_cpu_set_abort_callback(ggml_backend_t backend_cpu, ggml_abort_callback abort_callback, void * abort_callback_data);
+    GGML_BACKEND_API void ggml_backend_cpu_set_profile       (ggml_backend_t backend_cpu, struct ggml_cpu_profile * profile);
 
     GGML_BACKEND_API ggml_backend_reg_t ggml_backend_cpu_reg(void);
 
+    // host buffer type backed by huge pages when available (hugetlbfs pool, else transparent huge pages), for large weight, KV and compute buffers
+    // falls back to regular pages, the buffers are usable wherever a CPU buffer is
+    // setting the GGML_CPU_HUGEPAGE environment variable makes it the default buffer type of the CPU device
+    GGML_BACKEND_API ggml_backend_buffer_type_t ggml_backend_cpu_hugepage_buffer_type(void);
+
     GGML_BACKEND_API void ggml_cpu_fp32_to_fp32(const float *,       float *, int64_t);
     GGML_BACKEND_API void ggml_cpu_fp32_to_i32 (const float *,     int32_t *, int64_t);
     GGML_BACKEND_API void ggml_cpu_fp32_to_fp16(const float *, ggml_fp16_t *, int64_t);
@@ -43,9 +43,44 @@ extern "C" {
             int64_t        ne_label,     // number of elements per label
             int64_t        ndata,        // total number of datapoints/labels
             int64_t        ndata_shard); // number of datapoints/labels per shard (unit at which the dataset is shuffled/copied)
+
+    // out-of-core dataset backed by read-only memory-mapped files, returns NULL on failure
+    // the files contain the raw data/labels in the same layout as the tensors returned by ggml_opt_dataset_data/ggml_opt_dataset_labels
+    GGML_API ggml_opt_dataset_t ggml_opt_dataset_init_mmap(
+            enum ggml_type type_data,
+            enum ggml_type type_label,
+            int64_t        ne_datapoint,
+            int64_t        ne_label,
+            int64_t        ndata,
+            int64_t        ndata_shard,
+            const char   * fname_data,    // file with the data
+            const char   * fname_labels); // file with the labels, must be NULL if ne_label == 0
+
+    // callback for reading shard ishard of an out-of-core dataset
+    // data and labels have room for one shard, labels is NULL if the dataset has no labels
+    // may be called from a background thread
+    typedef void (*ggml_opt_dataset_read_shard_t)(int64_t ishard, void * data, void * labels, void * userdata);
+
+    // optional callback that is called for shards that are going to be read soon, can be used to start asynchronous I/O
+    typedef void (*ggml_opt_dataset_readahead_shard_t)(int64_t ishard, void * userdata);
+
+    // out-of-core dataset whose shards are read on demand via a user-provided callback
+    // the tensors returned by ggml_opt_dataset_data/ggml_opt_dataset_labels only describe the shape, they have no data
+    GGML_API ggml_opt_dataset_t ggml_opt_dataset_init_callback(
+            enum ggml_type                     type_data,
+            enum ggml_type                     type_label,
+            int64_t                            ne_datapoint,
+            int64_t                            ne_label,
+            int64_t                            ndata,
+            int64_t                            ndata_shard,
+            ggml_opt_dataset_read_shard_t      read_shard,
+            ggml_opt_dataset_readahead_shard_t readahead_shard, // may be NULL
+            void                             * userdata);
+
     GGML_API void ggml_opt_dataset_free(ggml_opt_dataset_t dataset);
 
     // get underlying tensors that store the data
+    // the data of memory-mapped datasets is read-only, datasets that use a callback have no data
     GGML_API int64_t              ggml_opt_dataset_ndata (ggml_opt_dataset_t dataset);
     GGML_API struct ggml_tensor * ggml_opt_dataset_data  (ggml_opt_dataset_t dataset); // shape = [ne_datapoint, ndata]
     GGML_API struct ggml_tensor * ggml_opt_dataset_labels(ggml_opt_dataset_t dataset); // shape = [nd_label,     ndata]
@@ -127,6 +162,17 @@ extern "C" {
 
         // only GGML_OPT_OPTIMIZER_TYPE_ADAMW needs m, v momenta per parameter tensor
         enum ggml_opt_optimizer_type optimizer;
+
+        // storage type of the AdamW momenta, BF16 or Q8_0 (8 bit with per-block scales) reduce the memory for the optimizer state
+        // F32 is used for parameters whose first dimension is not a multiple of the block size
+        // non-F32 momenta are currently only supported by the CPU backend
+        enum ggml_type type_momenta;
+
+        // activation checkpointing, if > 0 every checkpoint_interval-th node of the forward graph is marked as a checkpoint
+        // the other activations are recomputed during the backward pass which reduces memory use at the cost of extra compute,
+        //     ~sqrt(number of nodes) is a good trade-off, the compute context needs room for the recomputed tensors
+        // checkpoints can also be set manually with ggml_set_checkpoint, e.g. on the output of each layer
+        int32_t checkpoint_interval;
     };
 
     // get parameters for an optimization context with defaults set where possible
@@ -188,6 +234,15 @@ extern "C" {
     // do forward pass, increment result if not NULL, do backward pass if allocated
     GGML_API void ggml_opt_eval(ggml_opt_context_t opt_ctx, ggml_opt_result_t result);
 
+    // same as ggml_opt_eval but returns without waiting for the computation to finish
+    // reading back the loss/predictions into result is deferred until the next call to ggml_opt_synchronize,
+    //     which is also done implicitly by ggml_opt_alloc, ggml_opt_prepare_alloc, ggml_opt_reset, and ggml_opt_free
+    // the inputs must not be modified before the next call to ggml_opt_alloc
+    GGML_API void ggml_opt_eval_async(ggml_opt_context_t opt_ctx, ggml_opt_result_t result);
+
+    // wait for a pending ggml_opt_eval_async and accumulate its results
+    GGML_API void ggml_opt_synchronize(ggml_opt_context_t opt_ctx);
+
     // ############################################################################
     // ## The high-level functions start here. They do not depend on any private ##
     // ## functions or structs and can be copied to and adapted for user code.   ##
@@ -198,6 +253,7 @@ extern "C" {
     // 1. Select the appropriate loss for your problem.
     // 2. Create a dataset and set the data for the "data" tensor. Also set the "labels" tensor if your loss needs them.
     //    Setting the shard size to 1 will be fine, it's the granularity with which data is shuffled/loaded (bigger values are faster).
+    //    Datasets that do not fit into memory can instead be memory-mapped from a file or read shard by shard via a callback.
     // 3. Create a GGML graph for your model with no_alloc == true. Use two separate contexts for the tensors.
     //    The first context should contain the model parameters and inputs and be allocated statically in user code.
     //    The second context should contain all other tensors and will be (re)allocated automatically.
@@ -206,6 +262,7 @@ extern "C" {
     // 4. Call ggml_opt_fit. If you need more control you can use ggml_opt_epoch instead.
 
     // signature for a callback while evaluating opt_ctx on dataset, called after an evaluation
+    // and before the next batch is allocated, so opt_ctx is in the state of the batch that was just evaluated
     typedef void (*ggml_opt_epoch_callback)(
             bool               train,       // true after training evaluation, false after validation evaluation
             ggml_opt_context_t opt_ctx,
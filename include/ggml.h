@@ -418,7 +418,9 @@ extern "C" {
         // GGML_TYPE_IQ4_NL_4_8 = 37,
         // GGML_TYPE_IQ4_NL_8_8 = 38,
         GGML_TYPE_MXFP4   = 39, // MXFP4 (1 block)
-        GGML_TYPE_COUNT   = 40,
+        GGML_TYPE_F8_E4M3 = 40, // OCP FP8 E4M3 (finite, max 448)
+        GGML_TYPE_F8_E5M2 = 41, // OCP FP8 E5M2 (max 57344)
+        GGML_TYPE_COUNT   = 42,
     };
 
     // precision
@@ -454,6 +456,8 @@ extern "C" {
         GGML_FTYPE_MOSTLY_IQ1_M   = 23, // except 1d tensors
         GGML_FTYPE_MOSTLY_BF16    = 24, // except 1d tensors
         GGML_FTYPE_MOSTLY_MXFP4   = 25, // except 1d tensors
+        GGML_FTYPE_MOSTLY_F8_E4M3 = 26, // except 1d tensors
+        GGML_FTYPE_MOSTLY_F8_E5M2 = 27, // except 1d tensors
     };
 
     // available tensor operations:
@@ -530,6 +534,7 @@ extern "C" {
         GGML_OP_ARANGE,
         GGML_OP_TIMESTEP_EMBEDDING,
         GGML_OP_ARGSORT,
+        GGML_OP_TOP_K,
         GGML_OP_LEAKY_RELU,
         GGML_OP_TRI,
         GGML_OP_FILL,
@@ -624,6 +629,7 @@ extern "C" {
         GGML_TENSOR_FLAG_OUTPUT =  2, // ...is an output for the GGML compute graph
         GGML_TENSOR_FLAG_PARAM  =  4, // ...contains trainable parameters
         GGML_TENSOR_FLAG_LOSS   =  8, // ...defines loss for numerical optimization (multiple loss tensors add up)
+        GGML_TENSOR_FLAG_CHECKPOINT = 16, // ...is kept for the backward pass, other activations are recomputed from checkpoints
     };
 
     enum ggml_tri_type {
@@ -827,6 +833,8 @@ extern "C" {
     // Context tensor enumeration and lookup
     GGML_API struct ggml_tensor * ggml_get_first_tensor(const struct ggml_context * ctx);
     GGML_API struct ggml_tensor * ggml_get_next_tensor (const struct ggml_context * ctx, struct ggml_tensor * tensor);
+    // the first lookup indexes the names of the tensors, the next ones extend the index with the new tensors
+    // lookups from several threads are safe, but not while tensors are created or renamed in the same context
     GGML_API struct ggml_tensor * ggml_get_tensor(struct ggml_context * ctx, const char * name);
 
     // Converts a flat index into coordinates
@@ -849,6 +857,11 @@ extern "C" {
     GGML_API void ggml_set_param(struct ggml_tensor * tensor);
     GGML_API void ggml_set_loss(struct ggml_tensor * tensor);
 
+    // mark a tensor as an activation checkpoint, e.g. the output of a layer
+    // if a graph contains checkpoints, ggml_build_backward_expand does not keep the other intermediate results of the forward pass alive,
+    //     they are instead recomputed from the nearest checkpoints (or inputs/parameters) right before they are needed by the backward pass
+    GGML_API void ggml_set_checkpoint(struct ggml_tensor * tensor);
+
     //
     // operations on tensors with backpropagation
     //
@@ -2071,6 +2084,7 @@ extern "C" {
             struct ggml_tensor  * b,
             int                   stride);
 
+    // the kernel cannot be quantized, see ggml_conv_2d_direct_cwhn
     GGML_API struct ggml_tensor * ggml_conv_2d_direct(
             struct ggml_context * ctx,
             struct ggml_tensor  * a,   // convolution kernel [KW, KH, IC, OC]
@@ -2082,6 +2096,19 @@ extern "C" {
             int                   d0,  // dilation dimension 0
             int                   d1); // dilation dimension 1
 
+    // same as ggml_conv_2d_direct with the input channels in the rows of the kernel, so that it can be of any type,
+    // including quantized (CPU only)
+    GGML_API struct ggml_tensor * ggml_conv_2d_direct_cwhn(
+            struct ggml_context * ctx,
+            struct ggml_tensor  * a,   // convolution kernel [IC, KW, KH, OC]
+            struct ggml_tensor  * b,   // input data [W, H, C, N]
+            int                   s0,  // stride dimension 0
+            int                   s1,  // stride dimension 1
+            int                   p0,  // padding dimension 0
+            int                   p1,  // padding dimension 1
+            int                   d0,  // dilation dimension 0
+            int                   d1); // dilation dimension 1
+
     GGML_API struct ggml_tensor * ggml_conv_3d_direct(
             struct ggml_context * ctx,
             struct ggml_tensor  * a,   // kernel [KW, KH, KD, IC * OC]
@@ -2265,11 +2292,22 @@ extern "C" {
             float                 step);
 
     // top k elements per row
+    // implemented as an argsort followed by a view, which is supported (and fused) by most backends
     GGML_API struct ggml_tensor * ggml_top_k(
             struct ggml_context * ctx,
             struct ggml_tensor  * a,
             int                   k);
 
+    // top k elements per row, computed with a partial selection instead of a full sort of each row
+    // returns the I32 indices [k, ne1, ne2, ne3] of the k largest elements in descending order, ties are broken by the lower index
+    // if values is not NULL, it is set to the corresponding F32 values [k, ne1, ne2, ne3]
+    // note: GGML_OP_TOP_K is currently only implemented by the CPU backend
+    GGML_API struct ggml_tensor * ggml_top_k_ext(
+            struct ggml_context * ctx,
+            struct ggml_tensor  * a,
+            int                   k,
+            struct ggml_tensor ** values);
+
 #define GGML_KQ_MASK_PAD 64
 
     // q:    [n_embd_k, n_batch,     n_head,    ne3 ]
@@ -2330,9 +2368,10 @@ extern "C" {
 
     // partition into non-overlapping windows with padding if needed
     // example:
-    // a:   768   64   64    1
+    // a:   768   64   64    2
     // w:    14
-    // res: 768   14   14    25
+    // res: 768   14   14    50
+    // the windows of image i3 of a are res[:, :, :, 25*i3 : 25*(i3 + 1)]
     // used in sam
     GGML_API struct ggml_tensor * ggml_win_part(
             struct ggml_context * ctx,
@@ -2340,6 +2379,7 @@ extern "C" {
             int                   w);
 
     // reverse of ggml_win_part
+    // res: a->ne[0], w0, h0, a->ne[3] / (number of windows of a w0 x h0 image)
     // used in sam
     GGML_API struct ggml_tensor * ggml_win_unpart(
             struct ggml_context * ctx,
@@ -2524,6 +2564,8 @@ extern "C" {
     // AdamW optimizer step
     // Paper: https://arxiv.org/pdf/1711.05101v3.pdf
     // PyTorch: https://pytorch.org/docs/stable/generated/torch.optim.AdamW.html
+    // the momenta m and v can be stored as F32, BF16, or Q8_0 to reduce the memory needed for the optimizer state,
+    //     for Q8_0 v holds sqrt(v) instead of v to reduce the dynamic range within each block
     GGML_API struct ggml_tensor * ggml_opt_step_adamw(
             struct ggml_context * ctx,
             struct ggml_tensor  * a,
@@ -2606,6 +2648,8 @@ extern "C" {
     GGML_API bool ggml_quantize_requires_imatrix(enum ggml_type type);
 
     // calls ggml_quantize_init internally (i.e. can allocate memory)
+    // without imatrix, Q4_K, Q5_K and Q6_K use the AVX2 quantizers of the CPU backend once ggml_cpu_init has been called,
+    // with the same output as the reference (not with dynamically loaded backends, and no NEON or AVX-512 versions)
     GGML_API size_t ggml_quantize_chunk(
             enum ggml_type   type,
                const float * src,
@@ -2615,6 +2659,18 @@ extern "C" {
                    int64_t   n_per_row,
                const float * imatrix);
 
+    // same as ggml_quantize_chunk, with the rows split over n_threads threads
+    // rows are quantized independently, so the result is identical to ggml_quantize_chunk
+    GGML_API size_t ggml_quantize_chunk_mt(
+            enum ggml_type   type,
+               const float * src,
+                      void * dst,
+                   int64_t   start,
+                   int64_t   nrows,
+                   int64_t   n_per_row,
+               const float * imatrix,
+                       int   n_threads);
+
 #ifdef __cplusplus
     // restrict not standard in C++
 #    if defined(__GNUC__)
@@ -2661,6 +2717,16 @@ extern "C" {
         GGML_SCHED_PRIO_REALTIME
     };
 
+    // placement of the threads on the CPU topology, used when the cpumask is all-zeros
+    // each thread is pinned to one CPU, the fastest CPUs go to the first threads
+    // if there are more threads than CPUs of the policy, the other CPUs are used too
+    enum ggml_threadpool_placement {
+        GGML_THREADPOOL_PLACEMENT_NONE,       // default affinity settings
+        GGML_THREADPOOL_PLACEMENT_CORES,      // one thread per physical core, SMT siblings are left idle
+        GGML_THREADPOOL_PLACEMENT_PERF,       // performance cores only on hybrid CPUs, including their SMT siblings
+        GGML_THREADPOOL_PLACEMENT_PERF_CORES, // one thread per physical performance core
+    };
+
     // threadpool params
     // Use ggml_threadpool_params_default() or ggml_threadpool_params_init() to populate the defaults
     struct ggml_threadpool_params {
@@ -2670,6 +2736,7 @@ extern "C" {
         uint32_t            poll;                        // polling level (0 - no polling, 100 - aggressive polling)
         bool                strict_cpu;                  // strict cpu placement
         bool                paused;                      // start in paused state
+        enum ggml_threadpool_placement placement;        // placement policy when cpumask is all-zeros
     };
 
     struct ggml_threadpool;     // forward declaration, see ggml.c
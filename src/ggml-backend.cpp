@@ -20,6 +20,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #ifdef __APPLE__
@@ -638,6 +644,278 @@ void ggml_backend_multi_buffer_set_usage(ggml_backend_buffer_t buffer, enum ggml
     }
 }
 
+// split buffer
+//
+// the rows of each tensor (ne[1]) are divided between the buffer types of the parts, every part is a tensor of its own
+// allocated in a buffer of its buffer type, and the extra of the split tensor points to the parts
+// the data of the split tensor is in a host allocation of the buffer that is never read or written, so that it is a valid
+// address within the buffer like for the other buffers
+
+struct ggml_backend_split_buffer_type_context {
+    std::vector<ggml_backend_buffer_type_t> bufts;
+    std::vector<float> row_split; // [n_parts + 1] first row of each part, as a fraction of the rows
+    std::string name;
+};
+
+struct ggml_backend_split_tensor_extra {
+    std::vector<struct ggml_tensor *>  parts;     // [n_parts], NULL for the parts without rows
+    std::vector<int64_t>               row_start; // [n_parts + 1]
+    std::vector<ggml_backend_buffer_t> buffers;
+    struct ggml_context * ctx = nullptr;
+
+    ~ggml_backend_split_tensor_extra() {
+        for (ggml_backend_buffer_t buf : buffers) {
+            ggml_backend_buffer_free(buf);
+        }
+        ggml_free(ctx);
+    }
+};
+
+struct ggml_backend_split_buffer_context {
+    std::vector<ggml_backend_split_tensor_extra *> extras;
+    void * data = nullptr;
+    size_t size = 0;
+
+    ~ggml_backend_split_buffer_context() {
+        for (ggml_backend_split_tensor_extra * extra : extras) {
+            delete extra;
+        }
+        if (data != nullptr) {
+            ggml_aligned_free(data, size);
+        }
+    }
+};
+
+static void ggml_backend_split_buffer_free_buffer(ggml_backend_buffer_t buffer) {
+    delete (ggml_backend_split_buffer_context *) buffer->context;
+}
+
+static void * ggml_backend_split_buffer_get_base(ggml_backend_buffer_t buffer) {
+    return ((ggml_backend_split_buffer_context *) buffer->context)->data;
+}
+
+static enum ggml_status ggml_backend_split_buffer_init_tensor(ggml_backend_buffer_t buffer, struct ggml_tensor * tensor) {
+    GGML_ASSERT(tensor->view_src == nullptr); // views of split tensors are not supported
+    GGML_ASSERT(ggml_is_contiguous(tensor));
+
+    auto * buft_ctx = (ggml_backend_split_buffer_type_context *) buffer->buft->context;
+    auto * ctx      = (ggml_backend_split_buffer_context *) buffer->context;
+    const int n_parts = (int) buft_ctx->bufts.size();
+
+    auto * extra = new ggml_backend_split_tensor_extra;
+    ctx->extras.push_back(extra);
+    tensor->extra = extra;
+
+    struct ggml_init_params params = {
+        /*.mem_size   =*/ n_parts*ggml_tensor_overhead(),
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ true,
+    };
+    extra->ctx = ggml_init(params);
+    extra->parts.resize(n_parts, nullptr);
+    extra->row_start.resize(n_parts + 1);
+
+    const int64_t nrows = tensor->ne[1];
+    for (int p = 0; p <= n_parts; p++) {
+        extra->row_start[p] = p == n_parts ? nrows : std::min(nrows, (int64_t) (nrows*buft_ctx->row_split[p]));
+    }
+
+    for (int p = 0; p < n_parts; p++) {
+        const int64_t rows = extra->row_start[p + 1] - extra->row_start[p];
+        if (rows == 0) {
+            continue;
+        }
+
+        struct ggml_tensor * part = ggml_new_tensor_4d(extra->ctx, tensor->type, tensor->ne[0], rows, tensor->ne[2], tensor->ne[3]);
+        ggml_format_name(part, "%s#%d", tensor->name, p);
+
+        ggml_backend_buffer_t buf = ggml_backend_buft_alloc_buffer(buft_ctx->bufts[p], ggml_backend_buft_get_alloc_size(buft_ctx->bufts[p], part));
+        if (buf == nullptr) {
+            GGML_LOG_ERROR("%s: failed to allocate part %d of %s in %s\n", __func__, p, tensor->name, ggml_backend_buft_name(buft_ctx->bufts[p]));
+            return GGML_STATUS_ALLOC_FAILED;
+        }
+        extra->buffers.push_back(buf);
+        ggml_backend_buffer_set_usage(buf, GGML_BACKEND_BUFFER_USAGE_WEIGHTS);
+
+        enum ggml_status status = ggml_backend_tensor_alloc(buf, part, ggml_backend_buffer_get_base(buf));
+        if (status != GGML_STATUS_SUCCESS) {
+            return status;
+        }
+        extra->parts[p] = part;
+    }
+
+    return GGML_STATUS_SUCCESS;
+}
+
+// calls f(part, offset in the part, offset in the tensor, size) for the runs of rows of the part in [offset, offset + size)
+template <typename F>
+static void ggml_backend_split_tensor_foreach_rows(const struct ggml_tensor * tensor, size_t offset, size_t size, F && f) {
+    const auto * extra = (const ggml_backend_split_tensor_extra *) tensor->extra;
+    const size_t  nb1   = tensor->nb[1];
+    const int64_t ne1   = tensor->ne[1];
+
+    // only whole rows can be split
+    GGML_ASSERT(offset % nb1 == 0 && size % nb1 == 0);
+
+    int64_t       ir     = offset/nb1;
+    const int64_t ir_end = (offset + size)/nb1;
+    while (ir < ir_end) {
+        const int64_t i1  = ir % ne1;
+        const int64_t i23 = ir / ne1;
+
+        int p = 0;
+        while (extra->row_start[p + 1] <= i1) {
+            p++;
+        }
+        const int64_t rows_part = extra->row_start[p + 1] - extra->row_start[p];
+        const int64_t n         = std::min(extra->row_start[p + 1] - i1, ir_end - ir);
+
+        f(extra->parts[p], (i23*rows_part + i1 - extra->row_start[p])*nb1, ir*nb1 - offset, n*nb1);
+
+        ir += n;
+    }
+}
+
+static void ggml_backend_split_buffer_memset_tensor(ggml_backend_buffer_t buffer, struct ggml_tensor * tensor, uint8_t value, size_t offset, size_t size) {
+    ggml_backend_split_tensor_foreach_rows(tensor, offset, size, [&](struct ggml_tensor * part, size_t part_offset, size_t, size_t n) {
+        ggml_backend_tensor_memset(part, value, part_offset, n);
+    });
+
+    GGML_UNUSED(buffer);
+}
+
+static void ggml_backend_split_buffer_set_tensor(ggml_backend_buffer_t buffer, struct ggml_tensor * tensor, const void * data, size_t offset, size_t size) {
+    ggml_backend_split_tensor_foreach_rows(tensor, offset, size, [&](struct ggml_tensor * part, size_t part_offset, size_t data_offset, size_t n) {
+        ggml_backend_tensor_set(part, (const char *) data + data_offset, part_offset, n);
+    });
+
+    GGML_UNUSED(buffer);
+}
+
+static void ggml_backend_split_buffer_get_tensor(ggml_backend_buffer_t buffer, const struct ggml_tensor * tensor, void * data, size_t offset, size_t size) {
+    ggml_backend_split_tensor_foreach_rows(tensor, offset, size, [&](struct ggml_tensor * part, size_t part_offset, size_t data_offset, size_t n) {
+        ggml_backend_tensor_get(part, (char *) data + data_offset, part_offset, n);
+    });
+
+    GGML_UNUSED(buffer);
+}
+
+static void ggml_backend_split_buffer_clear(ggml_backend_buffer_t buffer, uint8_t value) {
+    auto * ctx = (ggml_backend_split_buffer_context *) buffer->context;
+    for (ggml_backend_split_tensor_extra * extra : ctx->extras) {
+        for (ggml_backend_buffer_t buf : extra->buffers) {
+            ggml_backend_buffer_clear(buf, value);
+        }
+    }
+}
+
+static const struct ggml_backend_buffer_i ggml_backend_split_buffer_i = {
+    /* .free_buffer     = */ ggml_backend_split_buffer_free_buffer,
+    /* .get_base        = */ ggml_backend_split_buffer_get_base,
+    /* .init_tensor     = */ ggml_backend_split_buffer_init_tensor,
+    /* .memset_tensor   = */ ggml_backend_split_buffer_memset_tensor,
+    /* .set_tensor      = */ ggml_backend_split_buffer_set_tensor,
+    /* .get_tensor      = */ ggml_backend_split_buffer_get_tensor,
+    /* .cpy_tensor      = */ NULL,
+    /* .clear           = */ ggml_backend_split_buffer_clear,
+    /* .reset           = */ NULL,
+};
+
+static const char * ggml_backend_split_buffer_type_get_name(ggml_backend_buffer_type_t buft) {
+    return ((ggml_backend_split_buffer_type_context *) buft->context)->name.c_str();
+}
+
+static ggml_backend_buffer_t ggml_backend_split_buffer_type_alloc_buffer(ggml_backend_buffer_type_t buft, size_t size) {
+    // the parts are allocated in init_tensor, when the rows of each part are known
+    auto * ctx = new ggml_backend_split_buffer_context;
+    if (size > 0) {
+        ctx->data = ggml_aligned_malloc(size);
+        ctx->size = size;
+        if (ctx->data == nullptr) {
+            GGML_LOG_ERROR("%s: failed to allocate buffer of size %zu\n", __func__, size);
+            delete ctx;
+            return nullptr;
+        }
+    }
+    return ggml_backend_buffer_init(buft, ggml_backend_split_buffer_i, ctx, size);
+}
+
+static size_t ggml_backend_split_buffer_type_get_alignment(ggml_backend_buffer_type_t buft) {
+    return TENSOR_ALIGNMENT;
+
+    GGML_UNUSED(buft);
+}
+
+static bool ggml_backend_split_buffer_type_is_host(ggml_backend_buffer_type_t buft) {
+    return false;
+
+    GGML_UNUSED(buft);
+}
+
+ggml_backend_buffer_type_t ggml_backend_split_buffer_type(ggml_backend_buffer_type_t * bufts, const float * tensor_split, int n_parts) {
+    GGML_ASSERT(n_parts > 0);
+
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::vector<ggml_backend_buffer_type_t> key_bufts(bufts, bufts + n_parts);
+    std::vector<float> row_split(n_parts + 1, 0.0f);
+    float total = 0.0f;
+    for (int p = 0; p < n_parts; p++) {
+        total += tensor_split ? tensor_split[p] : 1.0f;
+    }
+    GGML_ASSERT(total > 0.0f);
+    float acc = 0.0f;
+    for (int p = 0; p < n_parts; p++) {
+        row_split[p] = acc/total;
+        acc += tensor_split ? tensor_split[p] : 1.0f;
+    }
+    row_split[n_parts] = 1.0f;
+
+    static std::map<std::pair<std::vector<ggml_backend_buffer_type_t>, std::vector<float>>, struct ggml_backend_buffer_type> buft_map;
+
+    auto it = buft_map.find({ key_bufts, row_split });
+    if (it != buft_map.end()) {
+        return &it->second;
+    }
+
+    auto * ctx = new ggml_backend_split_buffer_type_context;
+    ctx->bufts     = key_bufts;
+    ctx->row_split = row_split;
+    ctx->name      = "Split(";
+    for (int p = 0; p < n_parts; p++) {
+        ctx->name += std::string(p > 0 ? "," : "") + ggml_backend_buft_name(bufts[p]);
+    }
+    ctx->name += ")";
+
+    struct ggml_backend_buffer_type buft = {
+        /* .iface   = */ {
+            /* .get_name         = */ ggml_backend_split_buffer_type_get_name,
+            /* .alloc_buffer     = */ ggml_backend_split_buffer_type_alloc_buffer,
+            /* .get_alignment    = */ ggml_backend_split_buffer_type_get_alignment,
+            /* .get_max_size     = */ NULL, // defaults to SIZE_MAX
+            /* .get_alloc_size   = */ NULL, // defaults to ggml_nbytes
+            /* .is_host          = */ ggml_backend_split_buffer_type_is_host,
+        },
+        /* .device  = */ ggml_backend_buft_get_device(bufts[0]),
+        /* .context = */ ctx,
+    };
+
+    return &(buft_map[{ key_bufts, row_split }] = buft);
+}
+
+bool ggml_backend_buft_is_split(ggml_backend_buffer_type_t buft) {
+    return buft->iface.get_name == ggml_backend_split_buffer_type_get_name;
+}
+
+// parts of a tensor in a split buffer, NULL for other tensors
+static const ggml_backend_split_tensor_extra * ggml_backend_split_tensor_get_extra(const struct ggml_tensor * tensor) {
+    if (tensor->buffer == NULL || tensor->view_src != NULL || tensor->buffer->iface.free_buffer != ggml_backend_split_buffer_free_buffer) {
+        return NULL;
+    }
+    return (const ggml_backend_split_tensor_extra *) tensor->extra;
+}
+
 // creates a copy of the tensor with the same memory layout
 static struct ggml_tensor * ggml_dup_tensor_layout(struct ggml_context * ctx, const struct ggml_tensor * tensor) {
     struct ggml_tensor * dup = ggml_dup_tensor(ctx, tensor);
@@ -671,6 +949,8 @@ struct ggml_backend_sched_split {
     int i_end;
     struct ggml_tensor * inputs[GGML_SCHED_MAX_SPLIT_INPUTS];
     int n_inputs;
+    // number of splits, starting with this one, that are independent and can be computed concurrently
+    int n_parallel;
     // graph view of this split
     struct ggml_cgraph graph;
 };
@@ -722,6 +1002,16 @@ struct ggml_backend_sched {
 
     bool op_offload;
 
+    // cost model placement
+    struct ggml_backend_sched_cost_model * cost_model;
+    bool cost_enabled;
+
+    // splits of the last graph, reused when the next graph has the same fingerprint
+    struct ggml_backend_sched_split_cache * split_cache;
+
+    // matrix multiplications with weights in split buffers
+    struct ggml_backend_sched_tp * tp;
+
     int debug;
 };
 
@@ -875,41 +1165,1244 @@ static void ggml_backend_sched_print_assignments(ggml_backend_sched_t sched, str
                 GGML_LOG_DEBUG(" %20.20s (%5.5s) [%5.5s %8.8s]", src->name,
                     fmt_size(ggml_nbytes(src)), src_backend ? ggml_backend_name(src_backend) : "NULL", GET_CAUSE(src));
             }
-            GGML_LOG_DEBUG("\n");
+            GGML_LOG_DEBUG("\n");
+        }
+    }
+}
+
+static bool ggml_backend_sched_buffer_supported(ggml_backend_sched_t sched, struct ggml_tensor * t, int backend_id) {
+    ggml_backend_buffer_t buf = t->view_src ? t->view_src->buffer : t->buffer;
+    ggml_backend_buffer_type_t buft = NULL;
+
+    if (buf) {
+        // the tensor is already allocated
+        buft = buf->buft;
+    } else {
+        // see if the tensor already has a backend assigned, and use the buffer type of that backend
+        int tensor_backend_id = tensor_backend_id(t);
+        if (tensor_backend_id == -1 && t->view_src) {
+            tensor_backend_id = tensor_backend_id(t->view_src);
+        }
+        if (tensor_backend_id != -1) {
+            buft = sched->bufts[tensor_backend_id];
+        }
+    }
+
+    return buft != NULL && ggml_backend_supports_buft(sched->backends[backend_id], buft);
+}
+
+static void ggml_backend_sched_set_if_supported(ggml_backend_sched_t sched, struct ggml_tensor * node, int cur_backend_id, int * node_backend_id) {
+    if (ggml_backend_supports_op(sched->backends[cur_backend_id], node)) {
+        *node_backend_id = cur_backend_id;
+        SET_CAUSE(node, "2.sup");
+    }
+}
+
+// cost model
+//
+// the time of a graph is estimated as the sum of the costs of its ops, of the copies of the split inputs and of
+// the launches of the splits, since the splits are computed one after the other
+// the cost of an op comes from the user callback, or from the time measured by ggml_backend_sched_calibrate for an op
+// with the same signature, or from a linear fit of the measured times of the same op on the amount of work
+
+#define GGML_SCHED_COPY_LATENCY_US   20.0   // default cost of the copies that were not calibrated
+#define GGML_SCHED_COPY_BYTES_PER_US 8000.0 // 8 GB/s
+#define GGML_SCHED_COST_MAX_ITER     8
+#define GGML_SCHED_CALIBRATE_COPY_SIZE (16*1024*1024)
+
+struct ggml_backend_sched_op_fit {
+    double us;      // fixed cost
+    double us_work; // cost per unit of work
+    bool   valid;
+};
+
+struct ggml_backend_sched_cost_model {
+    ggml_backend_sched_op_cost_t op_cost;
+    void * op_cost_user_data;
+
+    // measured by ggml_backend_sched_calibrate
+    std::unordered_map<std::string, double> op_us[GGML_SCHED_MAX_BACKENDS]; // by op signature
+    std::vector<std::pair<double, double>>  op_samples[GGML_SCHED_MAX_BACKENDS][GGML_OP_COUNT]; // (work, us)
+    ggml_backend_sched_op_fit               op_fit[GGML_SCHED_MAX_BACKENDS][GGML_OP_COUNT];
+
+    double copy_latency_us[GGML_SCHED_MAX_BACKENDS][GGML_SCHED_MAX_BACKENDS];   // negative if unknown
+    double copy_bytes_per_us[GGML_SCHED_MAX_BACKENDS][GGML_SCHED_MAX_BACKENDS];
+    double split_us[GGML_SCHED_MAX_BACKENDS]; // cost of computing a graph on the backend, besides its ops
+
+    // placement scratch, reused between graphs
+    std::vector<double>  node_us;   // [n_nodes][n_backends], negative if unknown or unsupported
+    std::vector<int>     order;     // indices of the nodes that are not views
+    std::vector<int>     order_pos; // [n_nodes] position of each node in order
+    std::vector<int>     pairs;     // positions in order of the pairs of consecutive nodes affected by a move
+    std::vector<char>    fixed;     // [hash_set.size] nodes that cannot be moved
+    std::vector<int32_t> cons_offs; // [hash_set.size + 1] offsets in cons
+    std::vector<int32_t> cons;      // indices of the nodes that use each tensor as a source
+    std::vector<int32_t> view_offs; // [hash_set.size + 1] offsets in views
+    std::vector<struct ggml_tensor *> views; // sources of the nodes that are views of each tensor
+    std::vector<int32_t> stamp;     // [hash_set.size]
+    int32_t              cur_stamp;
+    std::vector<struct ggml_tensor *> affected;
+    std::vector<int>     prev_ids;
+
+    double est_us; // estimated time of the last graph
+};
+
+static ggml_backend_sched_cost_model * ggml_backend_sched_get_cost_model(ggml_backend_sched_t sched) {
+    if (sched->cost_model == NULL) {
+        ggml_backend_sched_cost_model * cm = new ggml_backend_sched_cost_model();
+        cm->op_cost = NULL;
+        cm->op_cost_user_data = NULL;
+        for (int a = 0; a < GGML_SCHED_MAX_BACKENDS; a++) {
+            for (int b = 0; b < GGML_SCHED_MAX_BACKENDS; b++) {
+                cm->copy_latency_us[a][b]   = -1.0;
+                cm->copy_bytes_per_us[a][b] = -1.0;
+            }
+            for (int op = 0; op < GGML_OP_COUNT; op++) {
+                cm->op_fit[a][op] = { 0.0, 0.0, false };
+            }
+            cm->split_us[a] = 0.0;
+        }
+        cm->cur_stamp = 0;
+        cm->est_us = -1.0;
+        sched->cost_model = cm;
+    }
+    return sched->cost_model;
+}
+
+// ops with the same signature are expected to take the same time
+static std::string ggml_backend_sched_op_key(const struct ggml_tensor * op) {
+    std::string key;
+    key.append((const char *) &op->op, sizeof(op->op));
+    key.append((const char *) op->op_params, sizeof(op->op_params));
+    for (int j = -1; j < GGML_MAX_SRC; j++) {
+        const struct ggml_tensor * t = j < 0 ? op : op->src[j];
+        if (t == NULL) {
+            key.push_back('\0');
+            continue;
+        }
+        key.append((const char *) &t->type, sizeof(t->type));
+        key.append((const char *) t->ne, sizeof(t->ne));
+        key.append((const char *) t->nb, sizeof(t->nb));
+    }
+    return key;
+}
+
+// amount of work of an op, used to extrapolate the measured times to other shapes
+static double ggml_backend_sched_op_work(const struct ggml_tensor * op) {
+    switch (op->op) {
+        case GGML_OP_MUL_MAT:
+        case GGML_OP_MUL_MAT_ID:
+        case GGML_OP_OUT_PROD:
+            return 2.0*(double) op->src[0]->ne[0]*(double) ggml_nelements(op);
+        case GGML_OP_FLASH_ATTN_EXT:
+            return 2.0*(double) (op->src[0]->ne[0] + op->src[2]->ne[0])*(double) op->src[1]->ne[1]*(double) ggml_nrows(op->src[0]);
+        default:
+            {
+                // memory bound: bytes read and written
+                double work = (double) ggml_nbytes(op);
+                for (int j = 0; j < GGML_MAX_SRC; j++) {
+                    if (op->src[j] != NULL) {
+                        work += (double) ggml_nbytes(op->src[j]);
+                    }
+                }
+                return work;
+            }
+    }
+}
+
+static double ggml_backend_sched_op_cost(ggml_backend_sched_t sched, int backend_id, struct ggml_tensor * op, const std::string & key) {
+    const ggml_backend_sched_cost_model * cm = sched->cost_model;
+
+    if (cm->op_cost != NULL) {
+        const double us = cm->op_cost(sched->backends[backend_id], op, cm->op_cost_user_data);
+        if (us >= 0.0) {
+            return us;
+        }
+    }
+
+    if (!cm->op_us[backend_id].empty()) {
+        auto it = cm->op_us[backend_id].find(key);
+        if (it != cm->op_us[backend_id].end()) {
+            return it->second;
+        }
+    }
+
+    const ggml_backend_sched_op_fit & fit = cm->op_fit[backend_id][op->op];
+    if (fit.valid) {
+        return fit.us + fit.us_work*ggml_backend_sched_op_work(op);
+    }
+
+    return -1.0;
+}
+
+static double ggml_backend_sched_copy_us(ggml_backend_sched_t sched, int src_backend_id, int dst_backend_id, size_t nbytes) {
+    const ggml_backend_sched_cost_model * cm = sched->cost_model;
+
+    double latency_us   = cm->copy_latency_us[src_backend_id][dst_backend_id];
+    double bytes_per_us = cm->copy_bytes_per_us[src_backend_id][dst_backend_id];
+    if (latency_us < 0.0 || bytes_per_us <= 0.0) {
+        latency_us   = GGML_SCHED_COPY_LATENCY_US;
+        bytes_per_us = GGML_SCHED_COPY_BYTES_PER_US;
+    }
+
+    return latency_us + (double) nbytes/bytes_per_us;
+}
+
+// backend that holds the data of a tensor, -1 if it is not known yet
+static int ggml_backend_sched_data_backend_id(ggml_backend_sched_t sched, struct ggml_tensor * t) {
+    int backend_id = tensor_backend_id(t);
+    if (backend_id == -1 && t->view_src != NULL) {
+        backend_id = tensor_backend_id(t->view_src);
+    }
+    return backend_id;
+}
+
+// cost of the copies of a tensor to the backends of its users, as done in pass 5
+static double ggml_backend_sched_copies_us(ggml_backend_sched_t sched, struct ggml_cgraph * graph, struct ggml_tensor * t) {
+    const ggml_backend_sched_cost_model * cm = sched->cost_model;
+
+    const int src_backend_id = ggml_backend_sched_data_backend_id(sched, t);
+    if (src_backend_id == -1) {
+        // placed later with its users, no copy
+        return 0.0;
+    }
+
+    const size_t id = hash_id(t);
+
+    uint32_t done = 1u << src_backend_id;
+    double us = 0.0;
+    for (int32_t k = cm->cons_offs[id]; k < cm->cons_offs[id + 1]; k++) {
+        const int backend_id = tensor_backend_id(graph->nodes[cm->cons[k]]);
+        if (backend_id == -1 || (done & (1u << backend_id))) {
+            continue;
+        }
+        done |= 1u << backend_id;
+        if (!ggml_backend_sched_buffer_supported(sched, t, backend_id)) {
+            us += ggml_backend_sched_copy_us(sched, src_backend_id, backend_id, ggml_nbytes(t));
+        }
+    }
+    return us;
+}
+
+static void ggml_backend_sched_add_affected(ggml_backend_sched_t sched, struct ggml_tensor * t) {
+    ggml_backend_sched_cost_model * cm = sched->cost_model;
+    const size_t id = hash_id(t);
+    if (cm->stamp[id] != cm->cur_stamp) {
+        cm->stamp[id] = cm->cur_stamp;
+        cm->affected.push_back(t);
+    }
+}
+
+// cost of the splits that start between the pairs of consecutive nodes in cm->pairs
+static double ggml_backend_sched_splits_us(ggml_backend_sched_t sched, struct ggml_cgraph * graph) {
+    const ggml_backend_sched_cost_model * cm = sched->cost_model;
+
+    double us = 0.0;
+    for (int p : cm->pairs) {
+        const int backend_id0 = tensor_backend_id(graph->nodes[cm->order[p]]);
+        const int backend_id1 = tensor_backend_id(graph->nodes[cm->order[p + 1]]);
+        if (backend_id0 != backend_id1 && backend_id1 != -1) {
+            us += cm->split_us[backend_id1];
+        }
+    }
+    return us;
+}
+
+// moves the nodes to backend_id if this lowers the estimated time, returns true if they were moved
+static bool ggml_backend_sched_try_move(ggml_backend_sched_t sched, struct ggml_cgraph * graph, const int * idxs, int n, int backend_id) {
+    ggml_backend_sched_cost_model * cm = sched->cost_model;
+    const int n_backends = sched->n_backends;
+
+    double before = 0.0;
+    for (int k = 0; k < n; k++) {
+        struct ggml_tensor * node = graph->nodes[idxs[k]];
+        const int cur_backend_id = tensor_backend_id(node);
+        if (cur_backend_id == -1) {
+            return false;
+        }
+        const double us_cur = cm->node_us[(size_t) idxs[k]*n_backends + cur_backend_id];
+        const double us_new = cm->node_us[(size_t) idxs[k]*n_backends + backend_id];
+        if (cm->fixed[hash_id(node)] || us_cur < 0.0 || us_new < 0.0) {
+            return false;
+        }
+        before += us_cur;
+    }
+
+    // the copies that depend on the location of the nodes: their sources, and the nodes and their views as sources
+    cm->cur_stamp++;
+    cm->affected.clear();
+    for (int k = 0; k < n; k++) {
+        struct ggml_tensor * node = graph->nodes[idxs[k]];
+        for (int j = 0; j < GGML_MAX_SRC; j++) {
+            if (node->src[j] != NULL) {
+                ggml_backend_sched_add_affected(sched, node->src[j]);
+            }
+        }
+        ggml_backend_sched_add_affected(sched, node);
+        const size_t id = hash_id(node);
+        for (int32_t v = cm->view_offs[id]; v < cm->view_offs[id + 1]; v++) {
+            ggml_backend_sched_add_affected(sched, cm->views[v]);
+        }
+    }
+
+    for (struct ggml_tensor * t : cm->affected) {
+        before += ggml_backend_sched_copies_us(sched, graph, t);
+    }
+
+    // the splits that start or end around the nodes
+    cm->pairs.clear();
+    for (int k = 0; k < n; k++) {
+        const int p = cm->order_pos[idxs[k]];
+        if (p > 0) {
+            cm->pairs.push_back(p - 1);
+        }
+        if (p + 1 < (int) cm->order.size()) {
+            cm->pairs.push_back(p);
+        }
+    }
+    std::sort(cm->pairs.begin(), cm->pairs.end());
+    cm->pairs.erase(std::unique(cm->pairs.begin(), cm->pairs.end()), cm->pairs.end());
+    before += ggml_backend_sched_splits_us(sched, graph);
+
+    cm->prev_ids.resize(n);
+    double after = 0.0;
+    for (int k = 0; k < n; k++) {
+        int * node_backend_id = &tensor_backend_id(graph->nodes[idxs[k]]);
+        cm->prev_ids[k] = *node_backend_id;
+        *node_backend_id = backend_id;
+        after += cm->node_us[(size_t) idxs[k]*n_backends + backend_id];
+    }
+    for (struct ggml_tensor * t : cm->affected) {
+        after += ggml_backend_sched_copies_us(sched, graph, t);
+    }
+    after += ggml_backend_sched_splits_us(sched, graph);
+
+    if (after < before - 1e-3) {
+        for (int k = 0; k < n; k++) {
+            SET_CAUSE(graph->nodes[idxs[k]], "3.cost");
+        }
+        return true;
+    }
+
+    for (int k = 0; k < n; k++) {
+        tensor_backend_id(graph->nodes[idxs[k]]) = cm->prev_ids[k];
+    }
+    return false;
+}
+
+// estimated time of the graph with the current assignments
+static double ggml_backend_sched_estimate(ggml_backend_sched_t sched, struct ggml_cgraph * graph) {
+    ggml_backend_sched_cost_model * cm = sched->cost_model;
+
+    double us = 0.0;
+    cm->cur_stamp++;
+    for (int i = 0; i < graph->n_nodes; i++) {
+        struct ggml_tensor * node = graph->nodes[i];
+        if (ggml_is_view_op(node->op)) {
+            continue;
+        }
+        const int node_backend_id = tensor_backend_id(node);
+        if (node_backend_id != -1) {
+            us += std::max(0.0, cm->node_us[(size_t) i*sched->n_backends + node_backend_id]);
+        }
+        for (int j = 0; j < GGML_MAX_SRC; j++) {
+            struct ggml_tensor * src = node->src[j];
+            if (src == NULL) {
+                continue;
+            }
+            const size_t id = hash_id(src);
+            if (cm->stamp[id] != cm->cur_stamp) {
+                cm->stamp[id] = cm->cur_stamp;
+                us += ggml_backend_sched_copies_us(sched, graph, src);
+            }
+        }
+    }
+
+    if (!cm->order.empty()) {
+        const int backend_id = tensor_backend_id(graph->nodes[cm->order[0]]);
+        us += backend_id != -1 ? cm->split_us[backend_id] : 0.0;
+    }
+    cm->pairs.clear();
+    for (int p = 0; p + 1 < (int) cm->order.size(); p++) {
+        cm->pairs.push_back(p);
+    }
+    us += ggml_backend_sched_splits_us(sched, graph);
+
+    return us;
+}
+
+// refines the assignments of the ops with local moves that lower the estimated time of the graph:
+// single ops, which can create new splits when an op is much faster on another backend,
+// and whole runs of ops on the same backend, which can merge splits and remove copies
+static void ggml_backend_sched_refine_by_cost(ggml_backend_sched_t sched, struct ggml_cgraph * graph) {
+    ggml_backend_sched_cost_model * cm = sched->cost_model;
+    const int n_backends = sched->n_backends;
+    const size_t hash_size = sched->hash_set.size;
+
+    cm->stamp.assign(hash_size, 0);
+    cm->cur_stamp = 0;
+
+    // users of each tensor and views of each tensor used as sources
+    cm->cons_offs.assign(hash_size + 1, 0);
+    cm->view_offs.assign(hash_size + 1, 0);
+    for (int i = 0; i < graph->n_nodes; i++) {
+        struct ggml_tensor * node = graph->nodes[i];
+        if (ggml_is_view_op(node->op)) {
+            continue;
+        }
+        for (int j = 0; j < GGML_MAX_SRC; j++) {
+            struct ggml_tensor * src = node->src[j];
+            if (src == NULL) {
+                continue;
+            }
+            cm->cons_offs[hash_id(src) + 1]++;
+            if (src->view_src != NULL) {
+                cm->view_offs[hash_id(src->view_src) + 1]++;
+            }
+        }
+    }
+    for (size_t h = 0; h < hash_size; h++) {
+        cm->cons_offs[h + 1] += cm->cons_offs[h];
+        cm->view_offs[h + 1] += cm->view_offs[h];
+    }
+    cm->cons.resize(cm->cons_offs[hash_size]);
+    cm->views.resize(cm->view_offs[hash_size]);
+    {
+        std::vector<int32_t> cons_pos(cm->cons_offs.begin(), cm->cons_offs.end() - 1);
+        std::vector<int32_t> view_pos(cm->view_offs.begin(), cm->view_offs.end() - 1);
+        for (int i = 0; i < graph->n_nodes; i++) {
+            struct ggml_tensor * node = graph->nodes[i];
+            if (ggml_is_view_op(node->op)) {
+                continue;
+            }
+            for (int j = 0; j < GGML_MAX_SRC; j++) {
+                struct ggml_tensor * src = node->src[j];
+                if (src == NULL) {
+                    continue;
+                }
+                cm->cons[cons_pos[hash_id(src)]++] = i;
+                if (src->view_src != NULL) {
+                    cm->views[view_pos[hash_id(src->view_src)]++] = src;
+                }
+            }
+        }
+    }
+
+    // ops with a pre-allocated destination write in place and cannot be moved, neither can the sources they write to
+    for (int i = 0; i < graph->n_nodes; i++) {
+        struct ggml_tensor * node = graph->nodes[i];
+        if (ggml_is_view_op(node->op)) {
+            continue;
+        }
+        if (node->buffer != NULL || node->view_src != NULL) {
+            cm->fixed[hash_id(node)] = 1;
+        }
+        if (node->view_src != NULL) {
+            cm->fixed[hash_id(node->view_src)] = 1;
+        }
+    }
+
+    // cost of every op on every backend
+    bool calibrated = false;
+    for (int b = 0; b < n_backends; b++) {
+        calibrated = calibrated || !cm->op_us[b].empty();
+    }
+    cm->node_us.assign((size_t) graph->n_nodes*n_backends, -1.0);
+    std::string key;
+    for (int i = 0; i < graph->n_nodes; i++) {
+        struct ggml_tensor * node = graph->nodes[i];
+        if (ggml_is_view_op(node->op) || node->op == GGML_OP_NONE) {
+            continue;
+        }
+        if (calibrated) {
+            key = ggml_backend_sched_op_key(node);
+        }
+        for (int b = 0; b < n_backends; b++) {
+            if (ggml_backend_supports_op(sched->backends[b], node)) {
+                cm->node_us[(size_t) i*n_backends + b] = ggml_backend_sched_op_cost(sched, b, node, key);
+            }
+        }
+    }
+
+    std::vector<int> & order = cm->order;
+    order.clear();
+    cm->order_pos.assign(graph->n_nodes, -1);
+    for (int i = 0; i < graph->n_nodes; i++) {
+        if (!ggml_is_view_op(graph->nodes[i]->op)) {
+            cm->order_pos[i] = (int) order.size();
+            order.push_back(i);
+        }
+    }
+
+    const double est_us_init = ggml_backend_sched_estimate(sched, graph);
+
+    for (int iter = 0; iter < GGML_SCHED_COST_MAX_ITER; iter++) {
+        bool moved = false;
+
+        // single ops
+        for (int i : order) {
+            const int cur_backend_id = tensor_backend_id(graph->nodes[i]);
+            for (int b = 0; b < n_backends; b++) {
+                if (b != cur_backend_id && ggml_backend_sched_try_move(sched, graph, &i, 1, b)) {
+                    moved = true;
+                    break;
+                }
+            }
+        }
+
+        // runs of consecutive ops on the same backend
+        for (size_t k0 = 0; k0 < order.size(); ) {
+            const int run_backend_id = tensor_backend_id(graph->nodes[order[k0]]);
+            size_t k1 = k0 + 1;
+            while (k1 < order.size() && tensor_backend_id(graph->nodes[order[k1]]) == run_backend_id) {
+                k1++;
+            }
+            if (k1 - k0 > 1) {
+                for (int b = 0; b < n_backends; b++) {
+                    if (b != run_backend_id && ggml_backend_sched_try_move(sched, graph, &order[k0], (int) (k1 - k0), b)) {
+                        moved = true;
+                        break;
+                    }
+                }
+            }
+            k0 = k1;
+        }
+
+        if (!moved) {
+            break;
+        }
+    }
+
+    cm->est_us = ggml_backend_sched_estimate(sched, graph);
+
+    if (sched->debug) {
+        GGML_LOG_DEBUG("%s: estimated time %.1f us with the default assignments, %.1f us with the cost model\n", __func__, est_us_init, cm->est_us);
+    }
+}
+
+// tensor parallelism
+//
+// the matrix multiplications with weights in a split buffer are replaced with a partial product on the backend of each part
+// and a concatenation of the partial results, in a graph owned by the scheduler that is split instead of the graph of the user
+// the tensors of the user are not modified: the node of the user becomes a leaf of that graph, and the last concatenation is a view
+// of it, so that it still holds the result
+// the partial products get splits of their own and are computed concurrently when their backends differ
+
+struct ggml_backend_sched_tp {
+    std::vector<uint8_t>  ctx_buffer;
+    struct ggml_context * ctx = nullptr;
+
+    std::vector<int32_t> group;     // [hash_set.size] matrix multiplication of the partial products, -1 for other tensors
+    std::vector<size_t>  group_ids; // hash ids with a group
+
+    // threads of the backends of the concurrent splits, except the first one that is computed by the caller
+    struct worker {
+        std::thread          thread;
+        ggml_backend_t       backend = nullptr;
+        struct ggml_cgraph * graph   = nullptr; // requested graph, NULL if none
+        enum ggml_status     status  = GGML_STATUS_SUCCESS;
+    };
+    worker workers[GGML_SCHED_MAX_BACKENDS];
+    int    n_workers = 0;
+    int    n_pending = 0;
+    bool   stop      = false;
+    std::mutex              mutex;
+    std::condition_variable cv;
+
+    ~ggml_backend_sched_tp() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        cv.notify_all();
+        for (int i = 0; i < n_workers; i++) {
+            workers[i].thread.join();
+        }
+        ggml_free(ctx);
+    }
+
+    void worker_main(int iw) {
+        worker & w = workers[iw];
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            cv.wait(lock, [&]() { return stop || w.graph != nullptr; });
+            if (stop) {
+                return;
+            }
+            lock.unlock();
+
+            const enum ggml_status status = ggml_backend_graph_compute(w.backend, w.graph);
+
+            lock.lock();
+            w.status = status;
+            w.graph  = nullptr;
+            n_pending--;
+            cv.notify_all();
+        }
+    }
+
+    // computes graphs[0] on backends[0] in this thread and the others in the workers
+    enum ggml_status compute(ggml_backend_t * backends, struct ggml_cgraph ** graphs, int n) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            while (n_workers < n - 1) {
+                const int iw = n_workers++;
+                workers[iw].thread = std::thread([this, iw]() { worker_main(iw); });
+            }
+            for (int i = 1; i < n; i++) {
+                workers[i - 1].backend = backends[i];
+                workers[i - 1].graph   = graphs[i];
+                workers[i - 1].status  = GGML_STATUS_SUCCESS;
+            }
+            n_pending = n - 1;
+        }
+        cv.notify_all();
+
+        enum ggml_status status = ggml_backend_graph_compute(backends[0], graphs[0]);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&]() { return n_pending == 0; });
+        for (int i = 1; i < n; i++) {
+            if (status == GGML_STATUS_SUCCESS) {
+                status = workers[i - 1].status;
+            }
+        }
+        return status;
+    }
+};
+
+static int ggml_backend_sched_tp_group(ggml_backend_sched_t sched, struct ggml_tensor * node) {
+    if (sched->tp == NULL || sched->tp->group_ids.empty()) {
+        return -1;
+    }
+    return sched->tp->group[hash_id(node)];
+}
+
+static void ggml_backend_sched_tp_add(struct ggml_cgraph * graph, struct ggml_tensor * tensor, bool leaf) {
+    const size_t h = ggml_hash_insert(&graph->visited_hash_set, tensor);
+    if (h == GGML_HASHSET_ALREADY_EXISTS) {
+        return;
+    }
+    graph->use_counts[h] = 0;
+    if (leaf) {
+        GGML_ASSERT(graph->n_leafs < graph->size);
+        graph->leafs[graph->n_leafs++] = tensor;
+        return;
+    }
+    for (int j = 0; j < GGML_MAX_SRC; j++) {
+        if (tensor->src[j] != NULL && ggml_hash_contains(&graph->visited_hash_set, tensor->src[j])) {
+            graph->use_counts[ggml_hash_find(&graph->visited_hash_set, tensor->src[j])]++;
+        }
+    }
+    GGML_ASSERT(graph->n_nodes < graph->size);
+    graph->nodes[graph->n_nodes++] = tensor;
+}
+
+// backend of each part of a split buffer type: the first unused backend with the same buffer type, or else the first backend that supports it
+static void ggml_backend_sched_tp_part_backends(ggml_backend_sched_t sched, ggml_backend_buffer_type_t buft, std::vector<int> & backend_ids) {
+    const auto * ctx = (const ggml_backend_split_buffer_type_context *) buft->context;
+    bool used[GGML_SCHED_MAX_BACKENDS] = { false };
+
+    backend_ids.assign(ctx->bufts.size(), -1);
+    for (size_t p = 0; p < ctx->bufts.size(); p++) {
+        for (int b = 0; b < sched->n_backends && backend_ids[p] == -1; b++) {
+            if (!used[b] && sched->bufts[b] == ctx->bufts[p]) {
+                backend_ids[p] = b;
+                used[b] = true;
+            }
+        }
+        for (int b = 0; b < sched->n_backends && backend_ids[p] == -1; b++) {
+            if (ggml_backend_supports_buft(sched->backends[b], ctx->bufts[p])) {
+                backend_ids[p] = b;
+            }
+        }
+        if (backend_ids[p] == -1) {
+            GGML_ABORT("%s: no backend of the scheduler supports the buffer type %s of part %d of %s\n", __func__,
+                ggml_backend_buft_name(ctx->bufts[p]), (int) p, ggml_backend_buft_name(buft));
+        }
+    }
+}
+
+// computes a node of the user in the graph of the scheduler: the node becomes a leaf, and the returned copy of the node,
+// a view of it, is computed instead and can have other sources
+static struct ggml_tensor * ggml_backend_sched_tp_replace(ggml_backend_sched_t sched, struct ggml_cgraph * g, struct ggml_tensor * node, int backend_id) {
+    if (node->view_src != NULL) {
+        GGML_ABORT("%s: %s (%s) uses a split tensor, views and in-place ops of split tensors are not supported\n",
+            __func__, node->name, ggml_op_desc(node));
+    }
+
+    struct ggml_tensor * rep = ggml_view_tensor(sched->tp->ctx, node);
+    rep->op = node->op;
+    memcpy(rep->op_params, node->op_params, sizeof(rep->op_params));
+    memcpy(rep->src,       node->src,       sizeof(rep->src));
+    ggml_set_name(rep, node->name);
+
+    ggml_backend_sched_tp_add(g, node, true);
+
+    // the node and its view are computed and allocated by the same backend
+    sched->hv_tensor_backend_ids[hash_id(node)] = backend_id;
+    sched->hv_tensor_backend_ids[hash_id(rep)]  = backend_id;
+    SET_CAUSE(node, "tp");
+    SET_CAUSE(rep,  "tp");
+
+    return rep;
+}
+
+// returns a graph of the scheduler with the matrix multiplications with split weights replaced, or the same graph if there are none
+static struct ggml_cgraph * ggml_backend_sched_tp_expand(ggml_backend_sched_t sched, struct ggml_cgraph * graph) {
+    ggml_backend_sched_tp * tp = sched->tp;
+
+    if (tp != NULL) {
+        for (size_t id : tp->group_ids) {
+            tp->group[id] = -1;
+        }
+        tp->group_ids.clear();
+    }
+
+    // number of partial products and of the leafs to replace, and number of nodes to replace
+    int n_parts = 0;
+    int n_rep   = 0;
+    for (int i = 0; i < graph->n_leafs; i++) {
+        if (ggml_backend_split_tensor_get_extra(graph->leafs[i]) != NULL) {
+            n_parts++;
+        }
+    }
+    for (int i = 0; i < graph->n_nodes; i++) {
+        struct ggml_tensor * node = graph->nodes[i];
+        bool rep = false;
+        for (int j = 0; j < GGML_MAX_SRC; j++) {
+            if (node->src[j] != NULL && ggml_backend_split_tensor_get_extra(node->src[j]) != NULL) {
+                n_parts += (int) ggml_backend_split_tensor_get_extra(node->src[j])->parts.size();
+                rep = true;
+            }
+        }
+        n_rep += rep;
+    }
+    if (n_parts == 0) {
+        return graph;
+    }
+
+    if (tp == NULL) {
+        tp = sched->tp = new ggml_backend_sched_tp;
+        tp->group.assign(sched->hash_set.size, -1);
+    }
+
+    const size_t graph_size = std::max(graph->n_nodes, graph->n_leafs) + 2*n_parts + n_rep;
+    const size_t mem_size   = (2*n_parts + n_rep)*ggml_tensor_overhead() + ggml_graph_overhead_custom(graph_size, false);
+    if (tp->ctx_buffer.size() < mem_size) {
+        tp->ctx_buffer.resize(mem_size);
+    }
+    ggml_free(tp->ctx);
+    struct ggml_init_params params = {
+        /*.mem_size   =*/ tp->ctx_buffer.size(),
+        /*.mem_buffer =*/ tp->ctx_buffer.data(),
+        /*.no_alloc   =*/ true,
+    };
+    tp->ctx = ggml_init(params);
+
+    struct ggml_cgraph * g = ggml_new_graph_custom(tp->ctx, graph_size, false);
+    g->order = graph->order;
+
+    for (int i = 0; i < graph->n_leafs; i++) {
+        if (ggml_backend_split_tensor_get_extra(graph->leafs[i]) == NULL) {
+            ggml_backend_sched_tp_add(g, graph->leafs[i], true);
+        }
+    }
+
+    std::unordered_map<ggml_backend_buffer_type_t, std::vector<int>> part_backends;
+    auto get_part_backends = [&](ggml_backend_buffer_type_t buft) -> const std::vector<int> & {
+        auto it = part_backends.find(buft);
+        if (it == part_backends.end()) {
+            it = part_backends.emplace(buft, std::vector<int>()).first;
+            ggml_backend_sched_tp_part_backends(sched, buft, it->second);
+        }
+        return it->second;
+    };
+
+    int n_groups = 0;
+
+    for (int i = 0; i < graph->n_nodes; i++) {
+        struct ggml_tensor * node = graph->nodes[i];
+
+        // the tensors entirely in one part are replaced with the part, the node runs on the backend of the part
+        // a tensor split between several parts can only be the weights of a matrix multiplication
+        int j_split    = -1;
+        int backend_id = -1;
+        bool has_split = false;
+        for (int j = 0; j < GGML_MAX_SRC; j++) {
+            struct ggml_tensor * src = node->src[j];
+            const ggml_backend_split_tensor_extra * extra = src ? ggml_backend_split_tensor_get_extra(src) : NULL;
+            if (extra == NULL) {
+                continue;
+            }
+            has_split = true;
+
+            int n_used = 0;
+            for (size_t p = 0; p < extra->parts.size(); p++) {
+                if (extra->parts[p] != NULL) {
+                    n_used++;
+                    if (backend_id == -1) {
+                        backend_id = get_part_backends(src->buffer->buft)[p];
+                    }
+                }
+            }
+
+            if (n_used > 1) {
+                if (node->op != GGML_OP_MUL_MAT || j != 0) {
+                    GGML_ABORT("%s: %s uses the split tensor %s, only MUL_MAT can use the tensors split between several backends\n",
+                        __func__, ggml_op_desc(node), src->name);
+                }
+                j_split = j;
+            }
+        }
+
+        if (!has_split) {
+            ggml_backend_sched_tp_add(g, node, false);
+            continue;
+        }
+
+        // the backend assigned by the user, if any
+        const int user_backend_id = sched->hv_tensor_backend_ids[hash_id(node)];
+        if (user_backend_id != -1) {
+            backend_id = user_backend_id;
+        }
+
+        struct ggml_tensor * rep = ggml_backend_sched_tp_replace(sched, g, node, backend_id);
+
+        for (int j = 0; j < GGML_MAX_SRC; j++) {
+            const ggml_backend_split_tensor_extra * extra = rep->src[j] ? ggml_backend_split_tensor_get_extra(rep->src[j]) : NULL;
+            if (extra == NULL || j == j_split) {
+                continue;
+            }
+            for (struct ggml_tensor * part : extra->parts) {
+                if (part != NULL) {
+                    rep->src[j] = part;
+                    ggml_backend_sched_tp_add(g, part, true);
+                }
+            }
+        }
+
+        if (j_split != -1) {
+            struct ggml_tensor * src = rep->src[j_split];
+            const ggml_backend_split_tensor_extra * extra = ggml_backend_split_tensor_get_extra(src);
+            const std::vector<int> & backend_ids = get_part_backends(src->buffer->buft);
+
+            // partial products
+            const int group = n_groups++;
+            std::vector<struct ggml_tensor *> partials;
+            for (size_t p = 0; p < extra->parts.size(); p++) {
+                struct ggml_tensor * part = extra->parts[p];
+                if (part == NULL) {
+                    continue;
+                }
+                ggml_backend_sched_tp_add(g, part, true);
+
+                struct ggml_tensor * partial = ggml_mul_mat(tp->ctx, part, rep->src[1]);
+                memcpy(partial->op_params, rep->op_params, sizeof(partial->op_params));
+                ggml_format_name(partial, "%s#%d", node->name, (int) p);
+                ggml_backend_sched_tp_add(g, partial, false);
+
+                const size_t id = hash_id(partial);
+                sched->hv_tensor_backend_ids[id] = backend_ids[p];
+                SET_CAUSE(partial, "tp");
+                tp->group[id] = group;
+                tp->group_ids.push_back(id);
+                partials.push_back(partial);
+            }
+
+            // concatenation of the rows, the last one in the memory of the node of the user
+            struct ggml_tensor * cur = partials[0];
+            for (size_t k = 1; k + 1 < partials.size(); k++) {
+                cur = ggml_concat(tp->ctx, cur, partials[k], 0);
+                ggml_format_name(cur, "%s#cat%d", node->name, (int) k);
+                ggml_backend_sched_tp_add(g, cur, false);
+            }
+
+            rep->op = GGML_OP_CONCAT;
+            memset(rep->op_params, 0, sizeof(rep->op_params));
+            ggml_set_op_params_i32(rep, 0, 0);
+            memset(rep->src, 0, sizeof(rep->src));
+            rep->src[0] = cur;
+            rep->src[1] = partials.back();
+        }
+
+        ggml_backend_sched_tp_add(g, rep, false);
+    }
+
+    GGML_ASSERT((int) sched->hash_set.size >= g->n_nodes + g->n_leafs);
+
+    return g;
+}
+
+// marks the groups of splits with the partial products of a matrix multiplication on different backends
+static void ggml_backend_sched_tp_parallel_splits(ggml_backend_sched_t sched, struct ggml_cgraph * graph) {
+    auto split_group = [&](const struct ggml_backend_sched_split * split) {
+        for (int i = split->i_start; i < split->i_end; i++) {
+            if (!ggml_is_view_op(graph->nodes[i]->op)) {
+                return ggml_backend_sched_tp_group(sched, graph->nodes[i]);
+            }
+        }
+        return -1;
+    };
+
+    for (int s = 0; s < sched->n_splits; s++) {
+        sched->splits[s].n_parallel = 1;
+    }
+    if (sched->tp == NULL || sched->tp->group_ids.empty()) {
+        return;
+    }
+
+    for (int s = 0; s < sched->n_splits; ) {
+        const int group = split_group(&sched->splits[s]);
+        int t = s + 1;
+        if (group >= 0) {
+            bool used[GGML_SCHED_MAX_BACKENDS] = { false };
+            used[sched->splits[s].backend_id] = true;
+            while (t < sched->n_splits && split_group(&sched->splits[t]) == group && !used[sched->splits[t].backend_id]) {
+                used[sched->splits[t].backend_id] = true;
+                t++;
+            }
+        }
+        sched->splits[s].n_parallel = t - s;
+        s = t;
+    }
+}
+
+// split cache
+//
+// the graphs of consecutive evaluations usually have the same structure, only the data of the inputs changes
+// the assignments, splits and copies of the last graph are kept and reused when the next graph has the same fingerprint,
+// which covers the ops, shapes, strides, buffers and user assignments of all the tensors and how they are connected
+// on a hit, only the sources of the nodes are rewired to the existing copies and the data pointers are rebound by ggml-alloc
+// not used with pipeline parallelism (n_copies > 1), where the graph inputs are also copied
+// disabled with GGML_SCHED_REUSE=0
+
+struct ggml_backend_sched_split_cache {
+    bool     valid;
+    uint64_t fingerprint;
+
+    // position of the tensors of the current graph: node index, or -1 - leaf index
+    std::vector<int32_t>  pos;     // [hash_set.size]
+    std::vector<uint32_t> pos_gen; // [hash_set.size]
+    uint32_t gen;
+    std::vector<size_t> ids;       // [n_leafs + n_nodes] hash ids of the leafs and nodes of the current graph
+
+    int n_nodes;
+    int n_leafs;
+    std::vector<int> node_backend_ids; // [n_nodes]
+    std::vector<int> leaf_backend_ids; // [n_leafs]
+
+    // split inputs, in the order of the splits
+    struct input {
+        int32_t pos;
+        struct ggml_tensor * copy;
+        struct ggml_tensor * dep;
+    };
+    std::vector<input> inputs;
+    std::vector<int>   split_n_inputs; // [n_splits]
+
+    // sources of the nodes replaced with a copy
+    struct src_copy {
+        int32_t node;
+        int32_t src;
+        struct ggml_tensor * copy;
+    };
+    std::vector<src_copy> src_copies;
+};
+
+static void ggml_backend_sched_invalidate_splits(ggml_backend_sched_t sched) {
+    if (sched->split_cache != NULL) {
+        sched->split_cache->valid = false;
+    }
+}
+
+static inline uint64_t ggml_backend_sched_hash_mix(uint64_t h, uint64_t v) {
+    h = (h ^ v) * 0x9e3779b97f4a7c15ull;
+    return h ^ (h >> 32);
+}
+
+// tensors of the graph are identified by their position, other tensors by their address
+static uint64_t ggml_backend_sched_tensor_ref(ggml_backend_sched_t sched, const struct ggml_tensor * tensor) {
+    if (tensor == NULL) {
+        return 0;
+    }
+    const ggml_backend_sched_split_cache * sc = sched->split_cache;
+    const size_t id = ggml_hash_find(&sched->hash_set, tensor);
+    if (id != GGML_HASHSET_FULL && ggml_bitset_get(sched->hash_set.used, id) && sc->pos_gen[id] == sc->gen) {
+        return (uint64_t) (uint32_t) sc->pos[id] | (1ull << 32);
+    }
+    return (uint64_t) (uintptr_t) tensor;
+}
+
+static uint64_t ggml_backend_sched_tensor_fingerprint(ggml_backend_sched_t sched, uint64_t h, const struct ggml_tensor * tensor, size_t id) {
+    // buffer, ne, nb, op, op_params and flags are contiguous
+    static_assert((offsetof(struct ggml_tensor, src) - offsetof(struct ggml_tensor, buffer)) % sizeof(uint64_t) == 0, "unexpected ggml_tensor layout");
+    const char * p = (const char *) tensor + offsetof(struct ggml_tensor, buffer);
+    const char * e = (const char *) tensor + offsetof(struct ggml_tensor, src);
+    for (; p < e; p += sizeof(uint64_t)) {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        h = ggml_backend_sched_hash_mix(h, v);
+    }
+    h = ggml_backend_sched_hash_mix(h, (uint64_t) tensor->type);
+    h = ggml_backend_sched_hash_mix(h, ggml_backend_sched_tensor_ref(sched, tensor->view_src));
+    h = ggml_backend_sched_hash_mix(h, (uint64_t) tensor->view_offs);
+    for (int j = 0; j < GGML_MAX_SRC; j++) {
+        h = ggml_backend_sched_hash_mix(h, ggml_backend_sched_tensor_ref(sched, tensor->src[j]));
+    }
+    // backend assigned by the user
+    h = ggml_backend_sched_hash_mix(h, (uint64_t) (int64_t) sched->hv_tensor_backend_ids[id]);
+    return h;
+}
+
+// records the positions of the tensors of the graph and returns its fingerprint
+static uint64_t ggml_backend_sched_graph_fingerprint(ggml_backend_sched_t sched, struct ggml_cgraph * graph) {
+    ggml_backend_sched_split_cache * sc = sched->split_cache;
+
+    if (++sc->gen == 0) {
+        std::fill(sc->pos_gen.begin(), sc->pos_gen.end(), 0);
+        sc->gen = 1;
+    }
+
+    sc->ids.resize(graph->n_leafs + graph->n_nodes);
+
+    uint64_t h = ggml_backend_sched_hash_mix(0, ((uint64_t) graph->n_nodes << 32) | (uint64_t) graph->n_leafs);
+    h = ggml_backend_sched_hash_mix(h, sched->cost_enabled);
+
+    for (int i = 0; i < graph->n_leafs; i++) {
+        const size_t id = hash_id(graph->leafs[i]);
+        h = ggml_backend_sched_tensor_fingerprint(sched, h, graph->leafs[i], id);
+        sc->ids[i]      = id;
+        sc->pos[id]     = -1 - i;
+        sc->pos_gen[id] = sc->gen;
+    }
+    for (int i = 0; i < graph->n_nodes; i++) {
+        const size_t id = hash_id(graph->nodes[i]);
+        h = ggml_backend_sched_tensor_fingerprint(sched, h, graph->nodes[i], id);
+        sc->ids[graph->n_leafs + i] = id;
+        sc->pos[id]     = i;
+        sc->pos_gen[id] = sc->gen;
+    }
+
+    return h;
+}
+
+static struct ggml_tensor * ggml_backend_sched_tensor_at(struct ggml_cgraph * graph, int32_t pos) {
+    return pos >= 0 ? graph->nodes[pos] : graph->leafs[-1 - pos];
+}
+
+// builds the graph with the inputs of the splits from the split graphs
+// on a hit of the split cache, the views of the inputs of the last graph are rebound to the new inputs
+static void ggml_backend_sched_build_graph_copy(ggml_backend_sched_t sched, struct ggml_cgraph * graph, bool reuse) {
+    ggml_backend_sched_split_cache * sc = sched->split_cache;
+
+    // swap node_backend_ids and leaf _backend_ids with prevs
+    {
+        int * tmp = sched->node_backend_ids;
+        sched->node_backend_ids = sched->prev_node_backend_ids;
+        sched->prev_node_backend_ids = tmp;
+
+        tmp = sched->leaf_backend_ids;
+        sched->leaf_backend_ids = sched->prev_leaf_backend_ids;
+        sched->prev_leaf_backend_ids = tmp;
+    }
+
+    int graph_size = std::max(graph->n_nodes, graph->n_leafs) + sched->n_splits*GGML_SCHED_MAX_SPLIT_INPUTS*2*sched->n_copies;
+    if (sched->graph.size < graph_size) {
+        sched->graph.size = graph_size;
+        sched->graph.nodes = (ggml_tensor **) realloc(sched->graph.nodes, graph_size * sizeof(struct ggml_tensor *));
+        sched->graph.leafs = (ggml_tensor **) realloc(sched->graph.leafs, graph_size * sizeof(struct ggml_tensor *));
+        GGML_ASSERT(sched->graph.nodes != NULL);
+        GGML_ASSERT(sched->graph.leafs != NULL);
+    }
+    sched->graph.n_nodes = 0;
+    sched->graph.n_leafs = 0;
+
+    struct ggml_cgraph * graph_copy = &sched->graph;
+
+    int i_input = 0;
+    for (int i = 0; i < sched->n_splits; i++) {
+        struct ggml_backend_sched_split * split = &sched->splits[i];
+        split->graph = ggml_graph_view(graph, split->i_start, split->i_end);
+
+        // Optimize this split of the graph. This needs to happen before we make graph_copy,
+        // so they are in sync.
+        ggml_backend_graph_optimize(sched->backends[split->backend_id], &split->graph);
+
+        // add inputs to the graph copy so that they are allocated by ggml-alloc at the start of the split
+        for (int j = 0; j < split->n_inputs; j++, i_input++) {
+            assert(graph_copy->size > (graph_copy->n_nodes + 1));
+
+            struct ggml_tensor * input = split->inputs[j];
+            const size_t input_id = hash_id(input);
+            struct ggml_tensor * input_cpy = tensor_id_copy(input_id, split->backend_id, sched->cur_copy);
+
+            // add a dependency to the input source so that it is not freed before the copy is done
+            struct ggml_tensor * input_dep;
+            if (reuse) {
+                input_dep = sc->inputs[i_input].dep;
+                input_dep->src[0]    = input;
+                input_dep->view_src  = input->view_src ? input->view_src  : input;
+                input_dep->view_offs = input->view_src ? input->view_offs : 0;
+                input_dep->buffer    = NULL;
+                input_dep->data      = NULL;
+                ggml_format_name(input_dep, "%s (view)", input->name);
+
+                input_cpy->buffer = NULL;
+                input_cpy->data   = NULL;
+                ggml_format_name(input_cpy, "%s#%s#%d", ggml_backend_name(sched->backends[split->backend_id]), input->name, sched->cur_copy);
+            } else {
+                input_dep = ggml_view_tensor(sched->ctx, input);
+                input_dep->src[0] = input;
+                if (sc != NULL && sc->valid) {
+                    sc->inputs[i_input].dep = input_dep;
+                }
+            }
+            sched->node_backend_ids[graph_copy->n_nodes] = sched->hv_tensor_backend_ids[input_id];
+            graph_copy->nodes[graph_copy->n_nodes++] = input_dep;
+
+            // add a dependency to the input copy so that it is allocated at the start of the split
+            sched->node_backend_ids[graph_copy->n_nodes] = split->backend_id;
+            graph_copy->nodes[graph_copy->n_nodes++] = input_cpy;
+        }
+
+        for (int j = split->i_start; j < split->i_end; j++) {
+            assert(graph_copy->size > graph_copy->n_nodes);
+            sched->node_backend_ids[graph_copy->n_nodes] = tensor_backend_id(graph->nodes[j]);
+            graph_copy->nodes[graph_copy->n_nodes++] = graph->nodes[j];
+        }
+    }
+
+    if (sched->n_copies > 1) {
+        // add input copies as leafs so that they are allocated first
+        for (int i = 0; i < sched->n_graph_inputs; i++) {
+            struct ggml_tensor * input = sched->graph_inputs[i];
+            size_t id = hash_id(input);
+            int backend_id = tensor_backend_id(input);
+            for (int c = 0; c < sched->n_copies; c++) {
+                struct ggml_tensor * input_cpy = tensor_id_copy(id, backend_id, c);
+                sched->leaf_backend_ids[graph_copy->n_leafs] = backend_id;
+                assert(graph_copy->size > graph_copy->n_leafs);
+                graph_copy->leafs[graph_copy->n_leafs++] = input_cpy;
+            }
+        }
+
+        for (int i = 0; i < sched->n_splits; i++) {
+            struct ggml_backend_sched_split * split = &sched->splits[i];
+            int backend_id = split->backend_id;
+            for (int j = 0; j < split->n_inputs; j++) {
+                struct ggml_tensor * input = split->inputs[j];
+                size_t id = hash_id(input);
+                for (int c = 0; c < sched->n_copies; c++) {
+                    struct ggml_tensor * input_cpy = tensor_id_copy(id, backend_id, c);
+                    sched->leaf_backend_ids[graph_copy->n_leafs] = backend_id;
+                    assert(graph_copy->size > graph_copy->n_leafs);
+                    graph_copy->leafs[graph_copy->n_leafs++] = input_cpy;
+                }
+            }
+        }
+    }
+
+    // add leafs from the original graph
+    for (int i = 0; i < graph->n_leafs; i++) {
+        struct ggml_tensor * leaf = graph->leafs[i];
+        sched->leaf_backend_ids[graph_copy->n_leafs] = tensor_backend_id(leaf);
+        assert(graph_copy->size > graph_copy->n_leafs);
+        graph_copy->leafs[graph_copy->n_leafs++] = leaf;
+    }
+}
+
+// records the assignments, splits and copies of the graph after pass 5
+static void ggml_backend_sched_save_splits(ggml_backend_sched_t sched, struct ggml_cgraph * graph) {
+    ggml_backend_sched_split_cache * sc = sched->split_cache;
+
+    sc->n_nodes = graph->n_nodes;
+    sc->n_leafs = graph->n_leafs;
+    sc->node_backend_ids.resize(graph->n_nodes);
+    sc->leaf_backend_ids.resize(graph->n_leafs);
+    for (int i = 0; i < graph->n_nodes; i++) {
+        sc->node_backend_ids[i] = sched->hv_tensor_backend_ids[sc->ids[graph->n_leafs + i]];
+    }
+    for (int i = 0; i < graph->n_leafs; i++) {
+        sc->leaf_backend_ids[i] = sched->hv_tensor_backend_ids[sc->ids[i]];
+    }
+
+    sc->inputs.clear();
+    sc->split_n_inputs.resize(sched->n_splits);
+    for (int i = 0; i < sched->n_splits; i++) {
+        const struct ggml_backend_sched_split * split = &sched->splits[i];
+        sc->split_n_inputs[i] = split->n_inputs;
+        for (int j = 0; j < split->n_inputs; j++) {
+            struct ggml_tensor * input = split->inputs[j];
+            const size_t id = hash_id(input);
+            if (sc->pos_gen[id] != sc->gen) {
+                // the input is not in the graph
+                sc->valid = false;
+                return;
+            }
+            sc->inputs.push_back({ sc->pos[id], tensor_id_copy(id, split->backend_id, 0), NULL });
         }
     }
+
+    sc->valid = true;
 }
 
-static bool ggml_backend_sched_buffer_supported(ggml_backend_sched_t sched, struct ggml_tensor * t, int backend_id) {
-    ggml_backend_buffer_t buf = t->view_src ? t->view_src->buffer : t->buffer;
-    ggml_backend_buffer_type_t buft = NULL;
+// reuses the splits of the last graph if the graph has the same fingerprint
+static bool ggml_backend_sched_reuse_splits(ggml_backend_sched_t sched, struct ggml_cgraph * graph) {
+    ggml_backend_sched_split_cache * sc = sched->split_cache;
 
-    if (buf) {
-        // the tensor is already allocated
-        buft = buf->buft;
-    } else {
-        // see if the tensor already has a backend assigned, and use the buffer type of that backend
-        int tensor_backend_id = tensor_backend_id(t);
-        if (tensor_backend_id == -1 && t->view_src) {
-            tensor_backend_id = tensor_backend_id(t->view_src);
-        }
-        if (tensor_backend_id != -1) {
-            buft = sched->bufts[tensor_backend_id];
+    const uint64_t fingerprint = ggml_backend_sched_graph_fingerprint(sched, graph);
+    const bool hit = sc->valid && sc->fingerprint == fingerprint && sc->n_nodes == graph->n_nodes && sc->n_leafs == graph->n_leafs;
+    sc->fingerprint = fingerprint;
+    sc->valid = false;
+    if (!hit) {
+        return false;
+    }
+
+    sched->is_reset = false;
+    sched->n_graph_inputs = 0;
+
+    for (int i = 0; i < graph->n_leafs; i++) {
+        sched->hv_tensor_backend_ids[sc->ids[i]] = sc->leaf_backend_ids[i];
+    }
+    for (int i = 0; i < graph->n_nodes; i++) {
+        sched->hv_tensor_backend_ids[sc->ids[graph->n_leafs + i]] = sc->node_backend_ids[i];
+    }
+
+    int i_input = 0;
+    for (int i = 0; i < sched->n_splits; i++) {
+        struct ggml_backend_sched_split * split = &sched->splits[i];
+        split->n_inputs = sc->split_n_inputs[i];
+        for (int j = 0; j < split->n_inputs; j++, i_input++) {
+            struct ggml_tensor * input = ggml_backend_sched_tensor_at(graph, sc->inputs[i_input].pos);
+            split->inputs[j] = input;
+            tensor_copy(input, split->backend_id, 0) = sc->inputs[i_input].copy;
         }
     }
 
-    return buft != NULL && ggml_backend_supports_buft(sched->backends[backend_id], buft);
-}
+    for (const auto & c : sc->src_copies) {
+        graph->nodes[c.node]->src[c.src] = c.copy;
+    }
 
-static void ggml_backend_sched_set_if_supported(ggml_backend_sched_t sched, struct ggml_tensor * node, int cur_backend_id, int * node_backend_id) {
-    if (ggml_backend_supports_op(sched->backends[cur_backend_id], node)) {
-        *node_backend_id = cur_backend_id;
-        SET_CAUSE(node, "2.sup");
+    if (sched->debug) {
+        ggml_backend_sched_print_assignments(sched, graph);
     }
+
+    ggml_backend_sched_build_graph_copy(sched, graph, true);
+
+    sc->valid = true;
+
+    return true;
 }
 
 // assigns backends to ops and splits the graph into subgraphs that can be computed on the same backend
 void ggml_backend_sched_split_graph(ggml_backend_sched_t sched, struct ggml_cgraph * graph) {
+    graph = ggml_backend_sched_tp_expand(sched, graph);
+
+    if (sched->split_cache != NULL && ggml_backend_sched_reuse_splits(sched, graph)) {
+        return;
+    }
+
     // reset splits
     sched->n_splits = 0;
     sched->n_graph_inputs = 0;
@@ -928,6 +2421,18 @@ void ggml_backend_sched_split_graph(ggml_backend_sched_t sched, struct ggml_cgra
         GGML_ABORT("%s: failed to initialize context\n", __func__);
     }
 
+    // the cost model does not move the ops assigned by the user
+    if (sched->cost_enabled) {
+        ggml_backend_sched_cost_model * cm = ggml_backend_sched_get_cost_model(sched);
+        cm->fixed.assign(sched->hash_set.size, 0);
+        for (int i = 0; i < graph->n_nodes; i++) {
+            struct ggml_tensor * node = graph->nodes[i];
+            if (tensor_backend_id(node) != -1) {
+                cm->fixed[hash_id(node)] = 1;
+            }
+        }
+    }
+
     // pass 1: assign backends to ops with pre-allocated inputs
     for (int i = 0; i < graph->n_leafs; i++) {
         struct ggml_tensor * leaf = graph->leafs[i];
@@ -1081,8 +2586,9 @@ void ggml_backend_sched_split_graph(ggml_backend_sched_t sched, struct ggml_cgra
                     }
                 }
             }
-        } else {
+        } else if (ggml_backend_sched_tp_group(sched, node) == -1) {
             // assigned node: upgrade to higher prio backend if possible
+            // the partial products of a split matrix multiplication stay on the backend of their part
             for (int b = 0; b < *node_backend_id; b++) {
                 if (sched->bufts[b] == sched->bufts[*node_backend_id] && ggml_backend_supports_op(sched->backends[b], node)) {
                     bool supported = true;
@@ -1106,6 +2612,11 @@ void ggml_backend_sched_split_graph(ggml_backend_sched_t sched, struct ggml_cgra
         }
     }
 
+    // pass 3b: refine the assignments to lower the estimated time of the graph
+    if (sched->cost_enabled) {
+        ggml_backend_sched_refine_by_cost(sched, graph);
+    }
+
     // pass 4: assign backends to remaining src from dst and view_src
     for (int i = 0; i < graph->n_nodes; i++) {
         struct ggml_tensor * node = graph->nodes[i];
@@ -1139,6 +2650,9 @@ void ggml_backend_sched_split_graph(ggml_backend_sched_t sched, struct ggml_cgra
     }
 
     // pass 5: split graph, find tensors that need to be copied
+    if (sched->split_cache != NULL) {
+        sched->split_cache->src_copies.clear();
+    }
     {
         int i_split = 0;
         struct ggml_backend_sched_split * split = &sched->splits[0];
@@ -1154,6 +2668,7 @@ void ggml_backend_sched_split_graph(ggml_backend_sched_t sched, struct ggml_cgra
         split->i_start = 0;
         split->n_inputs = 0;
         int cur_backend_id = split->backend_id;
+        int cur_tp_group = i < graph->n_nodes ? ggml_backend_sched_tp_group(sched, graph->nodes[i]) : -1;
         for (; i < graph->n_nodes; i++) {
             struct ggml_tensor * node = graph->nodes[i];
 
@@ -1196,6 +2711,15 @@ void ggml_backend_sched_split_graph(ggml_backend_sched_t sched, struct ggml_cgra
                 }
             }
 
+            // each partial product of a split matrix multiplication in its own split, so that they can be computed concurrently
+            const int tp_group = ggml_backend_sched_tp_group(sched, node);
+            if (tp_group != cur_tp_group) {
+                need_new_split = true;
+                cur_tp_group = tp_group;
+            } else if (tp_group != -1 && split->i_start < i) {
+                need_new_split = true;
+            }
+
             if (node_backend_id != cur_backend_id || need_new_split) {
                 split->i_end = i;
                 i_split++;
@@ -1266,6 +2790,9 @@ void ggml_backend_sched_split_graph(ggml_backend_sched_t sched, struct ggml_cgra
                         split->inputs[n_inputs] = src;
                     }
                     node->src[j] = tensor_id_copy(src_id, cur_backend_id, sched->cur_copy);
+                    if (sched->split_cache != NULL) {
+                        sched->split_cache->src_copies.push_back({ i, j, node->src[j] });
+                    }
                 }
             }
         }
@@ -1273,105 +2800,17 @@ void ggml_backend_sched_split_graph(ggml_backend_sched_t sched, struct ggml_cgra
         sched->n_splits = i_split + 1;
     }
 
-    if (sched->debug) {
-        ggml_backend_sched_print_assignments(sched, graph);
-    }
-
-    // swap node_backend_ids and leaf _backend_ids with prevs
-    {
-        int * tmp = sched->node_backend_ids;
-        sched->node_backend_ids = sched->prev_node_backend_ids;
-        sched->prev_node_backend_ids = tmp;
-
-        tmp = sched->leaf_backend_ids;
-        sched->leaf_backend_ids = sched->prev_leaf_backend_ids;
-        sched->prev_leaf_backend_ids = tmp;
-    }
-
-    int graph_size = std::max(graph->n_nodes, graph->n_leafs) + sched->n_splits*GGML_SCHED_MAX_SPLIT_INPUTS*2*sched->n_copies;
-    if (sched->graph.size < graph_size) {
-        sched->graph.size = graph_size;
-        sched->graph.nodes = (ggml_tensor **) realloc(sched->graph.nodes, graph_size * sizeof(struct ggml_tensor *));
-        sched->graph.leafs = (ggml_tensor **) realloc(sched->graph.leafs, graph_size * sizeof(struct ggml_tensor *));
-        GGML_ASSERT(sched->graph.nodes != NULL);
-        GGML_ASSERT(sched->graph.leafs != NULL);
-    }
-    sched->graph.n_nodes = 0;
-    sched->graph.n_leafs = 0;
-
-    struct ggml_cgraph * graph_copy = &sched->graph;
-
-    for (int i = 0; i < sched->n_splits; i++) {
-        struct ggml_backend_sched_split * split = &sched->splits[i];
-        split->graph = ggml_graph_view(graph, split->i_start, split->i_end);
-
-        // Optimize this split of the graph. This needs to happen before we make graph_copy,
-        // so they are in sync.
-        ggml_backend_graph_optimize(sched->backends[split->backend_id], &split->graph);
-
-        // add inputs to the graph copy so that they are allocated by ggml-alloc at the start of the split
-        for (int j = 0; j < split->n_inputs; j++) {
-            assert(graph_copy->size > (graph_copy->n_nodes + 1));
-
-            struct ggml_tensor * input = split->inputs[j];
-            const size_t input_id = hash_id(input);
-            struct ggml_tensor * input_cpy = tensor_id_copy(input_id, split->backend_id, sched->cur_copy);
-
-            // add a dependency to the input source so that it is not freed before the copy is done
-            struct ggml_tensor * input_dep = ggml_view_tensor(sched->ctx, input);
-            input_dep->src[0] = input;
-            sched->node_backend_ids[graph_copy->n_nodes] = sched->hv_tensor_backend_ids[input_id];
-            graph_copy->nodes[graph_copy->n_nodes++] = input_dep;
-
-            // add a dependency to the input copy so that it is allocated at the start of the split
-            sched->node_backend_ids[graph_copy->n_nodes] = split->backend_id;
-            graph_copy->nodes[graph_copy->n_nodes++] = input_cpy;
-        }
+    ggml_backend_sched_tp_parallel_splits(sched, graph);
 
-        for (int j = split->i_start; j < split->i_end; j++) {
-            assert(graph_copy->size > graph_copy->n_nodes);
-            sched->node_backend_ids[graph_copy->n_nodes] = tensor_backend_id(graph->nodes[j]);
-            graph_copy->nodes[graph_copy->n_nodes++] = graph->nodes[j];
-        }
+    if (sched->split_cache != NULL) {
+        ggml_backend_sched_save_splits(sched, graph);
     }
 
-    if (sched->n_copies > 1) {
-        // add input copies as leafs so that they are allocated first
-        for (int i = 0; i < sched->n_graph_inputs; i++) {
-            struct ggml_tensor * input = sched->graph_inputs[i];
-            size_t id = hash_id(input);
-            int backend_id = tensor_backend_id(input);
-            for (int c = 0; c < sched->n_copies; c++) {
-                struct ggml_tensor * input_cpy = tensor_id_copy(id, backend_id, c);
-                sched->leaf_backend_ids[graph_copy->n_leafs] = backend_id;
-                assert(graph_copy->size > graph_copy->n_leafs);
-                graph_copy->leafs[graph_copy->n_leafs++] = input_cpy;
-            }
-        }
-
-        for (int i = 0; i < sched->n_splits; i++) {
-            struct ggml_backend_sched_split * split = &sched->splits[i];
-            int backend_id = split->backend_id;
-            for (int j = 0; j < split->n_inputs; j++) {
-                struct ggml_tensor * input = split->inputs[j];
-                size_t id = hash_id(input);
-                for (int c = 0; c < sched->n_copies; c++) {
-                    struct ggml_tensor * input_cpy = tensor_id_copy(id, backend_id, c);
-                    sched->leaf_backend_ids[graph_copy->n_leafs] = backend_id;
-                    assert(graph_copy->size > graph_copy->n_leafs);
-                    graph_copy->leafs[graph_copy->n_leafs++] = input_cpy;
-                }
-            }
-        }
+    if (sched->debug) {
+        ggml_backend_sched_print_assignments(sched, graph);
     }
 
-    // add leafs from the original graph
-    for (int i = 0; i < graph->n_leafs; i++) {
-        struct ggml_tensor * leaf = graph->leafs[i];
-        sched->leaf_backend_ids[graph_copy->n_leafs] = tensor_backend_id(leaf);
-        assert(graph_copy->size > graph_copy->n_leafs);
-        graph_copy->leafs[graph_copy->n_leafs++] = leaf;
-    }
+    ggml_backend_sched_build_graph_copy(sched, graph, false);
 }
 
 static bool ggml_backend_sched_alloc_splits(ggml_backend_sched_t sched) {
@@ -1421,11 +2860,20 @@ static enum ggml_status ggml_backend_sched_compute_splits(ggml_backend_sched_t s
     std::vector<int32_t> ids;
     std::vector<ggml_bitset_t> used_ids;
 
+    // splits that are computed concurrently once the inputs of all of them are copied
+    int parallel_start = 0;
+    int parallel_end   = 0;
+
     for (int split_id = 0; split_id < sched->n_splits; split_id++) {
         struct ggml_backend_sched_split * split = &splits[split_id];
         int split_backend_id = split->backend_id;
         ggml_backend_t split_backend = sched->backends[split_backend_id];
 
+        if (split->n_parallel > 1 && !sched->callback_eval) {
+            parallel_start = split_id;
+            parallel_end   = split_id + split->n_parallel;
+        }
+
         // copy the input tensors to the split backend
         for (int input_id = 0; input_id < split->n_inputs; input_id++) {
             ggml_backend_t input_backend = ggml_backend_sched_get_tensor_backend(sched, split->inputs[input_id]);
@@ -1549,6 +2997,34 @@ static enum ggml_status ggml_backend_sched_compute_splits(ggml_backend_sched_t s
             }
         }
 
+        if (split_id < parallel_end) {
+            if (split_id + 1 < parallel_end) {
+                continue;
+            }
+
+            ggml_backend_t       backends[GGML_SCHED_MAX_BACKENDS];
+            struct ggml_cgraph * graphs[GGML_SCHED_MAX_BACKENDS];
+            const int n = parallel_end - parallel_start;
+            for (int k = 0; k < n; k++) {
+                backends[k] = sched->backends[splits[parallel_start + k].backend_id];
+                graphs[k]   = &splits[parallel_start + k].graph;
+                ggml_backend_synchronize(backends[k]);
+            }
+
+            enum ggml_status ec = sched->tp->compute(backends, graphs, n);
+            if (ec != GGML_STATUS_SUCCESS) {
+                return ec;
+            }
+
+            for (int k = 0; k < n; k++) {
+                const int backend_id = splits[parallel_start + k].backend_id;
+                if (splits[parallel_start + k].n_inputs > 0 && sched->events[backend_id][sched->cur_copy] != NULL) {
+                    ggml_backend_event_record(sched->events[backend_id][sched->cur_copy], backends[k]);
+                }
+            }
+            continue;
+        }
+
         if (!sched->callback_eval) {
             enum ggml_status ec = ggml_backend_graph_compute_async(split_backend, &split->graph);
             if (ec != GGML_STATUS_SUCCESS) {
@@ -1623,6 +3099,13 @@ ggml_backend_sched_t ggml_backend_sched_new(
     sched->hv_tensor_backend_ids = (int *) malloc(sched->hash_set.size * sizeof(sched->hv_tensor_backend_ids[0]));
     sched->hv_tensor_copies      = (ggml_tensor **) malloc(sched->hash_set.size * sched->n_backends * sched->n_copies * sizeof(struct ggml_tensor *));
 
+    const char * GGML_SCHED_REUSE = getenv("GGML_SCHED_REUSE");
+    if (sched->n_copies == 1 && (GGML_SCHED_REUSE == NULL || atoi(GGML_SCHED_REUSE) != 0)) {
+        sched->split_cache = new ggml_backend_sched_split_cache();
+        sched->split_cache->pos.resize(sched->hash_set.size);
+        sched->split_cache->pos_gen.resize(sched->hash_set.size, 0);
+    }
+
     const size_t ggml_sched_max_splits = graph_size; // at most there is one split for each node in the graph
     const size_t nodes_size = graph_size + ggml_sched_max_splits*GGML_SCHED_MAX_SPLIT_INPUTS*2;
     sched->node_backend_ids = (int *) calloc(nodes_size, sizeof(sched->node_backend_ids[0]));
@@ -1668,6 +3151,9 @@ void ggml_backend_sched_free(ggml_backend_sched_t sched) {
     }
     ggml_gallocr_free(sched->galloc);
     ggml_free(sched->ctx);
+    delete sched->cost_model;
+    delete sched->split_cache;
+    delete sched->tp;
     ggml_hash_set_free(&sched->hash_set);
     free(sched->splits);
     free(sched->hv_tensor_backend_ids);
@@ -1770,6 +3256,234 @@ void ggml_backend_sched_set_eval_callback(ggml_backend_sched_t sched, ggml_backe
     sched->callback_eval_user_data = user_data;
 }
 
+void ggml_backend_sched_set_op_cost(ggml_backend_sched_t sched, ggml_backend_sched_op_cost_t op_cost, void * user_data) {
+    GGML_ASSERT(sched);
+    ggml_backend_sched_cost_model * cm = ggml_backend_sched_get_cost_model(sched);
+    cm->op_cost = op_cost;
+    cm->op_cost_user_data = user_data;
+    ggml_backend_sched_invalidate_splits(sched);
+    if (op_cost != NULL) {
+        sched->cost_enabled = true;
+    }
+}
+
+void ggml_backend_sched_set_copy_cost(ggml_backend_sched_t sched, ggml_backend_t src, ggml_backend_t dst, double latency_us, double bytes_per_us) {
+    GGML_ASSERT(sched);
+    GGML_ASSERT(latency_us >= 0.0 && bytes_per_us > 0.0);
+    const int src_id = ggml_backend_sched_backend_id(sched, src);
+    const int dst_id = ggml_backend_sched_backend_id(sched, dst);
+    GGML_ASSERT(src_id >= 0 && dst_id >= 0);
+
+    ggml_backend_sched_cost_model * cm = ggml_backend_sched_get_cost_model(sched);
+    cm->copy_latency_us[src_id][dst_id]   = latency_us;
+    cm->copy_bytes_per_us[src_id][dst_id] = bytes_per_us;
+    ggml_backend_sched_invalidate_splits(sched);
+}
+
+// average time of an op on zero-initialized copies of its sources, negative on failure
+static double ggml_backend_sched_time_op(ggml_backend_t backend, ggml_backend_buffer_type_t buft, const struct ggml_tensor * op, int n_iter) {
+    struct ggml_init_params params = {
+        /* .mem_size =   */ (GGML_MAX_SRC + 1)*ggml_tensor_overhead() + ggml_graph_overhead_custom(2*(GGML_MAX_SRC + 1), false),
+        /* .mem_buffer = */ NULL,
+        /* .no_alloc =   */ true
+    };
+    struct ggml_context * ctx = ggml_init(params);
+    if (ctx == NULL) {
+        return -1.0;
+    }
+
+    struct ggml_tensor * node = ggml_dup_tensor_layout(ctx, op);
+    node->op = op->op;
+    memcpy(node->op_params, op->op_params, sizeof(op->op_params));
+    for (int j = 0; j < GGML_MAX_SRC; j++) {
+        if (op->src[j] != NULL) {
+            node->src[j] = ggml_dup_tensor_layout(ctx, op->src[j]);
+        }
+    }
+
+    struct ggml_cgraph * graph = ggml_new_graph_custom(ctx, 2*(GGML_MAX_SRC + 1), false);
+    ggml_build_forward_expand(graph, node);
+
+    double us = -1.0;
+    ggml_backend_buffer_t buffer = ggml_backend_alloc_ctx_tensors_from_buft(ctx, buft);
+    if (buffer != NULL) {
+        ggml_backend_buffer_clear(buffer, 0);
+        if (ggml_backend_graph_compute(backend, graph) == GGML_STATUS_SUCCESS) { // warmup
+            const int64_t t_start = ggml_time_us();
+            for (int it = 0; it < n_iter; it++) {
+                ggml_backend_graph_compute(backend, graph);
+            }
+            us = (double) (ggml_time_us() - t_start)/n_iter;
+        }
+        ggml_backend_buffer_free(buffer);
+    }
+
+    ggml_free(ctx);
+
+    return us;
+}
+
+// average time of a copy of size bytes between two buffer types, negative on failure
+static double ggml_backend_sched_time_copy(ggml_backend_buffer_type_t src_buft, ggml_backend_buffer_type_t dst_buft, size_t size, int n_iter) {
+    struct ggml_init_params params = {
+        /* .mem_size =   */ ggml_tensor_overhead(),
+        /* .mem_buffer = */ NULL,
+        /* .no_alloc =   */ true
+    };
+    struct ggml_context * ctx_src = ggml_init(params);
+    struct ggml_context * ctx_dst = ggml_init(params);
+    struct ggml_tensor * src = ggml_new_tensor_1d(ctx_src, GGML_TYPE_I8, size);
+    struct ggml_tensor * dst = ggml_new_tensor_1d(ctx_dst, GGML_TYPE_I8, size);
+
+    double us = -1.0;
+    ggml_backend_buffer_t buf_src = ggml_backend_alloc_ctx_tensors_from_buft(ctx_src, src_buft);
+    ggml_backend_buffer_t buf_dst = ggml_backend_alloc_ctx_tensors_from_buft(ctx_dst, dst_buft);
+    if (buf_src != NULL && buf_dst != NULL) {
+        ggml_backend_buffer_clear(buf_src, 0);
+        ggml_backend_tensor_copy(src, dst); // warmup
+        const int64_t t_start = ggml_time_us();
+        for (int it = 0; it < n_iter; it++) {
+            ggml_backend_tensor_copy(src, dst);
+        }
+        us = (double) (ggml_time_us() - t_start)/n_iter;
+    }
+
+    ggml_backend_buffer_free(buf_src);
+    ggml_backend_buffer_free(buf_dst);
+    ggml_free(ctx_src);
+    ggml_free(ctx_dst);
+
+    return us;
+}
+
+// least squares fit of us = a + b*work, falls back to a cost proportional to the work
+static ggml_backend_sched_op_fit ggml_backend_sched_fit_op(const std::vector<std::pair<double, double>> & samples) {
+    ggml_backend_sched_op_fit fit = { 0.0, 0.0, false };
+    if (samples.empty()) {
+        return fit;
+    }
+
+    double sw = 0.0, st = 0.0, sww = 0.0, swt = 0.0;
+    for (const auto & s : samples) {
+        sw  += s.first;
+        st  += s.second;
+        sww += s.first*s.first;
+        swt += s.first*s.second;
+    }
+    const double n = (double) samples.size();
+    const double den = n*sww - sw*sw;
+
+    if (den > 0.0) {
+        fit.us_work = (n*swt - sw*st)/den;
+        fit.us      = (st - fit.us_work*sw)/n;
+    }
+    if (den <= 0.0 || fit.us_work < 0.0 || fit.us < 0.0) {
+        fit.us      = sw > 0.0 ? 0.0 : st/n;
+        fit.us_work = sw > 0.0 ? st/sw : 0.0;
+    }
+    fit.valid = true;
+
+    return fit;
+}
+
+bool ggml_backend_sched_calibrate(ggml_backend_sched_t sched, struct ggml_cgraph * graph, int n_iter) {
+    GGML_ASSERT(sched);
+    GGML_ASSERT(n_iter > 0);
+
+    ggml_backend_sched_synchronize(sched);
+
+    ggml_backend_sched_cost_model * cm = ggml_backend_sched_get_cost_model(sched);
+    bool ok = true;
+
+    // ops, without the cost of launching a graph measured on an op that does almost nothing
+    for (int b = 0; b < sched->n_backends; b++) {
+        {
+            struct ggml_init_params params = {
+                /* .mem_size =   */ 2*ggml_tensor_overhead(),
+                /* .mem_buffer = */ NULL,
+                /* .no_alloc =   */ true
+            };
+            struct ggml_context * ctx = ggml_init(params);
+            struct ggml_tensor * op = ggml_scale(ctx, ggml_new_tensor_1d(ctx, GGML_TYPE_F32, 1), 1.0f);
+            if (ggml_backend_supports_op(sched->backends[b], op)) {
+                cm->split_us[b] = std::max(0.0, ggml_backend_sched_time_op(sched->backends[b], sched->bufts[b], op, n_iter));
+            }
+            ggml_free(ctx);
+        }
+
+        for (int i = 0; i < graph->n_nodes; i++) {
+            struct ggml_tensor * node = graph->nodes[i];
+            // custom ops are not run on fake data
+            if (ggml_is_view_op(node->op) || node->op == GGML_OP_NONE ||
+                node->op == GGML_OP_CUSTOM || node->op == GGML_OP_MAP_CUSTOM1 ||
+                node->op == GGML_OP_MAP_CUSTOM2 || node->op == GGML_OP_MAP_CUSTOM3) {
+                continue;
+            }
+            std::string key = ggml_backend_sched_op_key(node);
+            if (cm->op_us[b].count(key) > 0 || !ggml_backend_supports_op(sched->backends[b], node)) {
+                continue;
+            }
+            double us = ggml_backend_sched_time_op(sched->backends[b], sched->bufts[b], node, n_iter);
+            if (us < 0.0) {
+                GGML_LOG_WARN("%s: failed to run %s (%s) on %s\n", __func__, ggml_op_desc(node), node->name, ggml_backend_name(sched->backends[b]));
+                ok = false;
+                continue;
+            }
+            us = std::max(0.0, us - cm->split_us[b]);
+            cm->op_us[b].emplace(std::move(key), us);
+            cm->op_samples[b][node->op].emplace_back(ggml_backend_sched_op_work(node), us);
+        }
+        for (int op = 0; op < GGML_OP_COUNT; op++) {
+            cm->op_fit[b][op] = ggml_backend_sched_fit_op(cm->op_samples[b][op]);
+        }
+    }
+
+    // copies between the backends that cannot use the buffers of each other
+    const size_t size_small = 4096;
+    const size_t size_large = GGML_SCHED_CALIBRATE_COPY_SIZE;
+    for (int a = 0; a < sched->n_backends; a++) {
+        for (int b = 0; b < sched->n_backends; b++) {
+            if (a == b || ggml_backend_supports_buft(sched->backends[b], sched->bufts[a])) {
+                continue;
+            }
+            const double us_small = ggml_backend_sched_time_copy(sched->bufts[a], sched->bufts[b], size_small, n_iter);
+            const double us_large = ggml_backend_sched_time_copy(sched->bufts[a], sched->bufts[b], size_large, n_iter);
+            if (us_small < 0.0 || us_large < 0.0) {
+                GGML_LOG_WARN("%s: failed to copy from %s to %s\n", __func__, ggml_backend_name(sched->backends[a]), ggml_backend_name(sched->backends[b]));
+                ok = false;
+                continue;
+            }
+            cm->copy_latency_us[a][b]   = us_small;
+            cm->copy_bytes_per_us[a][b] = us_large > us_small ? (double) (size_large - size_small)/(us_large - us_small) : (double) size_large/std::max(us_large, 1e-3);
+            if (sched->debug) {
+                GGML_LOG_DEBUG("%s: copy %s -> %s: %.1f us + %.1f MB/s\n", __func__, ggml_backend_name(sched->backends[a]), ggml_backend_name(sched->backends[b]),
+                    cm->copy_latency_us[a][b], cm->copy_bytes_per_us[a][b]);
+            }
+        }
+    }
+
+    sched->cost_enabled = true;
+    ggml_backend_sched_invalidate_splits(sched);
+
+    return ok;
+}
+
+void ggml_backend_sched_set_cost_model(ggml_backend_sched_t sched, bool enable) {
+    GGML_ASSERT(sched);
+    if (enable) {
+        ggml_backend_sched_get_cost_model(sched);
+    }
+    sched->cost_enabled = enable;
+}
+
+double ggml_backend_sched_get_estimated_time(ggml_backend_sched_t sched) {
+    GGML_ASSERT(sched);
+    if (!sched->cost_enabled || sched->cost_model == NULL) {
+        return -1.0;
+    }
+    return sched->cost_model->est_us;
+}
+
 int ggml_backend_sched_get_n_splits(ggml_backend_sched_t sched) {
     GGML_ASSERT(sched);
     return sched->n_splits;
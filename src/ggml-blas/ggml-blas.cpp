@@ -2,10 +2,17 @@
 #include "ggml-blas.h"
 #include "ggml-backend-impl.h"
 
-#include <future>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <cstring>
 
+#ifdef GGML_USE_OPENMP
+#   include <omp.h>
+#endif
+
 #if defined(GGML_BLAS_USE_ACCELERATE)
 #   include <Accelerate/Accelerate.h>
 #elif defined(GGML_BLAS_USE_MKL)
@@ -18,15 +25,146 @@
 #   include <cblas.h>
 #endif
 
+#ifndef GGML_USE_OPENMP
+// worker threads kept alive between the graph computations
+// the calling thread also takes part in the work, as thread 0
+class ggml_blas_thread_pool {
+public:
+    ~ggml_blas_thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        cv_start.notify_all();
+        for (auto & worker : workers) {
+            worker.join();
+        }
+    }
+
+    // run fn(ith, n_threads) for ith in [0, n_threads)
+    void run(int n_threads, const std::function<void(int, int)> & fn) {
+        if (n_threads <= 1) {
+            fn(0, 1);
+            return;
+        }
+
+        while ((int) workers.size() < n_threads - 1) {
+            const int ith = (int) workers.size() + 1;
+            std::lock_guard<std::mutex> lock(mutex);
+            workers.emplace_back([this, ith, gen = generation]() { worker(ith, gen); });
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job       = &fn;
+            n_active  = n_threads;
+            n_pending = n_threads - 1;
+            generation++;
+        }
+        cv_start.notify_all();
+
+        fn(0, n_threads);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        cv_done.wait(lock, [this] { return n_pending == 0; });
+        job = nullptr;
+    }
+
+private:
+    void worker(int ith, uint64_t gen) {
+        for (;;) {
+            const std::function<void(int, int)> * fn;
+            int n_threads;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv_start.wait(lock, [this, gen] { return stop || generation != gen; });
+                if (stop) {
+                    return;
+                }
+                gen = generation;
+                if (ith >= n_active) {
+                    continue;
+                }
+                fn        = job;
+                n_threads = n_active;
+            }
+
+            (*fn)(ith, n_threads);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--n_pending == 0) {
+                    cv_done.notify_one();
+                }
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+
+    std::mutex              mutex;
+    std::condition_variable cv_start;
+    std::condition_variable cv_done;
+
+    const std::function<void(int, int)> * job = nullptr;
+    uint64_t generation = 0;
+    int      n_active   = 0;
+    int      n_pending  = 0;
+    bool     stop       = false;
+};
+#endif
+
 struct ggml_backend_blas_context {
     int n_threads = GGML_DEFAULT_N_THREADS;
     std::unique_ptr<char[]> work_data;
     size_t work_size = 0;
 #ifndef GGML_USE_OPENMP
-    std::vector<std::future<void>> tasks;
+    ggml_blas_thread_pool pool;
 #endif
 };
 
+// BLAS_F32 buffer type: in addition to the original data, weights that are not F32 keep a copy converted to F32
+// the copy is made when the data is set, so that the conversion is not repeated for every matrix multiplication
+
+// the converted copy is stored after the original data
+static float * ggml_backend_blas_weight_f32(const struct ggml_tensor * tensor) {
+    return (float *) ((char *) tensor->data + GGML_PAD(ggml_nbytes(tensor), 64));
+}
+
+static bool ggml_backend_blas_weight_needs_f32(const struct ggml_tensor * tensor) {
+    return tensor->view_src == NULL &&
+           tensor->type != GGML_TYPE_F32 &&
+           ggml_get_type_traits(tensor->type)->to_float != NULL &&
+           ggml_is_contiguous(tensor) &&
+           ggml_n_dims(tensor) >= 2;
+}
+
+// convert the rows of the tensor overlapping the bytes [offset, offset + size)
+static void ggml_backend_blas_weight_convert(const struct ggml_tensor * tensor, size_t offset, size_t size) {
+    const ggml_to_float_t to_float = ggml_get_type_traits(tensor->type)->to_float;
+
+    const int64_t ne00 = tensor->ne[0];
+    const size_t  nb01 = tensor->nb[1];
+
+    const int64_t ir0 = offset/nb01;
+    const int64_t ir1 = std::min<int64_t>((offset + size + nb01 - 1)/nb01, ggml_nrows(tensor));
+
+    float * dst = ggml_backend_blas_weight_f32(tensor);
+    for (int64_t ir = ir0; ir < ir1; ir++) {
+        to_float((const char *) tensor->data + ir*nb01, dst + ir*ne00, ne00);
+    }
+}
+
+static bool ggml_backend_buft_is_blas(ggml_backend_buffer_type_t buft);
+
+// returns the converted copy of src0 if there is one
+static const float * ggml_backend_blas_get_weight_f32(const struct ggml_tensor * src0) {
+    if (src0->buffer == NULL || !ggml_backend_buft_is_blas(src0->buffer->buft) || src0->extra == NULL) {
+        return NULL;
+    }
+    return (const float *) src0->extra;
+}
+
 static void ggml_backend_blas_mul_mat(ggml_backend_blas_context * ctx, struct ggml_tensor * dst) {
     const struct ggml_tensor * src0 = dst->src[0];
     const struct ggml_tensor * src1 = dst->src[1];
@@ -54,65 +192,53 @@ static void ggml_backend_blas_mul_mat(ggml_backend_blas_context * ctx, struct gg
     const int64_t r2 = ne12/ne02;
     const int64_t r3 = ne13/ne03;
 
-    const int64_t ne_plane      = ne01*ne00;
-    const size_t  desired_wsize = type == GGML_TYPE_F32 ? 0 : ne03*ne02*ne_plane*sizeof(float);
+    const int64_t ne_plane = ne01*ne00;
 
-    if (ctx->work_size < desired_wsize) {
-        ctx->work_data.reset(new char[desired_wsize]);
-        ctx->work_size = desired_wsize;
-    }
-    void * wdata = ctx->work_data.get();
+    // weights from a BLAS_F32 buffer have already been converted
+    const float * wdata = ggml_backend_blas_get_weight_f32(src0);
 
     // convert src0 to float
-    if (type != GGML_TYPE_F32) {
+    if (type != GGML_TYPE_F32 && wdata == NULL) {
+        const size_t desired_wsize = ne03*ne02*ne_plane*sizeof(float);
+        if (ctx->work_size < desired_wsize) {
+            ctx->work_data.reset(new char[desired_wsize]);
+            ctx->work_size = desired_wsize;
+        }
+        float * const wplane = (float *) ctx->work_data.get();
+
         const auto * type_traits = ggml_get_type_traits(type);
         ggml_to_float_t const to_float = type_traits->to_float;
 
-        for (int64_t i03 = 0; i03 < ne03; i03++) {
-            for (int64_t i02 = 0; i02 < ne02; i02++) {
-                const void  *       x      = (char *)  src0->data + i02*nb02          + i03*nb03;
-                      float * const wplane = (float *) wdata      + i02*ne_plane      + i03*ne02*ne_plane;
+        // the rows of all the planes are distributed over the threads
+        const int64_t nr = ne01*ne02*ne03;
 
-                const int min_cols_per_thread = 4096;
-                const int min_rows_per_thread = std::max((int)(min_cols_per_thread/ne00), 1);
-                const int n_threads = std::max(std::min(ctx->n_threads, (int)(ne01/min_rows_per_thread)), 1);
+        const int min_cols_per_thread = 4096;
+        const int min_rows_per_thread = std::max((int)(min_cols_per_thread/ne00), 1);
+        const int n_threads = std::max(std::min<int64_t>(ctx->n_threads, nr/min_rows_per_thread), (int64_t) 1);
 
-#ifdef GGML_USE_OPENMP
-                #pragma omp parallel for num_threads(n_threads)
-                for (int64_t i01 = 0; i01 < ne01; i01++) {
-                    to_float((const char *) x + i01*nb01, wplane + i01*ne00, ne00);
-                }
-#else
-                for (int i = 1; i < n_threads; i++) {
-                    const int64_t start =       i*ne01/n_threads;
-                    const int64_t end   = (i + 1)*ne01/n_threads;
-                    if (start < end) {
-                        ctx->tasks.push_back(std::async(std::launch::async, [=]() {
-                            for (int64_t i01 = start; i01 < end; i01++) {
-                                to_float((const char *) x + i01*nb01, wplane + i01*ne00, ne00);
-                            }
-                        }));
-                    }
-                }
-                {
-                    // reuse the current thread for the first task
-                    const int64_t start = 0;
-                    const int64_t end   = ne01/n_threads;
-                    for (int64_t i01 = start; i01 < end; i01++) {
-                        to_float((const char *) x + i01*nb01, wplane + i01*ne00, ne00);
-                    }
-                }
-#endif
+        auto convert = [&](int ith, int nth) {
+            const int64_t ir0 =  ith     *nr/nth;
+            const int64_t ir1 = (ith + 1)*nr/nth;
+
+            for (int64_t ir = ir0; ir < ir1; ir++) {
+                const int64_t i03 = ir/(ne02*ne01);
+                const int64_t i02 = (ir - i03*ne02*ne01)/ne01;
+                const int64_t i01 = ir - i03*ne02*ne01 - i02*ne01;
+
+                to_float((const char *) src0->data + i01*nb01 + i02*nb02 + i03*nb03, wplane + ir*ne00, ne00);
             }
-        }
+        };
 
-#ifndef GGML_USE_OPENMP
-        // wait for all tasks to finish
-        for (auto & task : ctx->tasks) {
-            task.get();
+#ifdef GGML_USE_OPENMP
+        #pragma omp parallel num_threads(n_threads)
+        {
+            convert(omp_get_thread_num(), omp_get_num_threads());
         }
-        ctx->tasks.clear();
+#else
+        ctx->pool.run(n_threads, convert);
 #endif
+
+        wdata = wplane;
     }
 
 #if defined(OPENBLAS_VERSION)
@@ -136,8 +262,8 @@ static void ggml_backend_blas_mul_mat(ggml_backend_blas_context * ctx, struct gg
             const float * y = (float *) ((char *) src1->data + i12*nb12 + i13*nb13);
                   float * d = (float *) ((char *)  dst->data + i12*nb2  + i13*nb3);
 
-            if (type != GGML_TYPE_F32) {
-                x = (float *) wdata + i02*ne_plane + i03*ne02*ne_plane;
+            if (wdata != NULL) {
+                x = wdata + i02*ne_plane + i03*ne02*ne_plane;
             }
 
             cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans,
@@ -312,6 +438,92 @@ void ggml_backend_blas_set_n_threads(ggml_backend_t backend_blas, int n_threads)
     ctx->n_threads = n_threads;
 }
 
+// BLAS_F32 buffer type
+
+static enum ggml_status ggml_backend_blas_buffer_init_tensor(ggml_backend_buffer_t buffer, struct ggml_tensor * tensor) {
+    if (ggml_backend_blas_weight_needs_f32(tensor)) {
+        tensor->extra = ggml_backend_blas_weight_f32(tensor);
+    }
+
+    GGML_UNUSED(buffer);
+    return GGML_STATUS_SUCCESS;
+}
+
+static void ggml_backend_blas_buffer_memset_tensor(ggml_backend_buffer_t buffer, struct ggml_tensor * tensor, uint8_t value, size_t offset, size_t size) {
+    memset((char *) tensor->data + offset, value, size);
+    if (tensor->extra != NULL) {
+        ggml_backend_blas_weight_convert(tensor, offset, size);
+    }
+
+    GGML_UNUSED(buffer);
+}
+
+static void ggml_backend_blas_buffer_set_tensor(ggml_backend_buffer_t buffer, struct ggml_tensor * tensor, const void * data, size_t offset, size_t size) {
+    memcpy((char *) tensor->data + offset, data, size);
+    if (tensor->extra != NULL) {
+        ggml_backend_blas_weight_convert(tensor, offset, size);
+    }
+
+    GGML_UNUSED(buffer);
+}
+
+static const char * ggml_backend_blas_buffer_type_get_name(ggml_backend_buffer_type_t buft) {
+    return "BLAS_F32";
+
+    GGML_UNUSED(buft);
+}
+
+static ggml_backend_buffer_t ggml_backend_blas_buffer_type_alloc_buffer(ggml_backend_buffer_type_t buft, size_t size) {
+    ggml_backend_buffer_t buffer = ggml_backend_buft_alloc_buffer(ggml_backend_cpu_buffer_type(), size);
+
+    if (buffer == nullptr) {
+        return nullptr;
+    }
+
+    buffer->buft                = buft;
+    buffer->iface.init_tensor   = ggml_backend_blas_buffer_init_tensor;
+    buffer->iface.memset_tensor = ggml_backend_blas_buffer_memset_tensor;
+    buffer->iface.set_tensor    = ggml_backend_blas_buffer_set_tensor;
+    buffer->iface.cpy_tensor    = nullptr;
+    return buffer;
+}
+
+static size_t ggml_backend_blas_buffer_type_get_alignment(ggml_backend_buffer_type_t buft) {
+    return ggml_backend_buft_get_alignment(ggml_backend_cpu_buffer_type());
+
+    GGML_UNUSED(buft);
+}
+
+static size_t ggml_backend_blas_buffer_type_get_alloc_size(ggml_backend_buffer_type_t buft, const struct ggml_tensor * tensor) {
+    if (ggml_backend_blas_weight_needs_f32(tensor)) {
+        return GGML_PAD(ggml_nbytes(tensor), 64) + ggml_nelements(tensor)*sizeof(float);
+    }
+    return ggml_nbytes(tensor);
+
+    GGML_UNUSED(buft);
+}
+
+ggml_backend_buffer_type_t ggml_backend_blas_buffer_type(void) {
+    static struct ggml_backend_buffer_type ggml_backend_blas_buffer_type = {
+        /* .iface    = */ {
+                           /* .get_name         = */ ggml_backend_blas_buffer_type_get_name,
+                           /* .alloc_buffer     = */ ggml_backend_blas_buffer_type_alloc_buffer,
+                           /* .get_alignment    = */ ggml_backend_blas_buffer_type_get_alignment,
+                           /* .get_max_size     = */ nullptr,  // defaults to SIZE_MAX
+                           /* .get_alloc_size   = */ ggml_backend_blas_buffer_type_get_alloc_size,
+                           /* .is_host          = */ nullptr,  // the data has to be set with ggml_backend_tensor_set to update the F32 copy
+                           },
+        /* .device  = */ ggml_backend_reg_dev_get(ggml_backend_blas_reg(), 0),
+        /* .context = */ nullptr,
+    };
+
+    return &ggml_backend_blas_buffer_type;
+}
+
+static bool ggml_backend_buft_is_blas(ggml_backend_buffer_type_t buft) {
+    return buft->iface.get_name == ggml_backend_blas_buffer_type_get_name;
+}
+
 // device interface
 
 static const char * ggml_backend_blas_device_get_name(ggml_backend_dev_t dev) {
@@ -411,10 +623,14 @@ static bool ggml_backend_blas_device_supports_op(ggml_backend_dev_t dev, const s
             // TODO: find the optimal value
             const int64_t min_batch = 32;
 
+            // the CPU backend cannot read the weights of a BLAS_F32 buffer, so they are used for every batch size
+            // instead of being copied to the CPU backend for the small batches
+            const bool weights_blas = src0->buffer != NULL && ggml_backend_buft_is_blas(src0->buffer->buft);
+
             return ggml_is_contiguous(src0) &&
                    ggml_is_contiguous(src1) &&
                    src1->type == GGML_TYPE_F32 &&
-                   (ne0 >= min_batch && ne1 >= min_batch && ne10 >= min_batch) &&
+                   (weights_blas || (ne0 >= min_batch && ne1 >= min_batch && ne10 >= min_batch)) &&
                    (src0->type == GGML_TYPE_F32 || ggml_get_type_traits(src0->type)->to_float != NULL);
         }
 
@@ -436,7 +652,7 @@ static bool ggml_backend_blas_device_supports_op(ggml_backend_dev_t dev, const s
 }
 
 static bool ggml_backend_blas_device_supports_buft(ggml_backend_dev_t dev, ggml_backend_buffer_type_t buft) {
-    return ggml_backend_buft_is_host(buft);
+    return ggml_backend_buft_is_host(buft) || ggml_backend_buft_is_blas(buft);
 
     GGML_UNUSED(dev);
 }
@@ -488,10 +704,21 @@ static ggml_backend_dev_t ggml_backend_blas_reg_get_device(ggml_backend_reg_t re
     GGML_UNUSED(index);
 }
 
+static ggml_backend_buffer_type_t * ggml_backend_blas_device_get_extra_buffers_type(ggml_backend_dev_t device) {
+    static ggml_backend_buffer_type_t extra_bufts[] = { ggml_backend_blas_buffer_type(), nullptr };
+    return extra_bufts;
+
+    GGML_UNUSED(device);
+}
+
 static void * ggml_backend_blas_get_proc_address(ggml_backend_reg_t reg, const char * name) {
     if (std::strcmp(name, "ggml_backend_set_n_threads") == 0) {
         return (void *)ggml_backend_blas_set_n_threads;
     }
+    if (std::strcmp(name, "ggml_backend_dev_get_extra_bufts") == 0) {
+        ggml_backend_dev_get_extra_bufts_t fct = ggml_backend_blas_device_get_extra_buffers_type;
+        return (void *)fct;
+    }
     return NULL;
 
     GGML_UNUSED(reg);
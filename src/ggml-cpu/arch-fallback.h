@@ -5,6 +5,9 @@
 
 #if defined(GGML_CPU_GENERIC)
 // quants.c
+#define quantize_row_q4_K_generic quantize_row_q4_K
+#define quantize_row_q5_K_generic quantize_row_q5_K
+#define quantize_row_q6_K_generic quantize_row_q6_K
 #define quantize_row_q8_0_generic quantize_row_q8_0
 #define quantize_row_q8_1_generic quantize_row_q8_1
 #define quantize_row_q8_K_generic quantize_row_q8_K
@@ -14,6 +17,8 @@
 #define ggml_vec_dot_q5_1_q8_1_generic ggml_vec_dot_q5_1_q8_1
 #define ggml_vec_dot_q8_0_q8_0_generic ggml_vec_dot_q8_0_q8_0
 #define ggml_vec_dot_mxfp4_q8_0_generic ggml_vec_dot_mxfp4_q8_0
+#define ggml_vec_dot_f8_e4m3_f32_generic ggml_vec_dot_f8_e4m3_f32
+#define ggml_vec_dot_f8_e5m2_f32_generic ggml_vec_dot_f8_e5m2_f32
 #define ggml_vec_dot_tq1_0_q8_K_generic ggml_vec_dot_tq1_0_q8_K
 #define ggml_vec_dot_tq2_0_q8_K_generic ggml_vec_dot_tq2_0_q8_K
 #define ggml_vec_dot_q2_K_q8_K_generic ggml_vec_dot_q2_K_q8_K
@@ -30,6 +35,9 @@
 #define ggml_vec_dot_iq1_m_q8_K_generic ggml_vec_dot_iq1_m_q8_K
 #define ggml_vec_dot_iq4_nl_q8_0_generic ggml_vec_dot_iq4_nl_q8_0
 #define ggml_vec_dot_iq4_xs_q8_K_generic ggml_vec_dot_iq4_xs_q8_K
+#define ggml_vec_mad_q4_0_generic ggml_vec_mad_q4_0
+#define ggml_vec_mad_q8_0_generic ggml_vec_mad_q8_0
+#define ggml_vec_mad_q5_K_generic ggml_vec_mad_q5_K
 // repack.cpp
 #define ggml_quantize_mat_q8_0_4x4_generic ggml_quantize_mat_q8_0_4x4
 #define ggml_quantize_mat_q8_0_4x8_generic ggml_quantize_mat_q8_0_4x8
@@ -49,6 +57,13 @@
 #define ggml_gemm_iq4_nl_4x4_q8_0_generic ggml_gemm_iq4_nl_4x4_q8_0
 #define ggml_gemm_iq4_nl_8x8_q8_0_generic ggml_gemm_iq4_nl_8x8_q8_0
 #elif defined(__aarch64__) || defined(__arm__) || defined(_M_ARM) || defined(_M_ARM64)
+// quants.c
+#define quantize_row_q4_K_generic quantize_row_q4_K
+#define quantize_row_q5_K_generic quantize_row_q5_K
+#define quantize_row_q6_K_generic quantize_row_q6_K
+#define ggml_vec_mad_q4_0_generic ggml_vec_mad_q4_0
+#define ggml_vec_mad_q8_0_generic ggml_vec_mad_q8_0
+#define ggml_vec_mad_q5_K_generic ggml_vec_mad_q5_K
 // repack.cpp
 #define ggml_quantize_mat_q8_K_4x8_generic ggml_quantize_mat_q8_K_4x8
 #define ggml_gemv_q4_K_8x8_q8_K_generic ggml_gemv_q4_K_8x8_q8_K
@@ -69,10 +84,18 @@
 #elif defined(__POWERPC__) || defined(__powerpc__)
 // ref: https://github.com/ggml-org/llama.cpp/pull/14146#issuecomment-2972561679
 // quants.c
+#define quantize_row_q4_K_generic quantize_row_q4_K
+#define quantize_row_q5_K_generic quantize_row_q5_K
+#define quantize_row_q6_K_generic quantize_row_q6_K
 #define quantize_row_q8_K_generic quantize_row_q8_K
 #define ggml_vec_dot_tq1_0_q8_K_generic ggml_vec_dot_tq1_0_q8_K
 #define ggml_vec_dot_tq2_0_q8_K_generic ggml_vec_dot_tq2_0_q8_K
 #define ggml_vec_dot_iq1_m_q8_K_generic ggml_vec_dot_iq1_m_q8_K
+#define ggml_vec_dot_f8_e4m3_f32_generic ggml_vec_dot_f8_e4m3_f32
+#define ggml_vec_dot_f8_e5m2_f32_generic ggml_vec_dot_f8_e5m2_f32
+#define ggml_vec_mad_q4_0_generic ggml_vec_mad_q4_0
+#define ggml_vec_mad_q8_0_generic ggml_vec_mad_q8_0
+#define ggml_vec_mad_q5_K_generic ggml_vec_mad_q5_K
 // repack.cpp
 #define ggml_quantize_mat_q8_0_4x4_generic ggml_quantize_mat_q8_0_4x4
 #define ggml_quantize_mat_q8_0_4x8_generic ggml_quantize_mat_q8_0_4x8
@@ -93,11 +116,19 @@
 #define ggml_gemm_iq4_nl_8x8_q8_0_generic ggml_gemm_iq4_nl_8x8_q8_0
 #elif defined(__loongarch64)
 // quants.c
+#define quantize_row_q4_K_generic quantize_row_q4_K
+#define quantize_row_q5_K_generic quantize_row_q5_K
+#define quantize_row_q6_K_generic quantize_row_q6_K
 #define quantize_row_q8_K_generic quantize_row_q8_K
 #define ggml_vec_dot_tq1_0_q8_K_generic ggml_vec_dot_tq1_0_q8_K
 #define ggml_vec_dot_tq2_0_q8_K_generic ggml_vec_dot_tq2_0_q8_K
 #define ggml_vec_dot_iq1_m_q8_K_generic ggml_vec_dot_iq1_m_q8_K
 #define ggml_vec_dot_mxfp4_q8_0_generic ggml_vec_dot_mxfp4_q8_0
+#define ggml_vec_dot_f8_e4m3_f32_generic ggml_vec_dot_f8_e4m3_f32
+#define ggml_vec_dot_f8_e5m2_f32_generic ggml_vec_dot_f8_e5m2_f32
+#define ggml_vec_mad_q4_0_generic ggml_vec_mad_q4_0
+#define ggml_vec_mad_q8_0_generic ggml_vec_mad_q8_0
+#define ggml_vec_mad_q5_K_generic ggml_vec_mad_q5_K
 // repack.cpp
 #define ggml_quantize_mat_q8_0_4x4_generic ggml_quantize_mat_q8_0_4x4
 #define ggml_quantize_mat_q8_0_4x8_generic ggml_quantize_mat_q8_0_4x8
@@ -118,6 +149,9 @@
 #define ggml_gemm_iq4_nl_8x8_q8_0_generic ggml_gemm_iq4_nl_8x8_q8_0
 #elif defined(__riscv)
 // quants.c
+#define quantize_row_q4_K_generic quantize_row_q4_K
+#define quantize_row_q5_K_generic quantize_row_q5_K
+#define quantize_row_q6_K_generic quantize_row_q6_K
 #define quantize_row_q8_K_generic quantize_row_q8_K
 #define ggml_vec_dot_tq1_0_q8_K_generic ggml_vec_dot_tq1_0_q8_K
 #define ggml_vec_dot_tq2_0_q8_K_generic ggml_vec_dot_tq2_0_q8_K
@@ -131,6 +165,11 @@
 #define ggml_vec_dot_iq4_nl_q8_0_generic ggml_vec_dot_iq4_nl_q8_0
 #define ggml_vec_dot_iq4_xs_q8_K_generic ggml_vec_dot_iq4_xs_q8_K
 #define ggml_vec_dot_mxfp4_q8_0_generic ggml_vec_dot_mxfp4_q8_0
+#define ggml_vec_dot_f8_e4m3_f32_generic ggml_vec_dot_f8_e4m3_f32
+#define ggml_vec_dot_f8_e5m2_f32_generic ggml_vec_dot_f8_e5m2_f32
+#define ggml_vec_mad_q4_0_generic ggml_vec_mad_q4_0
+#define ggml_vec_mad_q8_0_generic ggml_vec_mad_q8_0
+#define ggml_vec_mad_q5_K_generic ggml_vec_mad_q5_K
 // repack.cpp
 #define ggml_quantize_mat_q8_0_4x4_generic ggml_quantize_mat_q8_0_4x4
 #define ggml_quantize_mat_q8_0_4x8_generic ggml_quantize_mat_q8_0_4x8
@@ -149,6 +188,9 @@
 #define ggml_gemm_iq4_nl_8x8_q8_0_generic ggml_gemm_iq4_nl_8x8_q8_0
 #elif defined(__s390x__)
 // quants.c
+#define quantize_row_q4_K_generic quantize_row_q4_K
+#define quantize_row_q5_K_generic quantize_row_q5_K
+#define quantize_row_q6_K_generic quantize_row_q6_K
 #define quantize_row_q8_K_generic quantize_row_q8_K
 #define ggml_vec_dot_tq1_0_q8_K_generic ggml_vec_dot_tq1_0_q8_K
 #define ggml_vec_dot_tq2_0_q8_K_generic ggml_vec_dot_tq2_0_q8_K
@@ -160,6 +202,11 @@
 #define ggml_vec_dot_iq3_s_q8_K_generic ggml_vec_dot_iq3_s_q8_K
 #define ggml_vec_dot_iq1_s_q8_K_generic ggml_vec_dot_iq1_s_q8_K
 #define ggml_vec_dot_iq1_m_q8_K_generic ggml_vec_dot_iq1_m_q8_K
+#define ggml_vec_dot_f8_e4m3_f32_generic ggml_vec_dot_f8_e4m3_f32
+#define ggml_vec_dot_f8_e5m2_f32_generic ggml_vec_dot_f8_e5m2_f32
+#define ggml_vec_mad_q4_0_generic ggml_vec_mad_q4_0
+#define ggml_vec_mad_q8_0_generic ggml_vec_mad_q8_0
+#define ggml_vec_mad_q5_K_generic ggml_vec_mad_q5_K
 // repack.cpp
 #define ggml_quantize_mat_q8_0_4x4_generic ggml_quantize_mat_q8_0_4x4
 #define ggml_quantize_mat_q8_0_4x8_generic ggml_quantize_mat_q8_0_4x8
@@ -180,6 +227,9 @@
 #define ggml_gemm_iq4_nl_8x8_q8_0_generic ggml_gemm_iq4_nl_8x8_q8_0
 #elif defined(__wasm__)
 // quants.c
+#define quantize_row_q4_K_generic quantize_row_q4_K
+#define quantize_row_q5_K_generic quantize_row_q5_K
+#define quantize_row_q6_K_generic quantize_row_q6_K
 #define ggml_vec_dot_q4_1_q8_1_generic ggml_vec_dot_q4_1_q8_1
 #define ggml_vec_dot_tq1_0_q8_K_generic ggml_vec_dot_tq1_0_q8_K
 #define ggml_vec_dot_tq2_0_q8_K_generic ggml_vec_dot_tq2_0_q8_K
@@ -193,6 +243,11 @@
 #define ggml_vec_dot_iq4_nl_q8_0_generic ggml_vec_dot_iq4_nl_q8_0
 #define ggml_vec_dot_iq4_xs_q8_K_generic ggml_vec_dot_iq4_xs_q8_K
 #define ggml_vec_dot_mxfp4_q8_0_generic ggml_vec_dot_mxfp4_q8_0
+#define ggml_vec_dot_f8_e4m3_f32_generic ggml_vec_dot_f8_e4m3_f32
+#define ggml_vec_dot_f8_e5m2_f32_generic ggml_vec_dot_f8_e5m2_f32
+#define ggml_vec_mad_q4_0_generic ggml_vec_mad_q4_0
+#define ggml_vec_mad_q8_0_generic ggml_vec_mad_q8_0
+#define ggml_vec_mad_q5_K_generic ggml_vec_mad_q5_K
 // repack.cpp
 #define ggml_quantize_mat_q8_0_4x4_generic ggml_quantize_mat_q8_0_4x4
 #define ggml_quantize_mat_q8_0_4x8_generic ggml_quantize_mat_q8_0_4x8
@@ -650,6 +650,74 @@ void ggml_vec_dot_mxfp4_q8_0(int n, float * GGML_RESTRICT s, size_t bs, const vo
     *s = sumf;
 }
 
+// FP8 weights are widened to FP16 bit patterns and converted with vcvt:
+//  E5M2 shares the FP16 exponent bias, so the byte is just the high half
+//  E4M3 lands in the FP16 exponent with a bias that is off by 8, compensated by a final * 256
+// the E4M3 NaN code 0x7f is not special-cased in the SIMD loop
+
+void ggml_vec_dot_f8_e4m3_f32(int n, float * GGML_RESTRICT s, size_t bs, const void * GGML_RESTRICT vx, size_t bx, const void * GGML_RESTRICT vy, size_t by, int nrc) {
+    assert(nrc == 1);
+    UNUSED(nrc);
+    UNUSED(bx);
+    UNUSED(by);
+    UNUSED(bs);
+
+    const uint8_t * GGML_RESTRICT x = vx;
+    const float   * GGML_RESTRICT y = vy;
+
+    int i = 0;
+    float sumf = 0;
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    const uint16x8_t m_sign = vdupq_n_u16(0x80);
+    const uint16x8_t m_bits = vdupq_n_u16(0x7f);
+
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    for (; i + 7 < n; i += 8) {
+        const uint16x8_t q = vmovl_u8(vld1_u8(x + i));
+        const float16x8_t h = vreinterpretq_f16_u16(vorrq_u16(vshlq_n_u16(vandq_u16(q, m_sign), 8),
+                                                              vshlq_n_u16(vandq_u16(q, m_bits), 7)));
+        acc0 = vfmaq_f32(acc0, vcvt_f32_f16(vget_low_f16(h)), vld1q_f32(y + i + 0));
+        acc1 = vfmaq_f32(acc1, vcvt_high_f32_f16(h),          vld1q_f32(y + i + 4));
+    }
+    sumf = 256.0f * vaddvq_f32(vaddq_f32(acc0, acc1));
+#endif
+    for (; i < n; ++i) {
+        sumf += GGML_FP8_E4M3_TO_FP32(x[i]) * y[i];
+    }
+    *s = sumf;
+}
+
+void ggml_vec_dot_f8_e5m2_f32(int n, float * GGML_RESTRICT s, size_t bs, const void * GGML_RESTRICT vx, size_t bx, const void * GGML_RESTRICT vy, size_t by, int nrc) {
+    assert(nrc == 1);
+    UNUSED(nrc);
+    UNUSED(bx);
+    UNUSED(by);
+    UNUSED(bs);
+
+    const uint8_t * GGML_RESTRICT x = vx;
+    const float   * GGML_RESTRICT y = vy;
+
+    int i = 0;
+    float sumf = 0;
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    for (; i + 7 < n; i += 8) {
+        const float16x8_t h = vreinterpretq_f16_u16(vshlq_n_u16(vmovl_u8(vld1_u8(x + i)), 8));
+        acc0 = vfmaq_f32(acc0, vcvt_f32_f16(vget_low_f16(h)), vld1q_f32(y + i + 0));
+        acc1 = vfmaq_f32(acc1, vcvt_high_f32_f16(h),          vld1q_f32(y + i + 4));
+    }
+    sumf = vaddvq_f32(vaddq_f32(acc0, acc1));
+#endif
+    for (; i < n; ++i) {
+        sumf += GGML_FP8_E5M2_TO_FP32(x[i]) * y[i];
+    }
+    *s = sumf;
+}
+
 void ggml_vec_dot_q5_0_q8_0(int n, float * GGML_RESTRICT s, size_t bs, const void * GGML_RESTRICT vx, size_t bx, const void * GGML_RESTRICT vy, size_t by, int nrc) {
     const int qk = QK8_0;
     const int nb = n / qk;
@@ -494,6 +494,461 @@ void quantize_row_q8_K(const float * GGML_RESTRICT x, void * GGML_RESTRICT y, in
     quantize_row_q8_K_ref(x, y, k);
 }
 
+//===================================== K-quants ==========================================
+
+#if defined(__AVX2__)
+
+// The scale searches of the K-quants run the scalar search of ggml-quants.c for 8 sub-blocks at once, with one
+// sub-block per lane. Every lane performs the same float operations in the same order as the reference, so the
+// result is bit-identical to quantize_row_qX_K_ref, provided that the compiler does not fuse any multiply-add.
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC optimize ("fp-contract=off")
+#endif
+
+static inline int nearest_int(float fval) {
+    assert(fabsf(fval) <= 4194303.f);
+    float val = fval + 12582912.f;
+    int i; memcpy(&i, &val, sizeof(int));
+    return (i & 0x007fffff) - 0x00400000;
+}
+
+static inline __m256i nearest_int_8(const __m256 fval) {
+    const __m256i i = _mm256_castps_si256(_mm256_add_ps(fval, _mm256_set1_ps(12582912.f)));
+    return _mm256_sub_epi32(_mm256_and_si256(i, _mm256_set1_epi32(0x007fffff)), _mm256_set1_epi32(0x00400000));
+}
+
+static inline void get_scale_min_k4(int j, const uint8_t * GGML_RESTRICT q, uint8_t * GGML_RESTRICT d, uint8_t * GGML_RESTRICT m) {
+    if (j < 4) {
+        *d = q[j] & 63; *m = q[j + 4] & 63;
+    } else {
+        *d = (q[j+4] & 0xF) | ((q[j-4] >> 6) << 4);
+        *m = (q[j+4] >>  4) | ((q[j-0] >> 6) << 4);
+    }
+}
+
+// make_qkx2_quants for 8 sub-blocks of 32 with the weights av_x + |x| of quantize_row_q4_K_ref/quantize_row_q5_K_ref
+static void make_qkx2_quants_x8(int nmax, const float * GGML_RESTRICT x, uint8_t * GGML_RESTRICT L,
+        float * GGML_RESTRICT scales, float * GGML_RESTRICT the_mins, float rmin, float rdelta, int nstep) {
+    const __m256i idx  = _mm256_setr_epi32(0, 32, 64, 96, 128, 160, 192, 224);
+    const __m256  zero = _mm256_setzero_ps();
+    const __m256  sign = _mm256_set1_ps(-0.0f);
+    const __m256i lmin = _mm256_setzero_si256();
+    const __m256i lmax = _mm256_set1_epi32(nmax);
+
+    __m256 xv[32];
+    __m256 wv[32];
+    __m256 Lb[32]; // best levels
+    __m256 La[32]; // levels of the current step
+
+    __m256 sum_x2 = zero;
+    for (int i = 0; i < 32; ++i) {
+        xv[i] = _mm256_i32gather_ps(x + i, idx, sizeof(float));
+        sum_x2 = _mm256_add_ps(sum_x2, _mm256_mul_ps(xv[i], xv[i]));
+    }
+    const __m256 av_x = _mm256_sqrt_ps(_mm256_div_ps(sum_x2, _mm256_set1_ps(32.f)));
+    for (int i = 0; i < 32; ++i) {
+        wv[i] = _mm256_add_ps(av_x, _mm256_andnot_ps(sign, xv[i]));
+    }
+
+    __m256 min   = xv[0];
+    __m256 max   = xv[0];
+    __m256 sum_w = wv[0];
+    __m256 sum_x = _mm256_mul_ps(wv[0], xv[0]);
+    for (int i = 1; i < 32; ++i) {
+        min   = _mm256_min_ps(xv[i], min);
+        max   = _mm256_max_ps(xv[i], max);
+        sum_w = _mm256_add_ps(sum_w, wv[i]);
+        sum_x = _mm256_add_ps(sum_x, _mm256_mul_ps(wv[i], xv[i]));
+    }
+    min = _mm256_blendv_ps(min, zero, _mm256_cmp_ps(min, zero, _CMP_GT_OQ));
+
+    // lanes with max == min take the early exit of the reference, their results are discarded below
+    const __m256 flat = _mm256_cmp_ps(max, min, _CMP_EQ_OQ);
+
+    __m256 iscale = _mm256_div_ps(_mm256_set1_ps((float) nmax), _mm256_sub_ps(max, min));
+    __m256 scale  = _mm256_div_ps(_mm256_set1_ps(1.0f), iscale);
+    __m256 best_error = zero;
+    for (int i = 0; i < 32; ++i) {
+        const __m256i l = _mm256_max_epi32(lmin, _mm256_min_epi32(lmax, nearest_int_8(_mm256_mul_ps(iscale, _mm256_sub_ps(xv[i], min)))));
+        Lb[i] = _mm256_cvtepi32_ps(l);
+        const __m256 diff = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(scale, Lb[i]), min), xv[i]);
+        best_error = _mm256_add_ps(best_error, _mm256_mul_ps(wv[i], _mm256_mul_ps(diff, diff)));
+    }
+
+    for (int is = 0; is <= nstep; ++is) {
+        const float t = rmin + rdelta*is + nmax;
+        iscale = _mm256_div_ps(_mm256_set1_ps(t), _mm256_sub_ps(max, min));
+
+        __m256 sum_l  = zero;
+        __m256 sum_l2 = zero;
+        __m256 sum_xl = zero;
+        for (int i = 0; i < 32; ++i) {
+            const __m256i l = _mm256_max_epi32(lmin, _mm256_min_epi32(lmax, nearest_int_8(_mm256_mul_ps(iscale, _mm256_sub_ps(xv[i], min)))));
+            La[i] = _mm256_cvtepi32_ps(l);
+            const __m256 wl = _mm256_mul_ps(wv[i], La[i]);
+            sum_l  = _mm256_add_ps(sum_l,  wl);
+            sum_l2 = _mm256_add_ps(sum_l2, _mm256_mul_ps(wl, La[i]));
+            sum_xl = _mm256_add_ps(sum_xl, _mm256_mul_ps(wl, xv[i]));
+        }
+
+        const __m256 D = _mm256_sub_ps(_mm256_mul_ps(sum_w, sum_l2), _mm256_mul_ps(sum_l, sum_l));
+        __m256 this_scale = _mm256_div_ps(_mm256_sub_ps(_mm256_mul_ps(sum_w,  sum_xl), _mm256_mul_ps(sum_x, sum_l)),  D);
+        __m256 this_min   = _mm256_div_ps(_mm256_sub_ps(_mm256_mul_ps(sum_l2, sum_x),  _mm256_mul_ps(sum_l, sum_xl)), D);
+        const __m256 pos = _mm256_cmp_ps(this_min, zero, _CMP_GT_OQ);
+        this_min   = _mm256_blendv_ps(this_min,   zero, pos);
+        this_scale = _mm256_blendv_ps(this_scale, _mm256_div_ps(sum_xl, sum_l2), pos);
+
+        __m256 cur_error = zero;
+        for (int i = 0; i < 32; ++i) {
+            const __m256 diff = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(this_scale, La[i]), this_min), xv[i]);
+            cur_error = _mm256_add_ps(cur_error, _mm256_mul_ps(wv[i], _mm256_mul_ps(diff, diff)));
+        }
+
+        const __m256 upd = _mm256_andnot_ps(flat, _mm256_and_ps(_mm256_cmp_ps(D, zero, _CMP_GT_OQ),
+                                                                _mm256_cmp_ps(cur_error, best_error, _CMP_LT_OQ)));
+        if (!_mm256_movemask_ps(upd)) {
+            continue;
+        }
+        for (int i = 0; i < 32; ++i) {
+            Lb[i] = _mm256_blendv_ps(Lb[i], La[i], upd);
+        }
+        best_error = _mm256_blendv_ps(best_error, cur_error,  upd);
+        scale      = _mm256_blendv_ps(scale,      this_scale, upd);
+        min        = _mm256_blendv_ps(min,        this_min,   upd);
+    }
+
+    _mm256_storeu_ps(scales,   _mm256_blendv_ps(scale, zero, flat));
+    _mm256_storeu_ps(the_mins, _mm256_xor_ps(min, sign));
+
+    int32_t l[32][8];
+    for (int i = 0; i < 32; ++i) {
+        _mm256_storeu_si256((__m256i *) l[i], _mm256_cvtps_epi32(_mm256_blendv_ps(Lb[i], zero, flat)));
+    }
+    for (int j = 0; j < 8; ++j) {
+        for (int i = 0; i < 32; ++i) {
+            L[32*j + i] = l[i][j];
+        }
+    }
+}
+
+// make_qx_quants with rmse_type = 1 for 8 sub-blocks of 16, as used by quantize_row_q6_K_ref
+static void make_qx_quants_x8(int nmax, const float * GGML_RESTRICT x, int8_t * GGML_RESTRICT L, float * GGML_RESTRICT scales) {
+    const __m256i idx  = _mm256_setr_epi32(0, 16, 32, 48, 64, 80, 96, 112);
+    const __m256  zero = _mm256_setzero_ps();
+    const __m256  sign = _mm256_set1_ps(-0.0f);
+    const __m256i lmin = _mm256_set1_epi32(-nmax);
+    const __m256i lmax = _mm256_set1_epi32(nmax - 1);
+
+    __m256 xv[16];
+    __m256 Lb[16]; // best levels
+    __m256 La[16]; // levels of the current step
+
+    __m256 max  = zero;
+    __m256 amax = zero;
+    for (int i = 0; i < 16; ++i) {
+        xv[i] = _mm256_i32gather_ps(x + i, idx, sizeof(float));
+        const __m256 ax = _mm256_andnot_ps(sign, xv[i]);
+        const __m256 gt = _mm256_cmp_ps(ax, amax, _CMP_GT_OQ);
+        amax = _mm256_blendv_ps(amax, ax,    gt);
+        max  = _mm256_blendv_ps(max,  xv[i], gt);
+    }
+
+    // all zero lanes take the early exit of the reference, their results are discarded below
+    const __m256 small = _mm256_cmp_ps(amax, _mm256_set1_ps(GROUP_MAX_EPS), _CMP_LT_OQ);
+
+    __m256 iscale = _mm256_div_ps(_mm256_set1_ps((float) -nmax), max);
+    __m256 sumlx  = zero;
+    __m256 suml2  = zero;
+    for (int i = 0; i < 16; ++i) {
+        const __m256i l = _mm256_max_epi32(lmin, _mm256_min_epi32(lmax, nearest_int_8(_mm256_mul_ps(iscale, xv[i]))));
+        Lb[i] = _mm256_cvtepi32_ps(l);
+        const __m256 w = _mm256_mul_ps(xv[i], xv[i]);
+        sumlx = _mm256_add_ps(sumlx, _mm256_mul_ps(_mm256_mul_ps(w, xv[i]), Lb[i]));
+        suml2 = _mm256_add_ps(suml2, _mm256_mul_ps(_mm256_mul_ps(w, Lb[i]), Lb[i]));
+    }
+    __m256 scale = _mm256_blendv_ps(_mm256_div_ps(sumlx, suml2), zero, _mm256_cmp_ps(suml2, zero, _CMP_EQ_OQ));
+    __m256 best  = _mm256_mul_ps(scale, sumlx);
+
+    for (int is = -9; is <= 9; ++is) {
+        if (is == 0) {
+            continue;
+        }
+        const float t = -(nmax + 0.1f*is);
+        iscale = _mm256_div_ps(_mm256_set1_ps(t), max);
+
+        sumlx = zero;
+        suml2 = zero;
+        for (int i = 0; i < 16; ++i) {
+            const __m256i l = _mm256_max_epi32(lmin, _mm256_min_epi32(lmax, nearest_int_8(_mm256_mul_ps(iscale, xv[i]))));
+            La[i] = _mm256_cvtepi32_ps(l);
+            const __m256 w = _mm256_mul_ps(xv[i], xv[i]);
+            sumlx = _mm256_add_ps(sumlx, _mm256_mul_ps(_mm256_mul_ps(w, xv[i]), La[i]));
+            suml2 = _mm256_add_ps(suml2, _mm256_mul_ps(_mm256_mul_ps(w, La[i]), La[i]));
+        }
+
+        const __m256 upd = _mm256_and_ps(_mm256_cmp_ps(suml2, zero, _CMP_GT_OQ),
+                                         _mm256_cmp_ps(_mm256_mul_ps(sumlx, sumlx), _mm256_mul_ps(best, suml2), _CMP_GT_OQ));
+        if (!_mm256_movemask_ps(upd)) {
+            continue;
+        }
+        for (int i = 0; i < 16; ++i) {
+            Lb[i] = _mm256_blendv_ps(Lb[i], La[i], upd);
+        }
+        scale = _mm256_blendv_ps(scale, _mm256_div_ps(sumlx, suml2), upd);
+        best  = _mm256_blendv_ps(best,  _mm256_mul_ps(scale, sumlx), upd);
+    }
+
+    _mm256_storeu_ps(scales, _mm256_blendv_ps(scale, zero, small));
+
+    const __m256 offset = _mm256_set1_ps((float) nmax);
+    int32_t l[16][8];
+    for (int i = 0; i < 16; ++i) {
+        _mm256_storeu_si256((__m256i *) l[i], _mm256_cvtps_epi32(_mm256_blendv_ps(_mm256_add_ps(Lb[i], offset), zero, small)));
+    }
+    for (int j = 0; j < 8; ++j) {
+        for (int i = 0; i < 16; ++i) {
+            L[16*j + i] = l[i][j];
+        }
+    }
+}
+
+#endif // __AVX2__
+
+void quantize_row_q4_K(const float * GGML_RESTRICT x, void * GGML_RESTRICT vy, int64_t k) {
+#if defined(__AVX2__)
+    assert(k % QK_K == 0);
+    const int64_t nb = k / QK_K;
+    block_q4_K * GGML_RESTRICT y = vy;
+
+    uint8_t L[QK_K];
+    float mins[QK_K/32];
+    float scales[QK_K/32];
+
+    for (int i = 0; i < nb; i++) {
+        make_qkx2_quants_x8(15, x, L, scales, mins, -1.f, 0.1f, 20);
+
+        float max_scale = 0; // as we are deducting the min, scales are always positive
+        float max_min = 0;
+        for (int j = 0; j < QK_K/32; ++j) {
+            if (scales[j] > max_scale) {
+                max_scale = scales[j];
+            }
+            if (mins[j] > max_min) {
+                max_min = mins[j];
+            }
+        }
+
+        float inv_scale = max_scale > 0 ? 63.f/max_scale : 0.f;
+        float inv_min   = max_min   > 0 ? 63.f/max_min   : 0.f;
+        for (int j = 0; j < QK_K/32; ++j) {
+            uint8_t ls = nearest_int(inv_scale*scales[j]);
+            uint8_t lm = nearest_int(inv_min*mins[j]);
+            ls = MIN(63, ls);
+            lm = MIN(63, lm);
+            if (j < 4) {
+                y[i].scales[j] = ls;
+                y[i].scales[j+4] = lm;
+            } else {
+                y[i].scales[j+4] = (ls & 0xF) | ((lm & 0xF) << 4);
+                y[i].scales[j-4] |= ((ls >> 4) << 6);
+                y[i].scales[j-0] |= ((lm >> 4) << 6);
+            }
+        }
+        y[i].d = GGML_CPU_FP32_TO_FP16(max_scale/63.f);
+        y[i].dmin = GGML_CPU_FP32_TO_FP16(max_min/63.f);
+
+        uint8_t sc, m;
+        for (int j = 0; j < QK_K/32; ++j) {
+            get_scale_min_k4(j, y[i].scales, &sc, &m);
+            const float d = GGML_CPU_FP16_TO_FP32(y[i].d) * sc;
+            if (!d) continue;
+            const float dm = GGML_CPU_FP16_TO_FP32(y[i].dmin) * m;
+            for (int ii = 0; ii < 32; ++ii) {
+                int l = nearest_int((x[32*j + ii] + dm)/d);
+                l = MAX(0, MIN(15, l));
+                L[32*j + ii] = l;
+            }
+        }
+
+        uint8_t * q = y[i].qs;
+        for (int j = 0; j < QK_K; j += 64) {
+            for (int l = 0; l < 32; ++l) q[l] = L[j + l] | (L[j + l + 32] << 4);
+            q += 32;
+        }
+
+        x += QK_K;
+    }
+#else
+    quantize_row_q4_K_generic(x, vy, k);
+#endif
+}
+
+void quantize_row_q5_K(const float * GGML_RESTRICT x, void * GGML_RESTRICT vy, int64_t k) {
+#if defined(__AVX2__)
+    assert(k % QK_K == 0);
+    const int64_t nb = k / QK_K;
+    block_q5_K * GGML_RESTRICT y = vy;
+
+    uint8_t L[QK_K];
+    float mins[QK_K/32];
+    float scales[QK_K/32];
+
+    for (int i = 0; i < nb; i++) {
+        make_qkx2_quants_x8(31, x, L, scales, mins, -0.5f, 0.1f, 15);
+
+        float max_scale = 0; // as we are deducting the min, scales are always positive
+        float max_min = 0;
+        for (int j = 0; j < QK_K/32; ++j) {
+            if (scales[j] > max_scale) {
+                max_scale = scales[j];
+            }
+            if (mins[j] > max_min) {
+                max_min = mins[j];
+            }
+        }
+
+        float inv_scale = max_scale > 0 ? 63.f/max_scale : 0.f;
+        float inv_min   = max_min   > 0 ? 63.f/max_min   : 0.f;
+        for (int j = 0; j < QK_K/32; ++j) {
+            uint8_t ls = nearest_int(inv_scale*scales[j]);
+            uint8_t lm = nearest_int(inv_min*mins[j]);
+            ls = MIN(63, ls);
+            lm = MIN(63, lm);
+            if (j < 4) {
+                y[i].scales[j] = ls;
+                y[i].scales[j+4] = lm;
+            } else {
+                y[i].scales[j+4] = (ls & 0xF) | ((lm & 0xF) << 4);
+                y[i].scales[j-4] |= ((ls >> 4) << 6);
+                y[i].scales[j-0] |= ((lm >> 4) << 6);
+            }
+        }
+        y[i].d = GGML_CPU_FP32_TO_FP16(max_scale/63.f);
+        y[i].dmin = GGML_CPU_FP32_TO_FP16(max_min/63.f);
+
+        uint8_t sc, m;
+        for (int j = 0; j < QK_K/32; ++j) {
+            get_scale_min_k4(j, y[i].scales, &sc, &m);
+            const float d = GGML_CPU_FP16_TO_FP32(y[i].d) * sc;
+            if (!d) continue;
+            const float dm = GGML_CPU_FP16_TO_FP32(y[i].dmin) * m;
+            for (int ii = 0; ii < 32; ++ii) {
+                int l = nearest_int((x[32*j + ii] + dm)/d);
+                l = MAX(0, MIN(31, l));
+                L[32*j + ii] = l;
+            }
+        }
+
+        uint8_t * GGML_RESTRICT qh = y[i].qh;
+        uint8_t * GGML_RESTRICT ql = y[i].qs;
+        memset(qh, 0, QK_K/8);
+
+        uint8_t m1 = 1, m2 = 2;
+        for (int n = 0; n < QK_K; n += 64) {
+            for (int j = 0; j < 32; ++j) {
+                int l1 = L[n + j];
+                if (l1 > 15) {
+                    l1 -= 16; qh[j] |= m1;
+                }
+                int l2 = L[n + j + 32];
+                if (l2 > 15) {
+                    l2 -= 16; qh[j] |= m2;
+                }
+                ql[j] = l1 | (l2 << 4);
+            }
+            m1 <<= 2; m2 <<= 2;
+            ql += 32;
+        }
+
+        x += QK_K;
+    }
+#else
+    quantize_row_q5_K_generic(x, vy, k);
+#endif
+}
+
+void quantize_row_q6_K(const float * GGML_RESTRICT x, void * GGML_RESTRICT vy, int64_t k) {
+#if defined(__AVX2__)
+    assert(k % QK_K == 0);
+    const int64_t nb = k / QK_K;
+    block_q6_K * GGML_RESTRICT y = vy;
+
+    int8_t L[QK_K];
+    float  scales[QK_K/16];
+
+    for (int i = 0; i < nb; i++) {
+        make_qx_quants_x8(32, x,           L,           scales);
+        make_qx_quants_x8(32, x + QK_K/2,  L + QK_K/2,  scales + QK_K/32);
+
+        float max_scale = 0;
+        float max_abs_scale = 0;
+        for (int ib = 0; ib < QK_K/16; ++ib) {
+            const float abs_scale = fabsf(scales[ib]);
+            if (abs_scale > max_abs_scale) {
+                max_abs_scale = abs_scale;
+                max_scale = scales[ib];
+            }
+        }
+
+        if (max_abs_scale < GROUP_MAX_EPS) {
+            memset(&y[i], 0, sizeof(block_q6_K));
+            y[i].d = GGML_CPU_FP32_TO_FP16(0.f);
+            x += QK_K;
+            continue;
+        }
+
+        float iscale = -128.f/max_scale;
+        y[i].d = GGML_CPU_FP32_TO_FP16(1/iscale);
+        for (int ib = 0; ib < QK_K/16; ++ib) {
+            y[i].scales[ib] = MIN(127, nearest_int(iscale*scales[ib]));
+        }
+
+        for (int j = 0; j < QK_K/16; ++j) {
+            float d = GGML_CPU_FP16_TO_FP32(y[i].d) * y[i].scales[j];
+            if (!d) {
+                continue;
+            }
+            for (int ii = 0; ii < 16; ++ii) {
+                int l = nearest_int(x[16*j + ii]/d);
+                l = MAX(-32, MIN(31, l));
+                L[16*j + ii] = l + 32;
+            }
+        }
+
+        uint8_t * GGML_RESTRICT ql = y[i].ql;
+        uint8_t * GGML_RESTRICT qh = y[i].qh;
+        for (int j = 0; j < QK_K; j += 128) {
+            for (int l = 0; l < 32; ++l) {
+                const uint8_t q1 = L[j + l +  0] & 0xF;
+                const uint8_t q2 = L[j + l + 32] & 0xF;
+                const uint8_t q3 = L[j + l + 64] & 0xF;
+                const uint8_t q4 = L[j + l + 96] & 0xF;
+                ql[l+ 0] = q1 | (q3 << 4);
+                ql[l+32] = q2 | (q4 << 4);
+                qh[l] = (L[j + l] >> 4) | ((L[j + l + 32] >> 4) << 2) | ((L[j + l + 64] >> 4) << 4) | ((L[j + l + 96] >> 4) << 6);
+            }
+            ql += 64;
+            qh += 32;
+        }
+
+        x += QK_K;
+    }
+#else
+    quantize_row_q6_K_generic(x, vy, k);
+#endif
+}
+
+#if defined(__AVX2__)
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT DEFAULT
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+#endif
+
 //===================================== Dot products =================================
 
 //
@@ -842,6 +1297,89 @@ void ggml_vec_dot_mxfp4_q8_0(int n, float * GGML_RESTRICT s, size_t bs, const vo
     *s = sumf;
 }
 
+// FP8 weights are widened to FP16 bit patterns and converted with F16C:
+//  E5M2 shares the FP16 exponent bias, so the byte is just the high half
+//  E4M3 lands in the FP16 exponent with a bias that is off by 8, compensated by a final * 256
+// the E4M3 NaN code 0x7f is not special-cased in the SIMD loops
+
+void ggml_vec_dot_f8_e4m3_f32(int n, float * GGML_RESTRICT s, size_t bs, const void * GGML_RESTRICT vx, size_t bx, const void * GGML_RESTRICT vy, size_t by, int nrc) {
+    assert(nrc == 1);
+    UNUSED(nrc);
+    UNUSED(bx);
+    UNUSED(by);
+    UNUSED(bs);
+
+    const uint8_t * GGML_RESTRICT x = vx;
+    const float   * GGML_RESTRICT y = vy;
+
+    int i = 0;
+    float sumf = 0;
+
+#if defined(__AVX512F__)
+    const __m256i m_sign = _mm256_set1_epi16(0x80);
+    const __m256i m_bits = _mm256_set1_epi16(0x7f);
+
+    __m512 acc = _mm512_setzero_ps();
+    for (; i + 15 < n; i += 16) {
+        const __m256i q = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(x + i)));
+        const __m256i h = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(q, m_sign), 8),
+                                          _mm256_slli_epi16(_mm256_and_si256(q, m_bits), 7));
+        acc = _mm512_fmadd_ps(_mm512_cvtph_ps(h), _mm512_loadu_ps(y + i), acc);
+    }
+    sumf = 256.0f * _mm512_reduce_add_ps(acc);
+#elif defined(__AVX2__) && defined(__F16C__)
+    const __m128i m_sign = _mm_set1_epi16(0x80);
+    const __m128i m_bits = _mm_set1_epi16(0x7f);
+
+    __m256 acc = _mm256_setzero_ps();
+    for (; i + 7 < n; i += 8) {
+        const __m128i q = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(x + i)));
+        const __m128i h = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(q, m_sign), 8),
+                                       _mm_slli_epi16(_mm_and_si128(q, m_bits), 7));
+        acc = _mm256_fmadd_ps(_mm256_cvtph_ps(h), _mm256_loadu_ps(y + i), acc);
+    }
+    sumf = 256.0f * hsum_float_8(acc);
+#endif
+    for (; i < n; ++i) {
+        sumf += GGML_FP8_E4M3_TO_FP32(x[i]) * y[i];
+    }
+    *s = sumf;
+}
+
+void ggml_vec_dot_f8_e5m2_f32(int n, float * GGML_RESTRICT s, size_t bs, const void * GGML_RESTRICT vx, size_t bx, const void * GGML_RESTRICT vy, size_t by, int nrc) {
+    assert(nrc == 1);
+    UNUSED(nrc);
+    UNUSED(bx);
+    UNUSED(by);
+    UNUSED(bs);
+
+    const uint8_t * GGML_RESTRICT x = vx;
+    const float   * GGML_RESTRICT y = vy;
+
+    int i = 0;
+    float sumf = 0;
+
+#if defined(__AVX512F__)
+    __m512 acc = _mm512_setzero_ps();
+    for (; i + 15 < n; i += 16) {
+        const __m256i h = _mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(x + i))), 8);
+        acc = _mm512_fmadd_ps(_mm512_cvtph_ps(h), _mm512_loadu_ps(y + i), acc);
+    }
+    sumf = _mm512_reduce_add_ps(acc);
+#elif defined(__AVX2__) && defined(__F16C__)
+    __m256 acc = _mm256_setzero_ps();
+    for (; i + 7 < n; i += 8) {
+        const __m128i h = _mm_slli_epi16(_mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(x + i))), 8);
+        acc = _mm256_fmadd_ps(_mm256_cvtph_ps(h), _mm256_loadu_ps(y + i), acc);
+    }
+    sumf = hsum_float_8(acc);
+#endif
+    for (; i < n; ++i) {
+        sumf += GGML_FP8_E5M2_TO_FP32(x[i]) * y[i];
+    }
+    *s = sumf;
+}
+
 void ggml_vec_dot_q5_0_q8_0(int n, float * GGML_RESTRICT s, size_t bs, const void * GGML_RESTRICT vx, size_t bx, const void * GGML_RESTRICT vy, size_t by, int nrc) {
     const int qk = QK8_0;
     const int nb = n / qk;
@@ -3818,3 +4356,232 @@ void ggml_vec_dot_iq4_xs_q8_K(int n, float * GGML_RESTRICT s, size_t bs, const v
 #endif
 }
 
+
+void ggml_vec_mad_q4_0(int n, float * GGML_RESTRICT y, const void * GGML_RESTRICT vx, size_t bx, const float * GGML_RESTRICT v, int nrc) {
+#if defined(__AVX2__)
+    const int qk = QK4_0;
+    const int nb = n / qk;
+
+    assert(n % qk == 0);
+
+    const __m128i m4 = _mm_set1_epi8(0x0F);
+    const __m128i m8 = _mm_set1_epi8(8);
+
+    // one block of y stays in registers while the rows are accumulated
+    for (int ib = 0; ib < nb; ++ib) {
+        float * GGML_RESTRICT yb = y + ib*qk;
+
+        __m256 acc0 = _mm256_loadu_ps(yb +  0);
+        __m256 acc1 = _mm256_loadu_ps(yb +  8);
+        __m256 acc2 = _mm256_loadu_ps(yb + 16);
+        __m256 acc3 = _mm256_loadu_ps(yb + 24);
+
+        for (int r = 0; r < nrc; ++r) {
+            if (v[r] == 0.0f) {
+                continue;
+            }
+
+            const block_q4_0 * GGML_RESTRICT x = (const block_q4_0 *) ((const char *) vx + r*bx) + ib;
+
+            const __m256 d = _mm256_set1_ps(v[r]*GGML_CPU_FP16_TO_FP32(x->d));
+
+            const __m128i q  = _mm_loadu_si128((const __m128i *) x->qs);
+            const __m128i lo = _mm_sub_epi8(_mm_and_si128(q, m4), m8);
+            const __m128i hi = _mm_sub_epi8(_mm_and_si128(_mm_srli_epi16(q, 4), m4), m8);
+
+            acc0 = _mm256_fmadd_ps(d, _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(lo)),                    acc0);
+            acc1 = _mm256_fmadd_ps(d, _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_srli_si128(lo, 8))), acc1);
+            acc2 = _mm256_fmadd_ps(d, _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(hi)),                    acc2);
+            acc3 = _mm256_fmadd_ps(d, _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_srli_si128(hi, 8))), acc3);
+        }
+
+        _mm256_storeu_ps(yb +  0, acc0);
+        _mm256_storeu_ps(yb +  8, acc1);
+        _mm256_storeu_ps(yb + 16, acc2);
+        _mm256_storeu_ps(yb + 24, acc3);
+    }
+#else
+    ggml_vec_mad_q4_0_generic(n, y, vx, bx, v, nrc);
+#endif
+}
+
+void ggml_vec_mad_q8_0(int n, float * GGML_RESTRICT y, const void * GGML_RESTRICT vx, size_t bx, const float * GGML_RESTRICT v, int nrc) {
+#if defined(__AVX2__)
+    const int qk = QK8_0;
+    const int nb = n / qk;
+
+    assert(n % qk == 0);
+
+    // one block of y stays in registers while the rows are accumulated
+    for (int ib = 0; ib < nb; ++ib) {
+        float * GGML_RESTRICT yb = y + ib*qk;
+
+        __m256 acc0 = _mm256_loadu_ps(yb +  0);
+        __m256 acc1 = _mm256_loadu_ps(yb +  8);
+        __m256 acc2 = _mm256_loadu_ps(yb + 16);
+        __m256 acc3 = _mm256_loadu_ps(yb + 24);
+
+        for (int r = 0; r < nrc; ++r) {
+            if (v[r] == 0.0f) {
+                continue;
+            }
+
+            const block_q8_0 * GGML_RESTRICT x = (const block_q8_0 *) ((const char *) vx + r*bx) + ib;
+
+            const __m256 d = _mm256_set1_ps(v[r]*GGML_CPU_FP16_TO_FP32(x->d));
+
+            const __m128i q0 = _mm_loadu_si128((const __m128i *) x->qs + 0);
+            const __m128i q1 = _mm_loadu_si128((const __m128i *) x->qs + 1);
+
+            acc0 = _mm256_fmadd_ps(d, _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(q0)),                    acc0);
+            acc1 = _mm256_fmadd_ps(d, _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_srli_si128(q0, 8))), acc1);
+            acc2 = _mm256_fmadd_ps(d, _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(q1)),                    acc2);
+            acc3 = _mm256_fmadd_ps(d, _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_srli_si128(q1, 8))), acc3);
+        }
+
+        _mm256_storeu_ps(yb +  0, acc0);
+        _mm256_storeu_ps(yb +  8, acc1);
+        _mm256_storeu_ps(yb + 16, acc2);
+        _mm256_storeu_ps(yb + 24, acc3);
+    }
+#else
+    ggml_vec_mad_q8_0_generic(n, y, vx, bx, v, nrc);
+#endif
+}
+
+#if defined(__AVX2__)
+// the 32 floats of y[0..31] as 4 vectors with y[4*k + t] in lane k of acc[t]
+static inline void ggml_vec_load_f32x32_t4(__m256 * GGML_RESTRICT acc, const float * GGML_RESTRICT y) {
+    const __m256 t0 = _mm256_unpacklo_ps(_mm256_loadu_ps(y +  0), _mm256_loadu_ps(y +  8));
+    const __m256 t1 = _mm256_unpackhi_ps(_mm256_loadu_ps(y +  0), _mm256_loadu_ps(y +  8));
+    const __m256 t2 = _mm256_unpacklo_ps(_mm256_loadu_ps(y + 16), _mm256_loadu_ps(y + 24));
+    const __m256 t3 = _mm256_unpackhi_ps(_mm256_loadu_ps(y + 16), _mm256_loadu_ps(y + 24));
+
+    const __m256i perm = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    acc[0] = _mm256_permutevar8x32_ps(_mm256_shuffle_ps(t0, t2, 0x44), perm);
+    acc[1] = _mm256_permutevar8x32_ps(_mm256_shuffle_ps(t0, t2, 0xEE), perm);
+    acc[2] = _mm256_permutevar8x32_ps(_mm256_shuffle_ps(t1, t3, 0x44), perm);
+    acc[3] = _mm256_permutevar8x32_ps(_mm256_shuffle_ps(t1, t3, 0xEE), perm);
+}
+
+// inverse of ggml_vec_load_f32x32_t4
+static inline void ggml_vec_store_f32x32_t4(float * GGML_RESTRICT y, const __m256 * GGML_RESTRICT acc) {
+    const __m256i perm = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+
+    const __m256 a0 = _mm256_permutevar8x32_ps(acc[0], perm);
+    const __m256 a1 = _mm256_permutevar8x32_ps(acc[1], perm);
+    const __m256 a2 = _mm256_permutevar8x32_ps(acc[2], perm);
+    const __m256 a3 = _mm256_permutevar8x32_ps(acc[3], perm);
+
+    const __m256 t0 = _mm256_unpacklo_ps(a0, a1);
+    const __m256 t1 = _mm256_unpackhi_ps(a0, a1);
+    const __m256 t2 = _mm256_unpacklo_ps(a2, a3);
+    const __m256 t3 = _mm256_unpackhi_ps(a2, a3);
+
+    _mm256_storeu_ps(y +  0, _mm256_shuffle_ps(t0, t2, 0x44));
+    _mm256_storeu_ps(y +  8, _mm256_shuffle_ps(t0, t2, 0xEE));
+    _mm256_storeu_ps(y + 16, _mm256_shuffle_ps(t1, t3, 0x44));
+    _mm256_storeu_ps(y + 24, _mm256_shuffle_ps(t1, t3, 0xEE));
+}
+
+// acc[0..3] += d*q - m for 32 unsigned 8-bit values, in the layout of ggml_vec_load_f32x32_t4
+// the bytes are taken out of their 32-bit lanes with shifts instead of shuffles, which are the bottleneck of this loop
+static inline void ggml_vec_mad_u8x32_t4(__m256 * GGML_RESTRICT acc, const __m256i q, const __m256 d, const __m256 m) {
+    const __m256i mff = _mm256_set1_epi32(0xFF);
+
+    acc[0] = _mm256_add_ps(acc[0], _mm256_fmsub_ps(d, _mm256_cvtepi32_ps(_mm256_and_si256(q, mff)),                         m));
+    acc[1] = _mm256_add_ps(acc[1], _mm256_fmsub_ps(d, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(q,  8), mff)), m));
+    acc[2] = _mm256_add_ps(acc[2], _mm256_fmsub_ps(d, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(q, 16), mff)), m));
+    acc[3] = _mm256_add_ps(acc[3], _mm256_fmsub_ps(d, _mm256_cvtepi32_ps(_mm256_srli_epi32(q, 24)),                         m));
+}
+#endif
+
+void ggml_vec_mad_q5_K(int n, float * GGML_RESTRICT y, const void * GGML_RESTRICT vx, size_t bx, const float * GGML_RESTRICT v, int nrc) {
+#if defined(__AVX2__)
+    assert(n % QK_K == 0);
+
+    const int nb = n / QK_K;
+
+    static const uint32_t kmask1 = 0x3f3f3f3f;
+    static const uint32_t kmask2 = 0x0f0f0f0f;
+    static const uint32_t kmask3 = 0x03030303;
+
+    uint32_t utmp[4];
+
+    const uint8_t * scales = (const uint8_t*)&utmp[0];
+    const uint8_t * mins   = (const uint8_t*)&utmp[2];
+
+    const __m256i m4 = _mm256_set1_epi8(0x0F);
+    const __m256i m1 = _mm256_set1_epi8(1);
+
+    // the rows are taken in groups of up to 32: the scales and mins of a block of each row are decoded once,
+    // then 64 values of y stay in registers while the rows of the group are accumulated
+    enum { GROUP = 32 };
+
+    const block_q5_K * GGML_RESTRICT xg[GROUP];
+    float dg[GROUP][QK_K/32];
+    float mg[GROUP][QK_K/32];
+
+    for (int i = 0; i < nb; ++i) {
+        for (int r0 = 0; r0 < nrc; r0 += GROUP) {
+            int ng = 0;
+            for (int r = r0; r < nrc && r < r0 + GROUP; ++r) {
+                if (v[r] == 0.0f) {
+                    continue;
+                }
+
+                const block_q5_K * GGML_RESTRICT x = (const block_q5_K *) ((const char *) vx + r*bx) + i;
+
+                memcpy(utmp, x->scales, 12);
+                utmp[3] = ((utmp[2] >> 4) & kmask2) | (((utmp[1] >> 6) & kmask3) << 4);
+                const uint32_t uaux = utmp[1] & kmask1;
+                utmp[1] = (utmp[2] & kmask2) | (((utmp[0] >> 6) & kmask3) << 4);
+                utmp[2] = uaux;
+                utmp[0] &= kmask1;
+
+                const float d    = v[r]*GGML_CPU_FP16_TO_FP32(x->d);
+                const float dmin = v[r]*GGML_CPU_FP16_TO_FP32(x->dmin);
+
+                for (int k = 0; k < QK_K/32; ++k) {
+                    dg[ng][k] = d*scales[k];
+                    mg[ng][k] = dmin*mins[k];
+                }
+                xg[ng++] = x;
+            }
+
+            if (ng == 0) {
+                continue;
+            }
+
+            for (int j = 0; j < QK_K/64; ++j) {
+                float * GGML_RESTRICT yb = y + i*QK_K + j*64;
+
+                __m256 acc[8];
+                ggml_vec_load_f32x32_t4(acc + 0, yb +  0);
+                ggml_vec_load_f32x32_t4(acc + 4, yb + 32);
+
+                for (int g = 0; g < ng; ++g) {
+                    const __m256i q4bits = _mm256_loadu_si256((const __m256i *) (xg[g]->qs + 32*j));
+                    const __m256i qh     = _mm256_loadu_si256((const __m256i *) xg[g]->qh);
+
+                    // the 5th bit of the two groups of 32 values is bit 2*j and 2*j + 1 of qh
+                    const __m256i h0 = _mm256_slli_epi16(_mm256_and_si256(_mm256_srl_epi16(qh, _mm_cvtsi32_si128(2*j + 0)), m1), 4);
+                    const __m256i h1 = _mm256_slli_epi16(_mm256_and_si256(_mm256_srl_epi16(qh, _mm_cvtsi32_si128(2*j + 1)), m1), 4);
+
+                    const __m256i q0 = _mm256_or_si256(_mm256_and_si256(q4bits, m4), h0);
+                    const __m256i q1 = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi16(q4bits, 4), m4), h1);
+
+                    ggml_vec_mad_u8x32_t4(acc + 0, q0, _mm256_set1_ps(dg[g][2*j + 0]), _mm256_set1_ps(mg[g][2*j + 0]));
+                    ggml_vec_mad_u8x32_t4(acc + 4, q1, _mm256_set1_ps(dg[g][2*j + 1]), _mm256_set1_ps(mg[g][2*j + 1]));
+                }
+
+                ggml_vec_store_f32x32_t4(yb +  0, acc + 0);
+                ggml_vec_store_f32x32_t4(yb + 32, acc + 4);
+            }
+        }
+    }
+#else
+    ggml_vec_mad_q5_K_generic(n, y, vx, bx, v, nrc);
+#endif
+}
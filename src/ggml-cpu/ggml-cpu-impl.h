@@ -521,6 +521,32 @@ void ggml_barrier(struct ggml_threadpool * tp);
 void ggml_threadpool_chunk_set(struct ggml_threadpool * tp, int value);
 int  ggml_threadpool_chunk_add(struct ggml_threadpool * tp, int value);
 
+// prefix sums of the relative capacity of the threads, [n_threads + 1]
+// NULL if all the threads have the same capacity, e.g. when they are not pinned to the cores of a hybrid CPU
+const float * ggml_threadpool_capacity(const struct ggml_threadpool * tp);
+
+// range [*i0, *i1) of the n items of thread ith out of nth, in proportion to the capacity of the threads
+static inline void ggml_thread_range(const struct ggml_compute_params * params, int64_t n, int64_t * i0, int64_t * i1) {
+    const int ith = params->ith;
+    const int nth = params->nth;
+
+    const float * capacity = ggml_threadpool_capacity(params->threadpool);
+    if (capacity == NULL) {
+        const int64_t dr = (n + nth - 1)/nth;
+
+        *i0 = dr*ith;
+        *i1 = *i0 + dr < n ? *i0 + dr : n;
+        return;
+    }
+
+    *i0 = (int64_t) ((double) n*(double) capacity[ith]/(double) capacity[nth]);
+    *i1 = ith == nth - 1 ? n : (int64_t) ((double) n*(double) capacity[ith + 1]/(double) capacity[nth]);
+}
+
+// RoPE sin/cos table of the node shared with the other ROPE nodes of the graph, NULL if not shared
+// init is set for the first node using the table, which has to compute it
+float * ggml_cpu_rope_cache(const struct ggml_compute_params * params, const struct ggml_tensor * node, bool * init);
+
 #ifdef __cplusplus
 }
 #endif
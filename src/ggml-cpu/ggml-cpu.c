@@ -8,11 +8,13 @@
 #include "ggml-cpu.h"
 #include "ggml-impl.h"
 #include "quants.h"
+#include "ggml-quants.h"
 #include "ggml-threading.h"
 #include "unary-ops.h"
 #include "binary-ops.h"
 #include "vec.h"
 #include "ops.h"
+#include "profile.h"
 #include "ggml.h"
 
 #if defined(_MSC_VER) || defined(__MINGW32__)
@@ -376,6 +378,18 @@ static const struct ggml_type_traits_cpu type_traits_cpu[GGML_TYPE_COUNT] = {
     [GGML_TYPE_I32] = {
         .from_float               = (ggml_from_float_t) ggml_cpu_fp32_to_i32,
     },
+    [GGML_TYPE_F8_E4M3] = {
+        .from_float               = quantize_row_f8_e4m3,
+        .vec_dot                  = ggml_vec_dot_f8_e4m3_f32,
+        .vec_dot_type             = GGML_TYPE_F32,
+        .nrows                    = 1,
+    },
+    [GGML_TYPE_F8_E5M2] = {
+        .from_float               = quantize_row_f8_e5m2,
+        .vec_dot                  = ggml_vec_dot_f8_e5m2_f32,
+        .vec_dot_type             = GGML_TYPE_F32,
+        .nrows                    = 1,
+    },
 };
 
 const struct ggml_type_traits_cpu * ggml_get_type_traits_cpu(enum ggml_type type) {
@@ -440,6 +454,15 @@ typedef pthread_mutex_t    ggml_mutex_t;
 
 #endif
 
+// max number of RoPE sin/cos tables shared between the nodes of a graph
+#define GGML_ROPE_CACHE_MAX 16
+
+// a RoPE sin/cos table shared by all ROPE nodes with the same positions and parameters
+struct ggml_rope_cache_entry {
+    const struct ggml_tensor * node; // first node using the table, it computes the table
+    size_t                     offs; // offset of the table from the end of the work buffer
+};
+
 // Threadpool def
 struct ggml_threadpool {
     ggml_mutex_t mutex;       // mutex for cond.var
@@ -452,6 +475,8 @@ struct ggml_threadpool {
     atomic_int n_graph;       // incremented when there is work to be done (i.e each graph)
     atomic_int GGML_CACHE_ALIGN n_barrier;
     atomic_int GGML_CACHE_ALIGN n_barrier_passed;
+    atomic_int GGML_CACHE_ALIGN n_barrier_node;        // ggml_barrier between the threads working on a node
+    atomic_int GGML_CACHE_ALIGN n_barrier_node_passed;
     atomic_int GGML_CACHE_ALIGN current_chunk; // currently processing chunk during Mat_Mul, shared between all the threads.
 
     // these are atomic as an annotation for thread-sanitizer
@@ -462,11 +487,24 @@ struct ggml_threadpool {
     struct ggml_compute_state * workers;   // per thread state
     int          n_threads_max; // number of threads in the pool
     atomic_int   n_threads_cur; // number of threads used in the current graph
+    atomic_int   n_threads_node; // number of threads working on the current node, see ggml_graph_node_n_threads
+
+    int64_t      node_min_work; // minimum work per thread of a node, 0 - all threads work on every node
 
     int32_t      prio;        // Scheduling priority
     uint32_t     poll;        // Polling level (0 - no polling)
 
     enum ggml_status ec;
+
+    struct ggml_cpu_profile_sample * prof_samples; // per-node timings of the current graph, NULL when not profiling
+    int                              prof_n_threads;
+
+    struct ggml_rope_cache_entry rope_cache[GGML_ROPE_CACHE_MAX]; // shared RoPE tables of the current graph
+    int                          n_rope_cache;
+    size_t                       rope_cache_size; // size of the tables, excluded from the work buffer of the ops
+
+    // prefix sums of the relative capacity of the threads, NULL if all the threads have the same capacity
+    float * capacity; // [n_threads_max + 1]
 };
 
 // Per-thread state
@@ -525,46 +563,74 @@ struct ggml_numa_nodes {
 
 struct ggml_state {
     struct ggml_numa_nodes numa;
+
+    struct ggml_cpu_topology topo;
+
+    int64_t node_min_work; // default of ggml_cplan.node_min_work
+
+    bool no_fusion; // GGML_CPU_DISABLE_FUSION, compute every node on its own, see ggml_graph_fused_nodes
 };
 
 static struct ggml_state g_state = {0};
 
-void ggml_barrier(struct ggml_threadpool * tp) {
-    int n_threads = atomic_load_explicit(&tp->n_threads_cur, memory_order_relaxed);
-    if (n_threads == 1) {
-        return;
-    }
-
-#ifdef GGML_USE_OPENMP
-    #pragma omp barrier
-#else
-    int n_passed = atomic_load_explicit(&tp->n_barrier_passed, memory_order_relaxed);
+static void ggml_barrier_wait(atomic_int * n_barrier, atomic_int * n_barrier_passed, int n_threads) {
+    int n_passed = atomic_load_explicit(n_barrier_passed, memory_order_relaxed);
 
     // enter barrier (full seq-cst fence)
-    int n_barrier = atomic_fetch_add_explicit(&tp->n_barrier, 1, memory_order_seq_cst);
+    int n_arrived = atomic_fetch_add_explicit(n_barrier, 1, memory_order_seq_cst);
 
-    if (n_barrier == (n_threads - 1)) {
+    if (n_arrived == (n_threads - 1)) {
         // last thread
-        atomic_store_explicit(&tp->n_barrier, 0, memory_order_relaxed);
+        atomic_store_explicit(n_barrier, 0, memory_order_relaxed);
 
         // exit barrier (fill seq-cst fence)
-        atomic_fetch_add_explicit(&tp->n_barrier_passed, 1, memory_order_seq_cst);
+        atomic_fetch_add_explicit(n_barrier_passed, 1, memory_order_seq_cst);
         return;
     }
 
     // wait for other threads
-    while (atomic_load_explicit(&tp->n_barrier_passed, memory_order_relaxed) == n_passed) {
+    while (atomic_load_explicit(n_barrier_passed, memory_order_relaxed) == n_passed) {
         ggml_thread_cpu_relax();
     }
 
     // exit barrier (full seq-cst fence)
     // TSAN doesn't support standalone fence yet, we use a dummy read-modify-write instead
     #ifdef GGML_TSAN_ENABLED
-    atomic_fetch_add_explicit(&tp->n_barrier_passed, 0, memory_order_seq_cst);
+    atomic_fetch_add_explicit(n_barrier_passed, 0, memory_order_seq_cst);
     #else
     atomic_thread_fence(memory_order_seq_cst);
     #endif
+}
+
+// barrier between all the threads of the graph
+static void ggml_barrier_graph(struct ggml_threadpool * tp) {
+    int n_threads = atomic_load_explicit(&tp->n_threads_cur, memory_order_relaxed);
+    if (n_threads == 1) {
+        return;
+    }
+
+#ifdef GGML_USE_OPENMP
+    #pragma omp barrier
+#else
+    ggml_barrier_wait(&tp->n_barrier, &tp->n_barrier_passed, n_threads);
+#endif
+}
+
+// barrier between the threads working on the current node
+// the threads that skip the node wait in ggml_barrier_graph, so they must not take part in this one
+void ggml_barrier(struct ggml_threadpool * tp) {
+    int n_threads = atomic_load_explicit(&tp->n_threads_node, memory_order_relaxed);
+    if (n_threads == 1) {
+        return;
+    }
+
+#ifdef GGML_USE_OPENMP
+    if (n_threads == atomic_load_explicit(&tp->n_threads_cur, memory_order_relaxed)) {
+        #pragma omp barrier
+        return;
+    }
 #endif
+    ggml_barrier_wait(&tp->n_barrier_node, &tp->n_barrier_node_passed, n_threads);
 }
 
 void ggml_threadpool_chunk_set(struct ggml_threadpool * tp, int value) {
@@ -590,6 +656,140 @@ static uint32_t ggml_get_numa_affinity(void) {
 }
 #endif
 
+#if defined(__gnu_linux__)
+static bool ggml_sysfs_read_int(const char * path, int64_t * value) {
+    FILE * f = fopen(path, "r");
+    if (f == NULL) {
+        return false;
+    }
+    long long v;
+    const bool ok = fscanf(f, "%lld", &v) == 1;
+    fclose(f);
+    if (ok) {
+        *value = v;
+    }
+    return ok;
+}
+
+// parses a CPU list such as "0-3,8,10-11"
+static bool ggml_sysfs_read_cpulist(const char * path, bool * mask) {
+    FILE * f = fopen(path, "r");
+    if (f == NULL) {
+        return false;
+    }
+    int a;
+    int b;
+    while (fscanf(f, "%d", &a) == 1) {
+        b = a;
+        int c = fgetc(f);
+        if (c == '-') {
+            if (fscanf(f, "%d", &b) != 1) {
+                break;
+            }
+            c = fgetc(f);
+        }
+        for (int i = MAX(a, 0); i <= b && i < GGML_MAX_N_THREADS; i++) {
+            mask[i] = true;
+        }
+        if (c != ',') {
+            break;
+        }
+    }
+    fclose(f);
+    return true;
+}
+#endif
+
+// discovers the physical cores, SMT siblings, L3 domains and the relative performance of the CPUs from sysfs
+static void ggml_cpu_topology_init(struct ggml_cpu_topology * topo) {
+    memset(topo, 0, sizeof(*topo));
+
+#if defined(__gnu_linux__)
+    char path[256];
+
+    // E-cores of Intel hybrid CPUs
+    bool atom[GGML_MAX_N_THREADS] = { false };
+    ggml_sysfs_read_cpulist("/sys/devices/cpu_atom/cpus", atom);
+
+    int64_t core_key[GGML_MAX_N_THREADS];
+    int32_t core_n_cpus[GGML_MAX_N_THREADS];
+
+    int64_t capacity_max = 0;
+
+    for (int i = 0; i < GGML_MAX_N_THREADS; i++) {
+        struct stat st;
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", i);
+        if (stat(path, &st) != 0) {
+            break;
+        }
+        topo->n_cpus = i + 1;
+
+        struct ggml_cpu_topo_cpu * cpu = &topo->cpus[i];
+
+        int64_t v = 1;
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/online", i);
+        cpu->online = !ggml_sysfs_read_int(path, &v) || v != 0; // cpu0 usually has no online file
+        if (!cpu->online) {
+            continue;
+        }
+
+        int64_t package = 0;
+        int64_t core_id = i;
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", i);
+        ggml_sysfs_read_int(path, &package);
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/core_id", i);
+        ggml_sysfs_read_int(path, &core_id);
+
+        // core_id is only unique within a package
+        const int64_t key = (package << 32) | (core_id & 0xffffffff);
+        cpu->core = topo->n_cores;
+        for (int c = 0; c < topo->n_cores; c++) {
+            if (core_key[c] == key) {
+                cpu->core = c;
+                break;
+            }
+        }
+        if (cpu->core == topo->n_cores) {
+            core_key[topo->n_cores]    = key;
+            core_n_cpus[topo->n_cores] = 0;
+            topo->n_cores++;
+        }
+        cpu->smt = core_n_cpus[cpu->core]++;
+
+        int64_t l3 = package;
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index3/id", i);
+        ggml_sysfs_read_int(path, &l3);
+        cpu->l3 = (int32_t) l3;
+
+        // cpu_capacity on ARM big.LITTLE, otherwise the max frequency is a good enough proxy
+        int64_t capacity = 0;
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpu_capacity", i);
+        if (!ggml_sysfs_read_int(path, &capacity)) {
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", i);
+            ggml_sysfs_read_int(path, &capacity);
+        }
+        cpu->capacity = (int32_t) MIN(capacity, INT32_MAX);
+        capacity_max  = MAX(capacity_max, capacity);
+    }
+
+    for (int i = 0; i < topo->n_cpus; i++) {
+        struct ggml_cpu_topo_cpu * cpu = &topo->cpus[i];
+        if (!cpu->online) {
+            continue;
+        }
+
+        cpu->capacity = capacity_max > 0 && cpu->capacity > 0 ? (int32_t) (1024*(int64_t) cpu->capacity/capacity_max) : 1024;
+
+        // the fastest cores differ by a few percent on some CPUs (favored cores), do not count them as hybrid
+        cpu->perf = !atom[i] && cpu->capacity >= 820;
+
+        topo->hybrid = topo->hybrid || !cpu->perf;
+    }
+
+    GGML_PRINT_DEBUG("%s: %d CPUs, %d cores, hybrid: %d\n", __func__, topo->n_cpus, topo->n_cores, topo->hybrid);
+#endif
+}
+
 void ggml_numa_init(enum ggml_numa_strategy numa_flag) {
     if (g_state.numa.n_nodes > 0) {
         fprintf(stderr, "ggml_numa_init: NUMA already initialized\n");
@@ -1360,7 +1560,8 @@ UseGgmlGemm2:;
     // If the chunking is poor for the number of threads on this setup, scrap the whole plan.  Re-chunk it by thread.
     //   Also, chunking by thread was measured to have perform better on NUMA systems.  See https://github.com/ggml-org/llama.cpp/pull/6915
     //   In theory, chunking should be just as useful on NUMA and non NUMA systems, but testing disagreed with that.
-    if (nchunk0 * nchunk1 < nth * 4 || ggml_is_numa()) {
+    const bool chunk_by_thread = nchunk0 * nchunk1 < nth * 4 || ggml_is_numa();
+    if (chunk_by_thread) {
         // distribute the thread work across the inner or outer loop based on which one is larger
         nchunk0 = nr0 > nr1 ? nth : 1; // parallelize by src0 rows
         nchunk1 = nr0 > nr1 ? 1 : nth; // parallelize by src1 rows
@@ -1377,11 +1578,20 @@ UseGgmlGemm2:;
         const int64_t ith0 = current_chunk % nchunk0;
         const int64_t ith1 = current_chunk / nchunk0;
 
-        const int64_t ir0_start = dr0 * ith0;
-        const int64_t ir0_end = MIN(ir0_start + dr0, nr0);
+        int64_t ir0_start = dr0 * ith0;
+        int64_t ir0_end = MIN(ir0_start + dr0, nr0);
 
-        const int64_t ir1_start = dr1 * ith1;
-        const int64_t ir1_end = MIN(ir1_start + dr1, nr1);
+        int64_t ir1_start = dr1 * ith1;
+        int64_t ir1_end = MIN(ir1_start + dr1, nr1);
+
+        if (chunk_by_thread) {
+            // one chunk per thread, sized by the capacity of the CPU of the thread on hybrid CPUs
+            if (nchunk0 > 1) {
+                ggml_thread_range(params, nr0, &ir0_start, &ir0_end);
+            } else {
+                ggml_thread_range(params, nr1, &ir1_start, &ir1_end);
+            }
+        }
 
         // dot kernels can handle 1 row and col at a time, but mmla kernels can process 2 rows and cols
         int64_t num_rows_per_vec_dot = vec_dot_num_rows;
@@ -1619,7 +1829,8 @@ static void ggml_compute_forward_mul_mat_id(
         int64_t nchunk0 = (nr0 + chunk_size - 1) / chunk_size;
         int64_t nchunk1 = (nr1 + chunk_size - 1) / chunk_size;
 
-        if (nchunk0 * nchunk1 < nth * 4 || disable_chunking) {
+        const bool chunk_by_thread = nchunk0 * nchunk1 < nth * 4 || disable_chunking;
+        if (chunk_by_thread) {
             nchunk0 = nr0 > nr1 ? nth : 1;
             nchunk1 = nr0 > nr1 ? 1 : nth;
         }
@@ -1635,11 +1846,19 @@ static void ggml_compute_forward_mul_mat_id(
             const int64_t ith0 = current_chunk % nchunk0;
             const int64_t ith1 = current_chunk / nchunk0;
 
-            const int64_t ir0_start = dr0 * ith0;
-            const int64_t ir0_end = MIN(ir0_start + dr0, nr0);
+            int64_t ir0_start = dr0 * ith0;
+            int64_t ir0_end = MIN(ir0_start + dr0, nr0);
 
-            const int64_t ir1_start = dr1 * ith1;
-            const int64_t ir1_end = MIN(ir1_start + dr1, nr1);
+            int64_t ir1_start = dr1 * ith1;
+            int64_t ir1_end = MIN(ir1_start + dr1, nr1);
+
+            if (chunk_by_thread) {
+                if (nchunk0 > 1) {
+                    ggml_thread_range(params, nr0, &ir0_start, &ir0_end);
+                } else {
+                    ggml_thread_range(params, nr1, &ir1_start, &ir1_end);
+                }
+            }
 
             ggml_compute_forward_mul_mat_id_one_chunk(
                 dst, src0, src1, ids, cur_a,
@@ -1927,6 +2146,10 @@ static void ggml_compute_forward(struct ggml_compute_params * params, struct ggm
             {
                 ggml_compute_forward_argsort(params, tensor);
             } break;
+        case GGML_OP_TOP_K:
+            {
+                ggml_compute_forward_top_k(params, tensor);
+            } break;
         case GGML_OP_LEAKY_RELU:
             {
                 ggml_compute_forward_leaky_relu(params, tensor);
@@ -2159,9 +2382,6 @@ static int ggml_get_n_tasks(struct ggml_tensor * node, int n_threads) {
         case GGML_OP_CUMSUM:
         case GGML_OP_TRI:
         case GGML_OP_FILL:
-            {
-                n_tasks = n_threads;
-            } break;
         case GGML_OP_SUB:
         case GGML_OP_SQR:
         case GGML_OP_SQRT:
@@ -2172,19 +2392,13 @@ static int ggml_get_n_tasks(struct ggml_tensor * node, int n_threads) {
         case GGML_OP_SUM_ROWS:
         case GGML_OP_MEAN:
         case GGML_OP_ARGMAX:
-            {
-                n_tasks = 1;
-            } break;
         case GGML_OP_COUNT_EQUAL:
         case GGML_OP_SOLVE_TRI:
-            {
-                n_tasks = n_threads;
-            } break;
         case GGML_OP_REPEAT:
         case GGML_OP_REPEAT_BACK:
         case GGML_OP_LEAKY_RELU:
             {
-                n_tasks = 1;
+                n_tasks = n_threads;
             } break;
         case GGML_OP_UNARY:
             switch (ggml_get_unary_op(node)) {
@@ -2285,7 +2499,8 @@ static int ggml_get_n_tasks(struct ggml_tensor * node, int n_threads) {
             } break;
         case GGML_OP_SOFT_MAX:
             {
-                n_tasks = MIN(n_threads, ggml_nrows(node->src[0]));
+                // few wide rows are split into chunks, see ggml_compute_forward_soft_max
+                n_tasks = n_threads;
             } break;
         case GGML_OP_IM2COL:
         case GGML_OP_IM2COL_BACK:
@@ -2298,8 +2513,11 @@ static int ggml_get_n_tasks(struct ggml_tensor * node, int n_threads) {
             {
                 n_tasks = n_threads;
             } break;
-        case GGML_OP_POOL_1D:
         case GGML_OP_POOL_2D:
+            {
+                n_tasks = n_threads;
+            } break;
+        case GGML_OP_POOL_1D:
         case GGML_OP_POOL_2D_BACK:
             {
                 n_tasks = 1;
@@ -2311,6 +2529,7 @@ static int ggml_get_n_tasks(struct ggml_tensor * node, int n_threads) {
         case GGML_OP_ARANGE:
         case GGML_OP_TIMESTEP_EMBEDDING:
         case GGML_OP_ARGSORT:
+        case GGML_OP_TOP_K:
         case GGML_OP_FLASH_ATTN_EXT:
         case GGML_OP_FLASH_ATTN_BACK:
         case GGML_OP_SSM_CONV:
@@ -2323,6 +2542,9 @@ static int ggml_get_n_tasks(struct ggml_tensor * node, int n_threads) {
             } break;
         case GGML_OP_WIN_PART:
         case GGML_OP_WIN_UNPART:
+            {
+                n_tasks = n_threads;
+            } break;
         case GGML_OP_GET_REL_POS:
             {
                 n_tasks = 1;
@@ -2647,6 +2869,7 @@ void ggml_threadpool_free(struct ggml_threadpool* threadpool) {
 
     const size_t workers_size = sizeof(struct ggml_compute_state) * n_threads;
     ggml_aligned_free(threadpool->workers, workers_size);
+    free(threadpool->capacity);
     ggml_aligned_free(threadpool, sizeof(struct ggml_threadpool));
 }
 
@@ -2689,22 +2912,80 @@ void ggml_threadpool_resume(struct ggml_threadpool * threadpool) {
 #endif
 }
 
-struct ggml_cplan ggml_graph_plan(
-          const struct ggml_cgraph * cgraph,
-                               int   n_threads,
-            struct ggml_threadpool * threadpool) {
+// two ROPE nodes can share the sin/cos table if they use the same positions and parameters
+static bool ggml_rope_cache_match(const struct ggml_tensor * a, const struct ggml_tensor * b) {
+    return a->op == b->op &&
+           a->src[1] == b->src[1] && a->src[2] == b->src[2] &&
+           a->ne[0] == b->ne[0] && a->ne[2] == b->ne[2] &&
+           memcmp(a->op_params, b->op_params, 15*sizeof(int32_t)) == 0;
+}
 
-    if (threadpool == NULL) {
-        //GGML_PRINT_DEBUG("Threadpool is not specified. Will create a disposable threadpool : n_threads %d\n", n_threads);
+// find the groups of ROPE nodes that can share a sin/cos table, returns the size of the tables
+// the positions and freq factors have to be graph inputs so that they do not change during the computation
+static size_t ggml_graph_rope_cache(const struct ggml_cgraph * cgraph, struct ggml_rope_cache_entry * entries, int * n_entries) {
+    size_t size = 0;
+
+    *n_entries = 0;
+
+    for (int i = 0; i < cgraph->n_nodes; ++i) {
+        const struct ggml_tensor * node = cgraph->nodes[i];
+
+        if (node->op != GGML_OP_ROPE && node->op != GGML_OP_ROPE_BACK) {
+            continue;
+        }
+        if (node->src[1]->op != GGML_OP_NONE || (node->src[2] && node->src[2]->op != GGML_OP_NONE)) {
+            continue;
+        }
+        if (*n_entries == GGML_ROPE_CACHE_MAX) {
+            break;
+        }
+
+        bool found = false;
+        for (int j = 0; j < *n_entries && !found; ++j) {
+            found = ggml_rope_cache_match(entries[j].node, node);
+        }
+        if (found) {
+            continue;
+        }
+
+        // only worth it if the table is used by more than one node
+        bool shared = false;
+        for (int j = i + 1; j < cgraph->n_nodes && !shared; ++j) {
+            shared = ggml_rope_cache_match(cgraph->nodes[j], node);
+        }
+        if (!shared) {
+            continue;
+        }
+
+        size += GGML_PAD(node->ne[0]*node->ne[2]*sizeof(float), CACHE_LINE_SIZE);
+
+        entries[(*n_entries)++] = (struct ggml_rope_cache_entry) {
+            /*.node =*/ node,
+            /*.offs =*/ size,
+        };
     }
-    if (n_threads <= 0) {
-        n_threads = threadpool ? threadpool->n_threads_max : GGML_DEFAULT_N_THREADS;
+
+    return size;
+}
+
+float * ggml_cpu_rope_cache(const struct ggml_compute_params * params, const struct ggml_tensor * node, bool * init) {
+    const struct ggml_threadpool * tp = params->threadpool;
+
+    for (int i = 0; i < tp->n_rope_cache; ++i) {
+        const struct ggml_rope_cache_entry * e = &tp->rope_cache[i];
+        if (ggml_rope_cache_match(e->node, node)) {
+            *init = e->node == node;
+            return (float *) ((char *) params->wdata + params->wsize + tp->rope_cache_size - e->offs);
+        }
     }
 
-    size_t work_size = 0;
+    *init = false;
+    return NULL;
+}
 
-    struct ggml_cplan cplan;
-    memset(&cplan, 0, sizeof(struct ggml_cplan));
+// size of the work buffer of the ops of the graph, and the max number of threads of a node
+static size_t ggml_graph_work_size(const struct ggml_cgraph * cgraph, int n_threads, int * max_tasks_out) {
+    size_t work_size = 0;
 
     int max_tasks = 1;
 
@@ -2723,7 +3004,7 @@ struct ggml_cplan ggml_graph_plan(
                 case GGML_OP_CPY:
                 case GGML_OP_DUP:
                     {
-                        if (ggml_is_quantized(node->type) ||
+                        if (ggml_is_quantized(node->type) || ggml_is_fp8(node->type) ||
                             // F16 -> BF16 and BF16 -> F16 copies go through intermediate F32
                             (node->src[0]->type == GGML_TYPE_F16  && node->src[1] && node->src[1]->type == GGML_TYPE_BF16) ||
                             (node->src[0]->type == GGML_TYPE_BF16 && node->src[1] && node->src[1]->type == GGML_TYPE_F16) ||
@@ -2737,13 +3018,13 @@ struct ggml_cplan ggml_graph_plan(
                 case GGML_OP_ADD_ID:
                 case GGML_OP_ADD1:
                     {
-                        if (ggml_is_quantized(node->src[0]->type)) {
+                        if (ggml_is_quantized(node->src[0]->type) || ggml_is_fp8(node->src[0]->type)) {
                             cur = ggml_type_size(GGML_TYPE_F32) * node->src[0]->ne[0] * n_tasks;
                         }
                     } break;
                 case GGML_OP_ACC:
                     {
-                        if (ggml_is_quantized(node->src[0]->type)) {
+                        if (ggml_is_quantized(node->src[0]->type) || ggml_is_fp8(node->src[0]->type)) {
                             cur = ggml_type_size(GGML_TYPE_F32) * node->src[1]->ne[0] * n_tasks;
                         }
                     } break;
@@ -2751,6 +3032,23 @@ struct ggml_cplan ggml_graph_plan(
                     {
                         cur = ggml_type_size(node->type)*n_tasks;
                     } break;
+                case GGML_OP_SUM:
+                case GGML_OP_SUM_ROWS:
+                case GGML_OP_MEAN:
+                    {
+                        cur = sizeof(ggml_float)*GGML_REDUCE_MAX_CHUNKS;
+                    } break;
+                case GGML_OP_ARGMAX:
+                    {
+                        cur = (sizeof(float) + sizeof(int32_t))*GGML_REDUCE_MAX_CHUNKS;
+                    } break;
+                case GGML_OP_TOP_K:
+                    {
+                        // per-thread heaps and the candidates of the chunks of wide rows, see ggml_compute_forward_top_k
+                        const int64_t k = ggml_get_op_params_i32(node, 0);
+                        cur  = (sizeof(float) + sizeof(int32_t))*(k + CACHE_LINE_SIZE_F32)*n_tasks;
+                        cur += (sizeof(float) + sizeof(int32_t))*MIN(k*GGML_REDUCE_MAX_CHUNKS, ggml_nelements(node->src[0])/2);
+                    } break;
                 case GGML_OP_MUL_MAT:
                     {
                         const enum ggml_type vec_dot_type = type_traits_cpu[node->src[0]->type].vec_dot_type;
@@ -2780,11 +3078,14 @@ struct ggml_cplan ggml_graph_plan(
                     } break;
                 case GGML_OP_OUT_PROD:
                     {
-                        if (ggml_is_quantized(node->src[0]->type)) {
+                        if (ggml_is_quantized(node->src[0]->type) || ggml_is_fp8(node->src[0]->type)) {
                             cur = ggml_type_size(GGML_TYPE_F32) * node->src[0]->ne[0] * n_tasks;
                         }
                     } break;
                 case GGML_OP_SOFT_MAX:
+                    {
+                        cur = (sizeof(float) + sizeof(ggml_float))*GGML_REDUCE_MAX_CHUNKS;
+                    } break;
                 case GGML_OP_ROPE:
                 case GGML_OP_ROPE_BACK:
                     {
@@ -2816,6 +3117,9 @@ struct ggml_cplan ggml_graph_plan(
                         }
                     } break;
                 case GGML_OP_CONV_2D:
+                    {
+                        cur = ggml_conv_2d_work_size(node, n_tasks);
+                    } break;
                 case GGML_OP_CONV_3D:
                     {
                         cur = GGML_IM2COL_WORK_SIZE;
@@ -2841,6 +3145,35 @@ struct ggml_cplan ggml_graph_plan(
 
                         cur = sizeof(float)*(1*ne10 + 2*ne20)*n_tasks; // 1x head size K + 2x head size V (per thread)
                     } break;
+                case GGML_OP_SSM_SCAN:
+                    {
+                        const int64_t n_seg = ggml_ssm_scan_n_segments(node, n_tasks);
+                        if (n_seg > 1) {
+                            const int64_t d_state = node->src[0]->ne[0];
+                            const int64_t head_dim = node->src[0]->ne[1];
+                            const int64_t n_head   = node->src[1]->ne[1];
+
+                            cur = sizeof(float)*((n_seg - 1)*n_head*head_dim*d_state + n_seg*n_head);
+                        }
+                    } break;
+                case GGML_OP_RWKV_WKV6:
+                case GGML_OP_GATED_LINEAR_ATTN:
+                case GGML_OP_RWKV_WKV7:
+                    {
+                        const int64_t n_seg = ggml_wkv_n_segments(node, n_tasks);
+                        if (n_seg > 1) {
+                            const int64_t n_head    = node->src[1]->ne[1];
+                            const int64_t head_size = node->ne[0] / n_head;
+
+                            if (node->op == GGML_OP_RWKV_WKV7) {
+                                // states and transition matrices
+                                cur = sizeof(float)*2*(n_seg - 1)*n_head*head_size*head_size;
+                            } else {
+                                // states, decays and per-thread scratch
+                                cur = sizeof(float)*((n_seg - 1)*n_head*(head_size + 1)*head_size + 3*head_size*n_tasks);
+                            }
+                        }
+                    } break;
                 case GGML_OP_FLASH_ATTN_BACK:
                     {
                         const int64_t    D = node->src[0]->ne[0];
@@ -2878,14 +3211,171 @@ struct ggml_cplan ggml_graph_plan(
         work_size += CACHE_LINE_SIZE*(n_threads);
     }
 
-    cplan.threadpool = threadpool;
-    cplan.n_threads  = MIN(max_tasks, n_threads);
-    cplan.work_size  = work_size;
-    cplan.work_data  = NULL;
+    if (max_tasks_out) {
+        *max_tasks_out = max_tasks;
+    }
+
+    return work_size;
+}
+
+struct ggml_cplan ggml_graph_plan(
+          const struct ggml_cgraph * cgraph,
+                               int   n_threads,
+            struct ggml_threadpool * threadpool) {
+
+    if (threadpool == NULL) {
+        //GGML_PRINT_DEBUG("Threadpool is not specified. Will create a disposable threadpool : n_threads %d\n", n_threads);
+    }
+    if (n_threads <= 0) {
+        n_threads = threadpool ? threadpool->n_threads_max : GGML_DEFAULT_N_THREADS;
+    }
+
+    struct ggml_cplan cplan;
+    memset(&cplan, 0, sizeof(struct ggml_cplan));
+
+    int max_tasks = 1;
+
+    size_t work_size = ggml_graph_work_size(cgraph, n_threads, &max_tasks);
+
+    // the shared RoPE tables are stored at the end of the work buffer
+    {
+        struct ggml_rope_cache_entry rope_cache[GGML_ROPE_CACHE_MAX];
+        int n_rope_cache;
+
+        work_size += ggml_graph_rope_cache(cgraph, rope_cache, &n_rope_cache);
+    }
+
+    cplan.threadpool    = threadpool;
+    cplan.n_threads     = MIN(max_tasks, n_threads);
+    cplan.work_size     = work_size;
+    cplan.work_data     = NULL;
+    cplan.node_min_work = -1;
 
     return cplan;
 }
 
+// rough estimate of the work of a node, in element-wise operations
+// INT64_MAX for the ops that always use all the threads
+static int64_t ggml_graph_node_work(const struct ggml_tensor * node) {
+    const struct ggml_tensor * src0 = node->src[0];
+
+    switch (node->op) {
+        case GGML_OP_MUL_MAT:
+        case GGML_OP_MUL_MAT_ID:
+            return src0->ne[0]*ggml_nelements(node);
+        case GGML_OP_OUT_PROD:
+            return src0->ne[1]*ggml_nelements(node);
+        case GGML_OP_CPY:
+        case GGML_OP_DUP:
+        case GGML_OP_CONT:
+        case GGML_OP_SET_ROWS:
+            // (de)quantization is several times more expensive than a copy
+            return (ggml_is_quantized(src0->type) || ggml_is_quantized(node->type) ||
+                    ggml_is_fp8(src0->type) || ggml_is_fp8(node->type) ? 8 : 1)*ggml_nelements(src0);
+        case GGML_OP_GET_ROWS:
+            return (ggml_is_quantized(src0->type) || ggml_is_fp8(src0->type) ? 8 : 1)*ggml_nelements(node);
+        case GGML_OP_ADD:
+        case GGML_OP_ADD_ID:
+        case GGML_OP_ADD1:
+        case GGML_OP_ACC:
+        case GGML_OP_SUB:
+        case GGML_OP_MUL:
+        case GGML_OP_DIV:
+        case GGML_OP_SQR:
+        case GGML_OP_SQRT:
+        case GGML_OP_SCALE:
+        case GGML_OP_SET:
+        case GGML_OP_CLAMP:
+        case GGML_OP_LEAKY_RELU:
+        case GGML_OP_REPEAT:
+        case GGML_OP_CONCAT:
+        case GGML_OP_FILL:
+        case GGML_OP_TRI:
+        case GGML_OP_PAD:
+        case GGML_OP_ROLL:
+        case GGML_OP_DIAG_MASK_ZERO:
+        case GGML_OP_DIAG_MASK_INF:
+        case GGML_OP_WIN_PART:
+        case GGML_OP_WIN_UNPART:
+            return ggml_nelements(node);
+        case GGML_OP_SUM:
+        case GGML_OP_SUM_ROWS:
+        case GGML_OP_MEAN:
+        case GGML_OP_ARGMAX:
+        case GGML_OP_COUNT_EQUAL:
+        case GGML_OP_REPEAT_BACK:
+        case GGML_OP_CUMSUM:
+        case GGML_OP_POOL_2D:
+            return ggml_nelements(src0);
+        case GGML_OP_LOG:
+        case GGML_OP_SIN:
+        case GGML_OP_COS:
+        case GGML_OP_UNARY:
+        case GGML_OP_GLU:
+        case GGML_OP_SILU_BACK:
+        case GGML_OP_NORM:
+        case GGML_OP_RMS_NORM:
+        case GGML_OP_RMS_NORM_BACK:
+        case GGML_OP_L2_NORM:
+        case GGML_OP_SOFT_MAX:
+        case GGML_OP_SOFT_MAX_BACK:
+        case GGML_OP_ROPE:
+        case GGML_OP_ROPE_BACK:
+            return 4*ggml_nelements(src0);
+        default:
+            return INT64_MAX;
+    }
+}
+
+// number of threads that work on a node, the threads with ith >= the result skip it
+static int ggml_graph_node_n_threads(const struct ggml_threadpool * tp, struct ggml_tensor * node, int n_threads) {
+    switch (node->op) {
+        case GGML_OP_MAP_CUSTOM1:
+        case GGML_OP_MAP_CUSTOM2:
+        case GGML_OP_MAP_CUSTOM3:
+        case GGML_OP_CUSTOM:
+            // the requested number of tasks
+            return ggml_get_n_tasks(node, n_threads);
+        default:
+            break;
+    }
+
+    if (tp->node_min_work <= 0 || n_threads == 1) {
+        return n_threads;
+    }
+
+    const int64_t work = ggml_graph_node_work(node);
+    if (work == INT64_MAX) {
+        return n_threads;
+    }
+
+    return (int) MAX(1, MIN(work/tp->node_min_work, n_threads));
+}
+
+static int ggml_graph_next_node(const struct ggml_cgraph * cgraph, int node_n) {
+    // skip NOPs
+    do {
+        node_n++;
+    } while (node_n < cgraph->n_nodes && ggml_op_is_empty(cgraph->nodes[node_n]->op));
+
+    return node_n;
+}
+
+// the last node computed together with the node at node_n, node_n if it is computed alone
+// every thread finds the same nodes, as the fused nodes only depend on the graph
+static int ggml_graph_fused_nodes(const struct ggml_cgraph * cgraph, int node_n, struct ggml_conv_2d_epilogue * conv_2d_ep) {
+    if (g_state.no_fusion) {
+        return node_n;
+    }
+
+    switch (cgraph->nodes[node_n]->op) {
+        case GGML_OP_CONV_2D:
+            return ggml_conv_2d_epilogue_init(cgraph, node_n, conv_2d_ep);
+        default:
+            return node_n;
+    }
+}
+
 static thread_ret_t ggml_graph_compute_thread(void * data) {
     struct ggml_compute_state * state = (struct ggml_compute_state *) data;
     struct ggml_threadpool    * tp    = state->threadpool;
@@ -2895,36 +3385,88 @@ static thread_ret_t ggml_graph_compute_thread(void * data) {
 
     set_numa_thread_affinity(state->ith);
 
+    const int n_threads = atomic_load_explicit(&tp->n_threads_cur, memory_order_relaxed);
+
     struct ggml_compute_params params = {
         /*.ith       =*/ state->ith,
-        /*.nth       =*/ atomic_load_explicit(&tp->n_threads_cur, memory_order_relaxed),
-        /*.wsize     =*/ cplan->work_size,
+        /*.nth       =*/ n_threads,
+        /*.wsize     =*/ cplan->work_size - tp->rope_cache_size,
         /*.wdata     =*/ cplan->work_data,
         /*.threadpool=*/ tp,
     };
 
-    for (int node_n = 0; node_n < cgraph->n_nodes && atomic_load_explicit(&tp->abort, memory_order_relaxed) != node_n; node_n++) {
+    struct ggml_cpu_profile_sample * sample = NULL;
+
+    int node_n = ggml_graph_next_node(cgraph, -1);
+    int nth    = node_n < cgraph->n_nodes ? ggml_graph_node_n_threads(tp, cgraph->nodes[node_n], n_threads) : 0;
+
+    bool aborted = false; // only set in thread 0
+
+    while (node_n < cgraph->n_nodes && atomic_load_explicit(&tp->abort, memory_order_relaxed) != node_n) {
         struct ggml_tensor * node = cgraph->nodes[node_n];
 
-        if (ggml_op_is_empty(node->op)) {
-            // skip NOPs
-            continue;
-        }
+        struct ggml_conv_2d_epilogue conv_2d_ep;
+
+        const int node_last = ggml_graph_fused_nodes(cgraph, node_n, &conv_2d_ep);
+        const int node_next = ggml_graph_next_node(cgraph, node_last);
+        const int nth_next  = node_next < cgraph->n_nodes ? ggml_graph_node_n_threads(tp, cgraph->nodes[node_next], n_threads) : 0;
+
+        // consecutive single-threaded nodes are all computed by thread 0 without barriers in between
+        const bool sync = node_next < cgraph->n_nodes && (nth > 1 || nth_next > 1);
+
+        sample = NULL;
+
+        if (state->ith < nth && !aborted) {
+            params.nth = nth;
+
+            // all the threads of the node store the same value before using it in ggml_barrier
+            atomic_store_explicit(&tp->n_threads_node, nth, memory_order_relaxed);
+
+            if (tp->prof_samples) {
+                sample = &tp->prof_samples[node_n*tp->prof_n_threads + state->ith];
+                sample->t_start = ggml_cpu_profile_time_ns();
+            }
+
+            if (node_last != node_n) {
+                ggml_compute_forward_conv_2d_fused(&params, node, &conv_2d_ep);
+            } else {
+                ggml_compute_forward(&params, node);
+            }
 
-        ggml_compute_forward(&params, node);
+            if (sample) {
+                sample->t_end  = ggml_cpu_profile_time_ns();
+                sample->t_sync = sample->t_end;
+            }
 
-        if (state->ith == 0 && cplan->abort_callback &&
-                cplan->abort_callback(cplan->abort_callback_data)) {
-            atomic_store_explicit(&tp->abort, node_n + 1, memory_order_relaxed);
+            if (state->ith == 0 && cplan->abort_callback && cplan->abort_callback(cplan->abort_callback_data)) {
+                aborted = true;
+            }
+        }
+
+        // only abort where all the threads meet, so that they all stop at the same node
+        // until then, thread 0 skips the single-threaded nodes that it computes without barriers
+        if (aborted && (sync || node_next == cgraph->n_nodes)) {
+            atomic_store_explicit(&tp->abort, node_next, memory_order_relaxed);
             tp->ec    = GGML_STATUS_ABORTED;
         }
 
-        if (node_n + 1 < cgraph->n_nodes) {
-            ggml_barrier(state->threadpool);
+        if (sync) {
+            ggml_barrier_graph(state->threadpool);
+
+            if (sample) {
+                sample->t_sync = ggml_cpu_profile_time_ns();
+            }
         }
+
+        node_n = node_next;
+        nth    = nth_next;
     }
 
-    ggml_barrier(state->threadpool);
+    ggml_barrier_graph(state->threadpool);
+
+    if (sample) {
+        sample->t_sync = ggml_cpu_profile_time_ns();
+    }
 
     return 0;
 }
@@ -3076,6 +3618,184 @@ static void ggml_graph_compute_kickoff(struct ggml_threadpool * threadpool, int
 
 #endif // GGML_USE_OPENMP
 
+struct ggml_cpu_placement_key {
+    int32_t tier; // 0 for the CPUs of the placement policy
+    int32_t perf;
+    int32_t smt;
+    int32_t l3;
+    int32_t cpu;
+};
+
+static int ggml_cpu_placement_key_cmp(const void * a, const void * b) {
+    const struct ggml_cpu_placement_key * ka = a;
+    const struct ggml_cpu_placement_key * kb = b;
+
+    if (ka->tier != kb->tier) return ka->tier - kb->tier;
+    if (ka->perf != kb->perf) return kb->perf - ka->perf;
+    if (ka->smt  != kb->smt ) return ka->smt  - kb->smt;
+    if (ka->l3   != kb->l3  ) return ka->l3   - kb->l3;
+    return ka->cpu - kb->cpu;
+}
+
+// CPU of each thread according to the placement policy, only the CPUs set in allowed are used (all if allowed is NULL)
+// returns false if the topology is unknown
+static bool ggml_cpu_topology_place_impl(const struct ggml_cpu_topology * topo, enum ggml_threadpool_placement placement,
+        int n_threads, const bool * allowed, int * cpu_of) {
+    struct ggml_cpu_placement_key keys[GGML_MAX_N_THREADS];
+    int n_keys     = 0;
+    int n_eligible = 0;
+
+    for (int i = 0; i < topo->n_cpus; i++) {
+        const struct ggml_cpu_topo_cpu * cpu = &topo->cpus[i];
+        if (!cpu->online || (allowed && !allowed[i])) {
+            continue;
+        }
+
+        bool eligible = true;
+        switch (placement) {
+            case GGML_THREADPOOL_PLACEMENT_CORES:      eligible = cpu->smt == 0;              break;
+            case GGML_THREADPOOL_PLACEMENT_PERF:       eligible = cpu->perf;                  break;
+            case GGML_THREADPOOL_PLACEMENT_PERF_CORES: eligible = cpu->perf && cpu->smt == 0; break;
+            default: break;
+        }
+
+        keys[n_keys++] = (struct ggml_cpu_placement_key) { eligible ? 0 : 1, cpu->perf, cpu->smt, cpu->l3, i };
+        n_eligible += eligible;
+    }
+
+    if (n_keys == 0) {
+        return false;
+    }
+
+    if (n_threads > n_keys) {
+        GGML_LOG_WARN("%s: %d threads for %d CPUs, some CPUs will run more than one thread\n", __func__, n_threads, n_keys);
+    } else if (n_threads > n_eligible) {
+        GGML_LOG_WARN("%s: %d threads for %d CPUs of the placement policy, using other CPUs too\n", __func__, n_threads, n_eligible);
+    }
+
+    qsort(keys, n_keys, sizeof(keys[0]), ggml_cpu_placement_key_cmp);
+
+    // the fastest CPU goes to thread 0, which also computes the nodes that use a single thread
+    for (int j = 0; j < n_threads; j++) {
+        cpu_of[j] = keys[j % n_keys].cpu;
+    }
+
+    return true;
+}
+
+// pins each thread to one CPU according to the placement policy, returns false if the topology is unknown
+static bool ggml_threadpool_place(struct ggml_compute_state * workers, int n_threads, enum ggml_threadpool_placement placement) {
+    const bool * allowed = NULL;
+
+#if defined(__gnu_linux__)
+    // stay within the affinity of the process, e.g. from taskset
+    bool mask[GGML_MAX_N_THREADS];
+    cpu_set_t cpuset = ggml_get_numa_affinity();
+    for (int i = 0; i < GGML_MAX_N_THREADS; i++) {
+        mask[i] = CPU_ISSET(i, &cpuset);
+    }
+    allowed = mask;
+#endif
+
+    int cpu_of[GGML_MAX_N_THREADS];
+    if (!ggml_cpu_topology_place_impl(&g_state.topo, placement, n_threads, allowed, cpu_of)) {
+        return false;
+    }
+
+    for (int j = 0; j < n_threads; j++) {
+        memset(workers[j].cpumask, 0, GGML_MAX_N_THREADS);
+        workers[j].cpumask[cpu_of[j]] = true;
+    }
+
+    return true;
+}
+
+// relative capacity of threads that are each pinned to the CPU cpu_of[j]
+// returns the prefix sums, or NULL if all the threads have the same capacity
+static float * ggml_cpu_topology_capacity(const struct ggml_cpu_topology * topo, int n_threads, const int * cpu_of) {
+    if (!topo->hybrid) {
+        return NULL;
+    }
+
+    int n_on_core[GGML_MAX_N_THREADS] = { 0 };
+    for (int j = 0; j < n_threads; j++) {
+        n_on_core[topo->cpus[cpu_of[j]].core]++;
+    }
+
+    float * capacity = malloc((n_threads + 1)*sizeof(float));
+
+    bool uniform = true;
+
+    capacity[0] = 0.0f;
+    for (int j = 0; j < n_threads; j++) {
+        const struct ggml_cpu_topo_cpu * cpu = &topo->cpus[cpu_of[j]];
+
+        // threads on SMT siblings share their core
+        const float c = (float) cpu->capacity / n_on_core[cpu->core];
+
+        capacity[j + 1] = capacity[j] + c;
+        uniform = uniform && c == capacity[1];
+    }
+
+    if (uniform) {
+        free(capacity);
+        return NULL;
+    }
+
+    return capacity;
+}
+
+// relative capacity of the threads that are pinned to a single CPU, from the topology
+// returns the prefix sums, or NULL if all the threads have the same capacity
+static float * ggml_threadpool_capacity_init(const struct ggml_compute_state * workers, int n_threads) {
+    const struct ggml_cpu_topology * topo = &g_state.topo;
+
+    if (!topo->hybrid) {
+        return NULL;
+    }
+
+    int cpu_of[GGML_MAX_N_THREADS];
+
+    for (int j = 0; j < n_threads; j++) {
+        cpu_of[j] = -1;
+        for (int i = 0; i < topo->n_cpus; i++) {
+            if (workers[j].cpumask[i]) {
+                if (cpu_of[j] >= 0 || !topo->cpus[i].online) {
+                    cpu_of[j] = -1; // not pinned to a single CPU, the capacity is unknown
+                    break;
+                }
+                cpu_of[j] = i;
+            }
+        }
+        if (cpu_of[j] < 0) {
+            return NULL;
+        }
+    }
+
+    return ggml_cpu_topology_capacity(topo, n_threads, cpu_of);
+}
+
+bool ggml_cpu_topology_place(const struct ggml_cpu_topology * topo, enum ggml_threadpool_placement placement, int n_threads,
+        int * cpus, float * capacity) {
+    GGML_ASSERT(n_threads > 0 && n_threads <= GGML_MAX_N_THREADS);
+
+    if (!ggml_cpu_topology_place_impl(topo, placement, n_threads, NULL, cpus)) {
+        return false;
+    }
+
+    float * c = ggml_cpu_topology_capacity(topo, n_threads, cpus);
+    for (int j = 0; j <= n_threads; j++) {
+        capacity[j] = c ? c[j] : 0.0f;
+    }
+    free(c);
+
+    return true;
+}
+
+const float * ggml_threadpool_capacity(const struct ggml_threadpool * tp) {
+    return tp->capacity;
+}
+
 static struct ggml_threadpool * ggml_threadpool_new_impl(
     struct ggml_threadpool_params * tpp,
                struct ggml_cgraph * cgraph,
@@ -3087,8 +3807,10 @@ static struct ggml_threadpool * ggml_threadpool_new_impl(
         threadpool->cgraph           = cgraph;
         threadpool->cplan            = cplan;
         threadpool->n_graph          = 0;
-        threadpool->n_barrier        = 0;
-        threadpool->n_barrier_passed = 0;
+        threadpool->n_barrier             = 0;
+        threadpool->n_barrier_passed      = 0;
+        threadpool->n_barrier_node        = 0;
+        threadpool->n_barrier_node_passed = 0;
         threadpool->current_chunk    = 0;
         threadpool->stop             = false;
         threadpool->pause            = tpp->paused;
@@ -3096,9 +3818,15 @@ static struct ggml_threadpool * ggml_threadpool_new_impl(
         threadpool->workers          = NULL;
         threadpool->n_threads_max    = tpp->n_threads;
         threadpool->n_threads_cur    = tpp->n_threads;
+        threadpool->n_threads_node   = tpp->n_threads;
+        threadpool->node_min_work    = 0;
         threadpool->poll             = tpp->poll;
         threadpool->prio             = tpp->prio;
         threadpool->ec               = GGML_STATUS_SUCCESS;
+        threadpool->prof_samples     = NULL;
+        threadpool->prof_n_threads   = 0;
+        threadpool->n_rope_cache     = 0;
+        threadpool->rope_cache_size  = 0;
     }
 
     // Allocate and init workers state
@@ -3113,31 +3841,38 @@ static struct ggml_threadpool * ggml_threadpool_new_impl(
 
     threadpool->workers = workers;
 
-#ifdef GGML_USE_OPENMP
-    int32_t cpumask_iter = 0;
-
     // Compute CPU masks for each thread
-    for (int j = 0; j < tpp->n_threads; j++) {
-        ggml_thread_cpumask_next(tpp->cpumask, workers[j].cpumask, tpp->strict_cpu, &cpumask_iter);
+    const bool placed = tpp->placement != GGML_THREADPOOL_PLACEMENT_NONE && !ggml_thread_cpumask_is_valid(tpp->cpumask) &&
+        ggml_threadpool_place(workers, tpp->n_threads, tpp->placement);
+
+    if (!placed) {
+        int32_t cpumask_iter = 0;
+
+#ifdef GGML_USE_OPENMP
+        for (int j = 0; j < tpp->n_threads; j++) {
+            ggml_thread_cpumask_next(tpp->cpumask, workers[j].cpumask, tpp->strict_cpu, &cpumask_iter);
+        }
+#else
+        // Place the main thread last (towards the higher numbered CPU cores).
+        for (int j = 1; j < tpp->n_threads; j++) {
+            ggml_thread_cpumask_next(tpp->cpumask, workers[j].cpumask, tpp->strict_cpu, &cpumask_iter);
+        }
+        ggml_thread_cpumask_next(tpp->cpumask, workers[0].cpumask, tpp->strict_cpu, &cpumask_iter);
+#endif
     }
-#else // GGML_USE_OPENMP
-    ggml_mutex_init(&threadpool->mutex);
-    ggml_cond_init(&threadpool->cond);
 
-    // Spin the threads for all workers, and update CPU placements.
-    // Place the main thread last (towards the higher numbered CPU cores).
+    threadpool->capacity = ggml_threadpool_capacity_init(workers, tpp->n_threads);
 
-    int32_t cpumask_iter = 0;
+#ifndef GGML_USE_OPENMP
+    ggml_mutex_init(&threadpool->mutex);
+    ggml_cond_init(&threadpool->cond);
 
+    // Spin the threads for all workers
     for (int j = 1; j < tpp->n_threads; j++) {
-        ggml_thread_cpumask_next(tpp->cpumask, workers[j].cpumask, tpp->strict_cpu, &cpumask_iter);
-
         int32_t rc = ggml_thread_create(&workers[j].thrd, NULL, ggml_graph_compute_secondary_thread, &workers[j]);
         GGML_ASSERT(rc == 0);
     }
 
-    ggml_thread_cpumask_next(tpp->cpumask, workers[0].cpumask, tpp->strict_cpu, &cpumask_iter);
-
     if (!threadpool->pause) {
         // Update main thread prio and affinity at the start, otherwise we'll do it in resume
         ggml_thread_apply_priority(threadpool->prio);
@@ -3145,12 +3880,14 @@ static struct ggml_threadpool * ggml_threadpool_new_impl(
             ggml_thread_apply_affinity(threadpool->workers[0].cpumask);
         }
     }
-#endif // GGML_USE_OPENMP
+#endif // !GGML_USE_OPENMP
 
     return threadpool;
 }
 
 struct ggml_threadpool * ggml_threadpool_new(struct ggml_threadpool_params * tpp) {
+    ggml_cpu_init(); // for the CPU topology
+
     return ggml_threadpool_new_impl(tpp, NULL, NULL);
 }
 
@@ -3182,6 +3919,22 @@ enum ggml_status ggml_graph_compute(struct ggml_cgraph * cgraph, struct ggml_cpl
         threadpool->ec               = GGML_STATUS_SUCCESS;
     }
 
+    // a cplan that was not made by ggml_graph_plan for this graph might not have room for the RoPE tables
+    threadpool->rope_cache_size = ggml_graph_rope_cache(cgraph, threadpool->rope_cache, &threadpool->n_rope_cache);
+    if (threadpool->n_rope_cache > 0 &&
+        ggml_graph_work_size(cgraph, cplan->n_threads, NULL) + threadpool->rope_cache_size > cplan->work_size) {
+        threadpool->n_rope_cache    = 0;
+        threadpool->rope_cache_size = 0;
+    }
+
+    threadpool->node_min_work = cplan->node_min_work < 0 ? g_state.node_min_work : cplan->node_min_work;
+
+    threadpool->prof_samples   = NULL;
+    threadpool->prof_n_threads = MIN(n_threads, threadpool->n_threads_max);
+    if (cplan->profile) {
+        threadpool->prof_samples = ggml_cpu_profile_begin(cplan->profile, cgraph, threadpool->prof_n_threads);
+    }
+
 #ifdef GGML_USE_OPENMP
     if (n_threads > 1) {
         #pragma omp parallel num_threads(n_threads)
@@ -3222,6 +3975,11 @@ enum ggml_status ggml_graph_compute(struct ggml_cgraph * cgraph, struct ggml_cpl
     // don't leave affinity set on the main thread
     clear_numa_thread_affinity();
 
+    if (cplan->profile) {
+        ggml_cpu_profile_end(cplan->profile);
+        threadpool->prof_samples = NULL;
+    }
+
     enum ggml_status ret = threadpool->ec;
 
     if (disposable_threadpool) {
@@ -3615,6 +4373,24 @@ void ggml_cpu_init(void) {
         ggml_init_arm_arch_features();
 #endif
 
+        ggml_cpu_topology_init(&g_state.topo);
+
+        {
+            // off unless requested, tests/test-node-threads --calibrate measures a suitable value for the machine
+            const char * env = getenv("GGML_CPU_NODE_MIN_WORK");
+            g_state.node_min_work = env ? MAX(0, atoll(env)) : 0;
+        }
+
+        g_state.no_fusion = getenv("GGML_CPU_DISABLE_FUSION") != NULL;
+
+#if defined(__AVX2__) && !defined(GGML_BACKEND_DL)
+        // the vectorized K-quant quantizers match the reference, ggml_quantize_chunk uses them when there is no imatrix
+        // not with dynamically loaded backends, where the CPU backend can be unloaded before ggml-base
+        ggml_quantize_set_row_fn(GGML_TYPE_Q4_K, quantize_row_q4_K);
+        ggml_quantize_set_row_fn(GGML_TYPE_Q5_K, quantize_row_q5_K);
+        ggml_quantize_set_row_fn(GGML_TYPE_Q6_K, quantize_row_q6_K);
+#endif
+
         is_first_call = false;
     }
 
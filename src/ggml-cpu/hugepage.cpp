@@ -0,0 +1,164 @@
+#include "ggml-backend.h"
+#include "ggml-backend-impl.h"
+#include "ggml-cpu.h"
+#include "ggml-impl.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#endif
+
+// buffer type HUGEPAGE
+//
+// large weight and KV buffers on 4 KB pages cause many TLB misses in the bandwidth bound matrix-vector products
+// the memory is taken, in order of preference, from:
+//   - the hugetlbfs pool with 1 GB pages, for buffers large enough that the padding to a whole page is small
+//   - the hugetlbfs pool with 2 MB pages
+//   - a 2 MB aligned anonymous mapping with transparent huge pages requested through madvise
+//   - a CPU buffer, allocated with ggml_aligned_malloc
+// the hugetlbfs pools are empty unless configured by the administrator (vm.nr_hugepages), in which case mmap fails and the next option is used
+
+#define GGML_HUGEPAGE_2M ((size_t) 2*1024*1024)
+#define GGML_HUGEPAGE_1G ((size_t) 1024*1024*1024)
+
+#if defined(__linux__)
+static int ggml_hugepage_log2(size_t page_size) {
+    int n = 0;
+    while (((size_t) 1 << n) < page_size) {
+        n++;
+    }
+    return n;
+}
+
+static void * ggml_hugepage_map_hugetlb(size_t size, size_t page_size) {
+    const size_t padded = GGML_PAD(size, page_size);
+
+    // use the pages only if the padding is small compared to the buffer
+    if (padded - size > size/8) {
+        return NULL;
+    }
+
+    const int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (ggml_hugepage_log2(page_size) << MAP_HUGE_SHIFT);
+    void * data = mmap(NULL, padded, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (data == MAP_FAILED) {
+        return NULL;
+    }
+
+    return data;
+}
+
+static void * ggml_hugepage_map_thp(size_t size) {
+    const size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    const size_t padded = GGML_PAD(size, page);
+
+    // over-allocate to align the start to 2 MB, so that the kernel can back the whole buffer with huge pages
+    void * base = mmap(NULL, padded + GGML_HUGEPAGE_2M, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+
+    const uintptr_t begin = (uintptr_t) base;
+    const uintptr_t data  = GGML_PAD(begin, GGML_HUGEPAGE_2M);
+    const uintptr_t end   = begin + padded + GGML_HUGEPAGE_2M;
+
+    if (data > begin) {
+        munmap(base, data - begin);
+    }
+    if (end > data + padded) {
+        munmap((void *) (data + padded), end - (data + padded));
+    }
+
+#ifdef MADV_HUGEPAGE
+    if (madvise((void *) data, padded, MADV_HUGEPAGE) != 0) {
+        GGML_LOG_DEBUG("%s: madvise(MADV_HUGEPAGE) failed, transparent huge pages may be disabled\n", __func__);
+    }
+#endif
+
+    return (void *) data;
+}
+
+// the length of a hugetlbfs mapping must be a multiple of its page size
+static void ggml_backend_cpu_hugepage_buffer_free_buffer_1g(ggml_backend_buffer_t buffer) {
+    munmap(buffer->context, GGML_PAD(buffer->size, GGML_HUGEPAGE_1G));
+}
+
+static void ggml_backend_cpu_hugepage_buffer_free_buffer_2m(ggml_backend_buffer_t buffer) {
+    munmap(buffer->context, GGML_PAD(buffer->size, GGML_HUGEPAGE_2M));
+}
+
+static void ggml_backend_cpu_hugepage_buffer_free_buffer_thp(ggml_backend_buffer_t buffer) {
+    munmap(buffer->context, buffer->size);
+}
+#endif
+
+static const char * ggml_backend_cpu_hugepage_buffer_type_get_name(ggml_backend_buffer_type_t buft) {
+    return "CPU_HUGEPAGE";
+
+    GGML_UNUSED(buft);
+}
+
+static ggml_backend_buffer_t ggml_backend_cpu_hugepage_buffer_type_alloc_buffer(ggml_backend_buffer_type_t buft, size_t size) {
+#if defined(__linux__)
+    void * data = nullptr;
+    void (*free_buffer)(ggml_backend_buffer_t) = nullptr;
+
+    if (size >= GGML_HUGEPAGE_1G && (data = ggml_hugepage_map_hugetlb(size, GGML_HUGEPAGE_1G)) != nullptr) {
+        free_buffer = ggml_backend_cpu_hugepage_buffer_free_buffer_1g;
+    } else if (size >= GGML_HUGEPAGE_2M && (data = ggml_hugepage_map_hugetlb(size, GGML_HUGEPAGE_2M)) != nullptr) {
+        free_buffer = ggml_backend_cpu_hugepage_buffer_free_buffer_2m;
+    } else if (size >= GGML_HUGEPAGE_2M && (data = ggml_hugepage_map_thp(size)) != nullptr) {
+        free_buffer = ggml_backend_cpu_hugepage_buffer_free_buffer_thp;
+    }
+
+    if (data != nullptr) {
+        GGML_LOG_DEBUG("%s: mapped %zu bytes\n", __func__, size);
+
+        ggml_backend_buffer_t buffer = ggml_backend_cpu_buffer_from_ptr(data, size);
+        buffer->buft                 = buft;
+        buffer->iface.free_buffer    = free_buffer;
+
+        return buffer;
+    }
+#endif
+
+    // small buffers, other platforms or no address space for the mappings
+    ggml_backend_buffer_t buffer = ggml_backend_buft_alloc_buffer(ggml_backend_cpu_buffer_type(), size);
+    if (buffer != nullptr) {
+        buffer->buft = buft;
+    }
+
+    return buffer;
+}
+
+static size_t ggml_backend_cpu_hugepage_buffer_type_get_alignment(ggml_backend_buffer_type_t buft) {
+    return ggml_backend_buft_get_alignment(ggml_backend_cpu_buffer_type());
+
+    GGML_UNUSED(buft);
+}
+
+static bool ggml_backend_cpu_hugepage_buffer_type_is_host(ggml_backend_buffer_type_t buft) {
+    return ggml_backend_buft_is_host(ggml_backend_cpu_buffer_type());
+
+    GGML_UNUSED(buft);
+}
+
+ggml_backend_buffer_type_t ggml_backend_cpu_hugepage_buffer_type(void) {
+    static struct ggml_backend_buffer_type ggml_backend_cpu_buffer_type_hugepage = {
+        /* .iface    = */ {
+                           /* .get_name         = */ ggml_backend_cpu_hugepage_buffer_type_get_name,
+                           /* .alloc_buffer     = */ ggml_backend_cpu_hugepage_buffer_type_alloc_buffer,
+                           /* .get_alignment    = */ ggml_backend_cpu_hugepage_buffer_type_get_alignment,
+                           /* .get_max_size     = */ nullptr,  // defaults to SIZE_MAX
+                           /* .get_alloc_size   = */ nullptr,  // defaults to ggml_nbytes
+                           /* .is_host          = */ ggml_backend_cpu_hugepage_buffer_type_is_host,
+                           },
+        /* .device   = */ ggml_backend_reg_dev_get(ggml_backend_cpu_reg(), 0),
+        /* .context  = */ nullptr,
+    };
+
+    return &ggml_backend_cpu_buffer_type_hugepage;
+}
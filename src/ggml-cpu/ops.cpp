@@ -1,11 +1,15 @@
 #include "ops.h"
 
+#define GGML_COMMON_DECL_CPP
+#include "ggml-common.h"
+
 #include "ggml-cpu.h"
 #include "ggml-impl.h"
 #include "binary-ops.h"
 #include "ggml.h"
 #include "unary-ops.h"
 #include "vec.h"
+#include "quants.h"
 
 #include <cfloat>
 #include <algorithm>
@@ -564,7 +568,7 @@ void ggml_compute_forward_dup(
             } break;
         default:
             {
-                if (ggml_is_quantized(src0->type) && dst->type == GGML_TYPE_F32) {
+                if ((ggml_is_quantized(src0->type) || ggml_is_fp8(src0->type)) && dst->type == GGML_TYPE_F32) {
                     ggml_compute_forward_dup_from_q(params, dst);
                     break;
                 }
@@ -605,7 +609,7 @@ static void ggml_compute_forward_add_q_f32(
     GGML_ASSERT(nb1 <= nb2);
     GGML_ASSERT(nb2 <= nb3);
 
-    GGML_ASSERT(ggml_is_quantized(src0->type));
+    GGML_ASSERT(ggml_is_quantized(src0->type) || ggml_is_fp8(src0->type));
     GGML_ASSERT(src1->type == GGML_TYPE_F32);
 
     // rows per thread
@@ -670,6 +674,8 @@ void ggml_compute_forward_add(
         case GGML_TYPE_Q5_1:
         case GGML_TYPE_Q8_0:
         case GGML_TYPE_MXFP4:
+        case GGML_TYPE_F8_E4M3:
+        case GGML_TYPE_F8_E5M2:
         case GGML_TYPE_Q2_K:
         case GGML_TYPE_Q3_K:
         case GGML_TYPE_Q4_K:
@@ -947,7 +953,7 @@ static void ggml_compute_forward_add1_q_f32(
     GGML_ASSERT(nb1 <= nb2);
     GGML_ASSERT(nb2 <= nb3);
 
-    GGML_ASSERT(ggml_is_quantized(src0->type));
+    GGML_ASSERT(ggml_is_quantized(src0->type) || ggml_is_fp8(src0->type));
     GGML_ASSERT(dst->type == src0->type);
     GGML_ASSERT(src1->type == GGML_TYPE_F32);
 
@@ -1119,6 +1125,8 @@ void ggml_compute_forward_add1(
         case GGML_TYPE_Q8_0:
         case GGML_TYPE_Q8_1:
         case GGML_TYPE_MXFP4:
+        case GGML_TYPE_F8_E4M3:
+        case GGML_TYPE_F8_E5M2:
         case GGML_TYPE_Q2_K:
         case GGML_TYPE_Q3_K:
         case GGML_TYPE_Q4_K:
@@ -1247,6 +1255,8 @@ void ggml_compute_forward_acc(
         case GGML_TYPE_Q8_0:
         case GGML_TYPE_Q8_1:
         case GGML_TYPE_MXFP4:
+        case GGML_TYPE_F8_E4M3:
+        case GGML_TYPE_F8_E5M2:
         case GGML_TYPE_Q2_K:
         case GGML_TYPE_Q3_K:
         case GGML_TYPE_Q4_K:
@@ -1272,102 +1282,78 @@ void ggml_compute_forward_acc(
 
 // ggml_compute_forward_sum
 
-static void ggml_compute_forward_sum_f32(
+static inline ggml_float ggml_vec_sum_ggf(const int n, const float * x) {
+    ggml_float sum;
+    ggml_vec_sum_f32_ggf(n, &sum, x);
+    return sum;
+}
+
+static inline ggml_float ggml_vec_sum_ggf(const int n, const ggml_fp16_t * x) {
+    float sum;
+    ggml_vec_sum_f16_ggf(n, &sum, x);
+    return sum;
+}
+
+static inline ggml_float ggml_vec_sum_ggf(const int n, const ggml_bf16_t * x) {
+    float sum;
+    ggml_vec_sum_bf16_ggf(n, &sum, x);
+    return sum;
+}
+
+// the elements are split into chunks that only depend on the number of elements,
+// each thread sums a subset of the chunks and thread 0 adds up the partial sums in order
+template <typename src_t>
+static void ggml_compute_forward_sum_impl(
         const ggml_compute_params * params,
         ggml_tensor * dst) {
 
     const ggml_tensor * src0 = dst->src[0];
 
-    if (params->ith != 0) {
-        return;
-    }
-
     assert(ggml_is_scalar(dst));
-    assert(src0->nb[0] == sizeof(float));
+    assert(src0->nb[0] == sizeof(src_t));
 
     GGML_TENSOR_LOCALS(int64_t, ne0, src0, ne)
     GGML_TENSOR_LOCALS(size_t,  nb0, src0, nb)
 
-    ggml_float sum     = 0;
-    ggml_float row_sum = 0;
-
-    for (int64_t i03 = 0; i03 < ne03; i03++) {
-        for (int64_t i02 = 0; i02 < ne02; i02++) {
-            for (int64_t i01 = 0; i01 < ne01; i01++) {
-                ggml_vec_sum_f32_ggf(ne00,
-                        &row_sum,
-                        (float *) ((char *) src0->data + i01*nb01 + i02*nb02 + i03*nb03));
-                sum += row_sum;
-            }
-        }
-    }
-    ((float *) dst->data)[0] = sum;
-}
-
-static void ggml_compute_forward_sum_f16(
-    const ggml_compute_params * params,
-          ggml_tensor * dst) {
+    const int64_t n      = ggml_nelements(src0);
+    const int64_t nchunk = std::clamp<int64_t>(n/GGML_REDUCE_CHUNK_MIN, 1, GGML_REDUCE_MAX_CHUNKS);
 
-    const ggml_tensor * src0 = dst->src[0];
+    ggml_float * partial = (ggml_float *) params->wdata;
 
-    if (params->ith != 0) {
-        return;
-    }
+    for (int64_t ic = params->ith; ic < nchunk; ic += params->nth) {
+        const int64_t i1 = (ic + 1)*n/nchunk;
 
-    assert(ggml_is_scalar(dst));
+        ggml_float sum = 0;
 
-    assert(src0->nb[0] == sizeof(ggml_fp16_t));
+        for (int64_t i = ic*n/nchunk; i < i1; ) {
+            const int64_t ir  = i/ne00;
+            const int64_t i00 = i - ir*ne00;
 
-    GGML_TENSOR_LOCALS(int64_t, ne0, src0, ne)
-    GGML_TENSOR_LOCALS(size_t,  nb0, src0, nb)
+            const int64_t i03 = ir/(ne02*ne01);
+            const int64_t i02 = (ir - i03*ne02*ne01)/ne01;
+            const int64_t i01 = (ir - i03*ne02*ne01 - i02*ne01);
 
-    float sum = 0;
-    float row_sum = 0;
+            const int64_t nc = std::min(ne00 - i00, i1 - i);
 
-    for (int64_t i03 = 0; i03 < ne03; i03++) {
-        for (int64_t i02 = 0; i02 < ne02; i02++) {
-            for (int64_t i01 = 0; i01 < ne01; i01++) {
-                ggml_vec_sum_f16_ggf(ne00,
-                    &row_sum,
-                    (ggml_fp16_t *) ((char *) src0->data + i01 * nb01 + i02 * nb02 + i03 * nb03));
-                sum += row_sum;
-            }
+            sum += ggml_vec_sum_ggf(nc, (const src_t *) ((const char *) src0->data + i01*nb01 + i02*nb02 + i03*nb03) + i00);
+            i   += nc;
         }
-    }
-    ((ggml_fp16_t *) dst->data)[0] = GGML_CPU_FP32_TO_FP16(sum);
-}
 
-static void ggml_compute_forward_sum_bf16(
-    const ggml_compute_params * params,
-          ggml_tensor * dst) {
+        partial[ic] = sum;
+    }
 
-    const ggml_tensor * src0 = dst->src[0];
+    ggml_barrier(params->threadpool);
 
     if (params->ith != 0) {
         return;
     }
 
-    assert(ggml_is_scalar(dst));
-
-    assert(src0->nb[0] == sizeof(ggml_bf16_t));
-
-    GGML_TENSOR_LOCALS(int64_t, ne0, src0, ne)
-    GGML_TENSOR_LOCALS(size_t,  nb0, src0, nb)
-
-    float sum = 0;
-    float row_sum = 0;
-
-    for (int64_t i03 = 0; i03 < ne03; i03++) {
-        for (int64_t i02 = 0; i02 < ne02; i02++) {
-            for (int64_t i01 = 0; i01 < ne01; i01++) {
-                ggml_vec_sum_bf16_ggf(ne00,
-                    &row_sum,
-                    (ggml_bf16_t *) ((char *) src0->data + i01 * nb01 + i02 * nb02 + i03 * nb03));
-                sum += row_sum;
-            }
-        }
+    ggml_float sum = 0;
+    for (int64_t ic = 0; ic < nchunk; ++ic) {
+        sum += partial[ic];
     }
-    ((ggml_bf16_t *) dst->data)[0] = GGML_FP32_TO_BF16(sum);
+
+    ((src_t *) dst->data)[0] = type_conversion_table<src_t>::from_f32(sum);
 }
 
 void ggml_compute_forward_sum(
@@ -1379,15 +1365,15 @@ void ggml_compute_forward_sum(
     switch (src0->type) {
         case GGML_TYPE_F32:
             {
-                ggml_compute_forward_sum_f32(params, dst);
+                ggml_compute_forward_sum_impl<float>(params, dst);
             } break;
         case GGML_TYPE_F16:
             {
-                ggml_compute_forward_sum_f16(params, dst);
+                ggml_compute_forward_sum_impl<ggml_fp16_t>(params, dst);
             } break;
         case GGML_TYPE_BF16:
             {
-                ggml_compute_forward_sum_bf16(params, dst);
+                ggml_compute_forward_sum_impl<ggml_bf16_t>(params, dst);
             } break;
         default:
             {
@@ -1448,16 +1434,24 @@ void ggml_compute_forward_cumsum(
 
 // ggml_compute_forward_sum_rows
 
-static void ggml_compute_forward_sum_rows_f32(
+// number of chunks each row of a reduction is split into, only depends on the shape of src0
+static int64_t ggml_reduce_rows_nseg(const ggml_tensor * src0) {
+    const int64_t nr = ggml_nrows(src0);
+    if (nr >= GGML_REDUCE_MAX_CHUNKS) {
+        return 1;
+    }
+    return std::clamp<int64_t>(std::min(src0->ne[0]/GGML_REDUCE_CHUNK_MIN, GGML_REDUCE_MAX_CHUNKS/nr), 1, GGML_REDUCE_MAX_CHUNKS);
+}
+
+// rows are distributed over the threads, if there are only a few wide rows they are also split into chunks
+// with mean == true the sums are divided by the row length
+static void ggml_compute_forward_sum_rows_f32_impl(
         const ggml_compute_params * params,
-        ggml_tensor * dst) {
+        ggml_tensor * dst,
+        const bool mean) {
 
     const ggml_tensor * src0 = dst->src[0];
 
-    if (params->ith != 0) {
-        return;
-    }
-
     GGML_ASSERT(src0->nb[0] == sizeof(float));
     GGML_ASSERT(dst->nb[0] == sizeof(float));
 
@@ -1468,16 +1462,58 @@ static void ggml_compute_forward_sum_rows_f32(
     GGML_ASSERT(ne2 == ne02);
     GGML_ASSERT(ne3 == ne03);
 
-    for (int64_t i3 = 0; i3 < ne03; i3++) {
-        for (int64_t i2 = 0; i2 < ne02; i2++) {
-            for (int64_t i1 = 0; i1 < ne01; i1++) {
-                float * src_row = (float *) ((char *) src0->data + i1*nb01 + i2*nb02 + i3*nb03);
-                float * dst_row = (float *) ((char *) dst->data  + i1*nb1  + i2*nb2  + i3*nb3);
-                float row_sum = 0;
-                ggml_vec_sum_f32(ne00, &row_sum, src_row);
-                dst_row[0] = row_sum;
-            }
+    const int64_t nseg = ggml_reduce_rows_nseg(src0);
+
+    const auto [ir0, ir1] = get_thread_range(params, src0);
+
+    if (nseg == 1) {
+        for (int64_t ir = ir0; ir < ir1; ++ir) {
+            const int64_t i3 = ir/(ne02*ne01);
+            const int64_t i2 = (ir - i3*ne02*ne01)/ne01;
+            const int64_t i1 = (ir - i3*ne02*ne01 - i2*ne01);
+
+            float * src_row = (float *) ((char *) src0->data + i1*nb01 + i2*nb02 + i3*nb03);
+            float * dst_row = (float *) ((char *) dst->data  + i1*nb1  + i2*nb2  + i3*nb3);
+            float row_sum = 0;
+            ggml_vec_sum_f32(ne00, &row_sum, src_row);
+            dst_row[0] = mean ? row_sum/(float) ne00 : row_sum;
+        }
+        return;
+    }
+
+    const int64_t nr = ggml_nrows(src0);
+
+    ggml_float * partial = (ggml_float *) params->wdata;
+
+    for (int64_t iu = params->ith; iu < nr*nseg; iu += params->nth) {
+        const int64_t ir   = iu/nseg;
+        const int64_t iseg = iu - ir*nseg;
+
+        const int64_t i3 = ir/(ne02*ne01);
+        const int64_t i2 = (ir - i3*ne02*ne01)/ne01;
+        const int64_t i1 = (ir - i3*ne02*ne01 - i2*ne01);
+
+        const int64_t i00 = iseg*ne00/nseg;
+        const int64_t i01 = (iseg + 1)*ne00/nseg;
+
+        const float * src_row = (const float *) ((const char *) src0->data + i1*nb01 + i2*nb02 + i3*nb03);
+        ggml_vec_sum_f32_ggf(i01 - i00, &partial[iu], src_row + i00);
+    }
+
+    ggml_barrier(params->threadpool);
+
+    for (int64_t ir = ir0; ir < ir1; ++ir) {
+        const int64_t i3 = ir/(ne02*ne01);
+        const int64_t i2 = (ir - i3*ne02*ne01)/ne01;
+        const int64_t i1 = (ir - i3*ne02*ne01 - i2*ne01);
+
+        ggml_float row_sum = 0;
+        for (int64_t iseg = 0; iseg < nseg; ++iseg) {
+            row_sum += partial[ir*nseg + iseg];
         }
+
+        float * dst_row = (float *) ((char *) dst->data + i1*nb1 + i2*nb2 + i3*nb3);
+        dst_row[0] = mean ? (float) row_sum/(float) ne00 : (float) row_sum;
     }
 }
 
@@ -1490,7 +1526,7 @@ void ggml_compute_forward_sum_rows(
     switch (src0->type) {
         case GGML_TYPE_F32:
             {
-                ggml_compute_forward_sum_rows_f32(params, dst);
+                ggml_compute_forward_sum_rows_f32_impl(params, dst, false);
             } break;
         default:
             {
@@ -1501,43 +1537,6 @@ void ggml_compute_forward_sum_rows(
 
 // ggml_compute_forward_mean
 
-static void ggml_compute_forward_mean_f32(
-        const ggml_compute_params * params,
-        ggml_tensor * dst) {
-
-    const ggml_tensor * src0 = dst->src[0];
-
-    if (params->ith != 0) {
-        return;
-    }
-
-    assert(src0->nb[0] == sizeof(float));
-
-    GGML_TENSOR_UNARY_OP_LOCALS
-
-    assert(ne0 == 1);
-    assert(ne1 == ne01);
-    assert(ne2 == ne02);
-    assert(ne3 == ne03);
-
-    GGML_UNUSED(ne0);
-    GGML_UNUSED(ne1);
-    GGML_UNUSED(ne2);
-    GGML_UNUSED(ne3);
-
-    for (int64_t i03 = 0; i03 < ne03; i03++) {
-        for (int64_t i02 = 0; i02 < ne02; i02++) {
-            for (int64_t i01 = 0; i01 < ne01; i01++) {
-                ggml_vec_sum_f32(ne00,
-                        (float *) ((char *)  dst->data + i01*nb1  + i02*nb2  + i03*nb3),
-                        (float *) ((char *) src0->data + i01*nb01 + i02*nb02 + i03*nb03));
-
-                *(float *) ((char *) dst->data + i01*nb1 + i02*nb2 + i03*nb3) /= (float) ne00;
-            }
-        }
-    }
-}
-
 void ggml_compute_forward_mean(
         const ggml_compute_params * params,
         ggml_tensor * dst) {
@@ -1547,7 +1546,7 @@ void ggml_compute_forward_mean(
     switch (src0->type) {
         case GGML_TYPE_F32:
             {
-                ggml_compute_forward_mean_f32(params, dst);
+                ggml_compute_forward_sum_rows_f32_impl(params, dst, true);
             } break;
         default:
             {
@@ -1564,10 +1563,6 @@ static void ggml_compute_forward_argmax_f32(
 
     const ggml_tensor * src0 = dst->src[0];
 
-    if (params->ith != 0) {
-        return;
-    }
-
     assert(src0->nb[0] == sizeof(float));
     assert(dst->nb[0] == sizeof(float));
 
@@ -1577,12 +1572,50 @@ static void ggml_compute_forward_argmax_f32(
     const size_t nb01 = src0->nb[1];
     const size_t nb0 = dst->nb[0];
 
-    for (int64_t i1 = 0; i1 < ne01; i1++) {
-        float * src = (float *) ((char *) src0->data + i1*nb01);
-        int32_t * dst_ = (int32_t *) ((char *)  dst->data + i1*nb0);
+    const int64_t nseg = ggml_reduce_rows_nseg(src0);
+
+    const auto [ir0, ir1] = get_thread_range(params, src0);
+
+    if (nseg == 1) {
+        for (int64_t i1 = ir0; i1 < ir1; i1++) {
+            float * src = (float *) ((char *) src0->data + i1*nb01);
+            int32_t * dst_ = (int32_t *) ((char *)  dst->data + i1*nb0);
+            int v = 0;
+            ggml_vec_argmax_f32(ne00, &v, src);
+            dst_[0] = v;
+        }
+        return;
+    }
+
+    float   * partial_max = (float *) params->wdata;
+    int32_t * partial_idx = (int32_t *) (partial_max + ne01*nseg);
+
+    for (int64_t iu = params->ith; iu < ne01*nseg; iu += params->nth) {
+        const int64_t i1   = iu/nseg;
+        const int64_t iseg = iu - i1*nseg;
+
+        const int64_t i00 = iseg*ne00/nseg;
+        const int64_t i01 = (iseg + 1)*ne00/nseg;
+
+        const float * src = (const float *) ((const char *) src0->data + i1*nb01);
         int v = 0;
-        ggml_vec_argmax_f32(ne00, &v, src);
-        dst_[0] = v;
+        ggml_vec_argmax_f32(i01 - i00, &v, src + i00);
+        partial_idx[iu] = i00 + v;
+        partial_max[iu] = src[i00 + v];
+    }
+
+    ggml_barrier(params->threadpool);
+
+    for (int64_t i1 = ir0; i1 < ir1; i1++) {
+        // same as ggml_vec_argmax_f32, the last occurrence of the maximum wins
+        int64_t ibest = i1*nseg;
+        for (int64_t iu = ibest + 1; iu < (i1 + 1)*nseg; ++iu) {
+            if (partial_max[iu] >= partial_max[ibest]) {
+                ibest = iu;
+            }
+        }
+        int32_t * dst_ = (int32_t *) ((char *)  dst->data + i1*nb0);
+        dst_[0] = partial_idx[ibest];
     }
 }
 
@@ -1692,40 +1725,30 @@ static void ggml_compute_forward_repeat_f32(
 
     const ggml_tensor * src0 = dst->src[0];
 
-    if (params->ith != 0) {
-        return;
-    }
-
     GGML_ASSERT(ggml_can_repeat(src0, dst));
 
     GGML_TENSOR_UNARY_OP_LOCALS
 
     // guaranteed to be an integer due to the check in ggml_can_repeat
     const int nr0 = (int)(ne0/ne00);
-    const int nr1 = (int)(ne1/ne01);
-    const int nr2 = (int)(ne2/ne02);
-    const int nr3 = (int)(ne3/ne03);
 
     // TODO: support for transposed / permuted tensors
     GGML_ASSERT(nb0  == sizeof(float));
     GGML_ASSERT(nb00 == sizeof(float));
 
-    // TODO: maybe this is not optimal?
-    for                         (int i3 = 0; i3 < nr3;  i3++) {
-        for                     (int k3 = 0; k3 < ne03; k3++) {
-            for                 (int i2 = 0; i2 < nr2;  i2++) {
-                for             (int k2 = 0; k2 < ne02; k2++) {
-                    for         (int i1 = 0; i1 < nr1;  i1++) {
-                        for     (int k1 = 0; k1 < ne01; k1++) {
-                            for (int i0 = 0; i0 < nr0;  i0++) {
-                                ggml_vec_cpy_f32(ne00,
-                                        (float *) ((char *)  dst->data + (i3*ne03 + k3)*nb3  + (i2*ne02 + k2)*nb2  + (i1*ne01 + k1)*nb1  + (i0*ne00)*nb0),
-                                        (float *) ((char *) src0->data + (          k3)*nb03 + (          k2)*nb02 + (          k1)*nb01));
-                            }
-                        }
-                    }
-                }
-            }
+    // each thread fills a range of dst rows
+    const auto [ir0, ir1] = get_thread_range(params, dst);
+
+    for (int64_t ir = ir0; ir < ir1; ++ir) {
+        const int64_t i3 = ir/(ne2*ne1);
+        const int64_t i2 = (ir - i3*ne2*ne1)/ne1;
+        const int64_t i1 = (ir - i3*ne2*ne1 - i2*ne1);
+
+        float * y = (float *) ((char *)  dst->data + i3*nb3  + i2*nb2  + i1*nb1);
+        float * x = (float *) ((char *) src0->data + (i3%ne03)*nb03 + (i2%ne02)*nb02 + (i1%ne01)*nb01);
+
+        for (int i0 = 0; i0 < nr0; i0++) {
+            ggml_vec_cpy_f32(ne00, y + i0*ne00, x);
         }
     }
 }
@@ -1736,42 +1759,32 @@ static void ggml_compute_forward_repeat_f16(
 
     const ggml_tensor * src0 = dst->src[0];
 
-    if (params->ith != 0) {
-        return;
-    }
-
     GGML_ASSERT(ggml_can_repeat(src0, dst));
 
     GGML_TENSOR_UNARY_OP_LOCALS
 
     // guaranteed to be an integer due to the check in ggml_can_repeat
     const int nr0 = (int)(ne0/ne00);
-    const int nr1 = (int)(ne1/ne01);
-    const int nr2 = (int)(ne2/ne02);
-    const int nr3 = (int)(ne3/ne03);
 
     // TODO: support for transposed / permuted tensors
     GGML_ASSERT(nb0  == sizeof(ggml_fp16_t));
     GGML_ASSERT(nb00 == sizeof(ggml_fp16_t));
 
-    // TODO: maybe this is not optimal?
-    for                         (int i3 = 0; i3 < nr3;  i3++) {
-        for                     (int k3 = 0; k3 < ne03; k3++) {
-            for                 (int i2 = 0; i2 < nr2;  i2++) {
-                for             (int k2 = 0; k2 < ne02; k2++) {
-                    for         (int i1 = 0; i1 < nr1;  i1++) {
-                        for     (int k1 = 0; k1 < ne01; k1++) {
-                            for (int i0 = 0; i0 < nr0;  i0++) {
-                                ggml_fp16_t * y = (ggml_fp16_t *) ((char *)  dst->data + (i3*ne03 + k3)*nb3  + (i2*ne02 + k2)*nb2  + (i1*ne01 + k1)*nb1  + (i0*ne00)*nb0);
-                                ggml_fp16_t * x = (ggml_fp16_t *) ((char *) src0->data + (          k3)*nb03 + (          k2)*nb02 + (          k1)*nb01);
-                                // ggml_vec_cpy_f16(ne00, y, x)
-                                for (int i = 0; i < ne00; ++i) {
-                                    y[i]  = x[i];
-                                }
-                            }
-                        }
-                    }
-                }
+    // each thread fills a range of dst rows
+    const auto [ir0, ir1] = get_thread_range(params, dst);
+
+    for (int64_t ir = ir0; ir < ir1; ++ir) {
+        const int64_t i3 = ir/(ne2*ne1);
+        const int64_t i2 = (ir - i3*ne2*ne1)/ne1;
+        const int64_t i1 = (ir - i3*ne2*ne1 - i2*ne1);
+
+        ggml_fp16_t * y = (ggml_fp16_t *) ((char *)  dst->data + i3*nb3  + i2*nb2  + i1*nb1);
+        ggml_fp16_t * x = (ggml_fp16_t *) ((char *) src0->data + (i3%ne03)*nb03 + (i2%ne02)*nb02 + (i1%ne01)*nb01);
+
+        for (int i0 = 0; i0 < nr0; i0++) {
+            // ggml_vec_cpy_f16(ne00, y, x)
+            for (int i = 0; i < ne00; ++i) {
+                y[i0*ne00 + i] = x[i];
             }
         }
     }
@@ -1816,10 +1829,6 @@ static void ggml_compute_forward_repeat_back_f32(
 
     const ggml_tensor * src0 = dst->src[0];
 
-    if (params->ith != 0) {
-        return;
-    }
-
     GGML_ASSERT(ggml_can_repeat(dst, src0));
 
     GGML_TENSOR_UNARY_OP_LOCALS
@@ -1834,33 +1843,24 @@ static void ggml_compute_forward_repeat_back_f32(
     GGML_ASSERT(nb0  == sizeof(float));
     GGML_ASSERT(nb00 == sizeof(float));
 
-    if (ggml_is_contiguous(dst)) {
-        ggml_vec_set_f32(ne0*ne1*ne2*ne3, (float *)dst->data, 0);
-    } else {
-        for         (int k3 = 0; k3 < ne3; k3++) {
-            for     (int k2 = 0; k2 < ne2; k2++) {
-                for (int k1 = 0; k1 < ne1; k1++) {
-                    ggml_vec_set_f32(ne0,
-                        (float *) ((char *) dst->data + k1*nb1 + k2*nb2 + k3*nb3),
-                        0);
-                }
-            }
-        }
-    }
+    // each thread accumulates a range of dst rows, the order of the additions is the same for any number of threads
+    const auto [ir0, ir1] = get_thread_range(params, dst);
 
-    // TODO: maybe this is not optimal?
-    for                         (int i3 = 0; i3 < nr3; i3++) {
-        for                     (int k3 = 0; k3 < ne3; k3++) {
-            for                 (int i2 = 0; i2 < nr2; i2++) {
-                for             (int k2 = 0; k2 < ne2; k2++) {
-                    for         (int i1 = 0; i1 < nr1; i1++) {
-                        for     (int k1 = 0; k1 < ne1; k1++) {
-                            for (int i0 = 0; i0 < nr0; i0++) {
-                                ggml_vec_acc_f32(ne0,
-                                        (float *) ((char *)  dst->data + (         k3)*nb3  + (         k2)*nb2  + (         k1)*nb1),
-                                        (float *) ((char *) src0->data + (i3*ne3 + k3)*nb03 + (i2*ne2 + k2)*nb02 + (i1*ne1 + k1)*nb01 + (i0*ne0)*nb00));
-                            }
-                        }
+    for (int64_t ir = ir0; ir < ir1; ++ir) {
+        const int64_t k3 = ir/(ne2*ne1);
+        const int64_t k2 = (ir - k3*ne2*ne1)/ne1;
+        const int64_t k1 = (ir - k3*ne2*ne1 - k2*ne1);
+
+        float * y = (float *) ((char *) dst->data + k1*nb1 + k2*nb2 + k3*nb3);
+
+        ggml_vec_set_f32(ne0, y, 0);
+
+        for                 (int i3 = 0; i3 < nr3; i3++) {
+            for             (int i2 = 0; i2 < nr2; i2++) {
+                for         (int i1 = 0; i1 < nr1; i1++) {
+                    for     (int i0 = 0; i0 < nr0; i0++) {
+                        ggml_vec_acc_f32(ne0, y,
+                                (float *) ((char *) src0->data + (i3*ne3 + k3)*nb03 + (i2*ne2 + k2)*nb02 + (i1*ne1 + k1)*nb01 + (i0*ne0)*nb00));
                     }
                 }
             }
@@ -2585,24 +2585,21 @@ static void ggml_compute_forward_leaky_relu_f32(
 
     const ggml_tensor * src0 = dst->src[0];
 
-    if (params->ith != 0) {
-        return;
-    }
-
     assert(ggml_is_contiguous_1(src0));
     assert(ggml_is_contiguous_1(dst));
     assert(ggml_are_same_shape(src0, dst));
 
-    const int n  = ggml_nrows(src0);
     const int nc = src0->ne[0];
 
+    const auto [ir0, ir1] = get_thread_range(params, src0);
+
     float negative_slope;
     memcpy(&negative_slope, dst->op_params, sizeof(float));
 
     assert(dst->nb[0]  == sizeof(float));
     assert(src0->nb[0] == sizeof(float));
 
-    for (int i = 0; i < n; i++) {
+    for (int64_t i = ir0; i < ir1; i++) {
         ggml_vec_leaky_relu_f32(nc,
                 (float *) ((char *) dst->data  + i*( dst->nb[1])),
                 (float *) ((char *) src0->data + i*(src0->nb[1])), negative_slope);
@@ -2615,24 +2612,21 @@ static void ggml_compute_forward_leaky_relu_f16(
 
     const ggml_tensor * src0 = dst->src[0];
 
-    if (params->ith != 0) {
-        return;
-    }
-
     assert(ggml_is_contiguous_1(src0));
     assert(ggml_is_contiguous_1(dst));
     assert(ggml_are_same_shape(src0, dst));
 
-    const int n  = ggml_nrows(src0);
     const int nc = src0->ne[0];
 
+    const auto [ir0, ir1] = get_thread_range(params, src0);
+
     float negative_slope;
     memcpy(&negative_slope, dst->op_params, sizeof(float));
 
     assert(dst->nb[0]  == sizeof(ggml_fp16_t));
     assert(src0->nb[0] == sizeof(ggml_fp16_t));
 
-    for (int i = 0; i < n; i++) {
+    for (int64_t i = ir0; i < ir1; i++) {
         ggml_vec_leaky_relu_f16(nc,
                 (ggml_fp16_t *) ((char *) dst->data  + i*( dst->nb[1])),
                 (ggml_fp16_t *) ((char *) src0->data + i*(src0->nb[1])), negative_slope);
@@ -4270,6 +4264,8 @@ void ggml_compute_forward_out_prod(
         case GGML_TYPE_Q5_1:
         case GGML_TYPE_Q8_0:
         case GGML_TYPE_MXFP4:
+        case GGML_TYPE_F8_E4M3:
+        case GGML_TYPE_F8_E5M2:
         case GGML_TYPE_Q2_K:
         case GGML_TYPE_Q3_K:
         case GGML_TYPE_Q4_K:
@@ -4545,6 +4541,8 @@ void ggml_compute_forward_set(
         case GGML_TYPE_Q8_0:
         case GGML_TYPE_Q8_1:
         case GGML_TYPE_MXFP4:
+        case GGML_TYPE_F8_E4M3:
+        case GGML_TYPE_F8_E5M2:
         case GGML_TYPE_Q2_K:
         case GGML_TYPE_Q3_K:
         case GGML_TYPE_Q4_K:
@@ -4767,6 +4765,8 @@ void ggml_compute_forward_get_rows(
         case GGML_TYPE_Q8_0:
         case GGML_TYPE_Q8_1:
         case GGML_TYPE_MXFP4:
+        case GGML_TYPE_F8_E4M3:
+        case GGML_TYPE_F8_E5M2:
         case GGML_TYPE_Q2_K:
         case GGML_TYPE_Q3_K:
         case GGML_TYPE_Q4_K:
@@ -5158,6 +5158,32 @@ void ggml_compute_forward_diag_mask_zero(
 
 // ggml_compute_forward_soft_max
 
+// y = scale*x + slope*mask, returns max(y)
+// an F16 mask is converted in blocks that stay in the L1 cache
+static float ggml_soft_max_scale_mask_max(const int64_t n, float * y, const float * x, const float scale,
+        const ggml_fp16_t * mp_f16, const float * mp_f32, const float slope) {
+    if (!mp_f16) {
+        return ggml_vec_scale_add_max_f32(n, y, x, scale, mp_f32, slope);
+    }
+
+    constexpr int64_t blck = 256;
+    float mb[blck];
+
+    float max = -INFINITY;
+    for (int64_t i = 0; i < n; i += blck) {
+        const int64_t nb = std::min(blck, n - i);
+        ggml_cpu_fp16_to_fp32(mp_f16 + i, mb, nb);
+        max = MAX(max, ggml_vec_scale_add_max_f32(nb, y + i, x + i, scale, mb, slope));
+    }
+    return max;
+}
+
+// the rows are distributed over the threads and computed in three passes:
+//   1. dst = scale*src0 + slope*mask and the max of the row
+//   2. dst = exp(dst - max) and the sum of the row
+//   3. dst = dst/sum
+// if there are only a few wide rows they are also split into chunks, each chunk does 1. and 2. with its own max,
+// and after a barrier 3. also rescales the chunk by exp(chunk max - row max)
 static void ggml_compute_forward_soft_max_f32(
         const ggml_compute_params * params,
               ggml_tensor * dst) {
@@ -5195,78 +5221,121 @@ static void ggml_compute_forward_soft_max_f32(
     const float m0 = powf(2.0f, -(max_bias       ) / n_head_log2);
     const float m1 = powf(2.0f, -(max_bias / 2.0f) / n_head_log2);
 
-    float * wp = (float *) params->wdata + (ne00 + CACHE_LINE_SIZE_F32) * ith;
-
     const bool use_f16 = (src1 && src1->type == GGML_TYPE_F16);
 
     // sinks
     const float * sk = src2 ? (float *)((char *) src2->data) : nullptr;
 
-    for (int64_t i03 = 0; i03 < ne03; i03++) {
-        for (int64_t i02 = 0; i02 < ne02; i02++) {
-            for (int64_t i01 = ith; i01 < ne01; i01 += nth) {
-                const int64_t i11 = i01;
-                const int64_t i12 = i02%ne12;
-                const int64_t i13 = i03%ne13;
-
-                // ALiBi
-                const uint32_t h = i02; // head
-                const float slope = (max_bias > 0.0f) ? h < n_head_log2 ? powf(m0, h + 1) : powf(m1, 2*(h - n_head_log2) + 1) : 1.0f;
-
-                float * sp = (float *)((char *) src0->data + i01*nb01 + i02*nb02 + i03*nb03);
-                float * dp = (float *)((char *)  dst->data + i01*nb1  + i02*nb2  + i03*nb3);
-
-                // broadcast the mask across rows
-                ggml_fp16_t * mp_f16 = src1 ? (ggml_fp16_t *)((char *) src1->data + i11*nb11 + i12*nb12 + i13*nb13) : NULL;
-                float       * mp_f32 = src1 ? (float       *)((char *) src1->data + i11*nb11 + i12*nb12 + i13*nb13) : NULL;
-
-                ggml_vec_cpy_f32  (ne00, wp, sp);
-                ggml_vec_scale_f32(ne00, wp, scale);
-                if (mp_f32) {
-                    if (use_f16) {
-                        for (int i = 0; i < ne00; ++i) {
-                            wp[i] += slope*GGML_CPU_FP16_TO_FP32(mp_f16[i]);
-                        }
-                    } else {
-                        for (int i = 0; i < ne00; ++i) {
-                            wp[i] += slope*mp_f32[i];
-                        }
-                    }
-                }
+    const int64_t nr   = ggml_nrows(src0);
+    const int64_t nseg = ggml_reduce_rows_nseg(src0);
+
+    // partial max and sum of each chunk
+    float      * seg_max = (float *) params->wdata;
+    ggml_float * seg_sum = (ggml_float *) (seg_max + GGML_REDUCE_MAX_CHUNKS);
+
+    for (int64_t iu = ith; iu < nr*nseg; iu += nth) {
+        const int64_t ir   = iu/nseg;
+        const int64_t iseg = iu - ir*nseg;
+
+        const int64_t i03 = ir/(ne02*ne01);
+        const int64_t i02 = (ir - i03*ne02*ne01)/ne01;
+        const int64_t i01 = (ir - i03*ne02*ne01 - i02*ne01);
+
+        const int64_t i11 = i01;
+        const int64_t i12 = i02%ne12;
+        const int64_t i13 = i03%ne13;
+
+        const int64_t i00 = iseg*ne00/nseg;
+        const int64_t n   = (iseg + 1)*ne00/nseg - i00;
+
+        // ALiBi
+        const uint32_t h = i02; // head
+        const float slope = (max_bias > 0.0f) ? h < n_head_log2 ? powf(m0, h + 1) : powf(m1, 2*(h - n_head_log2) + 1) : 1.0f;
+
+        float * sp = (float *)((char *) src0->data + i01*nb01 + i02*nb02 + i03*nb03) + i00;
+        float * dp = (float *)((char *)  dst->data + i01*nb1  + i02*nb2  + i03*nb3)  + i00;
+
+        // broadcast the mask across rows
+        ggml_fp16_t * mp_f16 = src1 &&  use_f16 ? (ggml_fp16_t *)((char *) src1->data + i11*nb11 + i12*nb12 + i13*nb13) + i00 : NULL;
+        float       * mp_f32 = src1 && !use_f16 ? (float       *)((char *) src1->data + i11*nb11 + i12*nb12 + i13*nb13) + i00 : NULL;
+
+        float max = ggml_soft_max_scale_mask_max(n, dp, sp, scale, mp_f16, mp_f32, slope);
 
 #ifndef NDEBUG
-                for (int i = 0; i < ne00; ++i) {
-                    //printf("p[%d] = %f\n", i, p[i]);
-                    assert(!isnan(wp[i]));
-                }
+        for (int64_t i = 0; i < n; ++i) {
+            assert(!isnan(dp[i]));
+        }
 #endif
 
-                float max = -INFINITY;
-                ggml_vec_max_f32(ne00, &max, wp);
+        if (nseg > 1) {
+            // a fully masked chunk does not contribute to the sum
+            ggml_float sum = 0.0;
+            if (max == -INFINITY) {
+                ggml_vec_set_f32(n, dp, 0.0f);
+            } else {
+                sum = ggml_vec_soft_max_f32(n, dp, dp, max);
+            }
+            seg_max[iu] = max;
+            seg_sum[iu] = sum;
+            continue;
+        }
 
-                // if we have sinks, make a correction as if they were included in the softmax
-                if (sk) {
-                    max = MAX(max, sk[i02]);
-                }
+        // if we have sinks, make a correction as if they were included in the softmax
+        if (sk) {
+            max = MAX(max, sk[i02]);
+        }
 
-                ggml_float sum = ggml_vec_soft_max_f32(ne00, dp, wp, max);
-                assert(sum > 0.0);
+        ggml_float sum = ggml_vec_soft_max_f32(n, dp, dp, max);
+        assert(sum > 0.0);
 
-                if (sk) {
-                    sum += (ggml_float) expf(sk[i02] - max);
-                }
+        if (sk) {
+            sum += (ggml_float) expf(sk[i02] - max);
+        }
 
-                sum = 1.0/sum;
-                ggml_vec_scale_f32(ne00, dp, sum);
+        sum = 1.0/sum;
+        ggml_vec_scale_f32(n, dp, sum);
 
 #ifndef NDEBUG
-                for (int i = 0; i < ne00; ++i) {
-                    assert(!isnan(dp[i]));
-                    assert(!isinf(dp[i]));
-                }
+        for (int64_t i = 0; i < n; ++i) {
+            assert(!isnan(dp[i]));
+            assert(!isinf(dp[i]));
+        }
 #endif
+    }
+
+    if (nseg == 1) {
+        return;
+    }
+
+    ggml_barrier(params->threadpool);
+
+    for (int64_t iu = ith; iu < nr*nseg; iu += nth) {
+        const int64_t ir   = iu/nseg;
+        const int64_t iseg = iu - ir*nseg;
+
+        const int64_t i03 = ir/(ne02*ne01);
+        const int64_t i02 = (ir - i03*ne02*ne01)/ne01;
+        const int64_t i01 = (ir - i03*ne02*ne01 - i02*ne01);
+
+        const int64_t i00 = iseg*ne00/nseg;
+        const int64_t n   = (iseg + 1)*ne00/nseg - i00;
+
+        float max = sk ? sk[i02] : -INFINITY;
+        for (int64_t j = ir*nseg; j < (ir + 1)*nseg; ++j) {
+            max = MAX(max, seg_max[j]);
+        }
+
+        ggml_float sum = sk ? (ggml_float) expf(sk[i02] - max) : 0.0;
+        for (int64_t j = ir*nseg; j < (ir + 1)*nseg; ++j) {
+            if (seg_max[j] != -INFINITY) {
+                sum += seg_sum[j]*(ggml_float) expf(seg_max[j] - max);
             }
         }
+        assert(sum > 0.0);
+
+        float * dp = (float *)((char *) dst->data + i01*nb1 + i02*nb2 + i03*nb3) + i00;
+
+        ggml_vec_scale_f32(n, dp, seg_max[iu] == -INFINITY ? 0.0f : (float) (expf(seg_max[iu] - max)/sum));
     }
 }
 
@@ -5491,6 +5560,8 @@ void ggml_compute_forward_clamp(
         case GGML_TYPE_Q8_0:
         case GGML_TYPE_Q8_1:
         case GGML_TYPE_MXFP4:
+        case GGML_TYPE_F8_E4M3:
+        case GGML_TYPE_F8_E5M2:
         case GGML_TYPE_Q2_K:
         case GGML_TYPE_Q3_K:
         case GGML_TYPE_Q4_K:
@@ -5739,22 +5810,47 @@ static void ggml_compute_forward_rope_flt(
 
     const int32_t * pos = (const int32_t *) src1->data;
 
+    auto rope_cache_init = [&](int64_t i2, float * cache) {
+        if (!mrope_used) {
+            const int64_t p = pos[i2];
+            ggml_rope_cache_init(p, freq_scale, freq_factors, corr_dims, ne0, ext_factor, attn_factor, cache, sin_sign, theta_scale);
+        }
+        else {
+            const int64_t p_t = pos[i2];
+            const int64_t p_h = pos[i2 + ne2];
+            const int64_t p_w = pos[i2 + ne2 * 2];
+            const int64_t p_e = pos[i2 + ne2 * 3];
+            ggml_mrope_cache_init(
+                p_t, p_h, p_w, p_e, sections, is_imrope, is_vision,
+                freq_scale, freq_factors, corr_dims, ne0, ext_factor, attn_factor, cache, sin_sign, theta_scale);
+        }
+    };
+
+    // the table of all positions can be shared with the other ROPE nodes of the graph, the first node computes it
+    bool table_init = false;
+    float * table = ggml_cpu_rope_cache(params, dst, &table_init);
+    if (table && table_init) {
+        for (int64_t i2 = ith; i2 < ne2; i2 += nth) {
+            rope_cache_init(i2, table + i2*ne0);
+        }
+        ggml_barrier(params->threadpool);
+    }
+
     for (int64_t i3 = 0; i3 < ne3; i3++) { // batch
         for (int64_t i2 = 0; i2 < ne2; i2++) { // seq-len
 
-            float * cache = (float *) params->wdata + (ne0 + CACHE_LINE_SIZE_F32)*ith;
-            if (!mrope_used) {
-                const int64_t p = pos[i2];
-                ggml_rope_cache_init(p, freq_scale, freq_factors, corr_dims, ne0, ext_factor, attn_factor, cache, sin_sign, theta_scale);
+            // skip the positions without rows for this thread
+            if (ir + ne1 <= ir0 || ir >= ir1) {
+                ir += ne1;
+                continue;
             }
-            else {
-                const int64_t p_t = pos[i2];
-                const int64_t p_h = pos[i2 + ne2];
-                const int64_t p_w = pos[i2 + ne2 * 2];
-                const int64_t p_e = pos[i2 + ne2 * 3];
-                ggml_mrope_cache_init(
-                    p_t, p_h, p_w, p_e, sections, is_imrope, is_vision,
-                    freq_scale, freq_factors, corr_dims, ne0, ext_factor, attn_factor, cache, sin_sign, theta_scale);
+
+            float * cache = nullptr;
+            if (table) {
+                cache = table + i2*ne0;
+            } else {
+                cache = (float *) params->wdata + (ne0 + CACHE_LINE_SIZE_F32)*ith;
+                rope_cache_init(i2, cache);
             }
 
             for (int64_t i1 = 0; i1 < ne1; i1++) { // attn-heads
@@ -6512,41 +6608,41 @@ void ggml_compute_forward_im2col_3d(
 }
 
 static void ggml_call_mul_mat(ggml_type type, const ggml_compute_params * params, int64_t m, int64_t n, int64_t k,
-                              void * a, void * b, float * c) {
+                              int64_t n_batch, void * a, void * b, float * c) {
     const ggml_type_traits * traits = ggml_get_type_traits(type);
     struct ggml_tensor src1 = {};
     src1.type  = type;
     src1.ne[0] = k;
     src1.ne[1] = m;
-    src1.ne[2] = 1;
+    src1.ne[2] = n_batch;
     src1.ne[3] = 1;
     src1.nb[0] = traits->type_size;
     src1.nb[1] = k * traits->type_size;
-    src1.nb[2] = src1.nb[1];
-    src1.nb[3] = src1.nb[2];
+    src1.nb[2] = m * src1.nb[1];
+    src1.nb[3] = n_batch * src1.nb[2];
     src1.data  = a;
 
     struct ggml_tensor src0 = {};
     src0.type  = type;
     src0.ne[0] = k;
     src0.ne[1] = n;
-    src0.ne[2] = 1;
+    src0.ne[2] = n_batch;
     src0.ne[3] = 1;
     src0.nb[0] = traits->type_size;
     src0.nb[1] = k * traits->type_size;
-    src0.nb[2] = src0.nb[1];
-    src0.nb[3] = src0.nb[2];
+    src0.nb[2] = n * src0.nb[1];
+    src0.nb[3] = n_batch * src0.nb[2];
     src0.data  = b;
 
     struct ggml_tensor dst = {};
     dst.ne[0] = n;
     dst.ne[1] = m;
-    dst.ne[2] = 1;
+    dst.ne[2] = n_batch;
     dst.ne[3] = 1;
     dst.nb[0] = sizeof(float);
     dst.nb[1] = n * sizeof(float);
-    dst.nb[2] = dst.nb[1];
-    dst.nb[3] = dst.nb[2];
+    dst.nb[2] = m * dst.nb[1];
+    dst.nb[3] = n_batch * dst.nb[2];
     dst.data  = c;
     dst.src[0] = &src0;
     dst.src[1] = &src1;
@@ -6556,11 +6652,183 @@ static void ggml_call_mul_mat(ggml_type type, const ggml_compute_params * params
 
 // ggml_compute_forward_conv_2d
 
+static bool ggml_conv_2d_tensors_overlap(const ggml_tensor * a, const ggml_tensor * b) {
+    const char * a0 = (const char *) a->data;
+    const char * b0 = (const char *) b->data;
+    return a0 < b0 + ggml_nbytes(b) && b0 < a0 + ggml_nbytes(a);
+}
+
+// element-wise nodes that can be applied to the outputs of the CONV_2D node conv, one output channel at a time
+static bool ggml_conv_2d_epilogue_op(const ggml_tensor * node, const ggml_tensor * prev, const ggml_tensor * conv) {
+    if (node->src[0] != prev || node->type != GGML_TYPE_F32 || !ggml_is_contiguous(node) || !ggml_are_same_shape(node, conv)) {
+        return false;
+    }
+
+    switch (node->op) {
+        case GGML_OP_ADD:
+        case GGML_OP_SUB:
+        case GGML_OP_MUL:
+        case GGML_OP_DIV:
+            {
+                // one value per output channel, or a single value
+                const ggml_tensor * b = node->src[1];
+                return b->type == GGML_TYPE_F32 && b->ne[0] == 1 && b->ne[1] == 1 && b->ne[3] == 1 &&
+                       (b->ne[2] == 1 || b->ne[2] == conv->ne[2]);
+            }
+        case GGML_OP_LEAKY_RELU:
+            return true;
+        case GGML_OP_UNARY:
+            switch (ggml_get_unary_op(node)) {
+                case GGML_UNARY_OP_RELU:
+                case GGML_UNARY_OP_SIGMOID:
+                case GGML_UNARY_OP_SILU:
+                case GGML_UNARY_OP_TANH:
+                    return true;
+                default:
+                    return false;
+            }
+        default:
+            return false;
+    }
+}
+
+int ggml_conv_2d_epilogue_init(const ggml_cgraph * cgraph, int node_n, ggml_conv_2d_epilogue * ep) {
+    ggml_tensor * conv = cgraph->nodes[node_n];
+
+    ep->n_ops = 0;
+    ep->dst   = conv;
+    ep->pool  = NULL;
+
+    // the use counts tell if the intermediate results are needed by other nodes
+    if (conv->op != GGML_OP_CONV_2D || conv->type != GGML_TYPE_F32 || cgraph->use_counts == NULL) {
+        return node_n;
+    }
+
+    // the convolution, the element-wise nodes that each read the previous one, and a POOL_2D of the result
+    int          idxs[GGML_CONV_2D_EPILOGUE_MAX + 2];
+    enum ggml_op ops [GGML_CONV_2D_EPILOGUE_MAX + 2];
+    int          n_nodes = 0;
+    bool         pool    = false;
+
+    idxs[n_nodes] = node_n;
+    ops [n_nodes] = conv->op;
+    n_nodes++;
+
+    const ggml_tensor * prev = conv;
+    for (int i = node_n + 1; i < cgraph->n_nodes; ++i) {
+        const ggml_tensor * node = cgraph->nodes[i];
+
+        if (ggml_op_is_empty(node->op)) {
+            continue;
+        }
+        if (n_nodes - 1 < GGML_CONV_2D_EPILOGUE_MAX && ggml_conv_2d_epilogue_op(node, prev, conv)) {
+            idxs[n_nodes] = i;
+            ops [n_nodes] = node->op;
+            n_nodes++;
+            prev = node;
+            continue;
+        }
+        if (node->op == GGML_OP_POOL_2D && node->src[0] == prev && node->type == GGML_TYPE_F32) {
+            idxs[n_nodes] = i;
+            ops [n_nodes] = node->op;
+            n_nodes++;
+            pool = true;
+        }
+        break;
+    }
+
+    // the longest chain whose intermediate results, including the in-place ones, are only read by the chain
+    const int n_found = n_nodes;
+    while (n_nodes > 1 && !ggml_can_fuse_subgraph_ext(cgraph, idxs, n_nodes, ops, &idxs[n_nodes - 1], 1)) {
+        n_nodes--;
+    }
+    pool = pool && n_nodes == n_found;
+
+    for (int i = 1; i < n_nodes - (pool ? 1 : 0); ++i) {
+        ep->ops[ep->n_ops++] = cgraph->nodes[idxs[i]];
+        ep->dst = cgraph->nodes[idxs[i]];
+    }
+    if (pool) {
+        ep->pool = cgraph->nodes[idxs[n_nodes - 1]];
+    }
+
+    const int last = idxs[n_nodes - 1];
+
+    // the fused nodes are computed while the convolution still reads its inputs, which the allocator may have given
+    // the same memory as the result of the last node
+    bool overlap = ep->dst != conv && (ggml_conv_2d_tensors_overlap(ep->dst, conv->src[0]) ||
+                                       ggml_conv_2d_tensors_overlap(ep->dst, conv->src[1]));
+    for (int i = 0; i < ep->n_ops && !overlap; ++i) {
+        const ggml_tensor * b = ep->ops[i]->src[1];
+        overlap = b != NULL && ggml_conv_2d_tensors_overlap(ep->dst, b);
+    }
+
+    if (overlap) {
+        ep->n_ops = 0;
+        ep->dst   = conv;
+        ep->pool  = NULL;
+        return node_n;
+    }
+
+    return last;
+}
+
+// stores n consecutive outputs x of the output channel oc to y, through the epilogue if there is one
+static void ggml_conv_2d_store(const ggml_conv_2d_epilogue * ep, int64_t oc, float * y, const float * x, int n) {
+    if (y != x) {
+        memcpy(y, x, n*sizeof(float));
+    }
+    if (ep == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < ep->n_ops; ++i) {
+        const ggml_tensor * node = ep->ops[i];
+
+        switch (node->op) {
+            case GGML_OP_ADD:
+            case GGML_OP_SUB:
+            case GGML_OP_MUL:
+            case GGML_OP_DIV:
+                {
+                    const ggml_tensor * b = node->src[1];
+                    const float v = *(const float *) ((const char *) b->data + (b->ne[2] == 1 ? 0 : oc*b->nb[2]));
+                    switch (node->op) {
+                        case GGML_OP_ADD: for (int j = 0; j < n; ++j) y[j] += v; break;
+                        case GGML_OP_SUB: for (int j = 0; j < n; ++j) y[j] -= v; break;
+                        case GGML_OP_MUL: for (int j = 0; j < n; ++j) y[j] *= v; break;
+                        case GGML_OP_DIV: for (int j = 0; j < n; ++j) y[j] /= v; break;
+                        default: GGML_ABORT("fatal error");
+                    }
+                } break;
+            case GGML_OP_LEAKY_RELU:
+                {
+                    float negative_slope;
+                    memcpy(&negative_slope, node->op_params, sizeof(float));
+                    ggml_vec_leaky_relu_f32(n, y, y, negative_slope);
+                } break;
+            case GGML_OP_UNARY:
+                {
+                    switch (ggml_get_unary_op(node)) {
+                        case GGML_UNARY_OP_RELU:    ggml_vec_relu_f32   (n, y, y); break;
+                        case GGML_UNARY_OP_SIGMOID: ggml_vec_sigmoid_f32(n, y, y); break;
+                        case GGML_UNARY_OP_SILU:    ggml_vec_silu_f32   (n, y, y); break;
+                        case GGML_UNARY_OP_TANH:    ggml_vec_tanh_f32   (n, y, y); break;
+                        default: GGML_ABORT("fatal error");
+                    }
+                } break;
+            default:
+                GGML_ABORT("fatal error");
+        }
+    }
+}
+
 static void ggml_compute_forward_conv_2d_impl(const ggml_compute_params * params,
                                               const ggml_tensor *         kernel,  // [KW, KH, IC, OC]
                                               const ggml_tensor *         src,     // [W, H, C, N]
                                               ggml_tensor *               dst,     // [OW, OH, OC, N]
-                                              ggml_type                   kernel_type) {
+                                              ggml_type                   kernel_type,
+                                              const ggml_conv_2d_epilogue * ep) {
 
     GGML_ASSERT(ggml_is_contiguous(kernel));
     GGML_ASSERT(kernel_type == GGML_TYPE_F16 || kernel_type == GGML_TYPE_F32);
@@ -6588,7 +6856,7 @@ static void ggml_compute_forward_conv_2d_impl(const ggml_compute_params * params
 
     const float * src_data = (float *) src->data;
     void  * knl_data       = kernel->data;
-    float * dst_data       = (float *) dst->data;
+    float * dst_data       = (float *) (ep ? ep->dst : dst)->data;
 
     const int64_t knl_n           = knl_w * knl_h * c_in;
     const int64_t patch_total     = dst->ne[3] * dst_w * dst_h;
@@ -6656,7 +6924,7 @@ static void ggml_compute_forward_conv_2d_impl(const ggml_compute_params * params
         GGML_ASSERT(gemm_output + patch_n * c_out <= (float*)tmp + params->wsize);
 
         // GEMM: patches[patch_n, knl_n] × kernel[knl_n, c_out] = output[patch_n, c_out]
-        ggml_call_mul_mat(kernel_type, params, patch_n, c_out, knl_n, tmp, knl_data, gemm_output);
+        ggml_call_mul_mat(kernel_type, params, patch_n, c_out, knl_n, 1, tmp, knl_data, gemm_output);
 
         ggml_barrier(params->threadpool);
 
@@ -6675,20 +6943,460 @@ static void ggml_compute_forward_conv_2d_impl(const ggml_compute_params * params
             for (int64_t oc = 0; oc < c_out; ++oc) {
                 const float value = gemm_output[i * c_out + oc];
                 float * dst_ptr = (float *)((char *)dst_data + dst_x * dst->nb[0] + dst_y * dst->nb[1] + oc * dst->nb[2] + batch_n * dst->nb[3]);
-                *dst_ptr = value;
+                ggml_conv_2d_store(ep, oc, dst_ptr, &value, 1);
             }
         }
     }
 }
 
-void ggml_compute_forward_conv_2d(
+// CONV_2D picks one of three algorithms from the shape of the convolution (ggml_conv_2d_get_algo):
+//  - Winograd F(4x4, 3x3) for large enough 3x3 convolutions with unit stride and dilation: the kernel and the 6x6
+//    input tiles are transformed, the 36 products of a batch of tiles with the kernel are computed by one batched
+//    matrix multiplication and transformed back to 4x4 output tiles
+//  - direct for [IC, KW, KH, OC], quantized and FP8 kernels and for many input channels: the input is converted once to rows of the vec_dot type
+//    of the kernel with the channels contiguous (NHWC), and the outputs are accumulated from the dot products of the
+//    kernel with the input pixels they cover, without materializing the patches
+//  - im2col otherwise: patches are gathered in batches and multiplied with the kernel
+enum ggml_conv_2d_algo {
+    GGML_CONV_2D_ALGO_IM2COL,
+    GGML_CONV_2D_ALGO_WINOGRAD,
+    GGML_CONV_2D_ALGO_DIRECT,
+};
+
+struct ggml_conv_2d_shape {
+    int64_t kw, kh, ic, oc; // kernel
+    int64_t w, h, n;        // input
+    int64_t ow, oh;         // output
+    int32_t s0, s1, p0, p1, d0, d1;
+};
+
+static ggml_conv_2d_shape ggml_conv_2d_get_shape(const ggml_tensor * dst) {
+    const ggml_tensor * kernel = dst->src[0];
+    const ggml_tensor * src    = dst->src[1];
+
+    // [IC, KW, KH, OC] kernel of ggml_conv_2d_direct_cwhn
+    const bool cwhn = ggml_get_op_params_i32(dst, 6) != 0;
+
+    ggml_conv_2d_shape sh;
+    sh.kw = cwhn ? kernel->ne[1] : kernel->ne[0];
+    sh.kh = cwhn ? kernel->ne[2] : kernel->ne[1];
+    sh.ic = cwhn ? kernel->ne[0] : kernel->ne[2];
+    sh.oc = kernel->ne[3];
+    sh.w  = src->ne[0];
+    sh.h  = src->ne[1];
+    sh.n  = src->ne[3];
+    sh.ow = dst->ne[0];
+    sh.oh = dst->ne[1];
+    sh.s0 = dst->op_params[0];
+    sh.s1 = dst->op_params[1];
+    sh.p0 = dst->op_params[2];
+    sh.p1 = dst->op_params[3];
+    sh.d0 = dst->op_params[4];
+    sh.d1 = dst->op_params[5];
+
+    return sh;
+}
+
+static ggml_conv_2d_algo ggml_conv_2d_get_algo(const ggml_tensor * dst) {
+    // only the direct convolution reads [IC, KW, KH, OC] kernels and computes with vec_dot on the kernel as it is stored
+    if (ggml_get_op_params_i32(dst, 6) != 0 || ggml_is_quantized(dst->src[0]->type) || ggml_is_fp8(dst->src[0]->type)) {
+        return GGML_CONV_2D_ALGO_DIRECT;
+    }
+
+    const ggml_conv_2d_shape sh = ggml_conv_2d_get_shape(dst);
+
+    const int64_t n_tiles = ((sh.ow + 3)/4) * ((sh.oh + 3)/4);
+
+    if (sh.kw == 3 && sh.kh == 3 && sh.s0 == 1 && sh.s1 == 1 && sh.d0 == 1 && sh.d1 == 1 &&
+        sh.ic >= GGML_CONV_2D_WINOGRAD_MIN_C && sh.oc >= GGML_CONV_2D_WINOGRAD_MIN_C &&
+        n_tiles >= GGML_CONV_2D_WINOGRAD_MIN_TILES) {
+        return GGML_CONV_2D_ALGO_WINOGRAD;
+    }
+
+    if (sh.ic >= GGML_CONV_2D_DIRECT_MIN_C) {
+        return GGML_CONV_2D_ALGO_DIRECT;
+    }
+
+    return GGML_CONV_2D_ALGO_IM2COL;
+}
+
+// number of 4x4 output tiles processed together by the Winograd convolution
+static int64_t ggml_conv_2d_winograd_batch(const ggml_conv_2d_shape & sh) {
+    const int64_t n_tiles = sh.n * ((sh.ow + 3)/4) * ((sh.oh + 3)/4);
+    const int64_t n_batch = GGML_IM2COL_WORK_SIZE / (36*(sh.ic + sh.oc)*sizeof(float));
+
+    return MAX(1, MIN(n_batch, n_tiles));
+}
+
+size_t ggml_conv_2d_work_size(const ggml_tensor * dst, int n_threads) {
+    const ggml_conv_2d_shape sh = ggml_conv_2d_get_shape(dst);
+
+    switch (ggml_conv_2d_get_algo(dst)) {
+        case GGML_CONV_2D_ALGO_WINOGRAD:
+            {
+                // transformed kernel, input tiles and their products with the kernel
+                return sizeof(float)*36*(sh.oc*sh.ic + ggml_conv_2d_winograd_batch(sh)*(sh.ic + sh.oc));
+            }
+        case GGML_CONV_2D_ALGO_DIRECT:
+            {
+                const ggml_tensor * kernel = dst->src[0];
+
+                const ggml_type vec_dot_type = ggml_get_type_traits_cpu(kernel->type)->vec_dot_type;
+
+                // per-thread image row, kernel with the input channels in the rows and the input as rows of the vec_dot type
+                size_t cur = sizeof(float)*n_threads*sh.w*sh.ic + sh.n*sh.h*sh.w*ggml_row_size(vec_dot_type, sh.ic);
+                if (ggml_get_op_params_i32(dst, 6) == 0) {
+                    cur += ggml_nbytes(kernel);
+                }
+                return cur;
+            }
+        case GGML_CONV_2D_ALGO_IM2COL:
+            break;
+    }
+
+    return GGML_IM2COL_WORK_SIZE;
+}
+
+// U = G g G^T of the 3x3 kernel g, element (i, j) of U is stored at u[(6*i + j)*su]
+static void ggml_conv_2d_winograd_kernel(const float * g, float * u, int64_t su) {
+    float t[6][3];
+    for (int j = 0; j < 3; ++j) {
+        const float g0 = g[0*3 + j];
+        const float g1 = g[1*3 + j];
+        const float g2 = g[2*3 + j];
+        t[0][j] = g0/4;
+        t[1][j] = -(g0 + g1 + g2)/6;
+        t[2][j] = -(g0 - g1 + g2)/6;
+        t[3][j] = g0/24 + g1/12 + g2/6;
+        t[4][j] = g0/24 - g1/12 + g2/6;
+        t[5][j] = g2;
+    }
+    for (int i = 0; i < 6; ++i) {
+        const float g0 = t[i][0];
+        const float g1 = t[i][1];
+        const float g2 = t[i][2];
+        float * r = u + 6*i*su;
+        r[0*su] = g0/4;
+        r[1*su] = -(g0 + g1 + g2)/6;
+        r[2*su] = -(g0 - g1 + g2)/6;
+        r[3*su] = g0/24 + g1/12 + g2/6;
+        r[4*su] = g0/24 - g1/12 + g2/6;
+        r[5*su] = g2;
+    }
+}
+
+// V = B^T d B of the 6x6 input tile d, element (i, j) of V is stored at v[(6*i + j)*sv]
+static void ggml_conv_2d_winograd_input(const float * d, float * v, int64_t sv) {
+    float t[6][6];
+    for (int j = 0; j < 6; ++j) {
+        const float d0 = d[0*6 + j];
+        const float d1 = d[1*6 + j];
+        const float d2 = d[2*6 + j];
+        const float d3 = d[3*6 + j];
+        const float d4 = d[4*6 + j];
+        const float d5 = d[5*6 + j];
+        t[0][j] = 4*d0 - 5*d2 + d4;
+        t[1][j] = -4*(d1 + d2) + d3 + d4;
+        t[2][j] =  4*(d1 - d2) - d3 + d4;
+        t[3][j] = -2*(d1 - d3) - d2 + d4;
+        t[4][j] =  2*(d1 - d3) - d2 + d4;
+        t[5][j] = 4*d1 - 5*d3 + d5;
+    }
+    for (int i = 0; i < 6; ++i) {
+        const float d0 = t[i][0];
+        const float d1 = t[i][1];
+        const float d2 = t[i][2];
+        const float d3 = t[i][3];
+        const float d4 = t[i][4];
+        const float d5 = t[i][5];
+        float * r = v + 6*i*sv;
+        r[0*sv] = 4*d0 - 5*d2 + d4;
+        r[1*sv] = -4*(d1 + d2) + d3 + d4;
+        r[2*sv] =  4*(d1 - d2) - d3 + d4;
+        r[3*sv] = -2*(d1 - d3) - d2 + d4;
+        r[4*sv] =  2*(d1 - d3) - d2 + d4;
+        r[5*sv] = 4*d1 - 5*d3 + d5;
+    }
+}
+
+// Y = A^T m A of the 6x6 product tile m, element (i, j) of m is read from m[(6*i + j)*sm], Y is stored row by row
+static void ggml_conv_2d_winograd_output(const float * m, int64_t sm, float * y) {
+    float t[4][6];
+    for (int j = 0; j < 6; ++j) {
+        const float m0 = m[(0*6 + j)*sm];
+        const float m1 = m[(1*6 + j)*sm];
+        const float m2 = m[(2*6 + j)*sm];
+        const float m3 = m[(3*6 + j)*sm];
+        const float m4 = m[(4*6 + j)*sm];
+        const float m5 = m[(5*6 + j)*sm];
+        t[0][j] = m0 + m1 + m2 + m3 + m4;
+        t[1][j] = m1 - m2 + 2*(m3 - m4);
+        t[2][j] = m1 + m2 + 4*(m3 + m4);
+        t[3][j] = m1 - m2 + 8*(m3 - m4) + m5;
+    }
+    for (int i = 0; i < 4; ++i) {
+        const float m0 = t[i][0];
+        const float m1 = t[i][1];
+        const float m2 = t[i][2];
+        const float m3 = t[i][3];
+        const float m4 = t[i][4];
+        const float m5 = t[i][5];
+        y[4*i + 0] = m0 + m1 + m2 + m3 + m4;
+        y[4*i + 1] = m1 - m2 + 2*(m3 - m4);
+        y[4*i + 2] = m1 + m2 + 4*(m3 + m4);
+        y[4*i + 3] = m1 - m2 + 8*(m3 - m4) + m5;
+    }
+}
+
+static void ggml_compute_forward_conv_2d_winograd(
         const ggml_compute_params * params,
-        ggml_tensor * dst) {
+        ggml_tensor * dst,
+        const ggml_conv_2d_epilogue * ep) {
+    const ggml_tensor * kernel = dst->src[0]; // [3, 3, IC, OC]
+    const ggml_tensor * src    = dst->src[1]; // [W, H, IC, N]
+
+    GGML_ASSERT(kernel->type == GGML_TYPE_F32 || kernel->type == GGML_TYPE_F16);
+    GGML_ASSERT(src->type == GGML_TYPE_F32);
+
+    const ggml_conv_2d_shape sh = ggml_conv_2d_get_shape(dst);
+
+    const int ith = params->ith;
+    const int nth = params->nth;
+
+    const int64_t tw      = (sh.ow + 3)/4;
+    const int64_t th      = (sh.oh + 3)/4;
+    const int64_t n_tiles = sh.n*tw*th;
+    const int64_t n_batch = ggml_conv_2d_winograd_batch(sh);
+
+    float * wkernel = (float *) params->wdata;   // {IC, OC, 36}
+    float * wtiles  = wkernel + 36*sh.oc*sh.ic;  // {IC, n_batch, 36}
+    float * wprod   = wtiles + 36*n_batch*sh.ic; // {OC, n_batch, 36}
+
+    for (int64_t k = ith; k < sh.oc*sh.ic; k += nth) {
+        const int64_t oc = k / sh.ic;
+        const int64_t ic = k % sh.ic;
+
+        float g[9];
+        for (int64_t ky = 0; ky < 3; ++ky) {
+            for (int64_t kx = 0; kx < 3; ++kx) {
+                const char * p = (const char *) kernel->data + kx*kernel->nb[0] + ky*kernel->nb[1] + ic*kernel->nb[2] + oc*kernel->nb[3];
+                g[ky*3 + kx] = kernel->type == GGML_TYPE_F16 ? GGML_CPU_FP16_TO_FP32(*(const ggml_fp16_t *) p) : *(const float *) p;
+            }
+        }
+
+        ggml_conv_2d_winograd_kernel(g, wkernel + oc*sh.ic + ic, sh.oc*sh.ic);
+    }
+
+    for (int64_t t0 = 0; t0 < n_tiles; t0 += n_batch) {
+        const int64_t nt = MIN(n_batch, n_tiles - t0);
+
+        // input tiles, contiguous ranges of (tile, channel) per thread
+        const int64_t dk = (nt*sh.ic + nth - 1)/nth;
+        const int64_t k0 = dk*ith;
+        const int64_t k1 = MIN(k0 + dk, nt*sh.ic);
+
+        for (int64_t k = k0; k < k1; ++k) {
+            const int64_t t    = k / sh.ic;
+            const int64_t ic   = k % sh.ic;
+            const int64_t tile = t0 + t;
+
+            const int64_t in = tile / (tw*th);
+            const int64_t ty = tile / tw % th;
+            const int64_t tx = tile % tw;
+
+            const int64_t iy0 = ty*4 - sh.p1;
+            const int64_t ix0 = tx*4 - sh.p0;
+
+            const char * s = (const char *) src->data + ic*src->nb[2] + in*src->nb[3];
+
+            float d[36];
+            for (int64_t i = 0; i < 6; ++i) {
+                const int64_t iy = iy0 + i;
+                for (int64_t j = 0; j < 6; ++j) {
+                    const int64_t ix = ix0 + j;
+                    d[i*6 + j] = iy < 0 || iy >= sh.h || ix < 0 || ix >= sh.w ? 0.0f : *(const float *) (s + iy*src->nb[1] + ix*src->nb[0]);
+                }
+            }
+
+            ggml_conv_2d_winograd_input(d, wtiles + t*sh.ic + ic, n_batch*sh.ic);
+        }
+
+        ggml_barrier(params->threadpool);
+
+        // the products of the tiles with the kernel, one matrix multiplication for each of the 36 elements
+        ggml_call_mul_mat(GGML_TYPE_F32, params, n_batch, sh.oc, sh.ic, 36, wtiles, wkernel, wprod);
+
+        ggml_barrier(params->threadpool);
+
+        for (int64_t k = ith; k < nt*sh.oc; k += nth) {
+            const int64_t t    = k / sh.oc;
+            const int64_t oc   = k % sh.oc;
+            const int64_t tile = t0 + t;
+
+            const int64_t in = tile / (tw*th);
+            const int64_t ty = tile / tw % th;
+            const int64_t tx = tile % tw;
+
+            float y[16];
+            ggml_conv_2d_winograd_output(wprod + t*sh.oc + oc, n_batch*sh.oc, y);
+
+            char * d = (char *) (ep ? ep->dst : dst)->data + tx*4*dst->nb[0] + oc*dst->nb[2] + in*dst->nb[3];
+            for (int64_t i = 0; i < 4 && ty*4 + i < sh.oh; ++i) {
+                ggml_conv_2d_store(ep, oc, (float *) (d + (ty*4 + i)*dst->nb[1]), y + 4*i, MIN(4, sh.ow - tx*4));
+            }
+        }
+    }
+}
+
+static void ggml_compute_forward_conv_2d_direct(
+        const ggml_compute_params * params,
+        ggml_tensor * dst,
+        const ggml_conv_2d_epilogue * ep) {
+    const ggml_tensor * kernel = dst->src[0]; // [IC, KW, KH, OC] of ggml_conv_2d_direct_cwhn, or [KW, KH, IC, OC]
+    const ggml_tensor * src    = dst->src[1]; // [W, H, IC, N]
+
+    GGML_ASSERT(src->type == GGML_TYPE_F32);
+    GGML_ASSERT(ggml_is_quantized(kernel->type) || ggml_is_fp8(kernel->type) || kernel->type == GGML_TYPE_F32 || kernel->type == GGML_TYPE_F16);
+
+    const ggml_conv_2d_shape sh = ggml_conv_2d_get_shape(dst);
+
+    const ggml_type        vec_dot_type = ggml_get_type_traits_cpu(kernel->type)->vec_dot_type;
+    ggml_vec_dot_t   const vec_dot      = ggml_get_type_traits_cpu(kernel->type)->vec_dot;
+    ggml_from_float_t const from_float  = ggml_get_type_traits_cpu(vec_dot_type)->from_float;
+
+    GGML_ASSERT(kernel->nb[0] == ggml_type_size(kernel->type));
+    GGML_ASSERT(sh.ic % ggml_blck_size(vec_dot_type) == 0);
+
+    const int ith = params->ith;
+    const int nth = params->nth;
+
+    const size_t row_size = ggml_row_size(vec_dot_type, sh.ic);
+
+    // [KW, KH, IC, OC] kernels are repacked with the input channels in the rows
+    const bool repack = ggml_get_op_params_i32(dst, 6) == 0;
+
+    float * wrow = (float *) params->wdata + ith*sh.w*sh.ic;               // {IC, W} per thread
+    char  * wknl = (char *) params->wdata + sizeof(float)*nth*sh.w*sh.ic; // {IC, KW, KH, OC} if repacked
+    char  * wsrc = wknl + (repack ? ggml_nbytes(kernel) : 0);             // {IC, W, H, N} of vec_dot_type
+
+    // the kernel with the input channels in the rows, and its strides along KW, KH and OC
+    const char * knl = repack ? wknl : (const char *) kernel->data;
+
+    const size_t ts   = ggml_type_size(kernel->type);
+    const size_t knb1 = repack ? sh.ic*ts   : kernel->nb[1];
+    const size_t knb2 = repack ? sh.kw*knb1 : kernel->nb[2];
+    const size_t knb3 = repack ? sh.kh*knb2 : kernel->nb[3];
+
+    if (repack) {
+        for (int64_t oc = ith; oc < sh.oc; oc += nth) {
+            for (int64_t ic = 0; ic < sh.ic; ++ic) {
+                for (int64_t ky = 0; ky < sh.kh; ++ky) {
+                    const char * k = (const char *) kernel->data + ky*kernel->nb[1] + ic*kernel->nb[2] + oc*kernel->nb[3];
+                          char * r = wknl + ic*ts + ky*knb2 + oc*knb3;
+                    for (int64_t kx = 0; kx < sh.kw; ++kx) {
+                        memcpy(r + kx*knb1, k + kx*ts, ts);
+                    }
+                }
+            }
+        }
+    }
+
+    // input pixels as rows of the vec_dot type, one image row at a time
+    for (int64_t r = ith; r < sh.n*sh.h; r += nth) {
+        const int64_t in = r / sh.h;
+        const int64_t iy = r % sh.h;
+
+        for (int64_t ic = 0; ic < sh.ic; ++ic) {
+            const char * s = (const char *) src->data + iy*src->nb[1] + ic*src->nb[2] + in*src->nb[3];
+            for (int64_t ix = 0; ix < sh.w; ++ix) {
+                wrow[ix*sh.ic + ic] = *(const float *) (s + ix*src->nb[0]);
+            }
+        }
+
+        for (int64_t ix = 0; ix < sh.w; ++ix) {
+            from_float(wrow + ix*sh.ic, wsrc + (r*sh.w + ix)*row_size, sh.ic);
+        }
+    }
+
+    ggml_barrier(params->threadpool);
+
+    // blocks of output pixels of a row, every kernel row is used for the whole block
+    const int64_t nbx = (sh.ow + GGML_CONV_2D_DIRECT_BLOCK - 1)/GGML_CONV_2D_DIRECT_BLOCK;
+
+    for (int64_t task = ith; task < sh.n*sh.oh*nbx; task += nth) {
+        const int64_t bx = task % nbx;
+        const int64_t oy = task / nbx % sh.oh;
+        const int64_t in = task / (nbx*sh.oh);
+
+        const int64_t ox0 = bx*GGML_CONV_2D_DIRECT_BLOCK;
+        const int64_t nx  = MIN(GGML_CONV_2D_DIRECT_BLOCK, sh.ow - ox0);
+
+        const char * img = wsrc + in*sh.h*sh.w*row_size;
+
+        for (int64_t oc = 0; oc < sh.oc; ++oc) {
+            float acc[GGML_CONV_2D_DIRECT_BLOCK] = { 0.0f };
+
+            for (int64_t ky = 0; ky < sh.kh; ++ky) {
+                const int64_t iy = oy*sh.s1 + ky*sh.d1 - sh.p1;
+                if (iy < 0 || iy >= sh.h) {
+                    continue;
+                }
+                for (int64_t kx = 0; kx < sh.kw; ++kx) {
+                    const char * k = knl + kx*knb1 + ky*knb2 + oc*knb3;
+
+                    for (int64_t p = 0; p < nx; ++p) {
+                        const int64_t ix = (ox0 + p)*sh.s0 + kx*sh.d0 - sh.p0;
+                        if (ix < 0 || ix >= sh.w) {
+                            continue;
+                        }
+                        float v;
+                        vec_dot(sh.ic, &v, 0, k, 0, img + (iy*sh.w + ix)*row_size, 0, 1);
+                        acc[p] += v;
+                    }
+                }
+            }
+
+            char * d = (char *) (ep ? ep->dst : dst)->data + ox0*dst->nb[0] + oy*dst->nb[1] + oc*dst->nb[2] + in*dst->nb[3];
+            ggml_conv_2d_store(ep, oc, (float *) d, acc, nx);
+        }
+    }
+}
+
+void ggml_compute_forward_conv_2d_fused(
+        const ggml_compute_params * params,
+        ggml_tensor * dst,
+        const ggml_conv_2d_epilogue * ep) {
 
     const ggml_tensor * src0 = dst->src[0];
     const ggml_tensor * src1 = dst->src[1];
 
-    ggml_compute_forward_conv_2d_impl(params, src0, src1, dst, src0->type);
+    GGML_ASSERT(dst->nb[0] == sizeof(float));
+
+    switch (ggml_conv_2d_get_algo(dst)) {
+        case GGML_CONV_2D_ALGO_WINOGRAD:
+            {
+                ggml_compute_forward_conv_2d_winograd(params, dst, ep);
+            } break;
+        case GGML_CONV_2D_ALGO_DIRECT:
+            {
+                ggml_compute_forward_conv_2d_direct(params, dst, ep);
+            } break;
+        case GGML_CONV_2D_ALGO_IM2COL:
+            {
+                ggml_compute_forward_conv_2d_impl(params, src0, src1, dst, src0->type, ep);
+            } break;
+    }
+
+    if (ep && ep->pool) {
+        ggml_barrier(params->threadpool);
+        ggml_compute_forward_pool_2d(params, ep->pool);
+    }
+}
+
+void ggml_compute_forward_conv_2d(
+        const ggml_compute_params * params,
+        ggml_tensor * dst) {
+    ggml_compute_forward_conv_2d_fused(params, dst, NULL);
 }
 
 // ggml_compute_forward_conv_3d
@@ -6798,7 +7506,7 @@ static void ggml_compute_forward_conv_3d_impl(const ggml_compute_params * params
         ggml_barrier(params->threadpool);
 
         float * gemm_output = (float *) ((char *) tmp + patches_per_batch * knl_n_total * traits->type_size);
-        ggml_call_mul_mat(kernel_type, params, patch_n_in_batch, oc, knl_n_total, tmp, knl_data, gemm_output);
+        ggml_call_mul_mat(kernel_type, params, patch_n_in_batch, oc, knl_n_total, 1, tmp, knl_data, gemm_output);
 
         ggml_barrier(params->threadpool);
 
@@ -7184,10 +7892,6 @@ void ggml_compute_forward_pool_2d(
 
     assert(src->type == GGML_TYPE_F32 || src->type == GGML_TYPE_F16);
 
-    if (params->ith != 0) {
-        return;
-    }
-
     const int32_t * opts = (const int32_t *)dst->op_params;
     ggml_op_pool op = static_cast<ggml_op_pool>(opts[0]);
     const int k0 = opts[1];
@@ -7196,57 +7900,55 @@ void ggml_compute_forward_pool_2d(
     const int s1 = opts[4];
     const int p0 = opts[5];
     const int p1 = opts[6];
-    const char * cdata = (const char*)src->data;
-    const char * const data_end = cdata + ggml_nbytes(src);
 
     const int64_t px = dst->ne[0];
     const int64_t py = dst->ne[1];
-    const int64_t pa = px * py;
-
-    float * dplane = (float *)dst->data;
 
     const int ka = k0 * k1;
     const int offset0 = -p0;
     const int offset1 = -p1;
 
-    while (cdata < data_end) {
-        for (int oy = 0; oy < py; ++oy) {
-            float * const drow = dplane + oy * px;
-            for (int ox = 0; ox < px; ++ox) {
-                float * const out =  drow + ox;
-                switch (op) {
-                    case GGML_OP_POOL_AVG:     *out = 0;        break;
-                    case GGML_OP_POOL_MAX:     *out = -FLT_MAX; break;
-                    case GGML_OP_POOL_COUNT: GGML_ABORT("fatal error");
-                }
+    // output rows per thread
+    const int64_t nr  = ggml_nelements(dst) / px;
+    const int64_t dr  = (nr + params->nth - 1) / params->nth;
+    const int64_t ir0 = dr * params->ith;
+    const int64_t ir1 = MIN(ir0 + dr, nr);
 
-                const int ix = offset0 + ox * s0;
-                const int iy = offset1 + oy * s1;
+    for (int64_t ir = ir0; ir < ir1; ++ir) {
+        const char * const cdata = (const char *)src->data + (ir / py) * src->nb[2];
+        const int64_t oy = ir % py;
+        float * const drow = (float *)dst->data + ir * px;
+        for (int ox = 0; ox < px; ++ox) {
+            float * const out =  drow + ox;
+            switch (op) {
+                case GGML_OP_POOL_AVG:     *out = 0;        break;
+                case GGML_OP_POOL_MAX:     *out = -FLT_MAX; break;
+                case GGML_OP_POOL_COUNT: GGML_ABORT("fatal error");
+            }
 
-                for (int ky = 0; ky < k1; ++ky) {
-                    if (iy + ky < 0 || iy + ky >= src->ne[1]) continue;
-                    const void * srow = (const void *)(cdata + src->nb[1] * (iy + ky));
-                    for (int kx = 0; kx < k0; ++kx) {
-                        int j = ix + kx;
-                        if (j < 0 || j >= src->ne[0]) continue;
-                        const float srow_j = (src->type == GGML_TYPE_F32) ? ((const float*)srow)[j] : GGML_CPU_FP16_TO_FP32(((const ggml_fp16_t*)srow)[j]);
-                        switch (op) {
-                            case GGML_OP_POOL_AVG:                     *out += srow_j; break;
-                            case GGML_OP_POOL_MAX: if (srow_j > *out)  *out  = srow_j; break;
-                            case GGML_OP_POOL_COUNT:               GGML_ABORT("fatal error");
-                        }
+            const int ix = offset0 + ox * s0;
+            const int iy = offset1 + oy * s1;
+
+            for (int ky = 0; ky < k1; ++ky) {
+                if (iy + ky < 0 || iy + ky >= src->ne[1]) continue;
+                const void * srow = (const void *)(cdata + src->nb[1] * (iy + ky));
+                for (int kx = 0; kx < k0; ++kx) {
+                    int j = ix + kx;
+                    if (j < 0 || j >= src->ne[0]) continue;
+                    const float srow_j = (src->type == GGML_TYPE_F32) ? ((const float*)srow)[j] : GGML_CPU_FP16_TO_FP32(((const ggml_fp16_t*)srow)[j]);
+                    switch (op) {
+                        case GGML_OP_POOL_AVG:                     *out += srow_j; break;
+                        case GGML_OP_POOL_MAX: if (srow_j > *out)  *out  = srow_j; break;
+                        case GGML_OP_POOL_COUNT:               GGML_ABORT("fatal error");
                     }
                 }
-                switch (op) {
-                    case GGML_OP_POOL_AVG:           *out /= ka; break;
-                    case GGML_OP_POOL_MAX:                       break;
-                    case GGML_OP_POOL_COUNT: GGML_ABORT("fatal error");
-                }
+            }
+            switch (op) {
+                case GGML_OP_POOL_AVG:           *out /= ka; break;
+                case GGML_OP_POOL_MAX:                       break;
+                case GGML_OP_POOL_COUNT: GGML_ABORT("fatal error");
             }
         }
-
-        cdata  += src->nb[2];
-        dplane += pa;
     }
 }
 
@@ -7864,8 +8566,184 @@ void ggml_compute_forward_argsort(
     }
 }
 
+// ggml_compute_forward_top_k
+
+struct top_k_entry {
+    float   v;
+    int32_t i;
+};
+
+// larger values first, ties are broken by the lower index
+static inline bool top_k_better(const top_k_entry & a, const top_k_entry & b) {
+    return a.v > b.v || (a.v == b.v && a.i < b.i);
+}
+
+// add e to the heap of the best k entries, the worst entry is at heap[0]
+static inline void top_k_push(top_k_entry * heap, int64_t & nheap, int64_t k, const top_k_entry & e) {
+    if (nheap < k) {
+        heap[nheap++] = e;
+        std::push_heap(heap, heap + nheap, top_k_better);
+    } else if (top_k_better(e, heap[0])) {
+        std::pop_heap(heap, heap + k, top_k_better);
+        heap[k - 1] = e;
+        std::push_heap(heap, heap + k, top_k_better);
+    }
+}
+
+// add x[0..n) with indices i0, i0 + 1, ... to the heap of the best k entries
+// once the heap is full, blocks that cannot contain a better entry are skipped after computing their maximum, which vectorizes well
+static void top_k_select(const float * x, int64_t n, int64_t i0, top_k_entry * heap, int64_t k) {
+    int64_t nheap = 0;
+
+    constexpr int64_t blck = 32;
+
+    for (int64_t j = 0; j < n; j += blck) {
+        const int64_t nj = std::min(blck, n - j);
+
+        if (nheap == k) {
+            float vmax = x[j];
+            for (int64_t l = 1; l < nj; ++l) {
+                vmax = std::max(vmax, x[j + l]);
+            }
+            if (vmax < heap[0].v) {
+                continue;
+            }
+        }
+
+        for (int64_t l = 0; l < nj; ++l) {
+            top_k_push(heap, nheap, k, { x[j + l], (int32_t) (i0 + j + l) });
+        }
+    }
+}
+
+// number of chunks each row is split into, only depends on the shape of src0 and k
+// every chunk keeps k candidates, so chunks are only used if that discards at least half of the row
+// the work buffer holds a heap of k entries per thread followed by the k*nseg*nrows candidates of the chunks
+static int64_t top_k_nseg(const ggml_tensor * src0, int64_t k) {
+    const int64_t nr = ggml_nrows(src0);
+    if (nr >= GGML_REDUCE_MAX_CHUNKS) {
+        return 1;
+    }
+    const int64_t nseg = std::min(src0->ne[0]/GGML_REDUCE_CHUNK_MIN, GGML_REDUCE_MAX_CHUNKS/nr);
+    return std::clamp<int64_t>(std::min(nseg, src0->ne[0]/(2*k)), 1, GGML_REDUCE_MAX_CHUNKS);
+}
+
+static void ggml_compute_forward_top_k_f32(
+        const ggml_compute_params * params,
+        ggml_tensor * dst) {
+
+    const ggml_tensor * src0 = dst->src[0];
+
+    GGML_TENSOR_UNARY_OP_LOCALS
+
+    GGML_ASSERT(nb00 == sizeof(float));
+    GGML_ASSERT(nb0  == sizeof(int32_t));
+
+    const int64_t k    = ggml_get_op_params_i32(dst, 0);
+    const int64_t nseg = top_k_nseg(src0, k);
+    const int64_t nr   = ggml_nrows(src0);
+
+    GGML_ASSERT(ne0 == k);
+
+    top_k_entry * heap = (top_k_entry *) params->wdata + (k + CACHE_LINE_SIZE_F32)*params->ith;
+
+    const auto [ir0, ir1] = get_thread_range(params, src0);
+
+    if (nseg == 1) {
+        for (int64_t ir = ir0; ir < ir1; ++ir) {
+            const int64_t i03 = ir/(ne02*ne01);
+            const int64_t i02 = (ir - i03*ne02*ne01)/ne01;
+            const int64_t i01 = (ir - i03*ne02*ne01 - i02*ne01);
+
+            const float * src_data = (const float *) ((const char *) src0->data + i01*nb01 + i02*nb02 + i03*nb03);
+            int32_t     * dst_data = (int32_t     *) ((char       *)  dst->data + i01*nb1  + i02*nb2  + i03*nb3);
+
+            top_k_select(src_data, ne00, 0, heap, k);
+            std::sort(heap, heap + k, top_k_better);
+
+            for (int64_t j = 0; j < k; ++j) {
+                dst_data[j] = heap[j].i;
+            }
+        }
+        return;
+    }
+
+    // few wide rows: each chunk of a row selects k candidates, then the candidates of each row are merged
+    top_k_entry * cand = (top_k_entry *) params->wdata + (k + CACHE_LINE_SIZE_F32)*params->nth;
+
+    for (int64_t iu = params->ith; iu < nr*nseg; iu += params->nth) {
+        const int64_t ir   = iu/nseg;
+        const int64_t iseg = iu - ir*nseg;
+
+        const int64_t i03 = ir/(ne02*ne01);
+        const int64_t i02 = (ir - i03*ne02*ne01)/ne01;
+        const int64_t i01 = (ir - i03*ne02*ne01 - i02*ne01);
+
+        const int64_t i00 = iseg*ne00/nseg;
+        const int64_t i10 = (iseg + 1)*ne00/nseg;
+
+        const float * src_data = (const float *) ((const char *) src0->data + i01*nb01 + i02*nb02 + i03*nb03);
+
+        // each chunk has at least 2*k elements
+        top_k_select(src_data + i00, i10 - i00, i00, cand + iu*k, k);
+    }
+
+    ggml_barrier(params->threadpool);
+
+    for (int64_t ir = ir0; ir < ir1; ++ir) {
+        const int64_t i03 = ir/(ne02*ne01);
+        const int64_t i02 = (ir - i03*ne02*ne01)/ne01;
+        const int64_t i01 = (ir - i03*ne02*ne01 - i02*ne01);
+
+        int32_t * dst_data = (int32_t *) ((char *) dst->data + i01*nb1 + i02*nb2 + i03*nb3);
+
+        int64_t nheap = 0;
+        for (int64_t j = 0; j < k*nseg; ++j) {
+            top_k_push(heap, nheap, k, cand[ir*nseg*k + j]);
+        }
+        std::sort(heap, heap + k, top_k_better);
+
+        for (int64_t j = 0; j < k; ++j) {
+            dst_data[j] = heap[j].i;
+        }
+    }
+}
+
+void ggml_compute_forward_top_k(
+        const ggml_compute_params * params,
+        ggml_tensor * dst) {
+
+    const ggml_tensor * src0 = dst->src[0];
+
+    switch (src0->type) {
+        case GGML_TYPE_F32:
+            {
+                ggml_compute_forward_top_k_f32(params, dst);
+            } break;
+        default:
+            {
+                GGML_ABORT("fatal error");
+            }
+    }
+}
+
 // ggml_compute_forward_flash_attn_ext
 
+// number of KV rows processed together by the flash attention kernel
+#define FA_KV_TILE 32
+
+typedef void (*ggml_vec_mad_q_t)(int n, float * GGML_RESTRICT y, const void * GGML_RESTRICT vx, size_t bx, const float * GGML_RESTRICT v, int nrc);
+
+// fused dequantize and multiply-add of several V rows, NULL if V rows are converted one at a time with to_float
+static ggml_vec_mad_q_t ggml_get_vec_mad_q(ggml_type type) {
+    switch (type) {
+        case GGML_TYPE_Q4_0: return ggml_vec_mad_q4_0;
+        case GGML_TYPE_Q8_0: return ggml_vec_mad_q8_0;
+        case GGML_TYPE_Q5_K: return ggml_vec_mad_q5_K;
+        default:             return NULL;
+    }
+}
+
 static void ggml_compute_forward_flash_attn_ext_f16_one_chunk(
         const ggml_compute_params * params,
         ggml_tensor * dst,
@@ -7940,6 +8818,7 @@ static void ggml_compute_forward_flash_attn_ext_f16_one_chunk(
     ggml_from_float_t const q_to_vec_dot   = ggml_get_type_traits_cpu(k_vec_dot_type)->from_float;
     ggml_vec_dot_t    const kq_vec_dot     = ggml_get_type_traits_cpu(k->type)->vec_dot;
     ggml_to_float_t   const v_to_float     = ggml_get_type_traits(v->type)->to_float;
+    ggml_vec_mad_q_t  const v_mad          = ggml_get_vec_mad_q(v->type);
 
     GGML_ASSERT((                            q_to_vec_dot) && "fattn: unsupported K-type");
     GGML_ASSERT((v->type == GGML_TYPE_F32 || v_to_float  ) && "fattn: unsupported V-type");
@@ -7984,73 +8863,89 @@ static void ggml_compute_forward_flash_attn_ext_f16_one_chunk(
         q_to_vec_dot(pq, Q_q, DK);
 
         // online softmax / attention
-        // loop over n_kv and n_head_kv
+        // loop over n_kv and n_head_kv in tiles of FA_KV_TILE rows: the KQ values of a tile are computed first,
+        // so that VKQ is rescaled at most once per tile and quantized V rows are accumulated by a single fused kernel call
         // ref: https://arxiv.org/pdf/2112.05682.pdf
-        for (int64_t ic = 0; ic < nek1; ++ic) {
-            const float mv = mp ? slope*GGML_CPU_FP16_TO_FP32(mp[ic]) : 0.0f;
-            if (mv == -INFINITY) {
-                continue;
-            }
+        for (int64_t ic0 = 0; ic0 < nek1; ic0 += FA_KV_TILE) {
+            const int64_t nc = MIN(FA_KV_TILE, nek1 - ic0);
+
+            float KQ[FA_KV_TILE]; // KQ values of the tile, -INFINITY for the masked rows
+            float Mt = -INFINITY; // maximum KQ value of the tile
 
-            float s; // KQ value
+            for (int64_t jc = 0; jc < nc; ++jc) {
+                const int64_t ic = ic0 + jc;
 
-            const char * k_data = (const char *) k->data + ( ic*nbk1 + ik2*nbk2 + ik3*nbk3);
-            kq_vec_dot(DK, &s, 0, k_data, 0, Q_q, 0, 1);
+                const float mv = mp ? slope*GGML_CPU_FP16_TO_FP32(mp[ic]) : 0.0f;
+                if (mv == -INFINITY) {
+                    KQ[jc] = -INFINITY;
+                    continue;
+                }
 
-            s = s*scale; // scale KQ value
+                float s; // KQ value
 
-            if (logit_softcap != 0.0f) {
-                s = logit_softcap*tanhf(s);
-            }
+                const char * k_data = (const char *) k->data + ( ic*nbk1 + ik2*nbk2 + ik3*nbk3);
+                kq_vec_dot(DK, &s, 0, k_data, 0, Q_q, 0, 1);
 
-            s += mv; // apply mask
+                s = s*scale; // scale KQ value
+
+                if (logit_softcap != 0.0f) {
+                    s = logit_softcap*tanhf(s);
+                }
 
-            const float Mold = M;
+                s += mv; // apply mask
 
-            float ms = 1.0f; // upon new higher max val, scale VKQ and KQ sum with this value
-            float vs = 1.0f; // post-softmax KQ value, expf(s - M)
+                KQ[jc] = s;
+                Mt = MAX(Mt, s);
+            }
 
-            const char * v_data = ((const char *) v->data + (ic*nbv1 + iv2*nbv2 + iv3*nbv3));
+            if (Mt == -INFINITY) {
+                // the whole tile is masked
+                continue;
+            }
 
-            if (v->type == GGML_TYPE_F16) {
-                if (s > M) {
-                    // s is new maximum, ms < 1.0f, vs == expf(s - s) == 1.0f
-                    M = s;
-                    ms = expf(Mold - M);
+            if (Mt > M) {
+                // new maximum, scale VKQ and KQ sum with expf(Mold - M)
+                const float ms = expf(M - Mt);
+                M = Mt;
 
-                    // V = V*expf(Mold - M)
+                if (v->type == GGML_TYPE_F16) {
                     ggml_vec_scale_f16(DV, VKQ16, ms);
                 } else {
-                    // no new maximum, ms == 1.0f, vs != 1.0f
-                    vs = expf(s - M);
+                    ggml_vec_scale_f32(DV, VKQ32, ms);
                 }
+                S = S*ms;
+            }
+
+            // post-softmax KQ values expf(s - M), 0 for the masked rows
+            for (int64_t jc = 0; jc < nc; ++jc) {
+                KQ[jc] = KQ[jc] == -INFINITY ? 0.0f : expf(KQ[jc] - M);
+                S += KQ[jc];
+            }
+
+            const char * v_data = ((const char *) v->data + (ic0*nbv1 + iv2*nbv2 + iv3*nbv3));
 
-                // V += v*expf(s - M)
-                ggml_vec_mad_f16(DV, VKQ16, (const ggml_fp16_t *) v_data, vs);
+            // V += v*expf(s - M)
+            if (v_mad) {
+                v_mad(DV, VKQ32, v_data, nbv1, KQ, nc);
             } else {
-                if (s > M) {
-                    // s is new maximum, ms < 1.0f, vs == expf(s - s) == 1.0f
-                    M = s;
-                    ms = expf(Mold - M);
+                for (int64_t jc = 0; jc < nc; ++jc) {
+                    if (KQ[jc] == 0.0f) {
+                        continue;
+                    }
 
-                    // V = V*expf(Mold - M)
-                    ggml_vec_scale_f32(DV, VKQ32, ms);
-                } else {
-                    // no new maximum, ms == 1.0f, vs != 1.0f
-                    vs = expf(s - M);
-                }
+                    const char * v_row = v_data + jc*nbv1;
 
-                // V += v*expf(s - M)
-                if (v_to_float) {
-                    v_to_float(v_data, V32, DV);
-                    ggml_vec_mad_f32(DV, VKQ32, V32, vs);
-                } else {
-                    // V is F32
-                    ggml_vec_mad_f32(DV, VKQ32, (const float *) v_data, vs);
+                    if (v->type == GGML_TYPE_F16) {
+                        ggml_vec_mad_f16(DV, VKQ16, (const ggml_fp16_t *) v_row, KQ[jc]);
+                    } else if (v_to_float) {
+                        v_to_float(v_row, V32, DV);
+                        ggml_vec_mad_f32(DV, VKQ32, V32, KQ[jc]);
+                    } else {
+                        // V is F32
+                        ggml_vec_mad_f32(DV, VKQ32, (const float *) v_row, KQ[jc]);
+                    }
                 }
             }
-
-            S = S*ms + vs; // scale and increment sum with partial sum
         }
 
         if (v->type == GGML_TYPE_F16) {
@@ -8603,6 +9498,182 @@ void ggml_compute_forward_ssm_conv(
 
 // ggml_compute_forward_ssm_scan
 
+int64_t ggml_ssm_scan_n_segments(const ggml_tensor * dst, int n_threads) {
+    const int64_t nh = dst->src[1]->ne[1]; // n_head
+    const int64_t nt = dst->src[1]->ne[2]; // number of tokens per sequence
+
+    if (dst->src[3]->ne[0] != 1) {
+        // Mamba-1 has a decay factor per state, only the sequential scan handles it
+        return 1;
+    }
+
+    // enough segments to give every thread a head, each segment spanning at least two chunks
+    const int64_t n_seg = (n_threads + nh - 1)/nh;
+
+    return MAX(1, MIN(n_seg, nt/(2*GGML_SSM_SCAN_CHUNK)));
+}
+
+// Mamba-2 scan of the tokens [t0, t1) of head h of sequence i3, starting from the state S {d_state, dim}, which is
+// advanced in place. The tokens are processed in chunks (SSD formulation): within a chunk the outputs are the products
+// of C with B and x weighted by the decay between the tokens, plus the product of C with the state entering the chunk,
+// and the state is advanced once per chunk by a rank-update with B and x. When write_y is false only the state is
+// computed. Returns the log of the total decay over the tokens.
+static float ggml_ssm_scan_segment_f32(
+        const ggml_tensor * dst,
+        int64_t i3, int64_t h, int64_t t0, int64_t t1,
+        float * S, bool write_y) {
+    const ggml_tensor * src1 = dst->src[1]; // x  {dim, n_head, n_seq_tokens, n_seqs}
+    const ggml_tensor * src2 = dst->src[2]; // dt {n_head, n_seq_tokens, n_seqs}
+    const ggml_tensor * src3 = dst->src[3]; // A  {1, n_head}
+    const ggml_tensor * src4 = dst->src[4]; // B  {d_state, n_group, n_seq_tokens, n_seqs}
+    const ggml_tensor * src5 = dst->src[5]; // C  {d_state, n_group, n_seq_tokens, n_seqs}
+
+    const int64_t nc = dst->src[0]->ne[0]; // d_state
+    const int64_t nr = dst->src[0]->ne[1]; // dim
+    const int64_t nh = src1->ne[1];
+    const int64_t ng = src4->ne[1];
+    const int64_t nt = src1->ne[2];
+
+    const int64_t g = h / (nh / ng); // repeat_interleave
+
+    const float A = ((const float *) src3->data)[h];
+
+    auto x_at = [&](int64_t t) { return (const float *) ((const char *) src1->data + t*src1->nb[2] + i3*src1->nb[3]) + h*nr; };
+    auto B_at = [&](int64_t t) { return (const float *) ((const char *) src4->data + t*src4->nb[2] + i3*src4->nb[3]) + g*nc; };
+    auto C_at = [&](int64_t t) { return (const float *) ((const char *) src5->data + t*src5->nb[2] + i3*src5->nb[3]) + g*nc; };
+    auto y_at = [&](int64_t t) { return (float *) dst->data + t*nh*nr + i3*nt*nh*nr + h*nr; };
+
+    float dts[GGML_SSM_SCAN_CHUNK]; // softplus(dt)
+    float cum[GGML_SSM_SCAN_CHUNK]; // log of the decay from the start of the chunk, inclusive
+
+    float log_decay = 0.0f;
+
+    for (int64_t c0 = t0; c0 < t1; c0 += GGML_SSM_SCAN_CHUNK) {
+        const int n = (int) MIN(GGML_SSM_SCAN_CHUNK, t1 - c0);
+
+        float acc = 0.0f;
+        for (int j = 0; j < n; ++j) {
+            const float dt = ((const float *) ((const char *) src2->data + (c0 + j)*src2->nb[1] + i3*src2->nb[2]))[h];
+            dts[j] = ggml_compute_softplus_f32(dt);
+            acc   += dts[j] * A;
+            cum[j] = acc;
+        }
+
+        if (write_y) {
+            for (int j = 0; j < n; ++j) {
+                const float * C = C_at(c0 + j);
+                      float * y = y_at(c0 + j);
+
+                // state entering the chunk
+                const float dA = expf(cum[j]);
+                for (int64_t i1 = 0; i1 < nr; ++i1) {
+                    ggml_vec_dot_f32(nc, y + i1, 0, S + i1*nc, 0, C, 0, 1);
+                    y[i1] *= dA;
+                }
+
+                // tokens of the chunk up to j
+                for (int u = 0; u <= j; ++u) {
+                    float cb;
+                    ggml_vec_dot_f32(nc, &cb, 0, C, 0, B_at(c0 + u), 0, 1);
+                    ggml_vec_mad_f32(nr, y, x_at(c0 + u), expf(cum[j] - cum[u]) * dts[u] * cb);
+                }
+            }
+        }
+
+        // advance the state to the end of the chunk
+        ggml_vec_scale_f32(nr*nc, S, expf(cum[n - 1]));
+        for (int u = 0; u < n; ++u) {
+            const float   w = expf(cum[n - 1] - cum[u]) * dts[u];
+            const float * x = x_at(c0 + u);
+            const float * B = B_at(c0 + u);
+            for (int64_t i1 = 0; i1 < nr; ++i1) {
+                ggml_vec_mad_f32(nc, S + i1*nc, B, x[i1] * w);
+            }
+        }
+
+        log_decay += cum[n - 1];
+    }
+
+    return log_decay;
+}
+
+// Mamba-2 scan parallel over the heads and the tokens: every thread first computes the final state of a segment of the
+// sequence from a zero state, these are then chained from the initial state to get the state entering every segment,
+// and finally the outputs of all the segments are computed independently.
+static void ggml_compute_forward_ssm_scan_f32_segments(
+        const ggml_compute_params * params,
+        ggml_tensor * dst,
+        int64_t n_seg) {
+    const ggml_tensor * src0 = dst->src[0]; // s  {d_state, dim, n_head, n_seqs+}
+    const ggml_tensor * src1 = dst->src[1]; // x  {dim, n_head, n_seq_tokens, n_seqs}
+    const ggml_tensor * src6 = dst->src[6]; // ids {n_seqs}
+
+    const int ith = params->ith;
+    const int nth = params->nth;
+
+    const int64_t nc = src0->ne[0]; // d_state
+    const int64_t nr = src0->ne[1]; // dim
+    const int64_t nh = src1->ne[1]; // n_head
+    const int64_t nt = src1->ne[2]; // number of tokens per sequence
+    const int64_t ns = src1->ne[3]; // number of sequences in the batch
+
+    const int64_t s_off  = ggml_nelements(src1) * ggml_element_size(src1);
+    const int64_t n_state = nr*nc; // state size of a head
+
+    const int64_t seg_len = (nt + n_seg - 1)/n_seg;
+
+    float * wstate = (float *) params->wdata;           // {d_state, dim, n_head, n_seg - 1} states entering the segments 0 .. n_seg - 2
+    float * wdecay = wstate + (n_seg - 1)*nh*n_state;   // {n_head, n_seg} total decay of the segments
+
+    const int32_t * ids = (const int32_t *) src6->data;
+
+    for (int64_t i3 = 0; i3 < ns; ++i3) {
+        const float * s0 = (const float *) ((const char *) src0->data + ids[i3]*(src0->nb[3]));
+              float * s  = (      float *) ((      char *) dst->data  + i3*(src0->nb[3]) + s_off);
+
+        // the last segment works directly on the output state
+        auto state = [&](int64_t p, int64_t h) {
+            return p == n_seg - 1 ? s + h*n_state : wstate + (p*nh + h)*n_state;
+        };
+
+        // local final states, stored as the states entering the next segments
+        for (int64_t k = ith; k < (n_seg - 1)*nh; k += nth) {
+            const int64_t p = k / nh;
+            const int64_t h = k % nh;
+
+            float * S = state(p + 1, h);
+            memset(S, 0, n_state*sizeof(float));
+            wdecay[p*nh + h] = ggml_ssm_scan_segment_f32(dst, i3, h, p*seg_len, MIN(nt, (p + 1)*seg_len), S, false);
+        }
+
+        ggml_barrier(params->threadpool);
+
+        // chain the segments from the initial state
+        for (int64_t h = ith; h < nh; h += nth) {
+            const float * prev = s0 + h*n_state;
+            memcpy(state(0, h), prev, n_state*sizeof(float));
+            prev = state(0, h);
+            for (int64_t p = 1; p < n_seg; ++p) {
+                float * S = state(p, h);
+                ggml_vec_mad_f32(n_state, S, prev, expf(wdecay[(p - 1)*nh + h]));
+                prev = S;
+            }
+        }
+
+        ggml_barrier(params->threadpool);
+
+        for (int64_t k = ith; k < n_seg*nh; k += nth) {
+            const int64_t p = k / nh;
+            const int64_t h = k % nh;
+
+            ggml_ssm_scan_segment_f32(dst, i3, h, p*seg_len, MIN(nt, (p + 1)*seg_len), state(p, h), true);
+        }
+
+        // the work buffer is reused by the next sequence
+        ggml_barrier(params->threadpool);
+    }
+}
+
 static void ggml_compute_forward_ssm_scan_f32(
         const ggml_compute_params * params,
         ggml_tensor * dst) {
@@ -8637,6 +9708,12 @@ static void ggml_compute_forward_ssm_scan_f32(
     GGML_ASSERT(src6->nb[0] == sizeof(int32_t));
     GGML_ASSERT(nh % ng == 0);
 
+    const int64_t n_seg = ggml_ssm_scan_n_segments(dst, nth);
+    if (n_seg > 1) {
+        ggml_compute_forward_ssm_scan_f32_segments(params, dst, n_seg);
+        return;
+    }
+
     // heads per thread
     const int dh = (nh + nth - 1)/nth;
 
@@ -8836,8 +9913,6 @@ void ggml_compute_forward_ssm_scan(
 static void ggml_compute_forward_win_part_f32(
         const ggml_compute_params * params,
         ggml_tensor * dst) {
-    GGML_UNUSED(params);
-
     const ggml_tensor * src0 = dst->src[0];
 
     GGML_TENSOR_LOCALS(int64_t, ne0, src0, ne)
@@ -8847,30 +9922,38 @@ static void ggml_compute_forward_win_part_f32(
     const int32_t nep1 = ((const int32_t *)(dst->op_params))[1];
     const int32_t w    = ((const int32_t *)(dst->op_params))[2];
 
+    const int64_t np = nep0*nep1;
+
+    assert(ggml_is_contiguous(src0));
     assert(ne00 == ne0);
-    assert(ne3  == nep0*nep1);
-
-    // TODO: optimize / multi-thread
-    for (int py = 0; py < nep1; ++py) {
-        for (int px = 0; px < nep0; ++px) {
-            const int64_t i3 = py*nep0 + px;
-            for (int64_t i2 = 0; i2 < ne2; ++i2) {
-                for (int64_t i1 = 0; i1 < ne1; ++i1) {
-                    for (int64_t i0 = 0; i0 < ne0; ++i0) {
-                        const int64_t i02 = py*w + i2;
-                        const int64_t i01 = px*w + i1;
-                        const int64_t i00 = i0;
-
-                        const int64_t i = i3*ne2*ne1*ne0 + i2*ne1*ne0    + i1*ne0   + i0;
-                        const int64_t j =                  i02*ne01*ne00 + i01*ne00 + i00;
-
-                        if (py*w + i2 >= ne02 || px*w + i1 >= ne01) {
-                            ((float *) dst->data)[i] = 0.0f;
-                        } else {
-                            ((float *) dst->data)[i] = ((float *) src0->data)[j];
-                        }
-                    }
-                }
+    assert(ne3  == np*ne03);
+
+    // rows of the windows per thread
+    const int64_t nr  = ne3*ne2;
+    const int64_t dr  = (nr + params->nth - 1)/params->nth;
+    const int64_t ir0 = dr*params->ith;
+    const int64_t ir1 = MIN(ir0 + dr, nr);
+
+    for (int64_t ir = ir0; ir < ir1; ++ir) {
+        const int64_t i3 = ir/ne2;
+        const int64_t i2 = ir%ne2;
+
+        // image i03, window (px, py)
+        const int64_t i03 = i3/np;
+        const int64_t py  = i3%np/nep0;
+        const int64_t px  = i3%np%nep0;
+
+        const int64_t i02 = py*w + i2;
+
+        float * d = (float *) dst->data + ir*ne1*ne0;
+
+        for (int64_t i1 = 0; i1 < ne1; ++i1) {
+            const int64_t i01 = px*w + i1;
+
+            if (i02 >= ne02 || i01 >= ne01) {
+                ggml_vec_set_f32(ne0, d + i1*ne0, 0.0f);
+            } else {
+                memcpy(d + i1*ne0, (const float *) src0->data + ((i03*ne02 + i02)*ne01 + i01)*ne00, ne0*sizeof(float));
             }
         }
     }
@@ -8899,8 +9982,6 @@ void ggml_compute_forward_win_part(
 static void ggml_compute_forward_win_unpart_f32(
         const ggml_compute_params * params,
         ggml_tensor * dst) {
-    GGML_UNUSED(params);
-
     const ggml_tensor * src0 = dst->src[0];
 
     GGML_TENSOR_LOCALS(int64_t, ne0, src0, ne)
@@ -8910,29 +9991,37 @@ static void ggml_compute_forward_win_unpart_f32(
 
     // padding
     const int px = (w - ne1%w)%w;
-    //const int py = (w - ne2%w)%w;
+    const int py = (w - ne2%w)%w;
 
     const int npx = (px + ne1)/w;
-    //const int npy = (py + ne2)/w;
+    const int npy = (py + ne2)/w;
 
+    assert(ggml_is_contiguous(src0));
     assert(ne0 == ne00);
+    assert(ne03 == npx*npy*ne3);
 
-    // TODO: optimize / multi-thread
-    for (int64_t i2 = 0; i2 < ne2; ++i2) {
-        for (int64_t i1 = 0; i1 < ne1; ++i1) {
-            for (int64_t i0 = 0; i0 < ne0; ++i0) {
-                const int ip2 = i2/w;
-                const int ip1 = i1/w;
+    // rows of the images per thread
+    const int64_t nr  = ne3*ne2;
+    const int64_t dr  = (nr + params->nth - 1)/params->nth;
+    const int64_t ir0 = dr*params->ith;
+    const int64_t ir1 = MIN(ir0 + dr, nr);
+
+    for (int64_t ir = ir0; ir < ir1; ++ir) {
+        const int64_t i3 = ir/ne2;
+        const int64_t i2 = ir%ne2;
 
-                const int64_t i02 = i2%w;
-                const int64_t i01 = i1%w;
-                const int64_t i00 = i0;
+        const int64_t ip2 = i2/w;
+        const int64_t i02 = i2%w;
 
-                const int64_t i = (ip2*npx + ip1)*ne02*ne01*ne00 + i02*ne01*ne00 + i01*ne00 + i00;
-                const int64_t j =                                  i2*ne1*ne0    + i1*ne0   + i0;
+        float * d = (float *) dst->data + ir*ne1*ne0;
 
-                ((float *) dst->data)[j] = ((float *) src0->data)[i];
-            }
+        for (int64_t i1 = 0; i1 < ne1; ++i1) {
+            const int64_t ip1 = i1/w;
+            const int64_t i01 = i1%w;
+
+            const int64_t i03 = (i3*npy + ip2)*npx + ip1;
+
+            memcpy(d + i1*ne0, (const float *) src0->data + ((i03*ne02 + i02)*ne01 + i01)*ne00, ne0*sizeof(float));
         }
     }
 }
@@ -9227,6 +10316,293 @@ void ggml_compute_forward_add_rel_pos(
     }
 }
 
+// RWKV_WKV6, GATED_LINEAR_ATTN and RWKV_WKV7 split over the sequence
+
+int64_t ggml_wkv_n_segments(const ggml_tensor * dst, int n_threads) {
+    const int64_t nh = dst->src[1]->ne[1]; // HEADS
+    const int64_t T  = dst->src[1]->ne[2];
+
+    const ggml_tensor * s0 = dst->op == GGML_OP_RWKV_WKV6 ? dst->src[5] : dst->op == GGML_OP_GATED_LINEAR_ATTN ? dst->src[4] : dst->src[6];
+    const int64_t nt = T / s0->ne[1]; // number of tokens per sequence
+
+    // enough segments to give every thread a head, each segment spanning at least two chunks
+    const int64_t n_seg = MAX(1, MIN((n_threads + nh - 1)/nh, nt/(2*GGML_WKV_CHUNK)));
+
+    if (dst->op == GGML_OP_RWKV_WKV7 && n_seg < 4) {
+        // the transition matrices of the segments cost about twice the scan itself
+        return 1;
+    }
+
+    return n_seg;
+}
+
+// Linear attention with a decay per key (RWKV v6 and GLA) of n tokens of one head, starting from the state
+// S {head_size (value), head_size (key)}, which is advanced in place. Token t of r, k, v and w is at t*stride.
+// RWKV v6 (u != NULL) reads the state before the update of the token and adds the bonus u to its own key, GLA
+// (u == NULL) reads the state after the update. The tokens are processed in chunks: within a chunk the outputs are
+// the products of the decayed queries with the state entering the chunk and with the keys and values of the chunk,
+// and the state is advanced once per chunk by a rank-update with the decayed keys and the values. When y is NULL
+// only the state is computed. When decay is not NULL it receives the total decay of the keys over the tokens.
+// tmp holds 3*head_size floats.
+static void ggml_wkv_segment_f32(
+        int64_t n, int64_t K, int64_t stride,
+        const float * r, const float * k, const float * v, const float * w, const float * u, float scale,
+        float * S, float * y, float * decay, float * tmp) {
+    float * p = tmp;         // decay from the start of the chunk
+    float * q = tmp + K;     // decayed query or key
+    float * d = tmp + 2*K;
+
+    if (decay) {
+        ggml_vec_set_f32(K, decay, 1.0f);
+    }
+
+    for (int64_t c0 = 0; c0 < n; c0 += GGML_WKV_CHUNK) {
+        const int64_t c1 = MIN(c0 + GGML_WKV_CHUNK, n);
+
+        if (y) {
+            ggml_vec_set_f32(K, p, 1.0f);
+
+            for (int64_t t = c0; t < c1; ++t) {
+                const float * r_t = r + t*stride;
+                const float * k_t = k + t*stride;
+                const float * w_t = w + t*stride;
+                      float * y_t = y + t*stride;
+
+                if (!u) {
+                    ggml_vec_mul_f32(K, p, p, w_t);
+                }
+
+                // state entering the chunk
+                ggml_vec_mul_f32(K, q, r_t, p);
+                ggml_vec_set_f32(K, y_t, 0.0f);
+                for (int64_t i = 0; i < K; ++i) {
+                    ggml_vec_mad_f32(K, y_t, S + i*K, q[i]*scale);
+                }
+
+                if (u) {
+                    ggml_vec_mul_f32(K, p, p, w_t);
+                }
+
+                // the token itself
+                float a;
+                if (u) {
+                    ggml_vec_mul_f32(K, d, r_t, u);
+                    ggml_vec_dot_f32(K, &a, 0, d, 0, k_t, 0, 1);
+                } else {
+                    ggml_vec_dot_f32(K, &a, 0, r_t, 0, k_t, 0, 1);
+                }
+                ggml_vec_mad_f32(K, y_t, v + t*stride, a*scale);
+
+                // earlier tokens of the chunk, the query is decayed step by step back to them
+                if (u) {
+                    ggml_vec_cpy_f32(K, d, r_t);
+                } else {
+                    ggml_vec_mul_f32(K, d, r_t, w_t);
+                }
+                for (int64_t s = t - 1; s >= c0; --s) {
+                    ggml_vec_dot_f32(K, &a, 0, d, 0, k + s*stride, 0, 1);
+                    ggml_vec_mad_f32(K, y_t, v + s*stride, a*scale);
+                    ggml_vec_mul_f32(K, d, d, w + s*stride);
+                }
+            }
+        }
+
+        // advance the state to the end of the chunk
+        ggml_vec_set_f32(K, p, 1.0f);
+        for (int64_t s = c0; s < c1; ++s) {
+            ggml_vec_mul_f32(K, p, p, w + s*stride);
+        }
+        for (int64_t i = 0; i < K; ++i) {
+            ggml_vec_scale_f32(K, S + i*K, p[i]);
+        }
+
+        ggml_vec_set_f32(K, d, 1.0f);
+        for (int64_t s = c1 - 1; s >= c0; --s) {
+            ggml_vec_mul_f32(K, q, k + s*stride, d);
+            for (int64_t i = 0; i < K; ++i) {
+                ggml_vec_mad_f32(K, S + i*K, v + s*stride, q[i]);
+            }
+            ggml_vec_mul_f32(K, d, d, w + s*stride);
+        }
+
+        if (decay) {
+            ggml_vec_mul_f32(K, decay, decay, p);
+        }
+    }
+}
+
+// RWKV v7 scan of n tokens of one head, starting from the state S {head_size (key), head_size (value)}, which is
+// advanced in place. When y is NULL the outputs are not computed. When M is not NULL it must hold the identity
+// matrix and receives the product of the transitions diag(w) + a b^T of the tokens, so that a state S0 entering the
+// tokens leaves them as S0 M plus the state computed from a zero state.
+static void ggml_wkv7_segment_f32(
+        int64_t n, int64_t K, int64_t stride,
+        const float * r, const float * w, const float * k, const float * v, const float * a, const float * b,
+        float * S, float * y, float * M) {
+    for (int64_t t = 0; t < n; ++t) {
+        const float * w_t = w + t*stride;
+        const float * k_t = k + t*stride;
+        const float * v_t = v + t*stride;
+        const float * a_t = a + t*stride;
+        const float * b_t = b + t*stride;
+
+        for (int64_t i = 0; i < K; ++i) {
+            float * s = S + i*K;
+
+            float sa;
+            ggml_vec_dot_f32(K, &sa, 0, s, 0, a_t, 0, 1);
+            ggml_vec_mul_f32(K, s, s, w_t);
+            ggml_vec_mad_f32(K, s, k_t, v_t[i]);
+            ggml_vec_mad_f32(K, s, b_t, sa);
+
+            if (y) {
+                ggml_vec_dot_f32(K, y + t*stride + i, 0, s, 0, r + t*stride, 0, 1);
+            }
+        }
+
+        if (M) {
+            for (int64_t i = 0; i < K; ++i) {
+                float * m = M + i*K;
+
+                float ma;
+                ggml_vec_dot_f32(K, &ma, 0, m, 0, a_t, 0, 1);
+                ggml_vec_mul_f32(K, m, m, w_t);
+                ggml_vec_mad_f32(K, m, b_t, ma);
+            }
+        }
+    }
+}
+
+// Scan parallel over the heads and the tokens, like the Mamba-2 SSM_SCAN: every thread first computes the final state
+// of a segment of the sequence from a zero state together with the decay (WKV6, GLA) or the transition matrix (WKV7)
+// of the segment, these are then chained from the initial state to get the state entering every segment, and finally
+// the outputs of all the segments are computed independently.
+static void ggml_compute_forward_wkv_segments_f32(
+        const ggml_compute_params * params,
+        ggml_tensor * dst,
+        int64_t n_seg) {
+    const bool wkv7 = dst->op == GGML_OP_RWKV_WKV7;
+
+    const int64_t T  = dst->src[1]->ne[2];
+    const int64_t C  = dst->ne[0];
+    const int64_t nh = dst->src[1]->ne[1];
+    const int64_t K  = C / nh; // head_size
+
+    const ggml_tensor * src_state = dst->op == GGML_OP_RWKV_WKV6 ? dst->src[5] : dst->op == GGML_OP_GATED_LINEAR_ATTN ? dst->src[4] : dst->src[6];
+
+    const int64_t n_seqs = src_state->ne[1];
+    const int64_t nt     = T / n_seqs;
+
+    const int ith = params->ith;
+    const int nth = params->nth;
+
+    GGML_ASSERT(C % nh == 0);
+
+    const int64_t n_state = K*K;
+    const int64_t n_trans = wkv7 ? n_state : K;
+
+    const int64_t seg_len = (nt + n_seg - 1)/n_seg;
+
+    float * wstate = (float *) params->wdata;                   // {K, K, nh, n_seg - 1} states entering the segments 0 .. n_seg - 2
+    float * wtrans = wstate + (n_seg - 1)*nh*n_state;           // {K, nh, n_seg - 1} decays or {K, K, nh, n_seg - 1} transitions
+    float * wtmp   = wtrans + (n_seg - 1)*nh*n_trans + ith*3*K; // per-thread scratch
+
+    const float * src0 = (const float *) dst->src[0]->data;
+    const float * src1 = (const float *) dst->src[1]->data;
+    const float * src2 = (const float *) dst->src[2]->data;
+    const float * src3 = (const float *) dst->src[3]->data;
+
+    for (int64_t i3 = 0; i3 < n_seqs; ++i3) {
+        const float * s0 = (const float *) src_state->data + i3*nh*n_state;
+              float * s  = (float *) dst->data + C*T + i3*nh*n_state;
+
+        // the last segment works directly on the output state
+        auto state = [&](int64_t p, int64_t h) {
+            return p == n_seg - 1 ? s + h*n_state : wstate + (p*nh + h)*n_state;
+        };
+
+        auto scan = [&](int64_t p, int64_t h, float * S, bool write_y, float * trans) {
+            const int64_t t0  = p*seg_len;
+            const int64_t n   = MIN(nt, t0 + seg_len) - t0;
+            const int64_t off = (i3*nt + t0)*C + h*K;
+
+            float * y = write_y ? (float *) dst->data + off : NULL;
+
+            switch (dst->op) {
+                case GGML_OP_RWKV_WKV6:
+                    {
+                        const float * time_faaaa = (const float *) dst->src[3]->data + h*K;
+                        const float * time_decay = (const float *) dst->src[4]->data + off;
+                        ggml_wkv_segment_f32(n, K, C, src2 + off, src0 + off, src1 + off, time_decay, time_faaaa, 1.0f, S, y, trans, wtmp);
+                    } break;
+                case GGML_OP_GATED_LINEAR_ATTN:
+                    {
+                        const float scale = ggml_get_op_params_f32(dst, 0);
+                        ggml_wkv_segment_f32(n, K, C, src2 + off, src0 + off, src1 + off, src3 + off, NULL, scale, S, y, trans, wtmp);
+                    } break;
+                case GGML_OP_RWKV_WKV7:
+                    {
+                        const float * a = (const float *) dst->src[4]->data + off;
+                        const float * b = (const float *) dst->src[5]->data + off;
+                        if (trans) {
+                            memset(trans, 0, n_state*sizeof(float));
+                            for (int64_t i = 0; i < K; ++i) {
+                                trans[i*K + i] = 1.0f;
+                            }
+                        }
+                        ggml_wkv7_segment_f32(n, K, C, src0 + off, src1 + off, src2 + off, src3 + off, a, b, S, y, trans);
+                    } break;
+                default:
+                    GGML_ABORT("fatal error");
+            }
+        };
+
+        // local final states, stored as the states entering the next segments
+        for (int64_t k = ith; k < (n_seg - 1)*nh; k += nth) {
+            const int64_t p = k / nh;
+            const int64_t h = k % nh;
+
+            float * S = state(p + 1, h);
+            memset(S, 0, n_state*sizeof(float));
+            scan(p, h, S, false, wtrans + (p*nh + h)*n_trans);
+        }
+
+        ggml_barrier(params->threadpool);
+
+        // chain the segments from the initial state
+        for (int64_t h = ith; h < nh; h += nth) {
+            float * prev = state(0, h);
+            memcpy(prev, s0 + h*n_state, n_state*sizeof(float));
+            for (int64_t p = 1; p < n_seg; ++p) {
+                float       * S     = state(p, h);
+                const float * trans = wtrans + ((p - 1)*nh + h)*n_trans;
+                for (int64_t i = 0; i < K; ++i) {
+                    if (wkv7) {
+                        for (int64_t j = 0; j < K; ++j) {
+                            ggml_vec_mad_f32(K, S + i*K, trans + j*K, prev[i*K + j]);
+                        }
+                    } else {
+                        ggml_vec_mad_f32(K, S + i*K, prev + i*K, trans[i]);
+                    }
+                }
+                prev = S;
+            }
+        }
+
+        ggml_barrier(params->threadpool);
+
+        for (int64_t k = ith; k < n_seg*nh; k += nth) {
+            const int64_t p = k / nh;
+            const int64_t h = k % nh;
+
+            scan(p, h, state(p, h), true, NULL);
+        }
+
+        // the work buffer is reused by the next sequence
+        ggml_barrier(params->threadpool);
+    }
+}
+
 // ggml_compute_forward_rwkv_wkv6
 
 static void ggml_compute_forward_rwkv_wkv6_f32(
@@ -9244,7 +10620,9 @@ static void ggml_compute_forward_rwkv_wkv6_f32(
     const int ith = params->ith;
     const int nth = params->nth;
 
-    if (ith >= HEADS) {
+    const int64_t n_seg = ggml_wkv_n_segments(dst, nth);
+    if (n_seg > 1) {
+        ggml_compute_forward_wkv_segments_f32(params, dst, n_seg);
         return;
     }
 
@@ -9461,7 +10839,9 @@ static void ggml_compute_forward_gla_f32(
     const int ith = params->ith;
     const int nth = params->nth;
 
-    if (ith >= HEADS) {
+    const int64_t n_seg = ggml_wkv_n_segments(dst, nth);
+    if (n_seg > 1) {
+        ggml_compute_forward_wkv_segments_f32(params, dst, n_seg);
         return;
     }
 
@@ -9735,7 +11115,9 @@ static void ggml_compute_forward_rwkv_wkv7_f32(
     const int ith = params->ith;
     const int nth = params->nth;
 
-    if (ith >= HEADS) {
+    const int64_t n_seg = ggml_wkv_n_segments(dst, nth);
+    if (n_seg > 1) {
+        ggml_compute_forward_wkv_segments_f32(params, dst, n_seg);
         return;
     }
 
@@ -10175,6 +11557,67 @@ void ggml_compute_forward_cross_entropy_loss_back(
     }
 }
 
+// the AdamW momenta are converted to/from F32 in blocks of QK8_0 values
+// for Q8_0, v stores sqrt(v) to reduce the dynamic range that the per-block scale needs to cover
+
+static void adamw_momenta_load(const void * row, ggml_type type, int64_t ib, int n, bool sqrt_v, float * dst) {
+    switch (type) {
+        case GGML_TYPE_F32: {
+            memcpy(dst, (const float *) row + ib*QK8_0, n*sizeof(float));
+        } break;
+        case GGML_TYPE_BF16: {
+            const ggml_bf16_t * x = (const ggml_bf16_t *) row + ib*QK8_0;
+            for (int i = 0; i < n; ++i) {
+                dst[i] = GGML_BF16_TO_FP32(x[i]);
+            }
+        } break;
+        case GGML_TYPE_Q8_0: {
+            const block_q8_0 * x = (const block_q8_0 *) row + ib;
+            const float d = GGML_CPU_FP16_TO_FP32(x->d);
+            for (int i = 0; i < n; ++i) {
+                const float xi = x->qs[i]*d;
+                dst[i] = sqrt_v ? xi*xi : xi;
+            }
+        } break;
+        default:
+            GGML_ABORT("fatal error");
+    }
+}
+
+static void adamw_momenta_store(void * row, ggml_type type, int64_t ib, int n, bool sqrt_v, float * src) {
+    switch (type) {
+        case GGML_TYPE_F32: {
+            memcpy((float *) row + ib*QK8_0, src, n*sizeof(float));
+        } break;
+        case GGML_TYPE_BF16: {
+            ggml_bf16_t * y = (ggml_bf16_t *) row + ib*QK8_0;
+            for (int i = 0; i < n; ++i) {
+                y[i] = GGML_FP32_TO_BF16(src[i]);
+            }
+        } break;
+        case GGML_TYPE_Q8_0: {
+            block_q8_0 * y = (block_q8_0 *) row + ib;
+            float amax = 0.0f;
+            for (int i = 0; i < n; ++i) {
+                if (sqrt_v) {
+                    src[i] = sqrtf(src[i]);
+                }
+                amax = std::max(amax, fabsf(src[i]));
+            }
+            const float d  = amax / 127.0f;
+            const float id = d ? 1.0f/d : 0.0f;
+            y->d = GGML_CPU_FP32_TO_FP16(d);
+            for (int i = 0; i < n; ++i) {
+                const float xi = src[i]*id;
+                // non-zero values of sqrt(v) must not be rounded to 0, the update would be divided by eps only
+                y->qs[i] = (int8_t) std::min(127.0f, sqrt_v && xi > 0.0f ? std::max(1.0f, roundf(xi)) : roundf(xi));
+            }
+        } break;
+        default:
+            GGML_ABORT("fatal error");
+    }
+}
+
 static void ggml_compute_forward_opt_step_adamw_f32(
         const ggml_compute_params * params,
         ggml_tensor * dst) {
@@ -10198,6 +11641,9 @@ static void ggml_compute_forward_opt_step_adamw_f32(
     GGML_TENSOR_UNARY_OP_LOCALS
     GGML_ASSERT(nb00 == sizeof(float));
 
+    const ggml_type type_m = src0_grad_m->type;
+    const ggml_type type_v = src0_grad_v->type;
+
     // rows per thread
     const int dr = (nr + nth - 1)/nth;
 
@@ -10215,6 +11661,10 @@ static void ggml_compute_forward_opt_step_adamw_f32(
     const float beta1h = adamw_params_ptr[5];
     const float beta2h = adamw_params_ptr[6];
     const float keep   = 1.f - alpha * wd;
+
+    float mb[QK8_0];
+    float vb[QK8_0];
+
     for (int ir = ir0; ir < ir1; ++ir) {
         const int64_t i03 = ir/(ne02*ne01);
         const int64_t i02 = (ir - i03*ne02*ne01)/ne01;
@@ -10224,20 +11674,32 @@ static void ggml_compute_forward_opt_step_adamw_f32(
 
         float       * w = (float       *) ((char       *) src0->data        + offset); // weight
         const float * g = (const float *) ((const char *) src0_grad->data   + offset); // grad
-        float       * m = (float       *) ((char       *) src0_grad_m->data + offset);
-        float       * v = (float       *) ((char       *) src0_grad_v->data + offset);
+        void        * m = (char *) src0_grad_m->data + i03*src0_grad_m->nb[3] + i02*src0_grad_m->nb[2] + i01*src0_grad_m->nb[1];
+        void        * v = (char *) src0_grad_v->data + i03*src0_grad_v->nb[3] + i02*src0_grad_v->nb[2] + i01*src0_grad_v->nb[1];
 
-        for (int i00 = 0; i00 < ne00; ++i00) {
-            m[i00] = m[i00]*beta1 +        g[i00]*(1.0f - beta1);
-            v[i00] = v[i00]*beta2 + g[i00]*g[i00]*(1.0f - beta2);
+        for (int64_t ib = 0; ib*QK8_0 < ne00; ++ib) {
+            const int64_t i0 = ib*QK8_0;
+            const int     n  = std::min<int64_t>(QK8_0, ne00 - i0);
 
-            const float mh =       m[i00]*beta1h;
-            const float vh = sqrtf(v[i00]*beta2h) + eps;
+            adamw_momenta_load(m, type_m, ib, n, false, mb);
+            adamw_momenta_load(v, type_v, ib, n, type_v == GGML_TYPE_Q8_0, vb);
+
+            for (int i = 0; i < n; ++i) {
+                const float gi = g[i0 + i];
+                mb[i] = mb[i]*beta1 +    gi*(1.0f - beta1);
+                vb[i] = vb[i]*beta2 + gi*gi*(1.0f - beta2);
+
+                const float mh =       mb[i]*beta1h;
+                const float vh = sqrtf(vb[i]*beta2h) + eps;
+
+                // The weight decay is applied independently of the Adam momenta m and v.
+                // This is NOT equivalent to l2 regularization that adds w[i00]*w[i00] to the loss.
+                // See: https://arxiv.org/pdf/1711.05101v3.pdf
+                w[i0 + i] = w[i0 + i] * keep - alpha * mh / vh;
+            }
 
-            // The weight decay is applied independently of the Adam momenta m and v.
-            // This is NOT equivalent to l2 regularization that adds w[i00]*w[i00] to the loss.
-            // See: https://arxiv.org/pdf/1711.05101v3.pdf
-            w[i00] = w[i00] * keep - alpha * mh / vh;
+            adamw_momenta_store(m, type_m, ib, n, false, mb);
+            adamw_momenta_store(v, type_v, ib, n, type_v == GGML_TYPE_Q8_0, vb);
         }
     }
 }
@@ -23,10 +23,45 @@ static const size_t CACHE_LINE_SIZE_F32 = CACHE_LINE_SIZE/sizeof(float);
 // Work buffer size for im2col operations in CONV2D
 #define GGML_IM2COL_WORK_SIZE (16 * 1024 * 1024)
 
+// CONV_2D uses Winograd F(4x4, 3x3) for 3x3 kernels with unit stride and dilation when both channel counts are at least
+// GGML_CONV_2D_WINOGRAD_MIN_C and the output has at least GGML_CONV_2D_WINOGRAD_MIN_TILES 4x4 tiles per image, and the
+// direct kernel for the other convolutions with at least GGML_CONV_2D_DIRECT_MIN_C input channels. The direct kernel
+// computes blocks of GGML_CONV_2D_DIRECT_BLOCK output pixels of a row at a time.
+#define GGML_CONV_2D_WINOGRAD_MIN_C     64
+#define GGML_CONV_2D_WINOGRAD_MIN_TILES 32
+#define GGML_CONV_2D_DIRECT_MIN_C       128
+#define GGML_CONV_2D_DIRECT_BLOCK       32
+
+// A CONV_2D node can compute up to GGML_CONV_2D_EPILOGUE_MAX element-wise nodes that follow it (per-channel or scalar
+// ADD, SUB, MUL, DIV and activations) while its output is still in cache, and a POOL_2D of the result, see
+// ggml_conv_2d_epilogue_init.
+#define GGML_CONV_2D_EPILOGUE_MAX 8
+
+// Reductions (SUM, SUM_ROWS, MEAN, ARGMAX) split wide rows into chunks of at least GGML_REDUCE_CHUNK_MIN elements
+// and store the partial results of at most GGML_REDUCE_MAX_CHUNKS chunks in the work buffer.
+// The chunks only depend on the shape of the source, so the results do not depend on the number of threads.
+#define GGML_REDUCE_CHUNK_MIN  4096
+#define GGML_REDUCE_MAX_CHUNKS 256
+
+// SSM_SCAN (Mamba-2) processes long sequences in chunks of GGML_SSM_SCAN_CHUNK tokens. When there are fewer heads than
+// threads, the sequence is also split into segments whose boundary states are stored in the work buffer.
+#define GGML_SSM_SCAN_CHUNK 64
+
+// RWKV_WKV6, GATED_LINEAR_ATTN and RWKV_WKV7 split long sequences into segments when there are fewer heads than
+// threads. WKV6 and GLA process a segment in chunks of GGML_WKV_CHUNK tokens.
+#define GGML_WKV_CHUNK 32
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+struct ggml_conv_2d_epilogue {
+    int                        n_ops;
+    const struct ggml_tensor * ops[GGML_CONV_2D_EPILOGUE_MAX]; // element-wise nodes in the order they are applied
+    struct ggml_tensor       * dst;                            // receives the result, the last node of ops or the CONV_2D node
+    struct ggml_tensor       * pool;                           // POOL_2D node of dst, or NULL
+};
+
 void ggml_compute_forward_dup(const struct ggml_compute_params * params, struct ggml_tensor * dst);
 void ggml_compute_forward_add(const struct ggml_compute_params * params, struct ggml_tensor * dst);
 void ggml_compute_forward_add_id(const struct ggml_compute_params * params, struct ggml_tensor * dst);
@@ -68,6 +103,9 @@ void ggml_compute_forward_im2col(const struct ggml_compute_params * params, stru
 void ggml_compute_forward_im2col_back_f32(const struct ggml_compute_params * params, struct ggml_tensor * dst);
 void ggml_compute_forward_im2col_3d(const struct ggml_compute_params * params, struct ggml_tensor * dst);
 void ggml_compute_forward_conv_2d(const struct ggml_compute_params * params, struct ggml_tensor * dst);
+size_t ggml_conv_2d_work_size(const struct ggml_tensor * dst, int n_threads);
+int ggml_conv_2d_epilogue_init(const struct ggml_cgraph * cgraph, int node_n, struct ggml_conv_2d_epilogue * ep);
+void ggml_compute_forward_conv_2d_fused(const struct ggml_compute_params * params, struct ggml_tensor * dst, const struct ggml_conv_2d_epilogue * ep);
 void ggml_compute_forward_conv_3d(const struct ggml_compute_params * params, struct ggml_tensor * dst);
 void ggml_compute_forward_conv_transpose_2d(const struct ggml_compute_params * params, struct ggml_tensor * dst);
 void ggml_compute_forward_conv_2d_dw(const struct ggml_compute_params * params, struct ggml_tensor * dst);
@@ -81,6 +119,7 @@ void ggml_compute_forward_roll(const struct ggml_compute_params * params, struct
 void ggml_compute_forward_arange(const struct ggml_compute_params * params, struct ggml_tensor * dst);
 void ggml_compute_forward_timestep_embedding(const struct ggml_compute_params * params, struct ggml_tensor * dst);
 void ggml_compute_forward_argsort(const struct ggml_compute_params * params, struct ggml_tensor * dst);
+void ggml_compute_forward_top_k(const struct ggml_compute_params * params, struct ggml_tensor * dst);
 void ggml_compute_forward_leaky_relu(const struct ggml_compute_params * params, struct ggml_tensor * dst);
 void ggml_compute_forward_tri(const struct ggml_compute_params * params, struct ggml_tensor * dst);
 void ggml_compute_forward_fill(const struct ggml_compute_params * params, struct ggml_tensor * dst);
@@ -91,6 +130,7 @@ void ggml_compute_forward_flash_attn_back(
         struct ggml_tensor * dst);
 void ggml_compute_forward_ssm_conv(const struct ggml_compute_params * params, struct ggml_tensor * dst);
 void ggml_compute_forward_ssm_scan(const struct ggml_compute_params * params, struct ggml_tensor * dst);
+int64_t ggml_ssm_scan_n_segments(const struct ggml_tensor * dst, int n_threads);
 void ggml_compute_forward_win_part(const struct ggml_compute_params * params, struct ggml_tensor * dst);
 void ggml_compute_forward_win_unpart(const struct ggml_compute_params * params, struct ggml_tensor * dst);
 void ggml_compute_forward_unary(const struct ggml_compute_params * params, struct ggml_tensor * dst);
@@ -99,6 +139,7 @@ void ggml_compute_forward_get_rel_pos(const struct ggml_compute_params * params,
 void ggml_compute_forward_add_rel_pos(const struct ggml_compute_params * params, struct ggml_tensor * dst);
 void ggml_compute_forward_rwkv_wkv6(const struct ggml_compute_params * params, struct ggml_tensor * dst);
 void ggml_compute_forward_rwkv_wkv7(const struct ggml_compute_params * params, struct ggml_tensor * dst);
+int64_t ggml_wkv_n_segments(const struct ggml_tensor * dst, int n_threads);
 void ggml_compute_forward_solve_tri(const struct ggml_compute_params * params, struct ggml_tensor * dst);
 void ggml_compute_forward_gla(const struct ggml_compute_params * params, struct ggml_tensor * dst);
 void ggml_compute_forward_map_custom1(const struct ggml_compute_params * params, struct ggml_tensor * dst);
@@ -0,0 +1,283 @@
+#include "profile.h"
+
+#include "ggml-cpu.h"
+#include "ggml-impl.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+struct ggml_cpu_profile_node {
+    char         name[GGML_MAX_NAME];
+    const char * op;
+    int64_t      flops;
+    int64_t      bytes;
+};
+
+struct ggml_cpu_profile_graph {
+    int     n_threads;
+    int64_t t_start;
+    int64_t t_end;
+
+    std::vector<ggml_cpu_profile_node>   nodes;
+    std::vector<ggml_cpu_profile_sample> samples; // [n_nodes][n_threads], t_start == 0 for threads that did not run the node
+};
+
+struct ggml_cpu_profile {
+    std::vector<ggml_cpu_profile_graph> graphs;
+};
+
+// rough estimate of the floating point operations of a node, one per output element unless the op is known to do more
+static int64_t ggml_cpu_profile_flops(const struct ggml_tensor * node) {
+    const struct ggml_tensor * src0 = node->src[0];
+
+    switch (node->op) {
+        case GGML_OP_MUL_MAT:
+        case GGML_OP_MUL_MAT_ID:
+            return 2*src0->ne[0]*ggml_nelements(node);
+        case GGML_OP_OUT_PROD:
+            return 2*src0->ne[1]*ggml_nelements(node);
+        case GGML_OP_FLASH_ATTN_EXT:
+            {
+                const struct ggml_tensor * k = node->src[1];
+                const struct ggml_tensor * v = node->src[2];
+                // KQ and KQV for each of the [n_q, n_head, ne3] queries
+                return 2*(src0->ne[0] + v->ne[0])*k->ne[1]*src0->ne[1]*src0->ne[2]*src0->ne[3];
+            }
+        case GGML_OP_SOFT_MAX:
+            return 5*ggml_nelements(node);
+        case GGML_OP_NORM:
+        case GGML_OP_RMS_NORM:
+        case GGML_OP_ROPE:
+            return 4*ggml_nelements(node);
+        case GGML_OP_NONE:
+        case GGML_OP_CPY:
+        case GGML_OP_CONT:
+        case GGML_OP_DUP:
+        case GGML_OP_GET_ROWS:
+        case GGML_OP_SET_ROWS:
+            return 0;
+        default:
+            return ggml_nelements(node);
+    }
+}
+
+// bytes read from the sources and written to the destination
+static int64_t ggml_cpu_profile_bytes(const struct ggml_tensor * node) {
+    int64_t bytes = ggml_nbytes(node);
+    for (int i = 0; i < GGML_MAX_SRC; ++i) {
+        if (node->src[i]) {
+            bytes += ggml_nbytes(node->src[i]);
+        }
+    }
+    return bytes;
+}
+
+int64_t ggml_cpu_profile_time_ns(void) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct ggml_cpu_profile_sample * ggml_cpu_profile_begin(struct ggml_cpu_profile * profile, const struct ggml_cgraph * cgraph, int n_threads) {
+    profile->graphs.emplace_back();
+    ggml_cpu_profile_graph & graph = profile->graphs.back();
+
+    graph.n_threads = n_threads;
+    graph.t_start   = ggml_cpu_profile_time_ns();
+    graph.t_end     = graph.t_start;
+
+    graph.nodes.resize(cgraph->n_nodes);
+    for (int i = 0; i < cgraph->n_nodes; ++i) {
+        const struct ggml_tensor * node = cgraph->nodes[i];
+        ggml_cpu_profile_node & pn = graph.nodes[i];
+
+        memcpy(pn.name, node->name, sizeof(pn.name));
+        pn.op    = ggml_op_desc(node);
+        pn.flops = ggml_op_is_empty(node->op) ? 0 : ggml_cpu_profile_flops(node);
+        pn.bytes = ggml_op_is_empty(node->op) ? 0 : ggml_cpu_profile_bytes(node);
+    }
+
+    graph.samples.assign((size_t) cgraph->n_nodes*n_threads, ggml_cpu_profile_sample{0, 0, 0});
+
+    return graph.samples.data();
+}
+
+void ggml_cpu_profile_end(struct ggml_cpu_profile * profile) {
+    GGML_ASSERT(!profile->graphs.empty());
+    profile->graphs.back().t_end = ggml_cpu_profile_time_ns();
+}
+
+struct ggml_cpu_profile * ggml_cpu_profile_init(void) {
+    return new ggml_cpu_profile;
+}
+
+void ggml_cpu_profile_free(struct ggml_cpu_profile * profile) {
+    delete profile;
+}
+
+void ggml_cpu_profile_reset(struct ggml_cpu_profile * profile) {
+    profile->graphs.clear();
+}
+
+int ggml_cpu_profile_n_graphs(const struct ggml_cpu_profile * profile) {
+    return (int) profile->graphs.size();
+}
+
+int ggml_cpu_profile_get_op_stats(const struct ggml_cpu_profile * profile, struct ggml_cpu_profile_op_stats * stats, int n_stats_max) {
+    std::map<std::string, ggml_cpu_profile_op_stats> per_op;
+
+    for (const ggml_cpu_profile_graph & graph : profile->graphs) {
+        for (size_t i = 0; i < graph.nodes.size(); ++i) {
+            const ggml_cpu_profile_sample * samples = graph.samples.data() + i*graph.n_threads;
+
+            int64_t t_first = INT64_MAX;
+            int64_t t_last  = 0;
+            int64_t t_busy  = 0;
+            int64_t t_wait  = 0;
+            for (int ith = 0; ith < graph.n_threads; ++ith) {
+                const ggml_cpu_profile_sample & s = samples[ith];
+                if (s.t_start == 0) {
+                    continue;
+                }
+                t_first = std::min(t_first, s.t_start);
+                t_last  = std::max(t_last,  s.t_end);
+                t_busy += s.t_end  - s.t_start;
+                t_wait += s.t_sync - s.t_end;
+            }
+            if (t_first == INT64_MAX) {
+                continue; // skipped, e.g. NOPs or after an abort
+            }
+
+            const ggml_cpu_profile_node & node = graph.nodes[i];
+
+            ggml_cpu_profile_op_stats & st = per_op[node.op];
+            st.op         = node.op;
+            st.n_nodes   += 1;
+            st.t_wall_ns += t_last - t_first;
+            st.t_busy_ns += t_busy;
+            st.t_wait_ns += t_wait;
+            st.flops     += node.flops;
+            st.bytes     += node.bytes;
+        }
+    }
+
+    std::vector<ggml_cpu_profile_op_stats> sorted;
+    sorted.reserve(per_op.size());
+    for (const auto & it : per_op) {
+        sorted.push_back(it.second);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const ggml_cpu_profile_op_stats & a, const ggml_cpu_profile_op_stats & b) {
+        return a.t_wall_ns > b.t_wall_ns;
+    });
+
+    for (int i = 0; i < std::min(n_stats_max, (int) sorted.size()); ++i) {
+        stats[i] = sorted[i];
+    }
+
+    return (int) sorted.size();
+}
+
+void ggml_cpu_profile_print(const struct ggml_cpu_profile * profile) {
+    const int n_ops = ggml_cpu_profile_get_op_stats(profile, nullptr, 0);
+    std::vector<ggml_cpu_profile_op_stats> stats(n_ops);
+    ggml_cpu_profile_get_op_stats(profile, stats.data(), n_ops);
+
+    int64_t t_total = 0;
+    for (const ggml_cpu_profile_graph & graph : profile->graphs) {
+        t_total += graph.t_end - graph.t_start;
+    }
+
+    GGML_LOG_INFO("=== CPU profile: %d graphs, %.3f ms\n", ggml_cpu_profile_n_graphs(profile), t_total/1e6);
+    GGML_LOG_INFO("%-24s %8s %12s %7s %12s %12s %10s %10s\n",
+            "op", "nodes", "wall ms", "wall %", "busy ms", "wait ms", "GFLOP/s", "GB/s");
+    for (const ggml_cpu_profile_op_stats & st : stats) {
+        GGML_LOG_INFO("%-24s %8" PRId64 " %12.3f %6.2f%% %12.3f %12.3f %10.2f %10.2f\n",
+                st.op, st.n_nodes,
+                st.t_wall_ns/1e6, t_total > 0 ? 100.0*st.t_wall_ns/t_total : 0.0,
+                st.t_busy_ns/1e6, st.t_wait_ns/1e6,
+                st.t_wall_ns > 0 ? (double) st.flops/st.t_wall_ns : 0.0,
+                st.t_wall_ns > 0 ? (double) st.bytes/st.t_wall_ns : 0.0);
+    }
+    GGML_LOG_INFO("========================================\n");
+}
+
+static void ggml_cpu_profile_write_json_string(FILE * f, const char * s) {
+    fputc('"', f);
+    for (; *s; ++s) {
+        const unsigned char c = *s;
+        if (c == '"' || c == '\\') {
+            fputc('\\', f);
+            fputc(c, f);
+        } else if (c < 0x20) {
+            fprintf(f, "\\u%04x", c);
+        } else {
+            fputc(c, f);
+        }
+    }
+    fputc('"', f);
+}
+
+bool ggml_cpu_profile_write_trace(const struct ggml_cpu_profile * profile, const char * fname) {
+    FILE * f = ggml_fopen(fname, "w");
+    if (!f) {
+        GGML_LOG_ERROR("%s: failed to open %s\n", __func__, fname);
+        return false;
+    }
+
+    const int64_t t0 = profile->graphs.empty() ? 0 : profile->graphs.front().t_start;
+
+    int n_threads_max = 0;
+    for (const ggml_cpu_profile_graph & graph : profile->graphs) {
+        n_threads_max = std::max(n_threads_max, graph.n_threads);
+    }
+
+    fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(f, "{\"ph\":\"M\",\"pid\":0,\"name\":\"process_name\",\"args\":{\"name\":\"ggml-cpu\"}}");
+    for (int ith = 0; ith < n_threads_max; ++ith) {
+        fprintf(f, ",\n{\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":\"thread %d\"}}", ith, ith);
+    }
+
+    // timestamps are in us
+    for (size_t ig = 0; ig < profile->graphs.size(); ++ig) {
+        const ggml_cpu_profile_graph & graph = profile->graphs[ig];
+
+        for (size_t i = 0; i < graph.nodes.size(); ++i) {
+            const ggml_cpu_profile_node & node = graph.nodes[i];
+
+            for (int ith = 0; ith < graph.n_threads; ++ith) {
+                const ggml_cpu_profile_sample & s = graph.samples[i*graph.n_threads + ith];
+                if (s.t_start == 0) {
+                    continue;
+                }
+
+                fprintf(f, ",\n{\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"name\":",
+                        ith, (s.t_start - t0)/1e3, (s.t_end - s.t_start)/1e3);
+                ggml_cpu_profile_write_json_string(f, node.name[0] ? node.name : node.op);
+                fprintf(f, ",\"cat\":");
+                ggml_cpu_profile_write_json_string(f, node.op);
+                fprintf(f, ",\"args\":{\"graph\":%zu,\"node\":%zu,\"flops\":%" PRId64 ",\"bytes\":%" PRId64 "}}",
+                        ig, i, node.flops, node.bytes);
+
+                if (s.t_sync > s.t_end) {
+                    fprintf(f, ",\n{\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"name\":\"barrier\",\"cat\":\"barrier\",\"args\":{\"graph\":%zu,\"node\":%zu}}",
+                            ith, (s.t_end - t0)/1e3, (s.t_sync - s.t_end)/1e3, ig, i);
+                }
+            }
+        }
+    }
+
+    fprintf(f, "\n]}\n");
+
+    const bool ok = ferror(f) == 0;
+    fclose(f);
+
+    if (!ok) {
+        GGML_LOG_ERROR("%s: failed to write %s\n", __func__, fname);
+    }
+    return ok;
+}
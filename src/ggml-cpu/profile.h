@@ -0,0 +1,31 @@
+#pragma once
+
+#include "ggml.h"
+
+#include <stdint.h>
+
+// GGML CPU internal header
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct ggml_cpu_profile;
+
+// timings of one node on one thread, see ggml_cpu_profile_time_ns()
+struct ggml_cpu_profile_sample {
+    int64_t t_start;
+    int64_t t_end;     // end of the compute
+    int64_t t_sync;    // end of the barrier following the node
+};
+
+int64_t ggml_cpu_profile_time_ns(void);
+
+// start recording a graph computation
+// returns a buffer of n_nodes*n_threads samples, indexed by node_n*n_threads + ith
+struct ggml_cpu_profile_sample * ggml_cpu_profile_begin(struct ggml_cpu_profile * profile, const struct ggml_cgraph * cgraph, int n_threads);
+void                             ggml_cpu_profile_end  (struct ggml_cpu_profile * profile);
+
+#ifdef __cplusplus
+}
+#endif
@@ -50,6 +50,14 @@ void quantize_row_mxfp4(const float * GGML_RESTRICT x, void * GGML_RESTRICT y, i
     quantize_row_mxfp4_ref(x, y, k);
 }
 
+void quantize_row_f8_e4m3(const float * GGML_RESTRICT x, void * GGML_RESTRICT y, int64_t k) {
+    quantize_row_f8_e4m3_ref(x, y, k);
+}
+
+void quantize_row_f8_e5m2(const float * GGML_RESTRICT x, void * GGML_RESTRICT y, int64_t k) {
+    quantize_row_f8_e5m2_ref(x, y, k);
+}
+
 //
 // 2-6 bit quantization in super-blocks
 //
@@ -68,7 +76,7 @@ void quantize_row_q3_K(const float * GGML_RESTRICT x, void * GGML_RESTRICT vy, i
 
 // ====================== 4-bit (de)-quantization
 
-void quantize_row_q4_K(const float * GGML_RESTRICT x, void * GGML_RESTRICT vy, int64_t k) {
+void quantize_row_q4_K_generic(const float * GGML_RESTRICT x, void * GGML_RESTRICT vy, int64_t k) {
     assert(k % QK_K == 0);
     block_q4_K * GGML_RESTRICT y = vy;
     quantize_row_q4_K_ref(x, y, k);
@@ -76,7 +84,7 @@ void quantize_row_q4_K(const float * GGML_RESTRICT x, void * GGML_RESTRICT vy, i
 
 // ====================== 5-bit (de)-quantization
 
-void quantize_row_q5_K(const float * GGML_RESTRICT x, void * GGML_RESTRICT vy, int64_t k) {
+void quantize_row_q5_K_generic(const float * GGML_RESTRICT x, void * GGML_RESTRICT vy, int64_t k) {
     assert(k % QK_K == 0);
     block_q5_K * GGML_RESTRICT y = vy;
     quantize_row_q5_K_ref(x, y, k);
@@ -84,7 +92,7 @@ void quantize_row_q5_K(const float * GGML_RESTRICT x, void * GGML_RESTRICT vy, i
 
 // ====================== 6-bit (de)-quantization
 
-void quantize_row_q6_K(const float * GGML_RESTRICT x, void * GGML_RESTRICT vy, int64_t k) {
+void quantize_row_q6_K_generic(const float * GGML_RESTRICT x, void * GGML_RESTRICT vy, int64_t k) {
     assert(k % QK_K == 0);
     block_q6_K * GGML_RESTRICT y = vy;
     quantize_row_q6_K_ref(x, y, k);
@@ -216,6 +224,41 @@ void ggml_vec_dot_mxfp4_q8_0_generic(int n, float * GGML_RESTRICT s, size_t bs,
     *s = sumf;
 }
 
+// the activations of the FP8 weights stay in F32, there is no integer dot product for floating point weights
+void ggml_vec_dot_f8_e4m3_f32_generic(int n, float * GGML_RESTRICT s, size_t bs, const void * GGML_RESTRICT vx, size_t bx, const void * GGML_RESTRICT vy, size_t by, int nrc) {
+    assert(nrc == 1);
+    UNUSED(nrc);
+    UNUSED(bx);
+    UNUSED(by);
+    UNUSED(bs);
+
+    const uint8_t * GGML_RESTRICT x = vx;
+    const float   * GGML_RESTRICT y = vy;
+
+    double sumf = 0;
+    for (int i = 0; i < n; ++i) {
+        sumf += (double) (GGML_FP8_E4M3_TO_FP32(x[i]) * y[i]);
+    }
+    *s = sumf;
+}
+
+void ggml_vec_dot_f8_e5m2_f32_generic(int n, float * GGML_RESTRICT s, size_t bs, const void * GGML_RESTRICT vx, size_t bx, const void * GGML_RESTRICT vy, size_t by, int nrc) {
+    assert(nrc == 1);
+    UNUSED(nrc);
+    UNUSED(bx);
+    UNUSED(by);
+    UNUSED(bs);
+
+    const uint8_t * GGML_RESTRICT x = vx;
+    const float   * GGML_RESTRICT y = vy;
+
+    double sumf = 0;
+    for (int i = 0; i < n; ++i) {
+        sumf += (double) (GGML_FP8_E5M2_TO_FP32(x[i]) * y[i]);
+    }
+    *s = sumf;
+}
+
 void ggml_vec_dot_q5_0_q8_0_generic(int n, float * GGML_RESTRICT s, size_t bs, const void * GGML_RESTRICT vx, size_t bx, const void * GGML_RESTRICT vy, size_t by, int nrc) {
     const int qk = QK8_0;
     const int nb = n / qk;
@@ -1180,6 +1223,106 @@ void ggml_vec_dot_iq4_xs_q8_K_generic(int n, float * GGML_RESTRICT s, size_t bs,
     *s = sumf;
 }
 
+// Multiply-add of quantized rows
+
+void ggml_vec_mad_q4_0_generic(int n, float * GGML_RESTRICT y, const void * GGML_RESTRICT vx, size_t bx, const float * GGML_RESTRICT v, int nrc) {
+    const int qk = QK4_0;
+    const int nb = n / qk;
+
+    assert(n % qk == 0);
+
+    for (int r = 0; r < nrc; ++r) {
+        if (v[r] == 0.0f) {
+            continue;
+        }
+
+        const block_q4_0 * GGML_RESTRICT x = (const block_q4_0 *) ((const char *) vx + r*bx);
+
+        for (int ib = 0; ib < nb; ++ib) {
+            const float d = v[r]*GGML_CPU_FP16_TO_FP32(x[ib].d);
+
+            for (int j = 0; j < qk/2; ++j) {
+                y[ib*qk + j]        += d*((x[ib].qs[j] & 0x0F) - 8);
+                y[ib*qk + j + qk/2] += d*((x[ib].qs[j] >>   4) - 8);
+            }
+        }
+    }
+}
+
+void ggml_vec_mad_q8_0_generic(int n, float * GGML_RESTRICT y, const void * GGML_RESTRICT vx, size_t bx, const float * GGML_RESTRICT v, int nrc) {
+    const int qk = QK8_0;
+    const int nb = n / qk;
+
+    assert(n % qk == 0);
+
+    for (int r = 0; r < nrc; ++r) {
+        if (v[r] == 0.0f) {
+            continue;
+        }
+
+        const block_q8_0 * GGML_RESTRICT x = (const block_q8_0 *) ((const char *) vx + r*bx);
+
+        for (int ib = 0; ib < nb; ++ib) {
+            const float d = v[r]*GGML_CPU_FP16_TO_FP32(x[ib].d);
+
+            for (int j = 0; j < qk; ++j) {
+                y[ib*qk + j] += d*x[ib].qs[j];
+            }
+        }
+    }
+}
+
+void ggml_vec_mad_q5_K_generic(int n, float * GGML_RESTRICT y, const void * GGML_RESTRICT vx, size_t bx, const float * GGML_RESTRICT v, int nrc) {
+    assert(n % QK_K == 0);
+
+    const int nb = n / QK_K;
+
+    static const uint32_t kmask1 = 0x3f3f3f3f;
+    static const uint32_t kmask2 = 0x0f0f0f0f;
+    static const uint32_t kmask3 = 0x03030303;
+
+    uint32_t utmp[4];
+
+    const uint8_t * scales = (const uint8_t*)&utmp[0];
+    const uint8_t * mins   = (const uint8_t*)&utmp[2];
+
+    for (int r = 0; r < nrc; ++r) {
+        if (v[r] == 0.0f) {
+            continue;
+        }
+
+        const block_q5_K * GGML_RESTRICT x = (const block_q5_K *) ((const char *) vx + r*bx);
+
+        for (int i = 0; i < nb; ++i) {
+            memcpy(utmp, x[i].scales, 12);
+            utmp[3] = ((utmp[2] >> 4) & kmask2) | (((utmp[1] >> 6) & kmask3) << 4);
+            const uint32_t uaux = utmp[1] & kmask1;
+            utmp[1] = (utmp[2] & kmask2) | (((utmp[0] >> 6) & kmask3) << 4);
+            utmp[2] = uaux;
+            utmp[0] &= kmask1;
+
+            const float d    = v[r]*GGML_CPU_FP16_TO_FP32(x[i].d);
+            const float dmin = v[r]*GGML_CPU_FP16_TO_FP32(x[i].dmin);
+
+            const uint8_t * GGML_RESTRICT q4 = x[i].qs;
+            const uint8_t * GGML_RESTRICT hm = x[i].qh;
+
+            float * GGML_RESTRICT yb = y + i*QK_K;
+
+            uint8_t m = 1;
+            for (int j = 0; j < QK_K/64; ++j) {
+                const float d1 = d*scales[2*j + 0]; const float m1 = dmin*mins[2*j + 0];
+                const float d2 = d*scales[2*j + 1]; const float m2 = dmin*mins[2*j + 1];
+                for (int l = 0; l < 32; ++l) yb[l]      += d1*((q4[l] & 0xF) + (hm[l] & m ? 16 : 0)) - m1;
+                m <<= 1;
+                for (int l = 0; l < 32; ++l) yb[l + 32] += d2*((q4[l]  >> 4) + (hm[l] & m ? 16 : 0)) - m2;
+                m <<= 1;
+                q4 += 32; yb += 64;
+            }
+        }
+    }
+}
+
 // ============================ 4-bit non-linear quants
 
 void quantize_row_iq4_nl(const float * GGML_RESTRICT x, void * GGML_RESTRICT y, int64_t k) {
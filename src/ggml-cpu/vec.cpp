@@ -487,6 +487,70 @@ ggml_float ggml_vec_cvar_f32(const int n, float * y, const float * x, const floa
     return sum/n;
 }
 
+float ggml_vec_scale_add_max_f32(const int n, float * y, const float * x, const float scale, const float * m, const float slope) {
+    int i = 0;
+    float max = -INFINITY;
+#if defined(__AVX512F__) && defined(__AVX512DQ__)
+    __m512 vmax = _mm512_set1_ps(-INFINITY);
+    for (; i + 15 < n; i += 16) {
+        __m512 val = _mm512_mul_ps(_mm512_loadu_ps(x + i), _mm512_set1_ps(scale));
+        if (m) {
+            val = _mm512_add_ps(val, _mm512_mul_ps(_mm512_loadu_ps(m + i), _mm512_set1_ps(slope)));
+        }
+        _mm512_storeu_ps(y + i, val);
+        vmax = _mm512_max_ps(vmax, val);
+    }
+    max = _mm512_reduce_max_ps(vmax);
+#elif defined(__AVX__)
+    __m256 vmax = _mm256_set1_ps(-INFINITY);
+    for (; i + 7 < n; i += 8) {
+        __m256 val = _mm256_mul_ps(_mm256_loadu_ps(x + i), _mm256_set1_ps(scale));
+        if (m) {
+            val = _mm256_add_ps(val, _mm256_mul_ps(_mm256_loadu_ps(m + i), _mm256_set1_ps(slope)));
+        }
+        _mm256_storeu_ps(y + i, val);
+        vmax = _mm256_max_ps(vmax, val);
+    }
+    __m128 vmax4 = _mm_max_ps(_mm256_extractf128_ps(vmax, 1), _mm256_castps256_ps128(vmax));
+    vmax4 = _mm_max_ps(vmax4, _mm_movehl_ps(vmax4, vmax4));
+    vmax4 = _mm_max_ss(vmax4, _mm_movehdup_ps(vmax4));
+    max = _mm_cvtss_f32(vmax4);
+#elif defined(__SSE2__)
+    __m128 vmax = _mm_set1_ps(-INFINITY);
+    for (; i + 3 < n; i += 4) {
+        __m128 val = _mm_mul_ps(_mm_loadu_ps(x + i), _mm_set1_ps(scale));
+        if (m) {
+            val = _mm_add_ps(val, _mm_mul_ps(_mm_loadu_ps(m + i), _mm_set1_ps(slope)));
+        }
+        _mm_storeu_ps(y + i, val);
+        vmax = _mm_max_ps(vmax, val);
+    }
+    vmax = _mm_max_ps(vmax, _mm_movehl_ps(vmax, vmax));
+    vmax = _mm_max_ss(vmax, _mm_shuffle_ps(vmax, vmax, _MM_SHUFFLE(1, 1, 1, 1)));
+    max = _mm_cvtss_f32(vmax);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    float32x4_t vmax = vdupq_n_f32(-INFINITY);
+    for (; i + 3 < n; i += 4) {
+        float32x4_t val = vmulq_n_f32(vld1q_f32(x + i), scale);
+        if (m) {
+            val = vaddq_f32(val, vmulq_n_f32(vld1q_f32(m + i), slope));
+        }
+        vst1q_f32(y + i, val);
+        vmax = vmaxq_f32(vmax, val);
+    }
+    max = vmaxvq_f32(vmax);
+#endif
+    for (; i < n; ++i) {
+        float val = x[i]*scale;
+        if (m) {
+            val += slope*m[i];
+        }
+        y[i] = val;
+        max = MAX(max, val);
+    }
+    return max;
+}
+
 ggml_float ggml_vec_soft_max_f32(const int n, float * y, const float * x, float max) {
     int i = 0;
     ggml_float sum = 0;
@@ -46,6 +46,7 @@ void ggml_vec_dot_f16(int n, float * GGML_RESTRICT s, size_t bs, ggml_fp16_t * G
 void ggml_vec_silu_f32(const int n, float * y, const float * x);
 ggml_float ggml_vec_cvar_f32(const int n, float * y, const float * x, const float mean); //it will also center y ( y = y - mean )
 ggml_float ggml_vec_soft_max_f32(const int n, float * y, const float * x, float max);
+float      ggml_vec_scale_add_max_f32(const int n, float * y, const float * x, const float scale, const float * m, const float slope); // y = scale*x + slope*m (m can be NULL), returns max(y)
 ggml_float ggml_vec_log_soft_max_f32(const int n, float * y, const float * x, float max);
 
 inline static void ggml_vec_set_i8(const int n, int8_t * x, const int8_t v) { for (int i = 0; i < n; ++i) x[i] = v; }
@@ -4111,9 +4111,11 @@ static bool ggml_backend_cuda_device_supports_op(ggml_backend_dev_t dev, const g
         case GGML_OP_ROPE_BACK: {
             return op->src[0]->nb[0] == ggml_type_size(op->src[0]->type) && ggml_is_contiguous_2(op->src[0]);
         }
+        case GGML_OP_CONV_2D:
+            // [IC, KW, KH, OC] kernels of ggml_conv_2d_direct_cwhn are not supported
+            return (op->src[0]->type == GGML_TYPE_F32 || op->src[0]->type == GGML_TYPE_F16) && ggml_get_op_params_i32(op, 6) == 0;
         case GGML_OP_IM2COL:
         case GGML_OP_IM2COL_3D:
-        case GGML_OP_CONV_2D:
         case GGML_OP_CONV_2D_DW:
         case GGML_OP_CONV_TRANSPOSE_2D:
         case GGML_OP_POOL_2D:
@@ -4145,9 +4147,10 @@ static bool ggml_backend_cuda_device_supports_op(ggml_backend_dev_t dev, const g
             return ggml_cuda_flash_attn_ext_supported(dev_ctx->device, op);
         case GGML_OP_CROSS_ENTROPY_LOSS:
         case GGML_OP_CROSS_ENTROPY_LOSS_BACK:
-        case GGML_OP_OPT_STEP_ADAMW:
         case GGML_OP_OPT_STEP_SGD:
             return true;
+        case GGML_OP_OPT_STEP_ADAMW:
+            return op->src[2]->type == GGML_TYPE_F32 && op->src[3]->type == GGML_TYPE_F32;
         default:
             return false;
     }
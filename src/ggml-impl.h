@@ -565,6 +565,105 @@ static inline ggml_bf16_t ggml_compute_fp32_to_bf16(float s) {
 #define GGML_FP32_TO_BF16(x) ggml_compute_fp32_to_bf16(x)
 #define GGML_BF16_TO_FP32(x) ggml_compute_bf16_to_fp32(x)
 
+/**
+ * Converts FP8 to float32.
+ *
+ * The OCP 8-bit floating point formats have the following structure:
+ *
+ *       ┌sign
+ *       │┌exponent
+ *       ││   ┌mantissa
+ *       │┌┴─┐┌┴┐
+ *     0b00000000 E4M3: bias 7, no infinities, NaN is S.1111.111, max 448
+ *
+ *       ┌sign
+ *       │┌exponent
+ *       ││    ┌mantissa
+ *       │┌┴──┐┌┐
+ *     0b00000000 E5M2: bias 15, the upper half of an IEEE binary16, max 57344
+ *
+ * Both formats have subnormals. E4M3 has the same layout as binary16 with the
+ * exponent and mantissa shifted right by 7 and a bias lower by 8, so both are
+ * decoded through binary16 (the SIMD kernels do the same with F16C or NEON).
+ */
+static inline float ggml_compute_fp8_e4m3_to_fp32(uint8_t x) {
+    if ((x & 0x7f) == 0x7f) {
+        return NAN;
+    }
+    const ggml_fp16_t h = (ggml_fp16_t) (((x & 0x80) << 8) | ((x & 0x7f) << 7));
+    return GGML_FP16_TO_FP32(h) * 256.0f;
+}
+
+static inline float ggml_compute_fp8_e5m2_to_fp32(uint8_t x) {
+    return GGML_FP16_TO_FP32((ggml_fp16_t) (x << 8));
+}
+
+/**
+ * Converts float32 to FP8.
+ *
+ * Floats round to nearest even. Finite values beyond the range saturate to the
+ * largest finite value, NaNs stay NaN and E5M2 keeps infinities.
+ */
+static inline uint8_t ggml_compute_fp32_to_fp8_e4m3(float f) {
+    union {
+        float f;
+        uint32_t i;
+    } u;
+    u.f = f;
+    const uint8_t  sign = (u.i >> 24) & 0x80;
+    const uint32_t a    = u.i & 0x7fffffff;
+    if (a > 0x7f800000) { /* nan */
+        return sign | 0x7f;
+    }
+    if (a >= 0x43e00000) { /* >= 448 */
+        return sign | 0x7e;
+    }
+    if (a < 0x3c800000) { /* < 2^-6: subnormal, multiple of 2^-9 */
+        u.i = a;
+        u.f = u.f * 512.0f + 8388608.0f; /* rounds to an integer */
+        return sign | (uint8_t) (u.i - 0x4b000000);
+    }
+    const uint32_t b = a - (120u << 23);
+    return sign | (uint8_t) ((b + (0x7ffff + ((b >> 20) & 1))) >> 20);
+}
+
+static inline uint8_t ggml_compute_fp32_to_fp8_e5m2(float f) {
+    union {
+        float f;
+        uint32_t i;
+    } u;
+    u.f = f;
+    const uint8_t  sign = (u.i >> 24) & 0x80;
+    const uint32_t a    = u.i & 0x7fffffff;
+    if (a > 0x7f800000) { /* nan */
+        return sign | 0x7f;
+    }
+    if (a == 0x7f800000) { /* inf */
+        return sign | 0x7c;
+    }
+    if (a >= 0x47600000) { /* >= 57344 */
+        return sign | 0x7b;
+    }
+    if (a < 0x38800000) { /* < 2^-14: subnormal, multiple of 2^-16 */
+        u.i = a;
+        u.f = u.f * 65536.0f + 8388608.0f; /* rounds to an integer */
+        return sign | (uint8_t) (u.i - 0x4b000000);
+    }
+    const uint32_t b = a - (112u << 23);
+    return sign | (uint8_t) ((b + (0xfffff + ((b >> 21) & 1))) >> 21);
+}
+
+#define GGML_FP8_E4M3_TO_FP32(x) ggml_compute_fp8_e4m3_to_fp32(x)
+#define GGML_FP8_E5M2_TO_FP32(x) ggml_compute_fp8_e5m2_to_fp32(x)
+#define GGML_FP32_TO_FP8_E4M3(x) ggml_compute_fp32_to_fp8_e4m3(x)
+#define GGML_FP32_TO_FP8_E5M2(x) ggml_compute_fp32_to_fp8_e5m2(x)
+
+// FP8 is not a quantized type (one element per block, kernels in the F32/F16 layout),
+// but like the quantized types it is converted with to_float/from_float
+static inline bool ggml_is_fp8(enum ggml_type type) {
+    return type == GGML_TYPE_F8_E4M3 || type == GGML_TYPE_F8_E5M2;
+}
+
 static inline int32_t ggml_node_get_use_count(const struct ggml_cgraph * cgraph, int node_idx) {
     const struct ggml_tensor * node = cgraph->nodes[node_idx];
 
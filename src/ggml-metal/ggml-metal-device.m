@@ -887,7 +887,7 @@ bool ggml_metal_device_supports_op(ggml_metal_device_t dev, const struct ggml_te
         case GGML_OP_IM2COL:
             return ggml_is_contiguous(op->src[1]) && op->src[1]->type == GGML_TYPE_F32 && (op->type == GGML_TYPE_F16 || op->type == GGML_TYPE_F32);
         case GGML_OP_CONV_2D:
-            return ggml_is_contiguous(op->src[0]) &&
+            return ggml_is_contiguous(op->src[0]) && ggml_get_op_params_i32(op, 6) == 0 &&
                    op->src[1]->type == GGML_TYPE_F32 &&
                    op->type == GGML_TYPE_F32 &&
                    (op->src[0]->type == GGML_TYPE_F16 || op->src[0]->type == GGML_TYPE_F32);
@@ -1018,6 +1018,7 @@ bool ggml_metal_device_supports_op(ggml_metal_device_t dev, const struct ggml_te
                 };
             }
         case GGML_OP_OPT_STEP_ADAMW:
+            return has_simdgroup_reduction && op->src[2]->type == GGML_TYPE_F32 && op->src[3]->type == GGML_TYPE_F32;
         case GGML_OP_OPT_STEP_SGD:
             return has_simdgroup_reduction;
         default:
@@ -6,18 +6,46 @@
 #include "ggml-impl.h"
 
 #include <algorithm>
+#include <cerrno>
 #include <cmath>
 #include <cstdint>
 #include <cinttypes>
+#include <condition_variable>
+#include <cstring>
 #include <map>
+#include <mutex>
 #include <random>
+#include <thread>
 #include <vector>
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#ifndef NOMINMAX
+#   define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// read-only memory mapping of a whole file
+struct ggml_opt_file_mapping {
+    void * addr = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE hmap = NULL;
+#endif
+};
+
 struct ggml_opt_dataset {
-    struct ggml_context   * ctx    = nullptr;
-    ggml_backend_buffer_t   buf    = nullptr;
-    struct ggml_tensor    * data   = nullptr;
-    struct ggml_tensor    * labels = nullptr;
+    struct ggml_context   * ctx        = nullptr;
+    ggml_backend_buffer_t   buf        = nullptr;
+    ggml_backend_buffer_t   buf_labels = nullptr; // only used if the labels are memory-mapped from a separate file
+    struct ggml_tensor    * data       = nullptr;
+    struct ggml_tensor    * labels     = nullptr;
 
     int64_t ndata       = -1;
     int64_t ndata_shard = -1;
@@ -25,6 +53,14 @@ struct ggml_opt_dataset {
     size_t  nbs_labels  = -1;
 
     std::vector<int64_t> permutation;
+
+    // out-of-core datasets, the data is either memory-mapped or read on demand shard by shard
+    ggml_opt_file_mapping mapping_data;
+    ggml_opt_file_mapping mapping_labels;
+
+    ggml_opt_dataset_read_shard_t      read_shard      = nullptr;
+    ggml_opt_dataset_readahead_shard_t readahead_shard = nullptr;
+    void *                             read_shard_ud   = nullptr;
 };
 
 struct ggml_opt_context {
@@ -69,6 +105,18 @@ struct ggml_opt_context {
     struct ggml_tensor *          opt_step_params = nullptr; // Stores output of get_opt_pars.
 
     enum ggml_opt_optimizer_type optimizer = GGML_OPT_OPTIMIZER_TYPE_ADAMW;
+
+    enum ggml_type type_momenta = GGML_TYPE_F32;
+
+    int32_t checkpoint_interval = 0;
+
+    // state of an evaluation started by ggml_opt_eval_async whose results have not been read back yet
+    bool                 eval_pending     = false;
+    ggml_opt_result_t    pending_result   = nullptr;
+    struct ggml_tensor * pending_loss     = nullptr;
+    struct ggml_tensor * pending_pred     = nullptr;
+    struct ggml_tensor * pending_ncorrect = nullptr;
+    int64_t              pending_ndata    = 0;
 };
 
 struct ggml_opt_result {
@@ -83,7 +131,88 @@ struct ggml_opt_result {
 
 // ====== Dataset ======
 
-ggml_opt_dataset_t ggml_opt_dataset_init(
+static bool ggml_opt_file_map(const char * fname, size_t size_min, ggml_opt_file_mapping & mapping) {
+#ifdef _WIN32
+    HANDLE hfile = CreateFileA(fname, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hfile == INVALID_HANDLE_VALUE) {
+        GGML_LOG_ERROR("%s: failed to open '%s'\n", __func__, fname);
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(hfile, &size) || size_t(size.QuadPart) < size_min) {
+        GGML_LOG_ERROR("%s: '%s' is too small, need at least %zu bytes\n", __func__, fname, size_min);
+        CloseHandle(hfile);
+        return false;
+    }
+    HANDLE hmap = CreateFileMappingA(hfile, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(hfile);
+    if (hmap == NULL) {
+        GGML_LOG_ERROR("%s: failed to map '%s'\n", __func__, fname);
+        return false;
+    }
+    void * addr = MapViewOfFile(hmap, FILE_MAP_READ, 0, 0, 0);
+    if (addr == NULL) {
+        GGML_LOG_ERROR("%s: failed to map '%s'\n", __func__, fname);
+        CloseHandle(hmap);
+        return false;
+    }
+    mapping.addr = addr;
+    mapping.size = size.QuadPart;
+    mapping.hmap = hmap;
+#else
+    const int fd = open(fname, O_RDONLY);
+    if (fd < 0) {
+        GGML_LOG_ERROR("%s: failed to open '%s': %s\n", __func__, fname, strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < size_min) {
+        GGML_LOG_ERROR("%s: '%s' is too small, need at least %zu bytes\n", __func__, fname, size_min);
+        close(fd);
+        return false;
+    }
+    void * addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        GGML_LOG_ERROR("%s: failed to map '%s': %s\n", __func__, fname, strerror(errno));
+        return false;
+    }
+    // shards are accessed in shuffled order, sequential readahead by the kernel would only waste I/O
+    posix_madvise(addr, st.st_size, POSIX_MADV_RANDOM);
+    mapping.addr = addr;
+    mapping.size = st.st_size;
+#endif
+    return true;
+}
+
+static void ggml_opt_file_unmap(ggml_opt_file_mapping & mapping) {
+    if (!mapping.addr) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(mapping.addr);
+    CloseHandle(mapping.hmap);
+#else
+    munmap(mapping.addr, mapping.size);
+#endif
+    mapping = {};
+}
+
+// hint to the OS that a range of a mapping will be needed soon so that it is paged in asynchronously
+static void ggml_opt_file_willneed(const ggml_opt_file_mapping & mapping, size_t offset, size_t size) {
+#ifdef _WIN32
+    GGML_UNUSED(mapping);
+    GGML_UNUSED(offset);
+    GGML_UNUSED(size);
+#else
+    static const size_t page_size = sysconf(_SC_PAGESIZE);
+    const size_t offset_page = offset - offset % page_size;
+    posix_madvise((char *) mapping.addr + offset_page, size + (offset - offset_page), POSIX_MADV_WILLNEED);
+#endif
+}
+
+// create the dataset with metadata only, the caller is responsible for providing the data
+static ggml_opt_dataset_t ggml_opt_dataset_init_impl(
         enum ggml_type type_data,
         enum ggml_type type_label,
         int64_t        ne_datapoint,
@@ -119,8 +248,6 @@ ggml_opt_dataset_t ggml_opt_dataset_init(
         result->nbs_labels = 0;
     }
 
-    result->buf = ggml_backend_alloc_ctx_tensors_from_buft(result->ctx, ggml_backend_cpu_buffer_type());
-
     const int64_t nshards = ndata/ndata_shard;
     result->permutation.resize(nshards);
     for (int64_t i = 0; i < nshards; ++i) {
@@ -129,8 +256,74 @@ ggml_opt_dataset_t ggml_opt_dataset_init(
     return result;
 }
 
+ggml_opt_dataset_t ggml_opt_dataset_init(
+        enum ggml_type type_data,
+        enum ggml_type type_label,
+        int64_t        ne_datapoint,
+        int64_t        ne_label,
+        int64_t        ndata,
+        int64_t        ndata_shard) {
+    ggml_opt_dataset_t result = ggml_opt_dataset_init_impl(type_data, type_label, ne_datapoint, ne_label, ndata, ndata_shard);
+    result->buf = ggml_backend_alloc_ctx_tensors_from_buft(result->ctx, ggml_backend_cpu_buffer_type());
+    return result;
+}
+
+ggml_opt_dataset_t ggml_opt_dataset_init_mmap(
+        enum ggml_type type_data,
+        enum ggml_type type_label,
+        int64_t        ne_datapoint,
+        int64_t        ne_label,
+        int64_t        ndata,
+        int64_t        ndata_shard,
+        const char   * fname_data,
+        const char   * fname_labels) {
+    GGML_ASSERT(fname_data);
+    GGML_ASSERT((ne_label > 0) == (fname_labels != nullptr));
+
+    ggml_opt_dataset_t result = ggml_opt_dataset_init_impl(type_data, type_label, ne_datapoint, ne_label, ndata, ndata_shard);
+
+    if (!ggml_opt_file_map(fname_data, ggml_nbytes(result->data), result->mapping_data)) {
+        ggml_opt_dataset_free(result);
+        return nullptr;
+    }
+    result->buf = ggml_backend_cpu_buffer_from_ptr(result->mapping_data.addr, result->mapping_data.size);
+    ggml_backend_tensor_alloc(result->buf, result->data, result->mapping_data.addr);
+
+    if (result->labels) {
+        if (!ggml_opt_file_map(fname_labels, ggml_nbytes(result->labels), result->mapping_labels)) {
+            ggml_opt_dataset_free(result);
+            return nullptr;
+        }
+        result->buf_labels = ggml_backend_cpu_buffer_from_ptr(result->mapping_labels.addr, result->mapping_labels.size);
+        ggml_backend_tensor_alloc(result->buf_labels, result->labels, result->mapping_labels.addr);
+    }
+    return result;
+}
+
+ggml_opt_dataset_t ggml_opt_dataset_init_callback(
+        enum ggml_type                     type_data,
+        enum ggml_type                     type_label,
+        int64_t                            ne_datapoint,
+        int64_t                            ne_label,
+        int64_t                            ndata,
+        int64_t                            ndata_shard,
+        ggml_opt_dataset_read_shard_t      read_shard,
+        ggml_opt_dataset_readahead_shard_t readahead_shard,
+        void                             * userdata) {
+    GGML_ASSERT(read_shard);
+
+    ggml_opt_dataset_t result = ggml_opt_dataset_init_impl(type_data, type_label, ne_datapoint, ne_label, ndata, ndata_shard);
+    result->read_shard      = read_shard;
+    result->readahead_shard = readahead_shard;
+    result->read_shard_ud   = userdata;
+    return result;
+}
+
 void ggml_opt_dataset_free(ggml_opt_dataset_t dataset) {
     ggml_backend_buffer_free(dataset->buf);
+    ggml_backend_buffer_free(dataset->buf_labels);
+    ggml_opt_file_unmap(dataset->mapping_data);
+    ggml_opt_file_unmap(dataset->mapping_labels);
     ggml_free(dataset->ctx);
     delete dataset;
 }
@@ -160,6 +353,40 @@ void ggml_opt_dataset_shuffle(ggml_opt_context_t opt_ctx, ggml_opt_dataset_t dat
     std::shuffle(dataset->permutation.begin(), dataset->permutation.begin() + ishard_max, opt_ctx->rng);
 }
 
+// copy a single shard to host memory, labels may be nullptr
+static void ggml_opt_dataset_read(ggml_opt_dataset_t dataset, int64_t ishard, void * data, void * labels) {
+    if (dataset->read_shard) {
+        dataset->read_shard(ishard, data, labels, dataset->read_shard_ud);
+        return;
+    }
+
+    memcpy(data, (const char *) dataset->data->data + ishard*dataset->nbs_data, dataset->nbs_data);
+    if (labels) {
+        memcpy(labels, (const char *) dataset->labels->data + ishard*dataset->nbs_labels, dataset->nbs_labels);
+    }
+}
+
+// start fetching the shards of batch ibatch in the background, no-op for in-memory datasets
+static void ggml_opt_dataset_readahead(ggml_opt_dataset_t dataset, int64_t ibatch, int64_t shards_per_batch) {
+    if ((ibatch + 1)*shards_per_batch > int64_t(dataset->permutation.size())) {
+        return;
+    }
+
+    for (int64_t ishard_batch = 0; ishard_batch < shards_per_batch; ++ishard_batch) {
+        const int64_t ishard = dataset->permutation[ibatch*shards_per_batch + ishard_batch];
+
+        if (dataset->readahead_shard) {
+            dataset->readahead_shard(ishard, dataset->read_shard_ud);
+        }
+        if (dataset->mapping_data.addr) {
+            ggml_opt_file_willneed(dataset->mapping_data, ishard*dataset->nbs_data, dataset->nbs_data);
+        }
+        if (dataset->mapping_labels.addr) {
+            ggml_opt_file_willneed(dataset->mapping_labels, ishard*dataset->nbs_labels, dataset->nbs_labels);
+        }
+    }
+}
+
 void ggml_opt_dataset_get_batch(ggml_opt_dataset_t dataset, struct ggml_tensor * data_batch, struct ggml_tensor * labels_batch, int64_t ibatch) {
     GGML_ASSERT(   data_batch && ggml_is_contiguous(data_batch));
     GGML_ASSERT(!labels_batch || ggml_is_contiguous(labels_batch));
@@ -178,17 +405,35 @@ void ggml_opt_dataset_get_batch(ggml_opt_dataset_t dataset, struct ggml_tensor *
 
     GGML_ASSERT((ibatch + 1)*shards_per_batch <= int64_t(dataset->permutation.size()));
 
+    ggml_opt_dataset_readahead(dataset, ibatch + 1, shards_per_batch);
+
+    // shards of datasets that are read via a callback need to be staged in host memory
+    std::vector<uint8_t> shard_data;
+    std::vector<uint8_t> shard_labels;
+    if (dataset->read_shard) {
+        shard_data.resize(dataset->nbs_data);
+        shard_labels.resize(dataset->nbs_labels);
+    }
+
     for (int64_t ishard_batch = 0; ishard_batch < shards_per_batch; ++ishard_batch) {
         const int64_t ishard = dataset->permutation[ibatch*shards_per_batch + ishard_batch];
 
-        const char * ptr_data = (const char *) dataset->data->data + ishard*dataset->nbs_data;
+        const char * ptr_data;
+        const char * ptr_labels;
+        if (dataset->read_shard) {
+            ggml_opt_dataset_read(dataset, ishard, shard_data.data(), labels_batch ? shard_labels.data() : nullptr);
+            ptr_data   = (const char *) shard_data.data();
+            ptr_labels = (const char *) shard_labels.data();
+        } else {
+            ptr_data   = (const char *) dataset->data->data + ishard*dataset->nbs_data;
+            ptr_labels = labels_batch ? (const char *) dataset->labels->data + ishard*dataset->nbs_labels : nullptr;
+        }
         ggml_backend_tensor_set(data_batch, ptr_data, ishard_batch*dataset->nbs_data, dataset->nbs_data);
 
         if (!labels_batch) {
             continue;
         }
 
-        const char * ptr_labels = (const char *) dataset->labels->data + ishard*dataset->nbs_labels;
         ggml_backend_tensor_set(labels_batch, ptr_labels, ishard_batch*dataset->nbs_labels, dataset->nbs_labels);
     }
 }
@@ -201,20 +446,14 @@ void ggml_opt_dataset_get_batch_host(ggml_opt_dataset_t dataset, void * data_bat
 
     GGML_ASSERT((ibatch + 1)*shards_per_batch <= int64_t(dataset->permutation.size()));
 
+    ggml_opt_dataset_readahead(dataset, ibatch + 1, shards_per_batch);
+
     for (int64_t ishard_batch = 0; ishard_batch < shards_per_batch; ++ishard_batch) {
         const int64_t ishard = dataset->permutation[ibatch*shards_per_batch + ishard_batch];
 
-        const char * ptr_data       = (const char *) dataset->data->data + ishard      *dataset->nbs_data;
-        char       * ptr_data_batch = (char       *) data_batch          + ishard_batch*dataset->nbs_data;
-        memcpy(ptr_data_batch, ptr_data, dataset->nbs_data);
-
-        if (!labels_batch) {
-            continue;
-        }
-
-        const char * ptr_labels       = (const char *) dataset->labels->data + ishard      *dataset->nbs_labels;
-        char       * ptr_labels_batch = (char       *) labels_batch          + ishard_batch*dataset->nbs_labels;
-        memcpy(ptr_labels_batch, ptr_labels, dataset->nbs_labels);
+        char * ptr_data_batch   = (char *) data_batch + ishard_batch*dataset->nbs_data;
+        char * ptr_labels_batch = labels_batch ? (char *) labels_batch + ishard_batch*dataset->nbs_labels : nullptr;
+        ggml_opt_dataset_read(dataset, ishard, ptr_data_batch, ptr_labels_batch);
     }
 }
 
@@ -246,16 +485,18 @@ struct ggml_opt_params ggml_opt_default_params(
         ggml_backend_sched_t      backend_sched,
         enum ggml_opt_loss_type   loss_type) {
     return {
-        /*backend_sched   =*/ backend_sched,
-        /*ctx_compute     =*/ nullptr,
-        /*inputs          =*/ nullptr,
-        /*logits          =*/ nullptr,
-        /*loss_type       =*/ loss_type,
-        /*build_type      =*/ GGML_OPT_BUILD_TYPE_OPT,
-        /*opt_period      =*/ 1,
-        /*get_opt_pars    =*/ ggml_opt_get_default_optimizer_params,
-        /*get_opt_pars_ud =*/ nullptr,
-        /*optimizer       =*/ GGML_OPT_OPTIMIZER_TYPE_ADAMW,
+        /*backend_sched       =*/ backend_sched,
+        /*ctx_compute         =*/ nullptr,
+        /*inputs              =*/ nullptr,
+        /*logits              =*/ nullptr,
+        /*loss_type           =*/ loss_type,
+        /*build_type          =*/ GGML_OPT_BUILD_TYPE_OPT,
+        /*opt_period          =*/ 1,
+        /*get_opt_pars        =*/ ggml_opt_get_default_optimizer_params,
+        /*get_opt_pars_ud     =*/ nullptr,
+        /*optimizer           =*/ GGML_OPT_OPTIMIZER_TYPE_ADAMW,
+        /*type_momenta        =*/ GGML_TYPE_F32,
+        /*checkpoint_interval =*/ 0,
     };
 }
 
@@ -475,8 +716,10 @@ static void ggml_opt_build(ggml_opt_context_t opt_ctx) {
             for (int i = 0; i < n_nodes; ++i) {
                 ggml_tensor * node = opt_ctx->gf->nodes[i];
                 if (node->flags & GGML_TENSOR_FLAG_PARAM) {
-                    opt_ctx->grad_m[i] = ggml_new_tensor(opt_ctx->ctx_static, GGML_TYPE_F32, GGML_MAX_DIMS, node->ne);
-                    opt_ctx->grad_v[i] = ggml_new_tensor(opt_ctx->ctx_static, GGML_TYPE_F32, GGML_MAX_DIMS, node->ne);
+                    const enum ggml_type type_momenta = node->ne[0] % ggml_blck_size(opt_ctx->type_momenta) == 0 ?
+                        opt_ctx->type_momenta : GGML_TYPE_F32;
+                    opt_ctx->grad_m[i] = ggml_new_tensor(opt_ctx->ctx_static, type_momenta, GGML_MAX_DIMS, node->ne);
+                    opt_ctx->grad_v[i] = ggml_new_tensor(opt_ctx->ctx_static, type_momenta, GGML_MAX_DIMS, node->ne);
                 } else {
                     opt_ctx->grad_m[i] = nullptr;
                     opt_ctx->grad_v[i] = nullptr;
@@ -485,6 +728,20 @@ static void ggml_opt_build(ggml_opt_context_t opt_ctx) {
         }
     }
 
+    if (opt_ctx->checkpoint_interval > 0) {
+        // views are skipped since they would only keep their source alive
+        int n_candidates = 0;
+        for (int i = 0; i < opt_ctx->gf->n_nodes; ++i) {
+            ggml_tensor * node = opt_ctx->gf->nodes[i];
+            if (node->op == GGML_OP_NONE || node->view_src) {
+                continue;
+            }
+            if (++n_candidates % opt_ctx->checkpoint_interval == 0) {
+                ggml_set_checkpoint(node);
+            }
+        }
+    }
+
     // gb_grad == graph backward gradients, forward pass, then backward pass to calculate gradients.
     opt_ctx->gb_grad = ggml_graph_dup(opt_ctx->ctx_compute, opt_ctx->gf, /*force_grads =*/ true);
     ggml_build_backward_expand(opt_ctx->ctx_compute, opt_ctx->gb_grad, opt_ctx->grad_accs.data());
@@ -548,19 +805,23 @@ static void ggml_opt_build(ggml_opt_context_t opt_ctx) {
 
 ggml_opt_context_t ggml_opt_init(struct ggml_opt_params params) {
     ggml_opt_context_t result = new struct ggml_opt_context;
-    result->backend_sched    = params.backend_sched;
-    result->ctx_compute      = params.ctx_compute;
-    result->loss_type        = params.loss_type;
-    result->build_type       = params.build_type;
-    result->build_type_alloc = params.build_type;
-    result->inputs           = params.inputs;
-    result->outputs          = params.outputs;
-    result->opt_period       = params.opt_period;
-    result->get_opt_pars     = params.get_opt_pars;
-    result->get_opt_pars_ud  = params.get_opt_pars_ud;
-    result->optimizer        = params.optimizer;
+    result->backend_sched       = params.backend_sched;
+    result->ctx_compute         = params.ctx_compute;
+    result->loss_type           = params.loss_type;
+    result->build_type          = params.build_type;
+    result->build_type_alloc    = params.build_type;
+    result->inputs              = params.inputs;
+    result->outputs             = params.outputs;
+    result->opt_period          = params.opt_period;
+    result->get_opt_pars        = params.get_opt_pars;
+    result->get_opt_pars_ud     = params.get_opt_pars_ud;
+    result->optimizer           = params.optimizer;
+    result->type_momenta        = params.type_momenta;
+    result->checkpoint_interval = params.checkpoint_interval;
 
     GGML_ASSERT(result->opt_period >= 1);
+    GGML_ASSERT(result->checkpoint_interval >= 0);
+    GGML_ASSERT(result->type_momenta == GGML_TYPE_F32 || result->type_momenta == GGML_TYPE_BF16 || result->type_momenta == GGML_TYPE_Q8_0);
 
     result->static_graphs = result->ctx_compute;
 
@@ -585,6 +846,7 @@ void ggml_opt_free(ggml_opt_context_t opt_ctx) {
     if (opt_ctx == nullptr) {
         return;
     }
+    ggml_opt_synchronize(opt_ctx);
     ggml_backend_buffer_free(opt_ctx->buf_static);
     ggml_backend_buffer_free(opt_ctx->buf_cpu);
     ggml_free(opt_ctx->ctx_static);
@@ -593,6 +855,7 @@ void ggml_opt_free(ggml_opt_context_t opt_ctx) {
 }
 
 void ggml_opt_reset(ggml_opt_context_t opt_ctx, bool optimizer) {
+    ggml_opt_synchronize(opt_ctx);
     if (optimizer) {
         ggml_graph_reset(opt_ctx->gb_opt);
         opt_ctx->iter = 1;
@@ -715,6 +978,7 @@ void ggml_opt_prepare_alloc(
         struct ggml_tensor  * inputs,
         struct ggml_tensor  * outputs) {
     GGML_ASSERT(!opt_ctx->static_graphs);
+    ggml_opt_synchronize(opt_ctx);
     opt_ctx->ctx_compute = ctx_compute;
     opt_ctx->gf          = gf;
     opt_ctx->inputs      = inputs;
@@ -723,6 +987,7 @@ void ggml_opt_prepare_alloc(
 
 void ggml_opt_alloc(ggml_opt_context_t opt_ctx, bool backward) {
     GGML_ASSERT(!opt_ctx->eval_ready);
+    ggml_opt_synchronize(opt_ctx);
     if (opt_ctx->build_type == GGML_OPT_BUILD_TYPE_OPT && opt_ctx->opt_period > 1 && opt_ctx->opt_i == 0) {
         ggml_graph_reset(opt_ctx->gb_grad);
     }
@@ -778,7 +1043,7 @@ void ggml_opt_alloc(ggml_opt_context_t opt_ctx, bool backward) {
     opt_ctx->eval_ready = true;
 }
 
-void ggml_opt_eval(ggml_opt_context_t opt_ctx, ggml_opt_result_t result) {
+void ggml_opt_eval_async(ggml_opt_context_t opt_ctx, ggml_opt_result_t result) {
     GGML_ASSERT(opt_ctx->eval_ready);
     if (opt_ctx->allocated_graph == opt_ctx->gb_opt) {
         const ggml_opt_optimizer_params & opt_pars = opt_ctx->get_opt_pars(opt_ctx->get_opt_pars_ud);
@@ -820,10 +1085,17 @@ void ggml_opt_eval(ggml_opt_context_t opt_ctx, ggml_opt_result_t result) {
         }
     }
 
-    ggml_backend_sched_graph_compute(opt_ctx->backend_sched, opt_ctx->allocated_graph_copy);
+    ggml_backend_sched_graph_compute_async(opt_ctx->backend_sched, opt_ctx->allocated_graph_copy);
     opt_ctx->iter += opt_ctx->allocated_graph == opt_ctx->gb_opt;
     opt_ctx->opt_i = (opt_ctx->opt_i + 1) % opt_ctx->opt_period;
 
+    opt_ctx->eval_pending     = true;
+    opt_ctx->pending_result   = result;
+    opt_ctx->pending_loss     = opt_ctx->loss;
+    opt_ctx->pending_pred     = opt_ctx->pred;
+    opt_ctx->pending_ncorrect = opt_ctx->ncorrect;
+    opt_ctx->pending_ndata    = opt_ctx->outputs->ne[1];
+
     if (!opt_ctx->static_graphs) {
         opt_ctx->gf                   = nullptr;
         opt_ctx->gb_grad              = nullptr;
@@ -833,7 +1105,16 @@ void ggml_opt_eval(ggml_opt_context_t opt_ctx, ggml_opt_result_t result) {
     }
 
     opt_ctx->eval_ready = false;
+}
+
+void ggml_opt_synchronize(ggml_opt_context_t opt_ctx) {
+    if (!opt_ctx->eval_pending) {
+        return;
+    }
+    ggml_backend_sched_synchronize(opt_ctx->backend_sched);
+    opt_ctx->eval_pending = false;
 
+    ggml_opt_result_t result = opt_ctx->pending_result;
     if (!result) {
         return;
     }
@@ -846,37 +1127,147 @@ void ggml_opt_eval(ggml_opt_context_t opt_ctx, ggml_opt_result_t result) {
         GGML_ASSERT(result->opt_period         == opt_ctx->opt_period);
     }
 
-    const int64_t ndata = opt_ctx->outputs->ne[1];
+    const int64_t ndata = opt_ctx->pending_ndata;
     GGML_ASSERT(result->ndata == ndata*int64_t(result->loss.size()) && "varying batch size not supported");
     result->ndata += ndata;
 
-    GGML_ASSERT(ggml_is_scalar(opt_ctx->loss));
-    GGML_ASSERT(opt_ctx->loss->type == GGML_TYPE_F32);
-    float loss;
-    ggml_backend_tensor_get(opt_ctx->loss, &loss, 0, ggml_nbytes(opt_ctx->loss));
-    result->loss.push_back(loss);
-
-    if (opt_ctx->pred) {
-        GGML_ASSERT(opt_ctx->pred->type == GGML_TYPE_I32);
-        std::vector<int32_t> pred(ndata);
-        ggml_backend_tensor_get(opt_ctx->pred, pred.data(), 0, ggml_nbytes(opt_ctx->pred));
-        result->pred.insert(result->pred.end(), pred.begin(), pred.end());
+    struct ggml_tensor * loss = opt_ctx->pending_loss;
+    GGML_ASSERT(ggml_is_scalar(loss));
+    GGML_ASSERT(loss->type == GGML_TYPE_F32);
+    float loss_val;
+    ggml_backend_tensor_get(loss, &loss_val, 0, ggml_nbytes(loss));
+    result->loss.push_back(loss_val);
+
+    struct ggml_tensor * pred = opt_ctx->pending_pred;
+    if (pred) {
+        GGML_ASSERT(pred->type == GGML_TYPE_I32);
+        const size_t npred = result->pred.size();
+        result->pred.resize(npred + ndata);
+        ggml_backend_tensor_get(pred, result->pred.data() + npred, 0, ggml_nbytes(pred));
     }
 
-    if (!opt_ctx->ncorrect || result->ncorrect < 0) {
+    struct ggml_tensor * ncorrect = opt_ctx->pending_ncorrect;
+    if (!ncorrect || result->ncorrect < 0) {
         result->ncorrect = -1;
         return;
     }
 
-    GGML_ASSERT(ggml_is_scalar(opt_ctx->ncorrect));
-    GGML_ASSERT(opt_ctx->ncorrect->type == GGML_TYPE_I64);
-    int64_t ncorrect;
-    ggml_backend_tensor_get(opt_ctx->ncorrect, &ncorrect, 0, ggml_nbytes(opt_ctx->ncorrect));
-    result->ncorrect += ncorrect;
+    GGML_ASSERT(ggml_is_scalar(ncorrect));
+    GGML_ASSERT(ncorrect->type == GGML_TYPE_I64);
+    int64_t ncorrect_val;
+    ggml_backend_tensor_get(ncorrect, &ncorrect_val, 0, ggml_nbytes(ncorrect));
+    result->ncorrect += ncorrect_val;
+}
+
+void ggml_opt_eval(ggml_opt_context_t opt_ctx, ggml_opt_result_t result) {
+    ggml_opt_eval_async(opt_ctx, result);
+    ggml_opt_synchronize(opt_ctx);
 }
 
 // ====== High-Level Functions ======
 
+// Assembles the next batch of a dataset in host memory on a background thread while the current batch is being evaluated.
+// Two staging buffers are used in turns, they are allocated from the host buffer type of the device that the inputs live on
+// (e.g. pinned memory) if there is one so that the upload to the inputs is a single fast copy per tensor.
+struct ggml_opt_batch_prefetcher {
+    ggml_opt_dataset_t dataset;
+
+    size_t nb_data;
+    size_t nb_labels;
+
+    ggml_backend_buffer_t buf[2]    = {nullptr, nullptr};
+    void *                data[2]   = {nullptr, nullptr};
+    void *                labels[2] = {nullptr, nullptr};
+
+    std::thread             thread;
+    std::mutex              mutex;
+    std::condition_variable cv;
+
+    int64_t ibatch_req = -1; // batch requested from the worker thread, -1 if none
+    int     islot_req  = 0;  // staging buffer that the requested batch should be written to
+    bool    done       = true;
+    bool    stop       = false;
+
+    ggml_opt_batch_prefetcher(ggml_opt_dataset_t dataset_src, struct ggml_tensor * inputs_dst, struct ggml_tensor * labels_dst)
+            : dataset(dataset_src), nb_data(ggml_nbytes(inputs_dst)), nb_labels(labels_dst ? ggml_nbytes(labels_dst) : 0) {
+        ggml_backend_buffer_type_t buft = nullptr;
+        if (inputs_dst->buffer) {
+            ggml_backend_dev_t dev = ggml_backend_buft_get_device(ggml_backend_buffer_get_type(inputs_dst->buffer));
+            buft = dev ? ggml_backend_dev_host_buffer_type(dev) : nullptr;
+        }
+        if (!buft) {
+            buft = ggml_backend_cpu_buffer_type();
+        }
+
+        const size_t align       = ggml_backend_buft_get_alignment(buft);
+        const size_t nb_data_pad = GGML_PAD(nb_data, align);
+        for (int islot = 0; islot < 2; ++islot) {
+            buf[islot] = ggml_backend_buft_alloc_buffer(buft, nb_data_pad + nb_labels);
+            GGML_ASSERT(buf[islot]);
+            data[islot]   = ggml_backend_buffer_get_base(buf[islot]);
+            labels[islot] = labels_dst ? (char *) data[islot] + nb_data_pad : nullptr;
+        }
+
+        thread = std::thread([this]() { worker(); });
+    }
+
+    ~ggml_opt_batch_prefetcher() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        cv.notify_all();
+        thread.join();
+        for (int islot = 0; islot < 2; ++islot) {
+            ggml_backend_buffer_free(buf[islot]);
+        }
+    }
+
+    void worker() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            cv.wait(lock, [this]() { return stop || ibatch_req >= 0; });
+            if (stop) {
+                return;
+            }
+            const int64_t ibatch = ibatch_req;
+            const int     islot  = islot_req;
+            lock.unlock();
+
+            ggml_opt_dataset_get_batch_host(dataset, data[islot], nb_data, labels[islot], ibatch);
+
+            lock.lock();
+            ibatch_req = -1;
+            done       = true;
+            cv.notify_all();
+        }
+    }
+
+    // start assembling batch ibatch into staging buffer islot
+    void request(int64_t ibatch, int islot) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            GGML_ASSERT(done);
+            ibatch_req = ibatch;
+            islot_req  = islot;
+            done       = false;
+        }
+        cv.notify_all();
+    }
+
+    // wait for the last requested batch and copy it from staging buffer islot to the input tensors
+    void upload(int islot, struct ggml_tensor * inputs_dst, struct ggml_tensor * labels_dst) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this]() { return done; });
+        }
+        ggml_backend_tensor_set(inputs_dst, data[islot], 0, nb_data);
+        if (labels_dst) {
+            ggml_backend_tensor_set(labels_dst, labels[islot], 0, nb_labels);
+        }
+    }
+};
+
 void ggml_opt_epoch(
         ggml_opt_context_t      opt_ctx,
         ggml_opt_dataset_t      dataset,
@@ -890,6 +1281,9 @@ void ggml_opt_epoch(
     struct ggml_tensor * labels = ggml_opt_labels(opt_ctx);
     struct ggml_tensor * data   = ggml_opt_dataset_data(dataset);
     GGML_ASSERT(data->ne[0] == inputs->ne[0]);
+    GGML_ASSERT(ggml_is_contiguous(inputs) && inputs->type == data->type);
+    GGML_ASSERT((labels == nullptr) == (ggml_opt_dataset_labels(dataset) == nullptr));
+    GGML_ASSERT(!labels || (ggml_is_contiguous(labels) && labels->type == ggml_opt_dataset_labels(dataset)->type));
 
     const int64_t ndata       =   data->ne[1];
     const int64_t ndata_batch = inputs->ne[1];
@@ -901,24 +1295,47 @@ void ggml_opt_epoch(
     GGML_ASSERT(idata_split % ndata_batch == 0);
     const int64_t ibatch_split = idata_split / ndata_batch;
 
-    int64_t ibatch = 0;
-    int64_t t_loop_start = ggml_time_us();
-    for (; ibatch < ibatch_split; ++ibatch) {
-        ggml_opt_alloc(opt_ctx, /*backward =*/ true);
-        ggml_opt_dataset_get_batch(dataset, inputs, labels, ibatch);
-        ggml_opt_eval(opt_ctx, result_train);
-        if (callback_train) {
-            callback_train(true, opt_ctx, dataset, result_train, ibatch+1, ibatch_split, t_loop_start);
+    // The evaluation of a batch is waited for at the start of the next iteration, the callback is invoked before
+    // the next batch is allocated so that it sees opt_ctx in the state of the batch that it reports.
+    // The next batch is assembled by the prefetcher while the current one is being evaluated.
+    int64_t t_loop_start_train = ggml_time_us();
+    int64_t t_loop_start_eval  = t_loop_start_train;
+    auto invoke_callback = [&](int64_t ibatch) {
+        if (ibatch < ibatch_split) {
+            if (callback_train) {
+                callback_train(true, opt_ctx, dataset, result_train, ibatch+1, ibatch_split, t_loop_start_train);
+            }
+        } else if (callback_eval) {
+            callback_eval(false, opt_ctx, dataset, result_eval, ibatch+1-ibatch_split, nbatches-ibatch_split, t_loop_start_eval);
         }
+    };
+
+    ggml_opt_batch_prefetcher prefetcher(dataset, inputs, labels);
+    if (nbatches > 0) {
+        prefetcher.request(0, 0);
     }
-    t_loop_start = ggml_time_us();
-    for (; ibatch < nbatches; ++ibatch) {
-        ggml_opt_alloc(opt_ctx, /*backward =*/ false);
-        ggml_opt_dataset_get_batch(dataset, inputs, labels, ibatch);
-        ggml_opt_eval(opt_ctx, result_eval);
-        if (callback_eval) {
-            callback_eval(false, opt_ctx, dataset, result_eval, ibatch+1-ibatch_split, nbatches-ibatch_split, t_loop_start);
+    for (int64_t ibatch = 0; ibatch < nbatches; ++ibatch) {
+        const bool train = ibatch < ibatch_split;
+        const int  islot = ibatch % 2;
+
+        if (ibatch > 0) {
+            ggml_opt_synchronize(opt_ctx); // waits for the previous batch and reads back its results
+            invoke_callback(ibatch - 1);
         }
+        ggml_opt_alloc(opt_ctx, /*backward =*/ train);
+        if (ibatch == ibatch_split) {
+            t_loop_start_eval = ggml_time_us();
+        }
+
+        prefetcher.upload(islot, inputs, labels);
+        if (ibatch + 1 < nbatches) {
+            prefetcher.request(ibatch + 1, 1 - islot);
+        }
+        ggml_opt_eval_async(opt_ctx, train ? result_train : result_eval);
+    }
+    ggml_opt_synchronize(opt_ctx);
+    if (nbatches > 0) {
+        invoke_callback(nbatches - 1);
     }
 }
 
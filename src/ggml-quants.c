@@ -21,6 +21,14 @@
 
 #define UNUSED GGML_UNUSED
 
+// row quantizers set with ggml_quantize_set_row_fn, NULL for the reference
+static ggml_from_float_t quantize_row_fn[GGML_TYPE_COUNT];
+
+void ggml_quantize_set_row_fn(enum ggml_type type, ggml_from_float_t fn) {
+    GGML_ASSERT(type == GGML_TYPE_Q4_K || type == GGML_TYPE_Q5_K || type == GGML_TYPE_Q6_K);
+    quantize_row_fn[type] = fn;
+}
+
 static inline int best_index_int8(int n, const int8_t * val, float x) {
     if (x <= val[0]) return 0;
     if (x >= val[n-1]) return n-1;
@@ -434,6 +442,32 @@ void dequantize_row_mxfp4(const block_mxfp4 * GGML_RESTRICT x, float * GGML_REST
     }
 }
 
+// FP8: one value per byte, no scale
+
+void quantize_row_f8_e4m3_ref(const float * GGML_RESTRICT x, uint8_t * GGML_RESTRICT y, int64_t k) {
+    for (int64_t i = 0; i < k; i++) {
+        y[i] = GGML_FP32_TO_FP8_E4M3(x[i]);
+    }
+}
+
+void quantize_row_f8_e5m2_ref(const float * GGML_RESTRICT x, uint8_t * GGML_RESTRICT y, int64_t k) {
+    for (int64_t i = 0; i < k; i++) {
+        y[i] = GGML_FP32_TO_FP8_E5M2(x[i]);
+    }
+}
+
+void dequantize_row_f8_e4m3(const uint8_t * GGML_RESTRICT x, float * GGML_RESTRICT y, int64_t k) {
+    for (int64_t i = 0; i < k; i++) {
+        y[i] = GGML_FP8_E4M3_TO_FP32(x[i]);
+    }
+}
+
+void dequantize_row_f8_e5m2(const uint8_t * GGML_RESTRICT x, float * GGML_RESTRICT y, int64_t k) {
+    for (int64_t i = 0; i < k; i++) {
+        y[i] = GGML_FP8_E5M2_TO_FP32(x[i]);
+    }
+}
+
 //
 // 2-6 bit quantization in super-blocks
 //
@@ -1449,7 +1483,12 @@ static void quantize_row_q4_K_impl(const float * GGML_RESTRICT x, block_q4_K * G
 size_t quantize_q4_K(const float * GGML_RESTRICT src, void * GGML_RESTRICT dst, int64_t nrow, int64_t n_per_row, const float * quant_weights) {
     size_t row_size = ggml_row_size(GGML_TYPE_Q4_K, n_per_row);
     if (!quant_weights) {
-        quantize_row_q4_K_ref(src, dst, (int64_t)nrow*n_per_row);
+        ggml_from_float_t fn = quantize_row_fn[GGML_TYPE_Q4_K];
+        if (fn) {
+            fn(src, dst, (int64_t)nrow*n_per_row);
+        } else {
+            quantize_row_q4_K_ref(src, dst, (int64_t)nrow*n_per_row);
+        }
     }
     else {
         char * qrow = (char *)dst;
@@ -1674,7 +1713,12 @@ static void quantize_row_q5_K_impl(const float * GGML_RESTRICT x, block_q5_K * G
 size_t quantize_q5_K(const float * GGML_RESTRICT src, void * GGML_RESTRICT dst, int64_t nrow, int64_t n_per_row, const float * quant_weights) {
     size_t row_size = ggml_row_size(GGML_TYPE_Q5_K, n_per_row);
     if (!quant_weights) {
-        quantize_row_q5_K_ref(src, dst, (int64_t)nrow*n_per_row);
+        ggml_from_float_t fn = quantize_row_fn[GGML_TYPE_Q5_K];
+        if (fn) {
+            fn(src, dst, (int64_t)nrow*n_per_row);
+        } else {
+            quantize_row_q5_K_ref(src, dst, (int64_t)nrow*n_per_row);
+        }
     }
     else {
         char * qrow = (char *)dst;
@@ -1877,7 +1921,12 @@ static void quantize_row_q6_K_impl(const float * GGML_RESTRICT x, block_q6_K * G
 size_t quantize_q6_K(const float * GGML_RESTRICT src, void * GGML_RESTRICT dst, int64_t nrow, int64_t n_per_row, const float * quant_weights) {
     size_t row_size = ggml_row_size(GGML_TYPE_Q6_K, n_per_row);
     if (!quant_weights) {
-        quantize_row_q6_K_ref(src, dst, (int64_t)nrow*n_per_row);
+        ggml_from_float_t fn = quantize_row_fn[GGML_TYPE_Q6_K];
+        if (fn) {
+            fn(src, dst, (int64_t)nrow*n_per_row);
+        } else {
+            quantize_row_q6_K_ref(src, dst, (int64_t)nrow*n_per_row);
+        }
     }
     else {
         char * qrow = (char *)dst;
@@ -2098,6 +2147,18 @@ size_t quantize_mxfp4(const float * GGML_RESTRICT src, void * GGML_RESTRICT dst,
     return nrow * ggml_row_size(GGML_TYPE_MXFP4, n_per_row);
 }
 
+size_t quantize_f8_e4m3(const float * GGML_RESTRICT src, void * GGML_RESTRICT dst, int64_t nrow, int64_t n_per_row, const float * quant_weights) {
+    GGML_UNUSED(quant_weights);
+    quantize_row_f8_e4m3_ref(src, dst, (int64_t)nrow*n_per_row);
+    return nrow * ggml_row_size(GGML_TYPE_F8_E4M3, n_per_row);
+}
+
+size_t quantize_f8_e5m2(const float * GGML_RESTRICT src, void * GGML_RESTRICT dst, int64_t nrow, int64_t n_per_row, const float * quant_weights) {
+    GGML_UNUSED(quant_weights);
+    quantize_row_f8_e5m2_ref(src, dst, (int64_t)nrow*n_per_row);
+    return nrow * ggml_row_size(GGML_TYPE_F8_E5M2, n_per_row);
+}
+
 // ====================== Ternary (de)-quantization (BitNet b1.58 and TriLMs)
 
 void quantize_row_tq1_0_ref(const float * GGML_RESTRICT x, block_tq1_0 * GGML_RESTRICT y, int64_t k) {
@@ -5110,6 +5171,27 @@ bool ggml_validate_row_data(enum ggml_type type, const void * data, size_t nbyte
                     return false;
                 }
             } break;
+        case GGML_TYPE_F8_E4M3:
+        case GGML_TYPE_F8_E5M2:
+            {
+                // E4M3 has no infinities, E5M2 has the binary16 ones
+                const bool e4m3 = type == GGML_TYPE_F8_E4M3;
+                int nans = 0;
+                int infs = 0;
+                const uint8_t * f = (const uint8_t *) data;
+                for (size_t i = 0; i < nb; ++i) {
+                    nans += e4m3 ? (f[i] & 0x7f) == 0x7f : (f[i] & 0x7f) > 0x7c;
+                    infs += e4m3 ? 0 : (f[i] & 0x7f) == 0x7c;
+                }
+                if (nans) {
+                    fprintf(stderr, "%s: found %d NaNs in row of %zu %s values\n", __func__, nans, nb, ggml_type_name(type));
+                    return false;
+                }
+                if (infs) {
+                    fprintf(stderr, "%s: found %d infinities in row of %zu %s values\n", __func__, infs, nb, ggml_type_name(type));
+                    return false;
+                }
+            } break;
         case GGML_TYPE_F16:
             {
                 const ggml_fp16_t * f = (const ggml_fp16_t *) data;
@@ -49,6 +49,8 @@
     #define NOMINMAX
 #endif
 #include <windows.h>
+#else
+#include <pthread.h>
 #endif
 
 #define UNUSED GGML_UNUSED
@@ -873,6 +875,22 @@ static const struct ggml_type_traits type_traits[GGML_TYPE_COUNT] = {
         .type_size                = 0,
         .is_quantized             = false,
     },
+    [GGML_TYPE_F8_E4M3] = {
+        .type_name                = "f8_e4m3",
+        .blck_size                = 1,
+        .type_size                = sizeof(uint8_t),
+        .is_quantized             = false,
+        .to_float                 = (ggml_to_float_t) dequantize_row_f8_e4m3,
+        .from_float_ref           = (ggml_from_float_t) quantize_row_f8_e4m3_ref,
+    },
+    [GGML_TYPE_F8_E5M2] = {
+        .type_name                = "f8_e5m2",
+        .blck_size                = 1,
+        .type_size                = sizeof(uint8_t),
+        .is_quantized             = false,
+        .to_float                 = (ggml_to_float_t) dequantize_row_f8_e5m2,
+        .from_float_ref           = (ggml_from_float_t) quantize_row_f8_e5m2_ref,
+    },
 };
 
 const struct ggml_type_traits * ggml_get_type_traits(enum ggml_type type) {
@@ -911,6 +929,13 @@ struct ggml_context {
 
     struct ggml_object * objects_begin;
     struct ggml_object * objects_end;
+
+    // open addressing name -> tensor index used by ggml_get_tensor
+    // built on the first lookup and extended with the tensors created since, see ggml_name_index_update
+    struct ggml_tensor ** name_index;
+    size_t                name_index_size; // power of 2, 0 if not allocated
+    size_t                name_index_n;
+    struct ggml_object  * name_index_last; // last object visited by ggml_name_index_update
 };
 
 //
@@ -990,6 +1015,7 @@ static const char * GGML_OP_NAME[GGML_OP_COUNT] = {
     "ARANGE",
     "TIMESTEP_EMBEDDING",
     "ARGSORT",
+    "TOP_K",
     "LEAKY_RELU",
     "TRI",
     "FILL",
@@ -1023,7 +1049,7 @@ static const char * GGML_OP_NAME[GGML_OP_COUNT] = {
     "GLU",
 };
 
-static_assert(GGML_OP_COUNT == 94, "GGML_OP_COUNT != 94");
+static_assert(GGML_OP_COUNT == 95, "GGML_OP_COUNT != 95");
 
 static const char * GGML_OP_SYMBOL[GGML_OP_COUNT] = {
     "none",
@@ -1098,6 +1124,7 @@ static const char * GGML_OP_SYMBOL[GGML_OP_COUNT] = {
     "arange(start, stop, step)",
     "timestep_embedding(timesteps, dim, max_period)",
     "argsort(x)",
+    "top_k(x)",
     "leaky_relu(x)",
     "tri(x)",
     "fill(x, c)",
@@ -1131,7 +1158,7 @@ static const char * GGML_OP_SYMBOL[GGML_OP_COUNT] = {
     "glu(x)",
 };
 
-static_assert(GGML_OP_COUNT == 94, "GGML_OP_COUNT != 94");
+static_assert(GGML_OP_COUNT == 95, "GGML_OP_COUNT != 95");
 
 static_assert(GGML_OP_POOL_COUNT == 2, "GGML_OP_POOL_COUNT != 2");
 
@@ -1340,6 +1367,8 @@ enum ggml_type ggml_ftype_to_ggml_type(enum ggml_ftype ftype) {
         case GGML_FTYPE_MOSTLY_Q5_1:          wtype = GGML_TYPE_Q5_1;  break;
         case GGML_FTYPE_MOSTLY_Q8_0:          wtype = GGML_TYPE_Q8_0;  break;
         case GGML_FTYPE_MOSTLY_MXFP4:         wtype = GGML_TYPE_MXFP4; break;
+        case GGML_FTYPE_MOSTLY_F8_E4M3:       wtype = GGML_TYPE_F8_E4M3; break;
+        case GGML_FTYPE_MOSTLY_F8_E5M2:       wtype = GGML_TYPE_F8_E5M2; break;
         case GGML_FTYPE_MOSTLY_Q2_K:          wtype = GGML_TYPE_Q2_K;  break;
         case GGML_FTYPE_MOSTLY_Q3_K:          wtype = GGML_TYPE_Q3_K;  break;
         case GGML_FTYPE_MOSTLY_Q4_K:          wtype = GGML_TYPE_Q4_K;  break;
@@ -1525,6 +1554,10 @@ struct ggml_context * ggml_init(struct ggml_init_params params) {
         /*.n_objects          =*/ 0,
         /*.objects_begin      =*/ NULL,
         /*.objects_end        =*/ NULL,
+        /*.name_index         =*/ NULL,
+        /*.name_index_size    =*/ 0,
+        /*.name_index_n       =*/ 0,
+        /*.name_index_last    =*/ NULL,
     };
 
     GGML_ASSERT(ctx->mem_buffer != NULL);
@@ -1544,6 +1577,12 @@ void ggml_reset(struct ggml_context * ctx) {
     ctx->n_objects     = 0;
     ctx->objects_begin = NULL;
     ctx->objects_end   = NULL;
+
+    if (ctx->name_index_n > 0) {
+        memset(ctx->name_index, 0, ctx->name_index_size*sizeof(struct ggml_tensor *));
+    }
+    ctx->name_index_n    = 0;
+    ctx->name_index_last = NULL;
 }
 
 void ggml_free(struct ggml_context * ctx) {
@@ -1555,6 +1594,7 @@ void ggml_free(struct ggml_context * ctx) {
         ggml_aligned_free(ctx->mem_buffer, ctx->mem_size);
     }
 
+    GGML_FREE(ctx->name_index);
     GGML_FREE(ctx);
 }
 
@@ -1878,7 +1918,88 @@ struct ggml_tensor * ggml_get_next_tensor(const struct ggml_context * ctx, struc
     return NULL;
 }
 
+// FNV-1a
+static size_t ggml_hash_name(const char * name) {
+    uint32_t h = 2166136261u;
+    for (; *name; ++name) {
+        h = (h ^ (uint8_t) *name) * 16777619u;
+    }
+    return h;
+}
+
+static struct ggml_tensor ** ggml_name_index_find(struct ggml_context * ctx, const char * name) {
+    const size_t mask = ctx->name_index_size - 1;
+
+    size_t i = ggml_hash_name(name) & mask;
+    while (ctx->name_index[i] != NULL && strcmp(ctx->name_index[i]->name, name) != 0) {
+        i = (i + 1) & mask;
+    }
+
+    return &ctx->name_index[i];
+}
+
+// adds the named tensors created since the last call to the index
+// when several tensors have the same name only the first one is indexed, which is the one the linear scan would return
+// names set after a tensor has been visited are not seen by the index, ggml_get_tensor falls back to a scan for those
+static void ggml_name_index_update(struct ggml_context * ctx) {
+    struct ggml_object * obj = ctx->name_index_last ? ctx->name_index_last->next : ctx->objects_begin;
+    if (obj == NULL) {
+        return;
+    }
+
+    // keep the load factor under 1/2, rebuilding from the start so that the current names are used
+    if (2*(size_t) ctx->n_objects >= ctx->name_index_size) {
+        size_t size = ctx->name_index_size > 0 ? ctx->name_index_size : 64;
+        while (2*(size_t) ctx->n_objects >= size) {
+            size *= 2;
+        }
+        GGML_FREE(ctx->name_index);
+        ctx->name_index      = GGML_CALLOC(size, sizeof(struct ggml_tensor *));
+        ctx->name_index_size = size;
+        ctx->name_index_n    = 0;
+
+        obj = ctx->objects_begin;
+    }
+
+    char * const mem_buffer = ctx->mem_buffer;
+
+    for (; obj != NULL; obj = obj->next) {
+        ctx->name_index_last = obj;
+
+        if (obj->type != GGML_OBJECT_TYPE_TENSOR) {
+            continue;
+        }
+
+        struct ggml_tensor * cur = (struct ggml_tensor *)(mem_buffer + obj->offs);
+        if (cur->name[0] == '\0') {
+            continue;
+        }
+
+        struct ggml_tensor ** slot = ggml_name_index_find(ctx, cur->name);
+        if (*slot == NULL) {
+            *slot = cur;
+            ctx->name_index_n++;
+        }
+    }
+}
+
 struct ggml_tensor * ggml_get_tensor(struct ggml_context * ctx, const char * name) {
+    if (name[0] != '\0') {
+        // the index is extended by the lookups, so that lookups from several threads are serialized
+        ggml_critical_section_start();
+
+        ggml_name_index_update(ctx);
+
+        struct ggml_tensor * cur = ctx->name_index_size > 0 ? *ggml_name_index_find(ctx, name) : NULL;
+
+        ggml_critical_section_end();
+
+        if (cur != NULL) {
+            return cur;
+        }
+    }
+
+    // not indexed: unnamed, or renamed after the index was updated
     struct ggml_object * obj = ctx->objects_begin;
 
     char * const mem_buffer = ctx->mem_buffer;
@@ -1968,8 +2089,9 @@ static struct ggml_tensor * ggml_add_cast_impl(
     //       GGML_ASSERT(ggml_can_repeat(b, a));
     GGML_ASSERT(ggml_can_repeat_rows(b, a));
 
-    // currently only supported for quantized input and f16
+    // currently only supported for quantized input, f16 and fp8
     GGML_ASSERT(ggml_is_quantized(a->type) ||
+                ggml_is_fp8(a->type) ||
                 a->type == GGML_TYPE_F16 ||
                 a->type == GGML_TYPE_BF16);
 
@@ -4676,23 +4798,29 @@ struct ggml_tensor * ggml_conv_2d_dw_direct(
 
 // ggml_conv_2d_direct
 
-struct ggml_tensor * ggml_conv_2d_direct(
+// op_params[6] is 1 if the kernel is [IC, KW, KH, OC]
+static struct ggml_tensor * ggml_conv_2d_direct_impl(
         struct ggml_context * ctx,
-        struct ggml_tensor  * a,   // convolution kernel [KW, KH, IC, OC]
-        struct ggml_tensor  * b,   // input data [W, H, C, N]
-        int                   s0,  // stride dimension 0
-        int                   s1,  // stride dimension 1
-        int                   p0,  // padding dimension 0
-        int                   p1,  // padding dimension 1
-        int                   d0,  // dilation dimension 0
-        int                   d1) {// dilation dimension 1
+        struct ggml_tensor  * a,
+        struct ggml_tensor  * b,
+        int                   s0,
+        int                   s1,
+        int                   p0,
+        int                   p1,
+        int                   d0,
+        int                   d1,
+        bool                  cwhn) {
 
-    GGML_ASSERT(a->ne[2] == b->ne[2]);
+    const int64_t kw = cwhn ? a->ne[1] : a->ne[0];
+    const int64_t kh = cwhn ? a->ne[2] : a->ne[1];
+    const int64_t ic = cwhn ? a->ne[0] : a->ne[2];
+
+    GGML_ASSERT(ic == b->ne[2]);
     //GGML_ASSERT(a->type == b->type);
 
     int64_t ne[4];
-    ne[0] = ggml_calc_conv_output_size(b->ne[0], a->ne[0], s0, p0, d0);
-    ne[1] = ggml_calc_conv_output_size(b->ne[1], a->ne[1], s1, p1, d1);
+    ne[0] = ggml_calc_conv_output_size(b->ne[0], kw, s0, p0, d0);
+    ne[1] = ggml_calc_conv_output_size(b->ne[1], kh, s1, p1, d1);
     ne[2] = a->ne[3];
     ne[3] = b->ne[3];
 
@@ -4704,6 +4832,7 @@ struct ggml_tensor * ggml_conv_2d_direct(
     ggml_set_op_params_i32(result, 3, p1);
     ggml_set_op_params_i32(result, 4, d0);
     ggml_set_op_params_i32(result, 5, d1);
+    ggml_set_op_params_i32(result, 6, cwhn ? 1 : 0);
 
     result->op = GGML_OP_CONV_2D;
     result->src[0] = a;
@@ -4712,6 +4841,35 @@ struct ggml_tensor * ggml_conv_2d_direct(
     return result;
 }
 
+struct ggml_tensor * ggml_conv_2d_direct(
+        struct ggml_context * ctx,
+        struct ggml_tensor  * a,   // convolution kernel [KW, KH, IC, OC]
+        struct ggml_tensor  * b,   // input data [W, H, C, N]
+        int                   s0,  // stride dimension 0
+        int                   s1,  // stride dimension 1
+        int                   p0,  // padding dimension 0
+        int                   p1,  // padding dimension 1
+        int                   d0,  // dilation dimension 0
+        int                   d1) {// dilation dimension 1
+    // the rows of a quantized kernel would have to be KW wide, use ggml_conv_2d_direct_cwhn
+    GGML_ASSERT(!ggml_is_quantized(a->type));
+
+    return ggml_conv_2d_direct_impl(ctx, a, b, s0, s1, p0, p1, d0, d1, false);
+}
+
+struct ggml_tensor * ggml_conv_2d_direct_cwhn(
+        struct ggml_context * ctx,
+        struct ggml_tensor  * a,   // convolution kernel [IC, KW, KH, OC]
+        struct ggml_tensor  * b,   // input data [W, H, C, N]
+        int                   s0,  // stride dimension 0
+        int                   s1,  // stride dimension 1
+        int                   p0,  // padding dimension 0
+        int                   p1,  // padding dimension 1
+        int                   d0,  // dilation dimension 0
+        int                   d1) {// dilation dimension 1
+    return ggml_conv_2d_direct_impl(ctx, a, b, s0, s1, p0, p1, d0, d1, true);
+}
+
 // ggml_conv_3d_direct
 
 struct ggml_tensor * ggml_conv_3d_direct(
@@ -5167,6 +5325,35 @@ struct ggml_tensor * ggml_top_k(
     return result;
 }
 
+// ggml_top_k_ext
+
+struct ggml_tensor * ggml_top_k_ext(
+        struct ggml_context * ctx,
+        struct ggml_tensor  * a,
+        int                   k,
+        struct ggml_tensor ** values) {
+    GGML_ASSERT(k > 0 && a->ne[0] >= k);
+    GGML_ASSERT(a->ne[0] <= INT32_MAX);
+
+    struct ggml_tensor * result = ggml_new_tensor_4d(ctx, GGML_TYPE_I32, k, a->ne[1], a->ne[2], a->ne[3]);
+
+    ggml_set_op_params_i32(result, 0, k);
+
+    result->op     = GGML_OP_TOP_K;
+    result->src[0] = a;
+
+    if (values) {
+        // gather the values with the indices as rows of [1, ne0, ne1, ne2*ne3]
+        struct ggml_tensor * a_rows = ggml_reshape_4d(ctx, ggml_is_contiguous(a) ? a : ggml_cont(ctx, a),
+                1, a->ne[0], a->ne[1], a->ne[2]*a->ne[3]);
+        struct ggml_tensor * ids = ggml_reshape_3d(ctx, result, k, a->ne[1], a->ne[2]*a->ne[3]);
+
+        *values = ggml_reshape_4d(ctx, ggml_get_rows(ctx, a_rows, ids), k, a->ne[1], a->ne[2], a->ne[3]);
+    }
+
+    return result;
+}
+
 // ggml_flash_attn_ext
 
 struct ggml_tensor * ggml_flash_attn_ext(
@@ -5419,7 +5606,6 @@ struct ggml_tensor * ggml_win_part(
         struct ggml_context * ctx,
         struct ggml_tensor  * a,
         int                   w) {
-    GGML_ASSERT(a->ne[3] == 1);
     GGML_ASSERT(a->type  == GGML_TYPE_F32);
 
     // padding
@@ -5430,7 +5616,8 @@ struct ggml_tensor * ggml_win_part(
     const int npy = (py + a->ne[2])/w;
     const int np  = npx*npy;
 
-    const int64_t ne[4] = { a->ne[0], w, w, np, };
+    // the windows of each image of the batch
+    const int64_t ne[4] = { a->ne[0], w, w, np*a->ne[3], };
     struct ggml_tensor * result = ggml_new_tensor(ctx, GGML_TYPE_F32, 4, ne);
 
     int32_t params[] = { npx, npy, w };
@@ -5452,8 +5639,12 @@ struct ggml_tensor * ggml_win_unpart(
         int                   w) {
     GGML_ASSERT(a->type == GGML_TYPE_F32);
 
-    const int64_t ne[4] = { a->ne[0], w0, h0, 1, };
-    struct ggml_tensor * result = ggml_new_tensor(ctx, GGML_TYPE_F32, 3, ne);
+    // number of windows of an image
+    const int np = ((w0 + w - 1)/w)*((h0 + w - 1)/w);
+    GGML_ASSERT(a->ne[3] % np == 0);
+
+    const int64_t ne[4] = { a->ne[0], w0, h0, a->ne[3]/np, };
+    struct ggml_tensor * result = ggml_new_tensor(ctx, GGML_TYPE_F32, 4, ne);
 
     int32_t params[] = { w };
     ggml_set_op_params(result, params, sizeof(params));
@@ -5949,6 +6140,10 @@ struct ggml_tensor * ggml_opt_step_adamw(
     GGML_ASSERT(ggml_are_same_shape(a, grad));
     GGML_ASSERT(ggml_are_same_shape(a, m));
     GGML_ASSERT(ggml_are_same_shape(a, v));
+    GGML_ASSERT(m->type == GGML_TYPE_F32 || m->type == GGML_TYPE_BF16 || m->type == GGML_TYPE_Q8_0);
+    GGML_ASSERT(v->type == GGML_TYPE_F32 || v->type == GGML_TYPE_BF16 || v->type == GGML_TYPE_Q8_0);
+    GGML_ASSERT(a->ne[0] % ggml_blck_size(m->type) == 0);
+    GGML_ASSERT(a->ne[0] % ggml_blck_size(v->type) == 0);
     GGML_ASSERT(adamw_params->type == GGML_TYPE_F32);
     GGML_ASSERT(ggml_nelements(adamw_params) == 7);
 
@@ -6161,8 +6356,51 @@ static void ggml_sub_or_set(
     ggml_build_forward_expand(cgraph, cgraph->grads[isrc]);
 }
 
+// activation checkpointing: return a tensor with the same value as the forward tensor that is recomputed from the nearest
+// checkpoints, inputs, or parameters, the recomputation is only scheduled once a node of the backward pass needs it
+// remat is indexed like the visited hash set of the forward graph and caches the recomputed tensors
+static struct ggml_tensor * ggml_remat(
+        struct ggml_context * ctx, struct ggml_cgraph * cgraph, struct ggml_tensor ** remat, struct ggml_tensor * tensor) {
+    if (!tensor) {
+        return NULL;
+    }
+
+    const size_t ihash = ggml_hash_find(&cgraph->visited_hash_set, tensor);
+    if (ihash == GGML_HASHSET_FULL || !ggml_bitset_get(cgraph->visited_hash_set.used, ihash)) {
+        return tensor;
+    }
+    if (remat[ihash]) {
+        return remat[ihash];
+    }
+
+    const int32_t keep_flags = GGML_TENSOR_FLAG_INPUT | GGML_TENSOR_FLAG_OUTPUT | GGML_TENSOR_FLAG_PARAM |
+        GGML_TENSOR_FLAG_LOSS | GGML_TENSOR_FLAG_CHECKPOINT;
+
+    struct ggml_tensor * result = tensor;
+    if (tensor->op != GGML_OP_NONE && !(tensor->flags & keep_flags)) {
+        struct ggml_tensor * view_src = ggml_remat(ctx, cgraph, remat, tensor->view_src);
+
+        // views of tensors that are kept anyways don't need any extra memory
+        if (!tensor->view_src || view_src != tensor->view_src) {
+            result = ggml_new_tensor_impl(ctx, tensor->type, GGML_MAX_DIMS, tensor->ne, view_src, tensor->view_offs);
+            for (int j = 0; j < GGML_MAX_DIMS; ++j) {
+                result->nb[j] = tensor->nb[j];
+            }
+            result->op = tensor->op;
+            memcpy(result->op_params, tensor->op_params, sizeof(tensor->op_params));
+            for (int j = 0; j < GGML_MAX_SRC; ++j) {
+                result->src[j] = ggml_remat(ctx, cgraph, remat, tensor->src[j]);
+            }
+            ggml_format_name(result, "%s (remat)", tensor->name);
+        }
+    }
+
+    remat[ihash] = result;
+    return result;
+}
+
 static void ggml_compute_backward(
-        struct ggml_context * ctx, struct ggml_cgraph * cgraph, int i, const bool * grads_needed) {
+        struct ggml_context * ctx, struct ggml_cgraph * cgraph, int i, const bool * grads_needed, struct ggml_tensor ** remat) {
     struct ggml_tensor * tensor = cgraph->nodes[i];
     struct ggml_tensor * grad   = ggml_graph_get_grad(cgraph, tensor);
 
@@ -6181,6 +6419,14 @@ static void ggml_compute_backward(
     const bool src1_needs_grads = src1 && isrc1 != GGML_HASHSET_FULL && ggml_bitset_get(hash_set->used, isrc1) && grads_needed[isrc1];
     const bool src2_needs_grads = src2 && isrc2 != GGML_HASHSET_FULL && ggml_bitset_get(hash_set->used, isrc2) && grads_needed[isrc2];
 
+    if (remat) {
+        // the gradient is calculated from recomputed activations instead of the ones from the forward pass
+        tensor = ggml_remat(ctx, cgraph, remat, tensor);
+        src0   = ggml_remat(ctx, cgraph, remat, src0);
+        src1   = ggml_remat(ctx, cgraph, remat, src1);
+        src2   = ggml_remat(ctx, cgraph, remat, src2);
+    }
+
     switch (tensor->op) {
         case GGML_OP_DUP: {
             if (src0_needs_grads) {
@@ -6812,13 +7058,23 @@ void ggml_build_backward_expand(
         grads_needed[ihash] = true;
     }
 
+    // activation checkpointing is used if at least one node of the forward graph is a checkpoint
+    struct ggml_tensor ** remat = NULL;
+    for (int i = 0; i < n_nodes_f; ++i) {
+        if (cgraph->nodes[i]->flags & GGML_TENSOR_FLAG_CHECKPOINT) {
+            remat = calloc(cgraph->visited_hash_set.size, sizeof(struct ggml_tensor *));
+            break;
+        }
+    }
+
     for (int i = n_nodes_f - 1; i >= 0; --i) {
         // inplace operations to add gradients are not created by ggml_compute_backward except for gradient accumulation
         // use allocator to automatically make inplace operations
-        ggml_compute_backward(ctx, cgraph, i, grads_needed);
+        ggml_compute_backward(ctx, cgraph, i, grads_needed, remat);
     }
 
     free(grads_needed);
+    free(remat);
 }
 
 static void * incr_ptr_aligned(void ** p, size_t size, size_t align) {
@@ -7379,6 +7635,10 @@ void ggml_set_loss(struct ggml_tensor * tensor) {
     tensor->flags |= GGML_TENSOR_FLAG_LOSS;
 }
 
+void ggml_set_checkpoint(struct ggml_tensor * tensor) {
+    tensor->flags |= GGML_TENSOR_FLAG_CHECKPOINT;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 void ggml_quantize_init(enum ggml_type type) {
@@ -7449,6 +7709,8 @@ size_t ggml_quantize_chunk(
         case GGML_TYPE_Q5_1:    result = quantize_q5_1(src + start, (char *) dst + start_row * row_size, nrows, n_per_row, imatrix); break;
         case GGML_TYPE_Q8_0:    result = quantize_q8_0(src + start, (char *) dst + start_row * row_size, nrows, n_per_row, imatrix); break;
         case GGML_TYPE_MXFP4:   result = quantize_mxfp4(src + start, (char *) dst + start_row * row_size, nrows, n_per_row, imatrix); break;
+        case GGML_TYPE_F8_E4M3: result = quantize_f8_e4m3(src + start, (char *) dst + start_row * row_size, nrows, n_per_row, imatrix); break;
+        case GGML_TYPE_F8_E5M2: result = quantize_f8_e5m2(src + start, (char *) dst + start_row * row_size, nrows, n_per_row, imatrix); break;
         case GGML_TYPE_Q2_K:    result = quantize_q2_K(src + start, (char *) dst + start_row * row_size, nrows, n_per_row, imatrix); break;
         case GGML_TYPE_Q3_K:    result = quantize_q3_K(src + start, (char *) dst + start_row * row_size, nrows, n_per_row, imatrix); break;
         case GGML_TYPE_Q4_K:    result = quantize_q4_K(src + start, (char *) dst + start_row * row_size, nrows, n_per_row, imatrix); break;
@@ -7492,6 +7754,102 @@ size_t ggml_quantize_chunk(
     return result;
 }
 
+// a range of rows quantized by ggml_quantize_chunk_mt
+struct ggml_quantize_chunk_task {
+    enum ggml_type   type;
+    const float    * src;
+    void           * dst;
+    int64_t          start;
+    int64_t          nrows;
+    int64_t          n_per_row;
+    const float    * imatrix;
+    size_t           result;
+
+    bool             started;
+#if defined(_WIN32)
+    HANDLE           thread;
+#else
+    pthread_t        thread;
+#endif
+};
+
+#if defined(_WIN32)
+static DWORD WINAPI ggml_quantize_chunk_thread(LPVOID arg) {
+#else
+static void * ggml_quantize_chunk_thread(void * arg) {
+#endif
+    struct ggml_quantize_chunk_task * task = (struct ggml_quantize_chunk_task *) arg;
+    task->result = ggml_quantize_chunk(task->type, task->src, task->dst, task->start, task->nrows, task->n_per_row, task->imatrix);
+    return 0;
+}
+
+size_t ggml_quantize_chunk_mt(
+        enum ggml_type   type,
+           const float * src,
+                  void * dst,
+               int64_t   start,
+               int64_t   nrows,
+               int64_t   n_per_row,
+           const float * imatrix,
+                   int   n_threads) {
+    n_threads = (int) MIN((int64_t) n_threads, nrows);
+    if (n_threads <= 1) {
+        return ggml_quantize_chunk(type, src, dst, start, nrows, n_per_row, imatrix);
+    }
+
+    // initialize the quantization tables once instead of having all threads wait on the critical section
+    ggml_quantize_init(type);
+
+    const int64_t rows_per_thread = (nrows + n_threads - 1) / n_threads;
+
+    struct ggml_quantize_chunk_task * tasks = GGML_MALLOC(n_threads*sizeof(struct ggml_quantize_chunk_task));
+
+    int n_tasks = 0;
+    for (int64_t ir0 = 0; ir0 < nrows; ir0 += rows_per_thread) {
+        struct ggml_quantize_chunk_task * task = &tasks[n_tasks++];
+        task->type      = type;
+        task->src       = src;
+        task->dst       = dst;
+        task->start     = start + ir0*n_per_row;
+        task->nrows     = MIN(rows_per_thread, nrows - ir0);
+        task->n_per_row = n_per_row;
+        task->imatrix   = imatrix;
+        task->result    = 0;
+    }
+
+    // the calling thread quantizes the first range
+    for (int i = 1; i < n_tasks; ++i) {
+#if defined(_WIN32)
+        tasks[i].thread  = CreateThread(NULL, 0, ggml_quantize_chunk_thread, &tasks[i], 0, NULL);
+        tasks[i].started = tasks[i].thread != NULL;
+#else
+        tasks[i].started = pthread_create(&tasks[i].thread, NULL, ggml_quantize_chunk_thread, &tasks[i]) == 0;
+#endif
+    }
+
+    ggml_quantize_chunk_thread(&tasks[0]);
+
+    size_t result = tasks[0].result;
+    for (int i = 1; i < n_tasks; ++i) {
+        if (tasks[i].started) {
+#if defined(_WIN32)
+            WaitForSingleObject(tasks[i].thread, INFINITE);
+            CloseHandle(tasks[i].thread);
+#else
+            pthread_join(tasks[i].thread, NULL);
+#endif
+        } else {
+            // the thread could not be created
+            ggml_quantize_chunk_thread(&tasks[i]);
+        }
+        result += tasks[i].result;
+    }
+
+    GGML_FREE(tasks);
+
+    return result;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 void ggml_log_set(ggml_log_callback log_callback, void * user_data) {
@@ -7505,6 +7863,7 @@ void ggml_threadpool_params_init(struct ggml_threadpool_params * p, int n_thread
     p->poll       = 50;    // hybrid-polling enabled
     p->strict_cpu = false; // no strict placement (all threads share same cpumask)
     p->paused     = false; // threads are ready to go
+    p->placement  = GGML_THREADPOOL_PLACEMENT_NONE; // no placement policy
     memset(p->cpumask, 0, GGML_MAX_N_THREADS); // all-zero means use the default affinity (usually inherited)
 }
 
@@ -7519,5 +7878,6 @@ bool ggml_threadpool_params_match(const struct ggml_threadpool_params * p0, cons
     if (p0->prio           != p1->prio       )    return false;
     if (p0->poll           != p1->poll       )    return false;
     if (p0->strict_cpu     != p1->strict_cpu )    return false;
+    if (p0->placement      != p1->placement  )    return false;
     return memcmp(p0->cpumask, p1->cpumask, GGML_MAX_N_THREADS) == 0;
 }
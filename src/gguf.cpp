@@ -13,6 +13,8 @@
 #include <new>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 template <typename T>
@@ -209,6 +211,10 @@ struct gguf_context {
     std::vector<struct gguf_kv> kv;
     std::vector<struct gguf_tensor_info> info;
 
+    // key/tensor name -> index into kv/info, kept in sync by gguf_kv_emplace, gguf_info_push and gguf_remove_key
+    std::unordered_map<std::string, int64_t> kv_index;
+    std::unordered_map<std::string, int64_t> info_index;
+
     size_t alignment = GGUF_DEFAULT_ALIGNMENT;
     size_t offset    = 0; // offset of `data` from beginning of file
     size_t size      = 0; // size of `data` in bytes
@@ -290,8 +296,19 @@ struct gguf_context * gguf_init_empty(void) {
     return new gguf_context;
 }
 
+template<typename... Args>
+static void gguf_kv_emplace(struct gguf_context * ctx, Args &&... args) {
+    ctx->kv.emplace_back(std::forward<Args>(args)...);
+    ctx->kv_index.emplace(ctx->kv.back().key, int64_t(ctx->kv.size()) - 1);
+}
+
+static void gguf_info_push(struct gguf_context * ctx, const struct gguf_tensor_info & info) {
+    ctx->info.push_back(info);
+    ctx->info_index.emplace(info.t.name, int64_t(ctx->info.size()) - 1);
+}
+
 template<typename T>
-bool gguf_read_emplace_helper(const struct gguf_reader & gr, std::vector<struct gguf_kv> & kv, const std::string & key, const bool is_array, const size_t n) {
+bool gguf_read_emplace_helper(const struct gguf_reader & gr, struct gguf_context * ctx, const std::string & key, const bool is_array, const size_t n) {
     if (is_array) {
         std::vector<T> value;
         try {
@@ -305,13 +322,13 @@ bool gguf_read_emplace_helper(const struct gguf_reader & gr, std::vector<struct
             GGML_LOG_ERROR("%s: encountered bad_alloc error while reading value for key '%s'\n", __func__, key.c_str());
             return false;
         }
-        kv.emplace_back(key, value);
+        gguf_kv_emplace(ctx, key, value);
     } else {
         T value;
         if (!gr.read(value)) {
             return false;
         }
-        kv.emplace_back(key, value);
+        gguf_kv_emplace(ctx, key, value);
     }
     return true;
 }
@@ -426,9 +443,10 @@ struct gguf_context * gguf_init_from_file_impl(FILE * file, struct gguf_init_par
                 GGML_LOG_ERROR("%s: encountered bad_alloc error while reading key %" PRIi64 "\n", __func__, i);
                 ok = false;
             }
-            for (size_t j = 0; ok && j < ctx->kv.size(); ++j) {
-                if (key == ctx->kv[j].key) {
-                    GGML_LOG_ERROR("%s: duplicate key '%s' for tensors %zu and %" PRIi64 " \n", __func__, key.c_str(), j, i);
+            if (ok) {
+                const auto it = ctx->kv_index.find(key);
+                if (it != ctx->kv_index.end()) {
+                    GGML_LOG_ERROR("%s: duplicate key '%s' for tensors %" PRIi64 " and %" PRIi64 " \n", __func__, key.c_str(), it->second, i);
                     ok = false;
                 }
             }
@@ -447,18 +465,18 @@ struct gguf_context * gguf_init_from_file_impl(FILE * file, struct gguf_init_par
             }
 
             switch (type) {
-                case GGUF_TYPE_UINT8:   ok = ok && gguf_read_emplace_helper<uint8_t>    (gr, ctx->kv, key, is_array, n); break;
-                case GGUF_TYPE_INT8:    ok = ok && gguf_read_emplace_helper<int8_t>     (gr, ctx->kv, key, is_array, n); break;
-                case GGUF_TYPE_UINT16:  ok = ok && gguf_read_emplace_helper<uint16_t>   (gr, ctx->kv, key, is_array, n); break;
-                case GGUF_TYPE_INT16:   ok = ok && gguf_read_emplace_helper<int16_t>    (gr, ctx->kv, key, is_array, n); break;
-                case GGUF_TYPE_UINT32:  ok = ok && gguf_read_emplace_helper<uint32_t>   (gr, ctx->kv, key, is_array, n); break;
-                case GGUF_TYPE_INT32:   ok = ok && gguf_read_emplace_helper<int32_t>    (gr, ctx->kv, key, is_array, n); break;
-                case GGUF_TYPE_FLOAT32: ok = ok && gguf_read_emplace_helper<float>      (gr, ctx->kv, key, is_array, n); break;
-                case GGUF_TYPE_BOOL:    ok = ok && gguf_read_emplace_helper<bool>       (gr, ctx->kv, key, is_array, n); break;
-                case GGUF_TYPE_STRING:  ok = ok && gguf_read_emplace_helper<std::string>(gr, ctx->kv, key, is_array, n); break;
-                case GGUF_TYPE_UINT64:  ok = ok && gguf_read_emplace_helper<uint64_t>   (gr, ctx->kv, key, is_array, n); break;
-                case GGUF_TYPE_INT64:   ok = ok && gguf_read_emplace_helper<int64_t>    (gr, ctx->kv, key, is_array, n); break;
-                case GGUF_TYPE_FLOAT64: ok = ok && gguf_read_emplace_helper<double>     (gr, ctx->kv, key, is_array, n); break;
+                case GGUF_TYPE_UINT8:   ok = ok && gguf_read_emplace_helper<uint8_t>    (gr, ctx, key, is_array, n); break;
+                case GGUF_TYPE_INT8:    ok = ok && gguf_read_emplace_helper<int8_t>     (gr, ctx, key, is_array, n); break;
+                case GGUF_TYPE_UINT16:  ok = ok && gguf_read_emplace_helper<uint16_t>   (gr, ctx, key, is_array, n); break;
+                case GGUF_TYPE_INT16:   ok = ok && gguf_read_emplace_helper<int16_t>    (gr, ctx, key, is_array, n); break;
+                case GGUF_TYPE_UINT32:  ok = ok && gguf_read_emplace_helper<uint32_t>   (gr, ctx, key, is_array, n); break;
+                case GGUF_TYPE_INT32:   ok = ok && gguf_read_emplace_helper<int32_t>    (gr, ctx, key, is_array, n); break;
+                case GGUF_TYPE_FLOAT32: ok = ok && gguf_read_emplace_helper<float>      (gr, ctx, key, is_array, n); break;
+                case GGUF_TYPE_BOOL:    ok = ok && gguf_read_emplace_helper<bool>       (gr, ctx, key, is_array, n); break;
+                case GGUF_TYPE_STRING:  ok = ok && gguf_read_emplace_helper<std::string>(gr, ctx, key, is_array, n); break;
+                case GGUF_TYPE_UINT64:  ok = ok && gguf_read_emplace_helper<uint64_t>   (gr, ctx, key, is_array, n); break;
+                case GGUF_TYPE_INT64:   ok = ok && gguf_read_emplace_helper<int64_t>    (gr, ctx, key, is_array, n); break;
+                case GGUF_TYPE_FLOAT64: ok = ok && gguf_read_emplace_helper<double>     (gr, ctx, key, is_array, n); break;
                 case GGUF_TYPE_ARRAY:
                 default:
                     {
@@ -509,9 +527,10 @@ struct gguf_context * gguf_init_from_file_impl(FILE * file, struct gguf_init_par
             ggml_set_name(&info.t, name.c_str());
 
             // make sure there are no duplicate tensor names
-            for (int64_t j = 0; ok && j < i; ++j) {
-                if (strcmp(info.t.name, ctx->info[j].t.name) == 0) {
-                    GGML_LOG_ERROR("%s: duplicate tensor name '%s' for tensors %" PRIi64 " and %" PRIi64 "\n", __func__, info.t.name, j, i);
+            {
+                const auto it = ctx->info_index.find(info.t.name);
+                if (it != ctx->info_index.end()) {
+                    GGML_LOG_ERROR("%s: duplicate tensor name '%s' for tensors %" PRIi64 " and %" PRIi64 "\n", __func__, info.t.name, it->second, i);
                     ok = false;
                     break;
                 }
@@ -599,7 +618,7 @@ struct gguf_context * gguf_init_from_file_impl(FILE * file, struct gguf_init_par
         // tensor data offset within buffer
         ok = ok && gr.read(info.offset);
 
-        ctx->info.push_back(info);
+        gguf_info_push(ctx, info);
     }
 
     if (!ok) {
@@ -773,18 +792,8 @@ int64_t gguf_get_n_kv(const struct gguf_context * ctx) {
 
 int64_t gguf_find_key(const struct gguf_context * ctx, const char * key) {
     // return -1 if key not found
-    int64_t keyfound = -1;
-
-    const int64_t n_kv = gguf_get_n_kv(ctx);
-
-    for (int64_t i = 0; i < n_kv; ++i) {
-        if (strcmp(key, gguf_get_key(ctx, i)) == 0) {
-            keyfound = i;
-            break;
-        }
-    }
-
-    return keyfound;
+    const auto it = ctx->kv_index.find(key);
+    return it == ctx->kv_index.end() ? -1 : it->second;
 }
 
 const char * gguf_get_key(const struct gguf_context * ctx, int64_t key_id) {
@@ -912,18 +921,8 @@ int64_t gguf_get_n_tensors(const struct gguf_context * ctx) {
 
 int64_t gguf_find_tensor(const struct gguf_context * ctx, const char * name) {
     // return -1 if tensor not found
-    int64_t tensor_id = -1;
-
-    const int64_t n_tensors = gguf_get_n_tensors(ctx);
-
-    for (int64_t i = 0; i < n_tensors; ++i) {
-        if (strcmp(name, gguf_get_tensor_name(ctx, i)) == 0) {
-            tensor_id = i;
-            break;
-        }
-    }
-
-    return tensor_id;
+    const auto it = ctx->info_index.find(name);
+    return it == ctx->info_index.end() ? -1 : it->second;
 }
 
 size_t gguf_get_tensor_offset(const struct gguf_context * ctx, int64_t tensor_id) {
@@ -949,7 +948,13 @@ size_t gguf_get_tensor_size(const struct gguf_context * ctx, int64_t tensor_id)
 int64_t gguf_remove_key(struct gguf_context * ctx, const char * key) {
     const int64_t key_id = gguf_find_key(ctx, key);
     if (key_id >= 0) {
+        ctx->kv_index.erase(key);
         ctx->kv.erase(ctx->kv.begin() + key_id);
+
+        // the following pairs moved down by one
+        for (int64_t i = key_id; i < int64_t(ctx->kv.size()); ++i) {
+            ctx->kv_index[ctx->kv[i].key] = i;
+        }
     }
     return key_id;
 }
@@ -969,73 +974,73 @@ static void gguf_check_reserved_keys(const std::string & key, const T val) {
 void gguf_set_val_u8(struct gguf_context * ctx, const char * key, uint8_t val) {
     gguf_check_reserved_keys(key, val);
     gguf_remove_key(ctx, key);
-    ctx->kv.emplace_back(key, val);
+    gguf_kv_emplace(ctx, key, val);
 }
 
 void gguf_set_val_i8(struct gguf_context * ctx, const char * key, int8_t val) {
     gguf_check_reserved_keys(key, val);
     gguf_remove_key(ctx, key);
-    ctx->kv.emplace_back(key, val);
+    gguf_kv_emplace(ctx, key, val);
 }
 
 void gguf_set_val_u16(struct gguf_context * ctx, const char * key, uint16_t val) {
     gguf_check_reserved_keys(key, val);
     gguf_remove_key(ctx, key);
-    ctx->kv.emplace_back(key, val);
+    gguf_kv_emplace(ctx, key, val);
 }
 
 void gguf_set_val_i16(struct gguf_context * ctx, const char * key, int16_t val) {
     gguf_check_reserved_keys(key, val);
     gguf_remove_key(ctx, key);
-    ctx->kv.emplace_back(key, val);
+    gguf_kv_emplace(ctx, key, val);
 }
 
 void gguf_set_val_u32(struct gguf_context * ctx, const char * key, uint32_t val) {
     gguf_check_reserved_keys(key, val);
     gguf_remove_key(ctx, key);
-    ctx->kv.emplace_back(key, val);
+    gguf_kv_emplace(ctx, key, val);
 }
 
 void gguf_set_val_i32(struct gguf_context * ctx, const char * key, int32_t val) {
     gguf_check_reserved_keys(key, val);
     gguf_remove_key(ctx, key);
-    ctx->kv.emplace_back(key, val);
+    gguf_kv_emplace(ctx, key, val);
 }
 
 void gguf_set_val_f32(struct gguf_context * ctx, const char * key, float val) {
     gguf_check_reserved_keys(key, val);
     gguf_remove_key(ctx, key);
-    ctx->kv.emplace_back(key, val);
+    gguf_kv_emplace(ctx, key, val);
 }
 
 void gguf_set_val_u64(struct gguf_context * ctx, const char * key, uint64_t val) {
     gguf_check_reserved_keys(key, val);
     gguf_remove_key(ctx, key);
-    ctx->kv.emplace_back(key, val);
+    gguf_kv_emplace(ctx, key, val);
 }
 
 void gguf_set_val_i64(struct gguf_context * ctx, const char * key, int64_t val) {
     gguf_check_reserved_keys(key, val);
     gguf_remove_key(ctx, key);
-    ctx->kv.emplace_back(key, val);
+    gguf_kv_emplace(ctx, key, val);
 }
 
 void gguf_set_val_f64(struct gguf_context * ctx, const char * key, double val) {
     gguf_check_reserved_keys(key, val);
     gguf_remove_key(ctx, key);
-    ctx->kv.emplace_back(key, val);
+    gguf_kv_emplace(ctx, key, val);
 }
 
 void gguf_set_val_bool(struct gguf_context * ctx, const char * key, bool val) {
     gguf_check_reserved_keys(key, val);
     gguf_remove_key(ctx, key);
-    ctx->kv.emplace_back(key, val);
+    gguf_kv_emplace(ctx, key, val);
 }
 
 void gguf_set_val_str(struct gguf_context * ctx, const char * key, const char * val) {
     gguf_check_reserved_keys(key, val);
     gguf_remove_key(ctx, key);
-    ctx->kv.emplace_back(key, std::string(val));
+    gguf_kv_emplace(ctx, key, std::string(val));
 }
 
 void gguf_set_arr_data(struct gguf_context * ctx, const char * key, enum gguf_type type, const void * data, size_t n) {
@@ -1047,7 +1052,7 @@ void gguf_set_arr_data(struct gguf_context * ctx, const char * key, enum gguf_ty
     if (!tmp.empty()) {
         memcpy(tmp.data(), data, nbytes);
     }
-    ctx->kv.emplace_back(key, tmp);
+    gguf_kv_emplace(ctx, key, tmp);
     ctx->kv.back().cast(type);
 }
 
@@ -1059,7 +1064,7 @@ void gguf_set_arr_str(struct gguf_context * ctx, const char * key, const char **
     for (size_t i = 0; i < n; ++i) {
         tmp[i] = data[i];
     }
-    ctx->kv.emplace_back(key, tmp);
+    gguf_kv_emplace(ctx, key, tmp);
 }
 
 // set or add KV pairs from another context
@@ -1129,7 +1134,7 @@ void gguf_add_tensor(
     ti.t = *tensor;
     ti.offset = ctx->info.empty() ? 0 :
         ctx->info.back().offset + GGML_PAD(ggml_nbytes(&ctx->info.back().t), ctx->alignment);
-    ctx->info.push_back(ti);
+    gguf_info_push(ctx, ti);
 }
 
 void gguf_set_tensor_type(struct gguf_context * ctx, const char * name, enum ggml_type type) {
@@ -1179,10 +1179,11 @@ struct test_case {
         }
     }
 
-    test_status_t eval(ggml_backend_t backend1,
-                       ggml_backend_t backend2,
-                       const char *   op_names_filter,
-                       printer *      output_printer) {
+    test_status_t eval(ggml_backend_t             backend1,
+                       ggml_backend_t             backend2,
+                       const char *               op_names_filter,
+                       printer *                  output_printer,
+                       ggml_backend_buffer_type_t buft1 = nullptr) {
         mode = MODE_TEST;
 
         ggml_init_params params = {
@@ -1235,7 +1236,7 @@ struct test_case {
         add_sentinel(ctx);
 
         // allocate
-        ggml_backend_buffer_t buf = ggml_backend_alloc_ctx_tensors(ctx, backend1);
+        ggml_backend_buffer_t buf = buft1 ? ggml_backend_alloc_ctx_tensors_from_buft(ctx, buft1) : ggml_backend_alloc_ctx_tensors(ctx, backend1);
 
         if (buf == NULL) {
             printf("failed to allocate tensors [%s] ", ggml_backend_name(backend1));
@@ -1348,7 +1349,7 @@ struct test_case {
         return test_passed ? test_status_t::OK : test_status_t::FAIL;
     }
 
-    bool eval_perf(ggml_backend_t backend, const char * op_names_filter, printer * output_printer) {
+    bool eval_perf(ggml_backend_t backend, const char * op_names_filter, printer * output_printer, ggml_backend_buffer_type_t buft = nullptr) {
         mode = MODE_PERF;
 
         static const size_t graph_nodes = 8192;
@@ -1379,7 +1380,7 @@ struct test_case {
         }
 
         // allocate
-        ggml_backend_buffer_ptr buf(ggml_backend_alloc_ctx_tensors(ctx.get(), backend)); // smart ptr
+        ggml_backend_buffer_ptr buf(buft ? ggml_backend_alloc_ctx_tensors_from_buft(ctx.get(), buft) : ggml_backend_alloc_ctx_tensors(ctx.get(), backend)); // smart ptr
 
         if (buf == NULL) {
             printf("failed to allocate tensors\n");
@@ -4414,6 +4415,78 @@ struct test_rope : public test_case {
     }
 };
 
+// GGML_OP_ROPE of Q and K over several layers with the same positions
+struct test_rope_shared : public test_case {
+    const ggml_type type;
+    const std::array<int64_t, 4> ne_a;
+    int n_dims;
+    int mode;
+    int n_layers;
+    bool ff;
+
+    std::string vars() override {
+        return VARS_TO_STR6(type, ne_a, n_dims, mode, n_layers, ff);
+    }
+
+    std::string op_desc(ggml_tensor * t) override {
+        GGML_UNUSED(t);
+        return "ROPE_SHARED";
+    }
+
+    bool run_whole_graph() override { return true; }
+
+    test_rope_shared(ggml_type type = GGML_TYPE_F32,
+            std::array<int64_t, 4> ne_a = {128, 8, 32, 1},
+            int n_dims = 128, int mode = GGML_ROPE_TYPE_NEOX, int n_layers = 3, bool ff = false)
+        : type(type), ne_a(ne_a), n_dims(n_dims), mode(mode), n_layers(n_layers), ff(ff) {}
+
+    ggml_tensor * build_graph(ggml_context * ctx) override {
+        ggml_tensor * pos = ggml_new_tensor_1d(ctx, GGML_TYPE_I32, ne_a[2]);
+        ggml_set_name(pos, "pos");
+
+        ggml_tensor * freq = nullptr;
+        if (ff) {
+            freq = ggml_new_tensor_1d(ctx, GGML_TYPE_F32, n_dims/2);
+            ggml_set_name(freq, "freq");
+        }
+
+        ggml_tensor * out = nullptr;
+        for (int il = 0; il < n_layers; il++) {
+            ggml_tensor * q = ggml_new_tensor(ctx, type, 4, ne_a.data());
+            ggml_tensor * k = ggml_new_tensor_4d(ctx, type, ne_a[0], 2, ne_a[2], ne_a[3]);
+
+            q = ggml_rope_ext(ctx, q, pos, freq, n_dims, mode, 0, 10000.0f, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f);
+            k = ggml_rope_ext(ctx, k, pos, freq, n_dims, mode, 0, 10000.0f, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f);
+
+            ggml_tensor * cur = ggml_add(ctx, q, ggml_repeat(ctx, k, q));
+            out = out ? ggml_add(ctx, out, cur) : cur;
+        }
+        ggml_set_name(out, "out");
+
+        return out;
+    }
+
+    void initialize_tensors(ggml_context * ctx) override {
+        for (ggml_tensor * t = ggml_get_first_tensor(ctx); t != NULL; t = ggml_get_next_tensor(ctx, t)) {
+            if (t->type == GGML_TYPE_I32) {
+                std::vector<int> data(t->ne[0]);
+                for (int i = 0; i < t->ne[0]; i++) {
+                    data[i] = rand() % 4096;
+                }
+                ggml_backend_tensor_set(t, data.data(), 0, data.size() * sizeof(int));
+            } else if (t->ne[0] == n_dims/2) {
+                init_tensor_uniform(t, 0.9f, 1.1f);
+            } else {
+                init_tensor_uniform(t);
+            }
+        }
+    }
+
+    double max_maa_err() override {
+        return 1e-3;
+    }
+};
+
 // GGML_OP_POOL2D
 struct test_pool2d : public test_case {
     enum ggml_op_pool pool_type;
@@ -4933,6 +5006,53 @@ struct test_argsort : public test_case {
     }
 };
 
+// GGML_OP_TOP_K
+struct test_top_k : public test_case {
+    const ggml_type type;
+    const std::array<int64_t, 4> ne;
+    const int k;
+    const bool values;
+
+    std::string vars() override {
+        return VARS_TO_STR4(type, ne, k, values);
+    }
+
+    test_top_k(ggml_type type = GGML_TYPE_F32,
+            std::array<int64_t, 4> ne = {16, 10, 10, 10},
+            int k = 4, bool values = false)
+        : type(type), ne(ne), k(k), values(values) {}
+
+    ggml_tensor * build_graph(ggml_context * ctx) override {
+        ggml_tensor * a = ggml_new_tensor(ctx, type, 4, ne.data());
+        ggml_set_name(a, "a");
+
+        ggml_tensor * vals = nullptr;
+        ggml_tensor * out = ggml_top_k_ext(ctx, a, k, values ? &vals : nullptr);
+        if (values) {
+            out = vals;
+        }
+        ggml_set_name(out, "out");
+
+        return out;
+    }
+
+    void initialize_tensors(ggml_context * ctx) override {
+        std::random_device rd;
+        std::default_random_engine rng(rd());
+        for (ggml_tensor * t = ggml_get_first_tensor(ctx); t != NULL; t = ggml_get_next_tensor(ctx, t)) {
+            // initialize with unique values to avoid ties
+            for (int64_t r = 0; r < ggml_nrows(t); r++) {
+                std::vector<float> data(t->ne[0]);
+                for (int i = 0; i < t->ne[0]; i++) {
+                    data[i] = i;
+                }
+                std::shuffle(data.begin(), data.end(), rng);
+                ggml_backend_tensor_set(t, data.data(), r * t->nb[1], t->ne[0] * sizeof(float));
+            }
+        }
+    }
+};
+
 struct test_topk_moe: public test_case {
     const std::array<int64_t, 4> ne;
     const int n_expert_used;
@@ -5805,14 +5925,16 @@ struct test_cross_entropy_loss_back : public test_case {
 struct test_opt_step_adamw : public test_case {
     const ggml_type type;
     const std::array<int64_t, 4> ne;
+    const ggml_type type_momenta;
 
     std::string vars() override {
-        return VARS_TO_STR2(type, ne);
+        return VARS_TO_STR3(type, ne, type_momenta);
     }
 
     test_opt_step_adamw(ggml_type type = GGML_TYPE_F32,
-            std::array<int64_t, 4> ne = {10, 5, 4, 3})
-        : type(type), ne(ne) {}
+            std::array<int64_t, 4> ne = {10, 5, 4, 3},
+            ggml_type type_momenta = GGML_TYPE_F32)
+        : type(type), ne(ne), type_momenta(type_momenta) {}
 
     ggml_tensor * build_graph(ggml_context * ctx) override {
         ggml_tensor * a = ggml_new_tensor_4d(ctx, type, ne[0], ne[1], ne[2], ne[3]);
@@ -5822,10 +5944,10 @@ struct test_opt_step_adamw : public test_case {
         ggml_tensor * grad = ggml_new_tensor_4d(ctx, type, ne[0], ne[1], ne[2], ne[3]);
         ggml_set_name(grad, "grad");
 
-        ggml_tensor * grad_m = ggml_new_tensor_4d(ctx, type, ne[0], ne[1], ne[2], ne[3]);
+        ggml_tensor * grad_m = ggml_new_tensor_4d(ctx, type_momenta, ne[0], ne[1], ne[2], ne[3]);
         ggml_set_name(grad_m, "grad_m");
 
-        ggml_tensor * grad_v = ggml_new_tensor_4d(ctx, type, ne[0], ne[1], ne[2], ne[3]);
+        ggml_tensor * grad_v = ggml_new_tensor_4d(ctx, type_momenta, ne[0], ne[1], ne[2], ne[3]);
         ggml_set_name(grad_v, "grad_v");
 
         ggml_tensor * adamw_params = ggml_new_tensor_1d(ctx, GGML_TYPE_F32, 7);
@@ -6866,6 +6988,8 @@ static std::vector<std::unique_ptr<test_case>> make_test_cases_eval() {
     test_cases.emplace_back(new test_argmax(GGML_TYPE_F32, {1024, 12, 1, 1}));
     test_cases.emplace_back(new test_argmax(GGML_TYPE_F32, {2000, 10, 1, 1}));
     test_cases.emplace_back(new test_argmax(GGML_TYPE_F32, {5438,  3, 1, 1}));
+    test_cases.emplace_back(new test_argmax(GGML_TYPE_F32, {151936, 1, 1, 1})); // few wide rows are split into chunks
+    test_cases.emplace_back(new test_argmax(GGML_TYPE_F32, {65536,  5, 1, 1}));
 
     for (int ne3 : {1, 3}) { // CUDA backward pass only supports ne3 == 1
         test_cases.emplace_back(new test_repeat(GGML_TYPE_F32, {10, 5, 4, ne3}, {1, 1, 1, 1}));
@@ -7417,6 +7541,12 @@ static std::vector<std::unique_ptr<test_case>> make_test_cases_eval() {
     test_cases.emplace_back(new test_soft_max(GGML_TYPE_F32, {32, 2, 32, 1}, true,  true,  GGML_TYPE_F32, {1, 1}, 0.1f, 8.0f));
     test_cases.emplace_back(new test_soft_max(GGML_TYPE_F32, {32, 2, 32, 1}, true,  true,  GGML_TYPE_F16, {1, 1}, 0.1f, 8.0f));
 
+    // few wide rows, split into chunks on the CPU
+    test_cases.emplace_back(new test_soft_max(GGML_TYPE_F32, {151936, 1, 1, 1}, false, false, GGML_TYPE_F32, {1, 1}, 1.0f, 0.0f));
+    test_cases.emplace_back(new test_soft_max(GGML_TYPE_F32, {151936, 2, 1, 1}, false, true,  GGML_TYPE_F32, {1, 1}, 0.1f, 0.0f));
+    test_cases.emplace_back(new test_soft_max(GGML_TYPE_F32, {32768,  2, 4, 1}, true,  false, GGML_TYPE_F16, {1, 1}, 0.1f, 0.0f));
+    test_cases.emplace_back(new test_soft_max(GGML_TYPE_F32, {32767,  3, 4, 1}, true,  true,  GGML_TYPE_F32, {1, 1}, 0.1f, 8.0f));
+
     for (float max_bias : {0.0f, 8.0f}) {
         for (float scale : {1.0f, 0.1f}) {
             for (int64_t ne0 : {16, 1024}) {
@@ -7493,6 +7623,16 @@ static std::vector<std::unique_ptr<test_case>> make_test_cases_eval() {
         }
     }
 
+    // ROPE nodes sharing the sin/cos table
+    for (ggml_type type : {GGML_TYPE_F32, GGML_TYPE_F16}) {
+        for (int mode : {GGML_ROPE_TYPE_NORMAL, GGML_ROPE_TYPE_NEOX}) {
+            for (bool ff : {false, true}) {
+                test_cases.emplace_back(new test_rope_shared(type, {128, 8, 32, 1}, 128, mode, 3, ff));
+                test_cases.emplace_back(new test_rope_shared(type, { 80, 4, 7, 2},  32, mode, 2, ff));
+            }
+        }
+    }
+
     for (int v : { 0, 1, 2, 3 }) {
         for (int dim : { 0, 1, 2, 3, }) {
             test_cases.emplace_back(new test_concat(GGML_TYPE_F32, {11, 12, 13, 14}, 7, dim, v));
@@ -7514,6 +7654,14 @@ static std::vector<std::unique_ptr<test_case>> make_test_cases_eval() {
         test_cases.emplace_back(new test_argsort(GGML_TYPE_F32, {2, 8, 8192, 1}, order)); // bailingmoe2 (group selection)
     }
 
+    for (int k : {1, 4, 8, 40}) {
+        test_cases.emplace_back(new test_top_k(GGML_TYPE_F32, {128, 10, 4, 1}, k));
+        test_cases.emplace_back(new test_top_k(GGML_TYPE_F32, {128, 10, 4, 1}, k, true));
+        test_cases.emplace_back(new test_top_k(GGML_TYPE_F32, {151936, 1, 1, 1}, k)); // few wide rows are split into chunks
+        test_cases.emplace_back(new test_top_k(GGML_TYPE_F32, {65536, 3, 1, 1}, k, true));
+    }
+    test_cases.emplace_back(new test_top_k(GGML_TYPE_F32, {40, 3, 2, 1}, 40));
+
     for (ggml_scale_mode mode : {GGML_SCALE_MODE_NEAREST, GGML_SCALE_MODE_BILINEAR, GGML_SCALE_MODE_BICUBIC}) {
         test_cases.emplace_back(new test_upscale(GGML_TYPE_F32, {512, 512, 3, 2}, 2, mode));
         test_cases.emplace_back(new test_upscale(GGML_TYPE_F32, {512, 512, 3, 2}, 2, mode, true));
@@ -7545,6 +7693,12 @@ static std::vector<std::unique_ptr<test_case>> make_test_cases_eval() {
     test_cases.emplace_back(new test_sum_rows(GGML_TYPE_F32, { 33, 256, 1, 1 }));
     test_cases.emplace_back(new test_mean(GGML_TYPE_F32, { 33, 256, 1, 1 }));
     test_cases.emplace_back(new test_mean(GGML_TYPE_F32, { 32769, 1, 1, 1 }));
+    // few wide rows are split into chunks
+    test_cases.emplace_back(new test_sum(GGML_TYPE_F32, { 1048576, 1, 1, 1 }));
+    test_cases.emplace_back(new test_sum(GGML_TYPE_F32, { 4097, 300, 1, 1 }));
+    test_cases.emplace_back(new test_sum_rows(GGML_TYPE_F32, { 65536, 3, 1, 1 }));
+    test_cases.emplace_back(new test_sum_rows(GGML_TYPE_F32, { 65536, 3, 2, 1 }, true, false));
+    test_cases.emplace_back(new test_mean(GGML_TYPE_F32, { 100000, 2, 1, 1 }));
     test_cases.emplace_back(new test_group_norm(GGML_TYPE_F32, {64, 64, 320, 1}));
     test_cases.emplace_back(new test_group_norm(GGML_TYPE_F32, {9, 9, 1280, 1}));
     test_cases.emplace_back(new test_group_norm_mul_add(GGML_TYPE_F32, {64, 64, 320, 1}));
@@ -7648,6 +7802,8 @@ static std::vector<std::unique_ptr<test_case>> make_test_cases_eval() {
     test_cases.emplace_back(new test_cross_entropy_loss_back(GGML_TYPE_F32, {30000, 1, 1, 1}));
 
     test_cases.emplace_back(new test_opt_step_adamw(GGML_TYPE_F32, {10, 5, 4, 3}));
+    test_cases.emplace_back(new test_opt_step_adamw(GGML_TYPE_F32, {64, 5, 4, 3}, GGML_TYPE_BF16));
+    test_cases.emplace_back(new test_opt_step_adamw(GGML_TYPE_F32, {64, 5, 4, 3}, GGML_TYPE_Q8_0));
     test_cases.emplace_back(new test_opt_step_sgd(GGML_TYPE_F32, {10, 5, 4, 3}));
 
     for (ggml_type type : base_types) {
@@ -7837,11 +7993,20 @@ static std::vector<std::unique_ptr<test_case>> make_test_cases_perf() {
     for (int kv : { 4096, 8192, 16384, }) {
         for (int hs : { 64, 128, }) {
             for (int nr : { 1, 4, }) {
-                test_cases.emplace_back(new test_flash_attn_ext(hs, hs, 8, {nr, 1}, kv, 1, true, false, 0, 0, GGML_PREC_F32, GGML_TYPE_F16));
+                for (ggml_type type_KV : { GGML_TYPE_F16, GGML_TYPE_Q8_0, GGML_TYPE_Q4_0, }) {
+                    test_cases.emplace_back(new test_flash_attn_ext(hs, hs, 8, {nr, 1}, kv, 1, true, false, 0, 0, GGML_PREC_F32, type_KV));
+                }
             }
         }
     }
 
+    // quantized KV cache with K-quants, the head size must be a multiple of the super-block size
+    for (int kv : { 4096, 16384, }) {
+        for (ggml_type type_KV : { GGML_TYPE_F16, GGML_TYPE_Q5_K, }) {
+            test_cases.emplace_back(new test_flash_attn_ext(256, 256, 8, {1, 1}, kv, 1, true, false, 0, 0, GGML_PREC_F32, type_KV));
+        }
+    }
+
     test_cases.emplace_back(new test_conv_2d_dw({512, 512, 256, 1}, {3, 3, 1, 256}, 1, 1, 1, false));
     test_cases.emplace_back(new test_conv_2d_dw({512, 512, 256, 1}, {3, 3, 1, 256}, 1, 1, 1, true));
 
@@ -7886,12 +8051,14 @@ static std::vector<std::unique_ptr<test_case>> make_test_cases_perf() {
     }
 
     test_cases.emplace_back(new test_argsort(GGML_TYPE_F32, {65000, 16, 1, 1}));
+    test_cases.emplace_back(new test_top_k(GGML_TYPE_F32, {151936, 1, 1, 1}, 40));
+    test_cases.emplace_back(new test_top_k(GGML_TYPE_F32, {256, 512, 1, 1}, 8)); // moe routing
 
     return test_cases;
 }
 
 static bool test_backend(ggml_backend_t backend, test_mode mode, const char * op_names_filter, const char * params_filter,
-                         printer * output_printer) {
+                         printer * output_printer, ggml_backend_buffer_type_t buft) {
     auto filter_test_cases = [](std::vector<std::unique_ptr<test_case>> & test_cases, const char * params_filter) {
         if (params_filter == nullptr) {
             return;
@@ -7924,7 +8091,7 @@ static bool test_backend(ggml_backend_t backend, test_mode mode, const char * op
         size_t                   tests_run = 0;
         std::vector<std::string> failed_tests;
         for (auto & test : test_cases) {
-            test_status_t status = test->eval(backend, backend_cpu, op_names_filter, output_printer);
+            test_status_t status = test->eval(backend, backend_cpu, op_names_filter, output_printer, buft);
             if (status == test_status_t::SKIPPED || status == test_status_t::NOT_SUPPORTED) {
                 continue;
             }
@@ -7961,7 +8128,7 @@ static bool test_backend(ggml_backend_t backend, test_mode mode, const char * op
         auto test_cases = make_test_cases_perf();
         filter_test_cases(test_cases, params_filter);
         for (auto & test : test_cases) {
-            test->eval_perf(backend, op_names_filter, output_printer);
+            test->eval_perf(backend, op_names_filter, output_printer, buft);
         }
         return true;
     }
@@ -8087,8 +8254,28 @@ static void show_test_coverage() {
     printf("  Coverage: %.1f%%\n", (double)covered_ops.size() / all_ops.size() * 100.0);
 }
 
+// the default or one of the extra buffer types of the device with the given name
+static ggml_backend_buffer_type_t find_buffer_type(ggml_backend_dev_t dev, const char * name) {
+    ggml_backend_buffer_type_t buft = ggml_backend_dev_buffer_type(dev);
+    if (strcmp(ggml_backend_buft_name(buft), name) == 0) {
+        return buft;
+    }
+
+    ggml_backend_reg_t reg = ggml_backend_dev_backend_reg(dev);
+    auto get_extra_bufts_fn = (ggml_backend_dev_get_extra_bufts_t) ggml_backend_reg_get_proc_address(reg, "ggml_backend_dev_get_extra_bufts");
+    if (get_extra_bufts_fn) {
+        for (ggml_backend_buffer_type_t * extra = get_extra_bufts_fn(dev); extra && *extra; ++extra) {
+            if (strcmp(ggml_backend_buft_name(*extra), name) == 0) {
+                return *extra;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
 static void usage(char ** argv) {
-    printf("Usage: %s [mode] [-o <op,..>] [-b <backend>] [-p <params regex>] [--output <console|sql|csv>] [--list-ops] [--show-coverage]\n", argv[0]);
+    printf("Usage: %s [mode] [-o <op,..>] [-b <backend>] [-p <params regex>] [--buft <buffer type>] [--output <console|sql|csv>] [--list-ops] [--show-coverage]\n", argv[0]);
     printf("    valid modes:\n");
     printf("      - test (default, compare with CPU backend for correctness)\n");
     printf("      - grad (compare gradients from backpropagation with method of finite differences)\n");
@@ -8096,6 +8283,8 @@ static void usage(char ** argv) {
     printf("      - support (probe backend operation support)\n");
     printf("    op names for -o are as given by ggml_op_desc() (e.g. ADD, MUL_MAT, etc),\n");
     printf("        optionally including the full test case string (e.g. \"ADD(type=f16,ne=[1,1,8,1],nr=[1,1,1,1],nf=1)\")\n");
+    printf("    --buft allocates all the tensors of the tested backend from the given buffer type in test and perf modes,\n");
+    printf("        the default or an extra buffer type of the device that can hold any tensor (e.g. BLAS_F32)\n");
     printf("    --output specifies output format (default: console, options: console, sql, csv)\n");
     printf("    --list-ops lists all available GGML operations\n");
     printf("    --show-coverage shows test coverage\n");
@@ -8107,6 +8296,7 @@ int main(int argc, char ** argv) {
     const char * op_names_filter = nullptr;
     const char * backend_filter = nullptr;
     const char * params_filter = nullptr;
+    const char * buft_name = nullptr;
 
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "test") == 0) {
@@ -8138,6 +8328,13 @@ int main(int argc, char ** argv) {
                 usage(argv);
                 return 1;
             }
+        } else if (strcmp(argv[i], "--buft") == 0) {
+            if (i + 1 < argc) {
+                buft_name = argv[++i];
+            } else {
+                usage(argv);
+                return 1;
+            }
         } else if (strcmp(argv[i], "--output") == 0) {
             if (i + 1 < argc) {
                 if (!output_format_from_str(argv[++i], output_format)) {
@@ -8190,6 +8387,17 @@ int main(int argc, char ** argv) {
             continue;
         }
 
+        ggml_backend_buffer_type_t buft = nullptr;
+        if (buft_name != NULL) {
+            buft = find_buffer_type(dev, buft_name);
+            if (buft == nullptr) {
+                output_printer->print_backend_init(backend_init_info(
+                    i, ggml_backend_dev_count(), ggml_backend_dev_name(dev), true, "Skipping, buffer type not available"));
+                n_ok++;
+                continue;
+            }
+        }
+
         ggml_backend_t backend = ggml_backend_dev_init(dev, NULL);
         GGML_ASSERT(backend != NULL);
 
@@ -8206,7 +8414,7 @@ int main(int argc, char ** argv) {
                                                              false, "", ggml_backend_dev_description(dev),
                                                              total / 1024 / 1024, free / 1024 / 1024, true));
 
-        bool ok = test_backend(backend, mode, op_names_filter, params_filter, output_printer.get());
+        bool ok = test_backend(backend, mode, op_names_filter, params_filter, output_printer.get(), buft);
 
         if (ok) {
             n_ok++;
@@ -0,0 +1,180 @@
+// Check the CPU CONV_2D algorithms (Winograd, direct with quantized and FP8 kernels, im2col) against a reference convolution
+
+#include "ggml.h"
+#include "ggml-cpu.h"
+
+#include "test-cpu-common.h"
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+struct test_case {
+    ggml_type type; // kernel type
+    int64_t kw, kh, ic, oc;
+    int64_t w, h, n;
+    int s0, s1, p0, p1, d0, d1;
+    double max_nmse;
+    bool cwhn; // [IC, KW, KH, OC] kernel of ggml_conv_2d_direct_cwhn, all quantized kernels
+};
+
+static bool test_conv_2d(const test_case & tc, int n_threads) {
+    struct ggml_init_params ip = {
+        /*.mem_size   =*/ 256*1024*1024,
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ false,
+    };
+    struct ggml_context * ctx = ggml_init(ip);
+
+    // kernel [KW, KH, IC, OC] and input [W, H, IC, N]
+    std::vector<float> knl(tc.kw*tc.kh*tc.ic*tc.oc);
+    std::vector<float> inp(tc.w*tc.h*tc.ic*tc.n);
+    test_fill(knl.data(), knl.size(), 1, 0.5f);
+    test_fill(inp.data(), inp.size(), 2, 1.0f);
+
+    struct ggml_tensor * b = ggml_new_tensor_4d(ctx, GGML_TYPE_F32, tc.w, tc.h, tc.ic, tc.n);
+    memcpy(b->data, inp.data(), ggml_nbytes(b));
+
+    struct ggml_tensor * a = NULL;
+    if (tc.cwhn) {
+        std::vector<float> perm(knl.size());
+        for (int64_t oc = 0; oc < tc.oc; ++oc) {
+            for (int64_t ic = 0; ic < tc.ic; ++ic) {
+                for (int64_t ky = 0; ky < tc.kh; ++ky) {
+                    for (int64_t kx = 0; kx < tc.kw; ++kx) {
+                        perm[((oc*tc.kh + ky)*tc.kw + kx)*tc.ic + ic] = knl[((oc*tc.ic + ic)*tc.kh + ky)*tc.kw + kx];
+                    }
+                }
+            }
+        }
+        a = ggml_new_tensor_4d(ctx, tc.type, tc.ic, tc.kw, tc.kh, tc.oc);
+        ggml_quantize_chunk(tc.type, perm.data(), a->data, 0, tc.kw*tc.kh*tc.oc, tc.ic, NULL);
+
+        // the reference uses the dequantized kernel and input pixels, which are quantized to Q8_0 (all quantized types here)
+        std::vector<float> pix(tc.ic);
+        std::vector<uint8_t> q(ggml_row_size(GGML_TYPE_Q8_0, tc.ic));
+        for (int64_t i = 0; ggml_is_quantized(tc.type) && i < tc.w*tc.h*tc.n; ++i) {
+            const int64_t in = i / (tc.w*tc.h);
+            const int64_t iy = i / tc.w % tc.h;
+            const int64_t ix = i % tc.w;
+            for (int64_t ic = 0; ic < tc.ic; ++ic) {
+                pix[ic] = inp[((in*tc.ic + ic)*tc.h + iy)*tc.w + ix];
+            }
+            ggml_quantize_chunk(GGML_TYPE_Q8_0, pix.data(), q.data(), 0, 1, tc.ic, NULL);
+            ggml_get_type_traits(GGML_TYPE_Q8_0)->to_float(q.data(), pix.data(), tc.ic);
+            for (int64_t ic = 0; ic < tc.ic; ++ic) {
+                inp[((in*tc.ic + ic)*tc.h + iy)*tc.w + ix] = pix[ic];
+            }
+        }
+
+        if (tc.type != GGML_TYPE_F32) {
+            ggml_get_type_traits(tc.type)->to_float(a->data, perm.data(), perm.size());
+        }
+        for (int64_t oc = 0; oc < tc.oc; ++oc) {
+            for (int64_t ic = 0; ic < tc.ic; ++ic) {
+                for (int64_t ky = 0; ky < tc.kh; ++ky) {
+                    for (int64_t kx = 0; kx < tc.kw; ++kx) {
+                        knl[((oc*tc.ic + ic)*tc.kh + ky)*tc.kw + kx] = perm[((oc*tc.kh + ky)*tc.kw + kx)*tc.ic + ic];
+                    }
+                }
+            }
+        }
+    } else if (tc.type == GGML_TYPE_F8_E4M3 || tc.type == GGML_TYPE_F8_E5M2) {
+        // FP8 kernels keep the [KW, KH, IC, OC] layout, the input pixels stay F32
+        a = ggml_new_tensor_4d(ctx, tc.type, tc.kw, tc.kh, tc.ic, tc.oc);
+        ggml_quantize_chunk(tc.type, knl.data(), a->data, 0, tc.ic*tc.oc, tc.kw*tc.kh, NULL);
+        ggml_get_type_traits(tc.type)->to_float(a->data, knl.data(), knl.size());
+    } else if (tc.type == GGML_TYPE_F16) {
+        a = ggml_new_tensor_4d(ctx, GGML_TYPE_F16, tc.kw, tc.kh, tc.ic, tc.oc);
+        for (size_t i = 0; i < knl.size(); ++i) {
+            ((ggml_fp16_t *) a->data)[i] = ggml_fp32_to_fp16(knl[i]);
+            knl[i] = ggml_fp16_to_fp32(((ggml_fp16_t *) a->data)[i]);
+        }
+    } else {
+        a = ggml_new_tensor_4d(ctx, GGML_TYPE_F32, tc.kw, tc.kh, tc.ic, tc.oc);
+        memcpy(a->data, knl.data(), ggml_nbytes(a));
+    }
+
+    struct ggml_tensor * out = tc.cwhn ?
+        ggml_conv_2d_direct_cwhn(ctx, a, b, tc.s0, tc.s1, tc.p0, tc.p1, tc.d0, tc.d1) :
+        ggml_conv_2d_direct     (ctx, a, b, tc.s0, tc.s1, tc.p0, tc.p1, tc.d0, tc.d1);
+
+    struct ggml_cgraph * gf = ggml_new_graph(ctx);
+    ggml_build_forward_expand(gf, out);
+
+    const std::vector<float> res = test_graph_compute_f32(gf, out, n_threads);
+
+    const int64_t ow = out->ne[0];
+    const int64_t oh = out->ne[1];
+
+    std::vector<float> ref(res.size());
+    for (int64_t in = 0; in < tc.n; ++in) {
+        for (int64_t oc = 0; oc < tc.oc; ++oc) {
+            for (int64_t oy = 0; oy < oh; ++oy) {
+                for (int64_t ox = 0; ox < ow; ++ox) {
+                    double sum = 0.0;
+                    for (int64_t ic = 0; ic < tc.ic; ++ic) {
+                        for (int64_t ky = 0; ky < tc.kh; ++ky) {
+                            for (int64_t kx = 0; kx < tc.kw; ++kx) {
+                                const int64_t iy = oy*tc.s1 + ky*tc.d1 - tc.p1;
+                                const int64_t ix = ox*tc.s0 + kx*tc.d0 - tc.p0;
+                                if (iy < 0 || iy >= tc.h || ix < 0 || ix >= tc.w) {
+                                    continue;
+                                }
+                                sum += (double) knl[((oc*tc.ic + ic)*tc.kh + ky)*tc.kw + kx] *
+                                       (double) inp[((in*tc.ic + ic)*tc.h + iy)*tc.w + ix];
+                            }
+                        }
+                    }
+                    ref[((in*tc.oc + oc)*oh + oy)*ow + ox] = (float) sum;
+                }
+            }
+        }
+    }
+    const double nmse = test_nmse(ref, res);
+
+    const bool ok = nmse < tc.max_nmse;
+    printf("%s: %-7s %s kernel = %dx%dx%3dx%3d, input = %3dx%3dx%d, s = %d,%d, p = %d,%d, d = %d,%d, n_threads = %d: nmse = %.3e %s\n",
+            __func__, ggml_type_name(tc.type), tc.cwhn ? "cwhn" : "whcn", (int) tc.kw, (int) tc.kh, (int) tc.ic, (int) tc.oc, (int) tc.w, (int) tc.h, (int) tc.n,
+            tc.s0, tc.s1, tc.p0, tc.p1, tc.d0, tc.d1, n_threads, nmse, ok ? "OK" : "FAIL");
+
+    ggml_free(ctx);
+
+    return ok;
+}
+
+int main(void) {
+    ggml_cpu_init();
+
+    const test_case cases[] = {
+        // Winograd
+        { GGML_TYPE_F32,  3, 3, 64, 64, 34, 33, 1, 1, 1, 1, 1, 1, 1, 1e-10 },
+        { GGML_TYPE_F32,  3, 3, 96, 64, 45, 30, 2, 1, 1, 0, 0, 1, 1, 1e-10 },
+        { GGML_TYPE_F16,  3, 3, 64, 72, 26, 23, 1, 1, 1, 1, 2, 1, 1, 1e-10 },
+        // direct
+        { GGML_TYPE_Q8_0, 3, 3, 32, 24, 29, 31, 1, 1, 1, 1, 1, 1, 1, 1e-10, true },
+        { GGML_TYPE_Q8_0, 3, 3, 64, 16, 40, 21, 2, 2, 2, 1, 1, 1, 1, 1e-10, true },
+        { GGML_TYPE_Q8_0, 1, 1, 64, 40, 37, 19, 1, 1, 1, 0, 0, 1, 1, 1e-10, true },
+        { GGML_TYPE_Q8_0, 3, 2, 32,  8, 50, 20, 1, 1, 1, 2, 1, 2, 1, 1e-10, true },
+        { GGML_TYPE_Q4_0, 3, 3, 32,  8, 20, 20, 1, 1, 1, 1, 1, 1, 1, 1e-10, true },
+        { GGML_TYPE_F32,  3, 3, 128, 16, 13, 13, 1, 2, 2, 1, 1, 1, 1, 1e-10 },
+        { GGML_TYPE_F16,  1, 1, 160, 24, 17, 11, 2, 1, 1, 0, 0, 1, 1, 1e-5  },
+        { GGML_TYPE_F8_E4M3, 3, 3, 64, 64, 34, 33, 1, 1, 1, 1, 1, 1, 1, 1e-10 },
+        { GGML_TYPE_F8_E5M2, 5, 3,  3, 16, 40, 40, 1, 1, 1, 1, 1, 1, 1, 1e-10 },
+        { GGML_TYPE_F32,  3, 3, 64, 64, 34, 33, 1, 1, 1, 1, 1, 1, 1, 1e-10, true },
+        { GGML_TYPE_F16,  3, 3, 16,  8, 30, 30, 1, 2, 2, 2, 2, 1, 1, 1e-5,  true },
+        // im2col
+        { GGML_TYPE_F32,  3, 3,  3, 16, 40, 40, 1, 1, 1, 1, 1, 1, 1, 1e-10 },
+        { GGML_TYPE_F32,  3, 3, 16, 16, 12, 12, 1, 1, 1, 1, 1, 1, 1, 1e-10 },
+        { GGML_TYPE_F16,  5, 5, 16,  8, 30, 30, 1, 2, 2, 2, 2, 1, 1, 1e-5  },
+    };
+
+    bool ok = true;
+    for (const test_case & tc : cases) {
+        ok = test_conv_2d(tc, 4) && ok;
+    }
+
+    return ok ? 0 : 1;
+}
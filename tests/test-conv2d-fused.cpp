@@ -0,0 +1,293 @@
+// Check that CONV_2D nodes fused with the element-wise and pooling nodes that follow them give the same results as the
+// separate nodes, and that the fused nodes are not computed on their own
+// --bench times the backbone of yolov3-tiny with and without the fused nodes
+
+#include "ggml.h"
+#include "ggml-cpu.h"
+
+#include "test-cpu-common.h"
+
+#undef NDEBUG
+#include <algorithm>
+#include <assert.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+enum test_step {
+    STEP_ADD,        // per-channel
+    STEP_SUB,        // per-channel
+    STEP_MUL,        // per-channel
+    STEP_DIV,        // per-channel
+    STEP_ADD_SCALAR,
+    STEP_LEAKY_RELU,
+    STEP_RELU,
+    STEP_SIGMOID,
+    STEP_SILU,
+    STEP_TANH,
+    STEP_MUL_INPLACE,        // per-channel
+    STEP_ADD_INPLACE,        // per-channel
+    STEP_LEAKY_RELU_INPLACE,
+    STEP_OUTPUT,     // marks the previous result as an output, which ends the fused nodes
+};
+
+struct test_case {
+    const char * name;
+    ggml_type type; // kernel type
+    int64_t k, ic, oc;
+    int64_t w, h, n;
+    int s, p;
+    std::vector<test_step> steps;
+    int pool_k, pool_s, pool_p; // no pooling if 0
+    int n_nodes_fused;          // number of nodes computed when fused
+};
+
+static struct ggml_tensor * channel_param(struct ggml_context * ctx, int64_t oc, int seed, float offset) {
+    struct ggml_tensor * t = ggml_new_tensor_4d(ctx, GGML_TYPE_F32, 1, 1, oc, 1);
+    test_fill(t, seed, 0.5f, offset);
+    return t;
+}
+
+// computes the graph of the test case, returns the number of nodes that were computed
+static int compute(const test_case & tc, bool fuse, int n_threads, std::vector<float> & res) {
+    struct ggml_init_params ip = {
+        /*.mem_size   =*/ 128*1024*1024,
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ false,
+    };
+    struct ggml_context * ctx = ggml_init(ip);
+
+    std::vector<float> knl(tc.k*tc.k*tc.ic*tc.oc);
+    test_fill(knl.data(), knl.size(), 1, 0.2f);
+
+    // quantized kernels are stored as [IC, KW, KH, OC], see ggml_conv_2d_direct_cwhn
+    struct ggml_tensor * a = NULL;
+    if (ggml_is_quantized(tc.type)) {
+        a = ggml_new_tensor_4d(ctx, tc.type, tc.ic, tc.k, tc.k, tc.oc);
+        ggml_quantize_chunk(tc.type, knl.data(), a->data, 0, tc.k*tc.k*tc.oc, tc.ic, NULL);
+    } else {
+        a = ggml_new_tensor_4d(ctx, tc.type, tc.k, tc.k, tc.ic, tc.oc);
+        ggml_get_type_traits_cpu(tc.type)->from_float(knl.data(), a->data, knl.size());
+    }
+
+    struct ggml_tensor * b = ggml_new_tensor_4d(ctx, GGML_TYPE_F32, tc.w, tc.h, tc.ic, tc.n);
+    test_fill(b, 2, 1.0f);
+
+    struct ggml_tensor * conv = ggml_is_quantized(tc.type) ?
+        ggml_conv_2d_direct_cwhn(ctx, a, b, tc.s, tc.s, tc.p, tc.p, 1, 1) :
+        ggml_conv_2d_direct     (ctx, a, b, tc.s, tc.s, tc.p, tc.p, 1, 1);
+    if (!fuse) {
+        ggml_set_output(conv);
+    }
+
+    struct ggml_tensor * cur = conv;
+    int seed = 3;
+    for (test_step step : tc.steps) {
+        switch (step) {
+            case STEP_ADD:        cur = ggml_add(ctx, cur, channel_param(ctx, tc.oc, seed++, 0.0f)); break;
+            case STEP_SUB:        cur = ggml_sub(ctx, cur, channel_param(ctx, tc.oc, seed++, 0.0f)); break;
+            case STEP_MUL:        cur = ggml_mul(ctx, cur, channel_param(ctx, tc.oc, seed++, 1.0f)); break;
+            case STEP_DIV:        cur = ggml_div(ctx, cur, channel_param(ctx, tc.oc, seed++, 1.0f)); break;
+            case STEP_ADD_SCALAR: cur = ggml_add(ctx, cur, channel_param(ctx, 1,     seed++, 0.0f)); break;
+            case STEP_LEAKY_RELU: cur = ggml_leaky_relu(ctx, cur, 0.1f, false); break;
+            case STEP_RELU:       cur = ggml_relu(ctx, cur);    break;
+            case STEP_SIGMOID:    cur = ggml_sigmoid(ctx, cur); break;
+            case STEP_SILU:       cur = ggml_silu(ctx, cur);    break;
+            case STEP_TANH:       cur = ggml_tanh(ctx, cur);    break;
+            // the in-place ops return views of their first source
+            case STEP_MUL_INPLACE:        cur = ggml_mul_inplace(ctx, cur, channel_param(ctx, tc.oc, seed++, 1.0f)); break;
+            case STEP_ADD_INPLACE:        cur = ggml_add_inplace(ctx, cur, channel_param(ctx, tc.oc, seed++, 0.0f)); break;
+            case STEP_LEAKY_RELU_INPLACE: cur = ggml_leaky_relu(ctx, cur, 0.1f, true); break;
+            case STEP_OUTPUT:     ggml_set_output(cur);         break;
+        }
+    }
+    if (tc.pool_k > 0) {
+        cur = ggml_pool_2d(ctx, cur, GGML_OP_POOL_MAX, tc.pool_k, tc.pool_k, tc.pool_s, tc.pool_s, tc.pool_p, tc.pool_p);
+    }
+
+    struct ggml_cgraph * gf = ggml_new_graph(ctx);
+    ggml_build_forward_expand(gf, cur);
+
+    struct ggml_cpu_profile * profile = ggml_cpu_profile_init();
+
+    const enum ggml_status status = test_graph_compute(gf, n_threads, profile);
+    assert(status == GGML_STATUS_SUCCESS);
+
+    res.resize(ggml_nelements(cur));
+    memcpy(res.data(), cur->data, ggml_nbytes(cur));
+
+    struct ggml_cpu_profile_op_stats stats[GGML_OP_COUNT + GGML_UNARY_OP_COUNT];
+    const int n_stats = ggml_cpu_profile_get_op_stats(profile, stats, GGML_OP_COUNT + GGML_UNARY_OP_COUNT);
+
+    int n_nodes = 0;
+    for (int i = 0; i < n_stats; ++i) {
+        n_nodes += (int) stats[i].n_nodes;
+    }
+
+    ggml_cpu_profile_free(profile);
+    ggml_free(ctx);
+
+    return n_nodes;
+}
+
+static bool test_conv_2d_fused(const test_case & tc, int n_threads) {
+    std::vector<float> ref;
+    std::vector<float> res;
+
+    const int n_nodes_ref = compute(tc, false, n_threads, ref);
+    const int n_nodes_res = compute(tc, true,  n_threads, res);
+
+    const double nmse = test_nmse(ref, res);
+
+    const int n_nodes_ref_expected = 1 + (int) tc.steps.size() - (int) std::count(tc.steps.begin(), tc.steps.end(), STEP_OUTPUT) + (tc.pool_k > 0);
+
+    const bool ok = nmse < 1e-12 && n_nodes_ref == n_nodes_ref_expected && n_nodes_res == tc.n_nodes_fused;
+    printf("%s: %-24s %-4s n_threads = %d: nodes = %d -> %d, nmse = %.3e %s\n",
+            __func__, tc.name, ggml_type_name(tc.type), n_threads, n_nodes_ref, n_nodes_res, nmse, ok ? "OK" : "FAIL");
+
+    return ok;
+}
+
+static int64_t time_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// best time of n_iter computations of the yolov3-tiny backbone on a 416x416 image: 3x3 convolutions with F16 kernels,
+// each followed by the batch norm (MUL, ADD), LEAKY_RELU and, in the first layers, a 2x2 max pooling
+// when fuse is false, the convolutions are outputs, which keeps the nodes that follow them separate
+static double bench_yolo(bool fuse, int n_threads, int n_iter) {
+    struct ggml_init_params ip = {
+        /*.mem_size   =*/ 512*1024*1024,
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ false,
+    };
+    struct ggml_context * ctx = ggml_init(ip);
+
+    struct layer {
+        int k, oc;
+        bool pool;
+    };
+    const layer layers[] = {
+        { 3,   16, true  }, { 3,   32, true  }, { 3,   64, true  }, { 3,  128, true  }, { 3, 256, true },
+        { 3,  512, false }, { 3, 1024, false }, { 1,  256, false }, { 3,  512, false },
+    };
+
+    struct ggml_tensor * cur = ggml_new_tensor_4d(ctx, GGML_TYPE_F32, 416, 416, 3, 1);
+    test_fill(cur, 1, 1.0f);
+
+    int seed = 2;
+    for (const layer & l : layers) {
+        const int64_t ic = cur->ne[2];
+
+        std::vector<float> knl(l.k*l.k*ic*l.oc);
+        test_fill(knl.data(), knl.size(), seed++, 0.1f);
+        struct ggml_tensor * a = ggml_new_tensor_4d(ctx, GGML_TYPE_F16, l.k, l.k, ic, l.oc);
+        ggml_get_type_traits_cpu(GGML_TYPE_F16)->from_float(knl.data(), a->data, knl.size());
+
+        cur = ggml_conv_2d_direct(ctx, a, cur, 1, 1, l.k/2, l.k/2, 1, 1);
+        if (!fuse) {
+            ggml_set_output(cur);
+        }
+        cur = ggml_mul(ctx, cur, channel_param(ctx, l.oc, seed++, 1.0f));
+        cur = ggml_add(ctx, cur, channel_param(ctx, l.oc, seed++, 0.0f));
+        cur = ggml_leaky_relu(ctx, cur, 0.1f, true);
+        if (l.pool) {
+            cur = ggml_pool_2d(ctx, cur, GGML_OP_POOL_MAX, 2, 2, 2, 2, 0, 0);
+        }
+    }
+
+    struct ggml_cgraph * gf = ggml_new_graph(ctx);
+    ggml_build_forward_expand(gf, cur);
+
+    struct ggml_cplan cplan = ggml_graph_plan(gf, n_threads, nullptr);
+    std::vector<uint8_t> work(cplan.work_size);
+    cplan.work_data = work.data();
+
+    double best = INFINITY;
+    for (int it = 0; it < n_iter; ++it) {
+        const int64_t t0 = time_us();
+        const enum ggml_status status = ggml_graph_compute(gf, &cplan);
+        best = std::min(best, (double) (time_us() - t0));
+        assert(status == GGML_STATUS_SUCCESS);
+    }
+
+    ggml_free(ctx);
+
+    return best/1000.0;
+}
+
+static void usage(char * argv[]) {
+    printf("Check the CONV_2D nodes fused with the nodes that follow them\n");
+    printf("\n");
+    printf("usage: %s [options]\n", argv[0]);
+    printf("\n");
+    printf("options: (default)\n");
+    printf("  -h, --help            show this help message and exit\n");
+    printf("  -t N, --threads N     number of threads of --bench (4)\n");
+    printf("  -i N, --iterations N  number of timed graphs of --bench (5)\n");
+    printf("  --bench               time the yolov3-tiny backbone with and without the fused nodes\n");
+}
+
+int main(int argc, char * argv[]) {
+    int  n_threads = 4;
+    int  n_iter    = 5;
+    bool bench     = false;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            usage(argv);
+            return 0;
+        } else if ((arg == "-t" || arg == "--threads") && i + 1 < argc) {
+            n_threads = std::max(1, atoi(argv[++i]));
+        } else if ((arg == "-i" || arg == "--iterations") && i + 1 < argc) {
+            n_iter = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--bench") {
+            bench = true;
+        } else {
+            fprintf(stderr, "error: unknown argument: %s\n", arg.c_str());
+            usage(argv);
+            return 1;
+        }
+    }
+
+    ggml_cpu_init();
+
+    const std::vector<test_case> cases = {
+        // im2col
+        { "bn_leaky_pool",      GGML_TYPE_F16,  3, 16, 16, 26, 26, 2, 1, 1, { STEP_MUL, STEP_ADD, STEP_LEAKY_RELU }, 2, 2, 0, 1 },
+        { "relu_tanh",          GGML_TYPE_F32,  3,  8, 12, 17, 15, 1, 2, 1, { STEP_ADD, STEP_RELU, STEP_TANH },      0, 0, 0, 1 },
+        { "pool_only",          GGML_TYPE_F32,  3,  8,  8, 20, 20, 1, 1, 1, { },                                     3, 2, 1, 1 },
+        // Winograd
+        { "norm_leaky_pool",    GGML_TYPE_F32,  3, 64, 64, 30, 28, 1, 1, 1, { STEP_SUB, STEP_DIV, STEP_MUL, STEP_ADD, STEP_LEAKY_RELU }, 2, 1, 0, 1 },
+        // direct
+        { "scalar_silu",        GGML_TYPE_F16,  1, 128, 32, 13, 13, 2, 1, 0, { STEP_ADD_SCALAR, STEP_SILU },         0, 0, 0, 1 },
+        { "bias_sigmoid_pool",  GGML_TYPE_Q8_0, 3, 64, 16, 24, 19, 1, 1, 1, { STEP_MUL, STEP_ADD, STEP_SIGMOID },    2, 2, 0, 1 },
+        // in-place element-wise nodes, as in yolov3-tiny
+        { "bn_leaky_inplace_pool", GGML_TYPE_F16, 3, 16, 32, 26, 26, 1, 1, 1, { STEP_MUL, STEP_ADD, STEP_LEAKY_RELU_INPLACE }, 2, 2, 0, 1 },
+        { "all_inplace_pool",   GGML_TYPE_F32,  3, 64, 64, 30, 28, 1, 1, 1, { STEP_MUL_INPLACE, STEP_ADD_INPLACE, STEP_LEAKY_RELU_INPLACE }, 2, 1, 0, 1 },
+        { "inplace_output",     GGML_TYPE_F32,  3, 16,  8, 18, 18, 1, 1, 1, { STEP_ADD_INPLACE, STEP_OUTPUT, STEP_LEAKY_RELU_INPLACE }, 2, 2, 0, 3 },
+        // the fused nodes end at an output, the rest is computed on its own
+        { "output_in_chain",    GGML_TYPE_F32,  3, 16,  8, 18, 18, 1, 1, 1, { STEP_ADD, STEP_OUTPUT, STEP_LEAKY_RELU }, 2, 2, 0, 3 },
+    };
+
+    bool ok = true;
+    for (const test_case & tc : cases) {
+        for (int n_threads : { 1, 4 }) {
+            ok = test_conv_2d_fused(tc, n_threads) && ok;
+        }
+    }
+
+    if (ok && bench) {
+        const double t_sep   = bench_yolo(false, n_threads, n_iter);
+        const double t_fused = bench_yolo(true,  n_threads, n_iter);
+        printf("\nyolov3-tiny backbone, n_threads = %d: %.1f ms separate nodes, %.1f ms fused, speedup %.3f\n",
+                n_threads, t_sep, t_fused, t_sep/t_fused);
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+// Helpers of the tests that compute small graphs on the CPU and compare them against a reference,
+// or against the same graph computed with another number of threads
+
+#pragma once
+
+#include "ggml.h"
+#include "ggml-cpu.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+// deterministic test data: sin(7*i + seed)*scale + offset
+static inline void test_fill(float * data, int64_t n, int seed, float scale, float offset = 0.0f) {
+    for (int64_t i = 0; i < n; ++i) {
+        data[i] = sinf((float) (i*7 + seed)) * scale + offset;
+    }
+}
+
+static inline void test_fill(struct ggml_tensor * t, int seed, float scale, float offset = 0.0f) {
+    GGML_ASSERT(t->type == GGML_TYPE_F32 && ggml_is_contiguous(t));
+    test_fill((float *) t->data, ggml_nelements(t), seed, scale, offset);
+}
+
+// computes the graph with n_threads, records the timings of the nodes in profile when not NULL
+static inline enum ggml_status test_graph_compute(struct ggml_cgraph * gf, int n_threads, struct ggml_cpu_profile * profile = NULL) {
+    struct ggml_cplan cplan = ggml_graph_plan(gf, n_threads, nullptr);
+
+    std::vector<uint8_t> work(cplan.work_size);
+    cplan.work_data = work.data();
+    cplan.profile   = profile;
+
+    return ggml_graph_compute(gf, &cplan);
+}
+
+// computes the graph with n_threads and returns the data of the F32 tensor out
+static inline std::vector<float> test_graph_compute_f32(struct ggml_cgraph * gf, struct ggml_tensor * out, int n_threads) {
+    GGML_ASSERT(out->type == GGML_TYPE_F32 && ggml_is_contiguous(out));
+
+    const enum ggml_status status = test_graph_compute(gf, n_threads);
+    GGML_ASSERT(status == GGML_STATUS_SUCCESS);
+
+    std::vector<float> res(ggml_nelements(out));
+    memcpy(res.data(), out->data, ggml_nbytes(out));
+
+    return res;
+}
+
+// normalized mean squared error of res against ref
+static inline double test_nmse(const float * ref, const float * res, size_t n) {
+    double err = 0.0;
+    double nrm = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        err += ((double) res[i] - ref[i])*((double) res[i] - ref[i]);
+        nrm += (double) ref[i]*ref[i];
+    }
+    return err/nrm;
+}
+
+static inline double test_nmse(const std::vector<float> & ref, const std::vector<float> & res) {
+    GGML_ASSERT(ref.size() == res.size());
+    return test_nmse(ref.data(), res.data(), ref.size());
+}
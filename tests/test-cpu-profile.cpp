@@ -0,0 +1,304 @@
+// Check the CPU profiler: one sample per node and thread, the per-op statistics, and that the Chrome trace is valid JSON
+// with the events of each thread in the order of the nodes
+
+#include "ggml.h"
+#include "ggml-cpu.h"
+
+#include "test-cpu-common.h"
+
+#undef NDEBUG
+#include <assert.h>
+#include <ctype.h>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+// minimal JSON parser, enough to read the trace back
+
+struct json_value {
+    enum kind_t { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT } kind = NUL;
+
+    double      number = 0.0;
+    std::string string;
+
+    std::vector<json_value>           array;
+    std::map<std::string, json_value> object;
+
+    const json_value * get(const char * key) const {
+        const auto it = object.find(key);
+        return it == object.end() ? nullptr : &it->second;
+    }
+};
+
+struct json_parser {
+    const char * p;
+
+    void skip_ws() {
+        while (isspace((unsigned char) *p)) {
+            ++p;
+        }
+    }
+
+    bool parse_string(std::string & s) {
+        if (*p != '"') {
+            return false;
+        }
+        for (++p; *p != '"'; ++p) {
+            if (*p == '\0' || (unsigned char) *p < 0x20) {
+                return false;
+            }
+            if (*p == '\\') {
+                ++p;
+                switch (*p) {
+                    case '"': case '\\': case '/': s += *p; break;
+                    case 'b': s += '\b'; break;
+                    case 'f': s += '\f'; break;
+                    case 'n': s += '\n'; break;
+                    case 'r': s += '\r'; break;
+                    case 't': s += '\t'; break;
+                    case 'u':
+                        {
+                            for (int i = 1; i <= 4; ++i) {
+                                if (!isxdigit((unsigned char) p[i])) {
+                                    return false;
+                                }
+                            }
+                            s += (char) strtol(std::string(p + 1, 4).c_str(), nullptr, 16);
+                            p += 4;
+                        } break;
+                    default:
+                        return false;
+                }
+            } else {
+                s += *p;
+            }
+        }
+        ++p;
+        return true;
+    }
+
+    bool parse(json_value & v) {
+        skip_ws();
+        if (*p == '{') {
+            v.kind = json_value::OBJECT;
+            ++p;
+            skip_ws();
+            if (*p == '}') {
+                ++p;
+                return true;
+            }
+            while (true) {
+                std::string key;
+                skip_ws();
+                if (!parse_string(key)) {
+                    return false;
+                }
+                skip_ws();
+                if (*p++ != ':' || !parse(v.object[key])) {
+                    return false;
+                }
+                skip_ws();
+                if (*p == '}') {
+                    ++p;
+                    return true;
+                }
+                if (*p++ != ',') {
+                    return false;
+                }
+            }
+        }
+        if (*p == '[') {
+            v.kind = json_value::ARRAY;
+            ++p;
+            skip_ws();
+            if (*p == ']') {
+                ++p;
+                return true;
+            }
+            while (true) {
+                v.array.emplace_back();
+                if (!parse(v.array.back())) {
+                    return false;
+                }
+                skip_ws();
+                if (*p == ']') {
+                    ++p;
+                    return true;
+                }
+                if (*p++ != ',') {
+                    return false;
+                }
+            }
+        }
+        if (*p == '"') {
+            v.kind = json_value::STRING;
+            return parse_string(v.string);
+        }
+        for (const char * lit : { "null", "true", "false" }) {
+            if (strncmp(p, lit, strlen(lit)) == 0) {
+                v.kind = lit[0] == 'n' ? json_value::NUL : json_value::BOOL;
+                v.number = lit[0] == 't';
+                p += strlen(lit);
+                return true;
+            }
+        }
+        char * end = nullptr;
+        v.kind   = json_value::NUMBER;
+        v.number = strtod(p, &end);
+        if (end == p) {
+            return false;
+        }
+        p = end;
+        return true;
+    }
+};
+
+static bool json_parse(const std::string & text, json_value & v) {
+    json_parser parser = { text.c_str() };
+    if (!parser.parse(v)) {
+        return false;
+    }
+    parser.skip_ws();
+    return *parser.p == '\0';
+}
+
+static bool read_file(const char * fname, std::string & text) {
+    FILE * f = fopen(fname, "rb");
+    if (!f) {
+        return false;
+    }
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        text.append(buf, n);
+    }
+    fclose(f);
+    return true;
+}
+
+static bool test_cpu_profile(int n_threads) {
+    struct ggml_init_params ip = {
+        /*.mem_size   =*/ 16*1024*1024,
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ false,
+    };
+    struct ggml_context * ctx = ggml_init(ip);
+
+    struct ggml_tensor * a = ggml_new_tensor_2d(ctx, GGML_TYPE_F32, 64, 32);
+    struct ggml_tensor * b = ggml_new_tensor_2d(ctx, GGML_TYPE_F32, 64, 16);
+    struct ggml_tensor * c = ggml_new_tensor_2d(ctx, GGML_TYPE_F32, 32, 16);
+    test_fill(a, 1, 0.5f);
+    test_fill(b, 2, 1.0f);
+    test_fill(c, 3, 1.0f);
+
+    // MUL_MAT -> ADD -> SOFT_MAX
+    struct ggml_tensor * out = ggml_soft_max(ctx, ggml_add(ctx, ggml_mul_mat(ctx, a, b), c));
+
+    struct ggml_cgraph * gf = ggml_new_graph(ctx);
+    ggml_build_forward_expand(gf, out);
+
+    const int n_nodes  = ggml_graph_n_nodes(gf);
+    const int n_graphs = 2;
+
+    struct ggml_cpu_profile * profile = ggml_cpu_profile_init();
+
+    // every thread computes every node, however small
+    struct ggml_cplan cplan = ggml_graph_plan(gf, n_threads, nullptr);
+    std::vector<uint8_t> work(cplan.work_size);
+    cplan.work_data     = work.data();
+    cplan.profile       = profile;
+    cplan.node_min_work = 0;
+
+    for (int ig = 0; ig < n_graphs; ++ig) {
+        const enum ggml_status status = ggml_graph_compute(gf, &cplan);
+        assert(status == GGML_STATUS_SUCCESS);
+    }
+
+    bool ok = ggml_cpu_profile_n_graphs(profile) == n_graphs;
+
+    // one op per node, each recorded once per graph
+    struct ggml_cpu_profile_op_stats stats[GGML_OP_COUNT];
+    const int n_stats = ggml_cpu_profile_get_op_stats(profile, stats, GGML_OP_COUNT);
+    ok = ok && n_stats == n_nodes;
+    for (int i = 0; i < n_stats && ok; ++i) {
+        ok = stats[i].n_nodes == n_graphs && stats[i].t_wall_ns >= 0 && stats[i].t_busy_ns >= 0 && stats[i].t_wait_ns >= 0 &&
+            (i == 0 || stats[i].t_wall_ns <= stats[i - 1].t_wall_ns);
+    }
+
+    const char * fname = "test-cpu-profile.json";
+    ok = ggml_cpu_profile_write_trace(profile, fname) && ok;
+
+    std::string text;
+    json_value  trace;
+    const bool parsed = read_file(fname, text) && json_parse(text, trace);
+    remove(fname);
+    ok = ok && parsed;
+
+    const json_value * events = parsed ? trace.get("traceEvents") : nullptr;
+    ok = ok && events && events->kind == json_value::ARRAY;
+
+    // [graph][node][thread] number of node events, and the end of the last node event of each thread
+    std::vector<int>    n_samples((size_t) n_graphs*n_nodes*n_threads, 0);
+    std::vector<double> t_last(n_threads, 0.0);
+
+    for (size_t ie = 0; ok && ie < events->array.size(); ++ie) {
+        const json_value & ev = events->array[ie];
+
+        const json_value * ph = ev.get("ph");
+        ok = ph && ph->kind == json_value::STRING;
+        if (!ok || ph->string != "X") {
+            continue;
+        }
+
+        const json_value * tid  = ev.get("tid");
+        const json_value * ts   = ev.get("ts");
+        const json_value * dur  = ev.get("dur");
+        const json_value * cat  = ev.get("cat");
+        const json_value * args = ev.get("args");
+        ok = tid && ts && dur && cat && args && tid->kind == json_value::NUMBER && ts->kind == json_value::NUMBER &&
+            dur->kind == json_value::NUMBER && cat->kind == json_value::STRING && args->get("graph") && args->get("node");
+        if (!ok) {
+            break;
+        }
+
+        const int ith   = (int) tid->number;
+        const int graph = (int) args->get("graph")->number;
+        const int node  = (int) args->get("node")->number;
+        ok = ith >= 0 && ith < n_threads && graph >= 0 && graph < n_graphs && node >= 0 && node < n_nodes &&
+            ts->number >= 0.0 && dur->number >= 0.0;
+        if (!ok || cat->string == "barrier") {
+            continue;
+        }
+
+        // the nodes of a thread are written in the order they were computed and do not overlap,
+        // up to the rounding of ts and dur to 1 ns
+        ok = ts->number >= t_last[ith] - 2e-3;
+        t_last[ith] = ts->number + dur->number;
+
+        n_samples[((size_t) graph*n_nodes + node)*n_threads + ith] += 1;
+    }
+
+    for (int n : n_samples) {
+        ok = ok && n == 1;
+    }
+
+    printf("%s: n_nodes = %d, n_graphs = %d, n_threads = %d: %s\n", __func__, n_nodes, n_graphs, n_threads, ok ? "OK" : "FAIL");
+
+    ggml_cpu_profile_free(profile);
+    ggml_free(ctx);
+
+    return ok;
+}
+
+int main(void) {
+    ggml_cpu_init();
+
+    bool ok = true;
+    for (int n_threads : { 1, 2, 4 }) {
+        ok = test_cpu_profile(n_threads) && ok;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+// Check the placement of the threads on synthetic CPU topologies: the CPUs picked by each placement policy, their order,
+// and the relative capacity of the threads that weights the split of the rows on hybrid CPUs
+
+#include "ggml.h"
+#include "ggml-cpu.h"
+
+#undef NDEBUG
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static void add_cpu(struct ggml_cpu_topology & topo, int core, int smt, int l3, int capacity, bool perf) {
+    struct ggml_cpu_topo_cpu & cpu = topo.cpus[topo.n_cpus++];
+    cpu.online   = true;
+    cpu.perf     = perf;
+    cpu.core     = core;
+    cpu.smt      = smt;
+    cpu.l3       = l3;
+    cpu.capacity = capacity;
+
+    topo.n_cores = std::max(topo.n_cores, core + 1);
+    topo.hybrid  = topo.hybrid || !perf;
+}
+
+// 4 performance cores with 2 hardware threads each (CPUs 0-7, siblings next to each other), 4 efficiency cores (CPUs 8-11)
+static struct ggml_cpu_topology topo_hybrid() {
+    struct ggml_cpu_topology topo;
+    memset(&topo, 0, sizeof(topo));
+    for (int core = 0; core < 4; ++core) {
+        add_cpu(topo, core, 0, 0, 1024, true);
+        add_cpu(topo, core, 1, 0, 1024, true);
+    }
+    for (int core = 4; core < 8; ++core) {
+        add_cpu(topo, core, 0, 0, 600, false);
+    }
+    return topo;
+}
+
+// 4 cores with 2 hardware threads each, in 2 L3 domains, numbered like Linux does: CPU i and i + 4 are siblings
+// cores 0 and 2 are in the first domain, so that the domains do not follow the CPU numbers
+static struct ggml_cpu_topology topo_smt(int offline_cpu) {
+    struct ggml_cpu_topology topo;
+    memset(&topo, 0, sizeof(topo));
+    for (int smt = 0; smt < 2; ++smt) {
+        for (int core = 0; core < 4; ++core) {
+            add_cpu(topo, core, smt, core % 2, 1024, true);
+        }
+    }
+    if (offline_cpu >= 0) {
+        topo.cpus[offline_cpu].online = false;
+    }
+    return topo;
+}
+
+struct test_case {
+    const char *                   name;
+    struct ggml_cpu_topology       topo;
+    enum ggml_threadpool_placement placement;
+    std::vector<int>               cpus;     // expected CPU of each thread
+    std::vector<float>             capacity; // expected capacity of each thread, empty if the rows are split evenly
+};
+
+static const char * placement_name(enum ggml_threadpool_placement placement) {
+    switch (placement) {
+        case GGML_THREADPOOL_PLACEMENT_NONE:       return "none";
+        case GGML_THREADPOOL_PLACEMENT_CORES:      return "cores";
+        case GGML_THREADPOOL_PLACEMENT_PERF:       return "perf";
+        case GGML_THREADPOOL_PLACEMENT_PERF_CORES: return "perf-cores";
+    }
+    return "?";
+}
+
+static std::string to_string(const std::vector<int> & v) {
+    std::string s;
+    for (size_t i = 0; i < v.size(); ++i) {
+        s += (i ? "," : "") + std::to_string(v[i]);
+    }
+    return s;
+}
+
+static bool run(const test_case & tc) {
+    const int n_threads = (int) tc.cpus.size();
+
+    std::vector<int>   cpus(n_threads, -1);
+    std::vector<float> capacity(n_threads + 1, -1.0f);
+
+    bool ok = ggml_cpu_topology_place(&tc.topo, tc.placement, n_threads, cpus.data(), capacity.data());
+
+    ok = ok && cpus == tc.cpus;
+
+    // the prefix sums of the capacity, or zeros for the even split
+    for (int j = 0; j < n_threads && ok; ++j) {
+        const float c = capacity[j + 1] - capacity[j];
+        ok = capacity[0] == 0.0f && (tc.capacity.empty() ? capacity[j + 1] == 0.0f : fabsf(c - tc.capacity[j]) < 1e-3f);
+    }
+
+    printf("%s: %-34s placement = %-10s n_threads = %2d: cpus = %s %s\n", __func__, tc.name, placement_name(tc.placement),
+            n_threads, to_string(cpus).c_str(), ok ? "OK" : "FAIL");
+    if (!ok) {
+        printf("  expected cpus = %s\n", to_string(tc.cpus).c_str());
+    }
+
+    return ok;
+}
+
+int main(void) {
+    ggml_cpu_init();
+
+    const struct ggml_cpu_topology hybrid = topo_hybrid();
+
+    std::vector<test_case> cases = {
+        // one thread per physical core, the performance cores first
+        { "hybrid",                hybrid, GGML_THREADPOOL_PLACEMENT_CORES,
+            { 0, 2, 4, 6, 8, 9, 10, 11 }, { 1024, 1024, 1024, 1024, 600, 600, 600, 600 } },
+        // the performance cores only, their second hardware threads after the first ones, each thread gets half a core
+        { "hybrid",                hybrid, GGML_THREADPOOL_PLACEMENT_PERF,
+            { 0, 2, 4, 6, 1, 3, 5, 7 }, {} },
+        // fewer threads than performance cores: the first hardware thread of each core, even split
+        { "hybrid",                hybrid, GGML_THREADPOOL_PLACEMENT_PERF_CORES,
+            { 0, 2, 4 }, {} },
+        // more threads than CPUs of the policy: the efficiency cores are used too, with their own capacity
+        { "hybrid",                hybrid, GGML_THREADPOOL_PLACEMENT_PERF,
+            { 0, 2, 4, 6, 1, 3, 5, 7, 8, 9 }, { 512, 512, 512, 512, 512, 512, 512, 512, 600, 600 } },
+        // the second hardware threads of the performance cores come before the efficiency cores
+        { "hybrid",                hybrid, GGML_THREADPOOL_PLACEMENT_PERF_CORES,
+            { 0, 2, 4, 6, 1, 3 }, { 512, 512, 1024, 1024, 512, 512 } },
+        // more threads than CPUs: the placement starts over, CPU 0 and 2 run two threads and share their core
+        // with their sibling
+        { "hybrid",                hybrid, GGML_THREADPOOL_PLACEMENT_CORES,
+            { 0, 2, 4, 6, 8, 9, 10, 11, 1, 3, 5, 7, 0, 2 },
+            { 1024.0f/3, 1024.0f/3, 512, 512, 600, 600, 600, 600, 1024.0f/3, 1024.0f/3, 512, 512, 1024.0f/3, 1024.0f/3 } },
+        // not hybrid: the rows are always split evenly
+        // the first hardware thread of each core, grouped by L3 domain
+        { "smt, 2 L3 domains",     topo_smt(-1), GGML_THREADPOOL_PLACEMENT_CORES,
+            { 0, 2, 1, 3 }, {} },
+        { "smt, 2 L3 domains",     topo_smt(-1), GGML_THREADPOOL_PLACEMENT_CORES,
+            { 0, 2, 1, 3, 4, 6 }, {} },
+        { "smt, 2 L3 domains",     topo_smt(-1), GGML_THREADPOOL_PLACEMENT_PERF,
+            { 0, 2, 1, 3, 4, 6, 5, 7 }, {} },
+        // an offline CPU is never used
+        { "smt, CPU 2 offline",    topo_smt(2), GGML_THREADPOOL_PLACEMENT_CORES,
+            { 0, 1, 3, 4, 6 }, {} },
+    };
+
+    bool ok = true;
+    for (const test_case & tc : cases) {
+        ok = run(tc) && ok;
+    }
+
+    // no online CPU: the topology is unknown and the threads are not placed
+    {
+        struct ggml_cpu_topology topo = topo_smt(-1);
+        for (int i = 0; i < topo.n_cpus; ++i) {
+            topo.cpus[i].online = false;
+        }
+
+        int   cpus[2];
+        float capacity[3];
+        const bool placed = ggml_cpu_topology_place(&topo, GGML_THREADPOOL_PLACEMENT_CORES, 2, cpus, capacity);
+        printf("%s: no online CPU: %s\n", __func__, placed ? "FAIL" : "OK");
+        ok = !placed && ok;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+// Check FLASH_ATTN_EXT with a quantized V, accumulated by the fused vec_mad kernels, against the same graph with
+// an F32 V that holds the dequantized values
+
+#include "ggml.h"
+#include "ggml-cpu.h"
+
+#include "test-cpu-common.h"
+
+#undef NDEBUG
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+struct test_case {
+    ggml_type type_v;
+    int64_t   d;
+    int64_t   n_kv;
+    int64_t   n_q;
+    int64_t   n_head;
+    int64_t   n_head_kv;
+    bool      mask;
+};
+
+static bool test_flash_attn_quant(const test_case & tc, int n_threads) {
+    struct ggml_init_params ip = {
+        /*.mem_size   =*/ 128*1024*1024,
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ false,
+    };
+    struct ggml_context * ctx = ggml_init(ip);
+
+    struct ggml_tensor * q = ggml_new_tensor_3d(ctx, GGML_TYPE_F32, tc.d, tc.n_q, tc.n_head);
+    test_fill(q, 1, 0.5f);
+
+    struct ggml_tensor * k = ggml_new_tensor_3d(ctx, GGML_TYPE_F16, tc.d, tc.n_kv, tc.n_head_kv);
+    for (int64_t i = 0; i < ggml_nelements(k); ++i) {
+        ((ggml_fp16_t *) k->data)[i] = ggml_fp32_to_fp16(sinf((float) (3*i + 2)));
+    }
+
+    // V is stored as [d, n_head_kv, n_kv] and permuted, as in a KV cache, so that its rows are not contiguous
+    std::vector<float> v_src(tc.d*tc.n_head_kv*tc.n_kv);
+    test_fill(v_src.data(), (int64_t) v_src.size(), 3, 1.0f);
+
+    struct ggml_tensor * v_q = ggml_new_tensor_3d(ctx, tc.type_v,      tc.d, tc.n_head_kv, tc.n_kv);
+    struct ggml_tensor * v_f = ggml_new_tensor_3d(ctx, GGML_TYPE_F32, tc.d, tc.n_head_kv, tc.n_kv);
+
+    const int64_t nrows = tc.n_head_kv*tc.n_kv;
+    ggml_quantize_chunk(tc.type_v, v_src.data(), v_q->data, 0, nrows, tc.d, NULL);
+    ggml_get_type_traits(tc.type_v)->to_float(v_q->data, (float *) v_f->data, nrows*tc.d);
+
+    struct ggml_tensor * mask = NULL;
+    if (tc.mask) {
+        mask = ggml_new_tensor_2d(ctx, GGML_TYPE_F16, tc.n_kv, GGML_PAD(tc.n_q, GGML_KQ_MASK_PAD));
+        for (int64_t i1 = 0; i1 < mask->ne[1]; ++i1) {
+            for (int64_t i0 = 0; i0 < tc.n_kv; ++i0) {
+                // the second tile of KV rows is masked entirely, the others partially
+                const bool masked = (i0 >= 32 && i0 < 64) || (i0 + i1) % 5 == 0;
+                ((ggml_fp16_t *) mask->data)[i1*tc.n_kv + i0] = ggml_fp32_to_fp16(masked ? -INFINITY : 0.1f*(i0 % 3));
+            }
+        }
+    }
+
+    const float scale = 1.0f/sqrtf((float) tc.d);
+
+    struct ggml_tensor * out_q = ggml_flash_attn_ext(ctx, q, k, ggml_permute(ctx, v_q, 0, 2, 1, 3), mask, scale, 0.0f, 0.0f);
+    struct ggml_tensor * out_f = ggml_flash_attn_ext(ctx, q, k, ggml_permute(ctx, v_f, 0, 2, 1, 3), mask, scale, 0.0f, 0.0f);
+    ggml_flash_attn_ext_set_prec(out_q, GGML_PREC_F32);
+    ggml_flash_attn_ext_set_prec(out_f, GGML_PREC_F32);
+
+    struct ggml_cgraph * gf_q = ggml_new_graph(ctx);
+    ggml_build_forward_expand(gf_q, out_q);
+
+    struct ggml_cgraph * gf_f = ggml_new_graph(ctx);
+    ggml_build_forward_expand(gf_f, out_f);
+
+    const std::vector<float> res = test_graph_compute_f32(gf_q, out_q, n_threads);
+    const std::vector<float> ref = test_graph_compute_f32(gf_f, out_f, n_threads);
+
+    const double nmse = test_nmse(ref, res);
+
+    // only the order of the additions differs
+    const bool ok = nmse < 1e-10;
+    printf("%s: type_v = %-4s d = %3d, n_kv = %3d, n_q = %d, n_head = %d/%d, mask = %d, n_threads = %d: nmse = %.3e %s\n",
+            __func__, ggml_type_name(tc.type_v), (int) tc.d, (int) tc.n_kv, (int) tc.n_q, (int) tc.n_head, (int) tc.n_head_kv,
+            tc.mask, n_threads, nmse, ok ? "OK" : "FAIL");
+
+    ggml_free(ctx);
+
+    return ok;
+}
+
+int main(void) {
+    ggml_cpu_init();
+
+    const test_case cases[] = {
+        { GGML_TYPE_Q4_0,  64,   7, 3, 4, 4, false }, // a single partial tile
+        { GGML_TYPE_Q4_0, 128, 113, 5, 8, 2, true  },
+        { GGML_TYPE_Q8_0,  64,  32, 1, 4, 4, false }, // a single full tile
+        { GGML_TYPE_Q8_0, 128, 113, 5, 8, 2, true  },
+        { GGML_TYPE_Q8_0, 256, 200, 2, 4, 1, true  },
+        { GGML_TYPE_Q5_K, 256,  45, 3, 4, 4, false },
+        { GGML_TYPE_Q5_K, 256, 113, 5, 4, 2, true  },
+        { GGML_TYPE_Q5_K, 512,  70, 2, 2, 1, true  },
+    };
+
+    bool ok = true;
+    for (const test_case & tc : cases) {
+        for (int n_threads : { 1, 4 }) {
+            ok = test_flash_attn_quant(tc, n_threads) && ok;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,206 @@
+// Benchmark loading a GGUF file with many tensors and keys and looking up all of them by name,
+// and check that ggml_get_tensor can be called from several threads
+
+#include "ggml.h"
+#include "gguf.h"
+
+#undef NDEBUG
+#include <algorithm>
+#include <assert.h>
+#include <chrono>
+#include <cinttypes>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct gguf_perf_params {
+    int64_t n_tensors = 20000;
+    int64_t n_kv      = 5000;
+    std::string fname = "test-gguf-perf.gguf";
+};
+
+static int64_t time_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static std::string tensor_name(int64_t i) {
+    // similar to the names of the expert tensors of a MoE model
+    return "blk." + std::to_string(i/64) + ".ffn_down_exps." + std::to_string(i%64) + ".weight";
+}
+
+static std::string key_name(int64_t i) {
+    return "test.meta." + std::to_string(i);
+}
+
+// the first lookups of the threads build the name index of a new context at the same time
+static bool test_get_tensor_threads(int n_threads, int64_t n_tensors) {
+    struct ggml_init_params ip = {
+        /*.mem_size   =*/ (size_t) n_tensors*ggml_tensor_overhead(),
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ true,
+    };
+    struct ggml_context * ctx = ggml_init(ip);
+
+    std::vector<struct ggml_tensor *> tensors(n_tensors);
+    for (int64_t i = 0; i < n_tensors; ++i) {
+        tensors[i] = ggml_new_tensor_1d(ctx, GGML_TYPE_F32, 1);
+        ggml_set_name(tensors[i], tensor_name(i).c_str());
+    }
+
+    std::vector<int> ok(n_threads, 1);
+    std::vector<std::thread> workers;
+    for (int ith = 0; ith < n_threads; ++ith) {
+        workers.emplace_back([&, ith]() {
+            for (int64_t i = 0; i < n_tensors; ++i) {
+                const int64_t j = (i + ith*n_tensors/n_threads) % n_tensors;
+                if (ggml_get_tensor(ctx, tensor_name(j).c_str()) != tensors[j]) {
+                    ok[ith] = 0;
+                }
+            }
+        });
+    }
+    for (std::thread & w : workers) {
+        w.join();
+    }
+
+    ggml_free(ctx);
+
+    return std::count(ok.begin(), ok.end(), 1) == n_threads;
+}
+
+static void usage(char * argv[]) {
+    printf("Benchmark loading a GGUF file with many tensors and keys and looking up all of them by name\n");
+    printf("\n");
+    printf("usage: %s [options]\n", argv[0]);
+    printf("\n");
+    printf("options: (default)\n");
+    printf("  -h, --help            show this help message and exit\n");
+    printf("  -t N, --tensors N     number of tensors (20000)\n");
+    printf("  -k N, --keys N        number of additional keys (5000)\n");
+    printf("  -o FNAME, --output FNAME\n");
+    printf("                        temporary file (test-gguf-perf.gguf)\n");
+}
+
+static bool write_file(const gguf_perf_params & params) {
+    struct ggml_init_params ip = {
+        /*.mem_size   =*/ (size_t) params.n_tensors*(ggml_tensor_overhead() + GGML_MEM_ALIGN),
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ false,
+    };
+    struct ggml_context * ctx = ggml_init(ip);
+    struct gguf_context * gctx = gguf_init_empty();
+
+    for (int64_t i = 0; i < params.n_kv; ++i) {
+        gguf_set_val_i64(gctx, key_name(i).c_str(), i);
+    }
+    for (int64_t i = 0; i < params.n_tensors; ++i) {
+        struct ggml_tensor * t = ggml_new_tensor_1d(ctx, GGML_TYPE_F32, 1);
+        ggml_set_name(t, tensor_name(i).c_str());
+        *(float *) t->data = (float) i;
+        gguf_add_tensor(gctx, t);
+    }
+
+    const bool ok = gguf_write_to_file(gctx, params.fname.c_str(), false);
+
+    gguf_free(gctx);
+    ggml_free(ctx);
+
+    return ok;
+}
+
+int main(int argc, char * argv[]) {
+    gguf_perf_params params;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            usage(argv);
+            return 0;
+        } else if ((arg == "-t" || arg == "--tensors") && i + 1 < argc) {
+            params.n_tensors = atoll(argv[++i]);
+        } else if ((arg == "-k" || arg == "--keys") && i + 1 < argc) {
+            params.n_kv = atoll(argv[++i]);
+        } else if ((arg == "-o" || arg == "--output") && i + 1 < argc) {
+            params.fname = argv[++i];
+        } else {
+            fprintf(stderr, "error: unknown argument: %s\n", arg.c_str());
+            usage(argv);
+            return 1;
+        }
+    }
+
+    const int64_t t_write = time_us();
+    if (!write_file(params)) {
+        fprintf(stderr, "error: failed to write %s\n", params.fname.c_str());
+        return 1;
+    }
+    printf("write:               %10.3f ms (%" PRId64 " tensors, %" PRId64 " keys)\n",
+        (time_us() - t_write)/1e3, params.n_tensors, params.n_kv);
+
+    struct ggml_context * ctx = NULL;
+    struct gguf_init_params gp = {
+        /*.no_alloc =*/ false,
+        /*.ctx      =*/ &ctx,
+    };
+
+    const int64_t t_load = time_us();
+    struct gguf_context * gctx = gguf_init_from_file(params.fname.c_str(), gp);
+    printf("gguf_init_from_file: %10.3f ms\n", (time_us() - t_load)/1e3);
+    remove(params.fname.c_str());
+    assert(gctx != NULL && ctx != NULL);
+
+    const int64_t t_keys = time_us();
+    for (int64_t i = 0; i < params.n_kv; ++i) {
+        const int64_t key_id = gguf_find_key(gctx, key_name(i).c_str());
+        assert(key_id >= 0 && gguf_get_val_i64(gctx, key_id) == i);
+    }
+    assert(gguf_find_key(gctx, "test.meta.missing") == -1);
+    printf("gguf_find_key:       %10.3f ms\n", (time_us() - t_keys)/1e3);
+
+    const int64_t t_find = time_us();
+    for (int64_t i = 0; i < params.n_tensors; ++i) {
+        const int64_t tensor_id = gguf_find_tensor(gctx, tensor_name(i).c_str());
+        assert(tensor_id == i);
+    }
+    assert(gguf_find_tensor(gctx, "missing.weight") == -1);
+    printf("gguf_find_tensor:    %10.3f ms\n", (time_us() - t_find)/1e3);
+
+    const int64_t t_get = time_us();
+    for (int64_t i = 0; i < params.n_tensors; ++i) {
+        const struct ggml_tensor * t = ggml_get_tensor(ctx, tensor_name(i).c_str());
+        assert(t != NULL && *(const float *) t->data == (float) i);
+    }
+    printf("ggml_get_tensor:     %10.3f ms\n", (time_us() - t_get)/1e3);
+
+    // the lookups must keep working after keys are removed and tensors are renamed or added
+    if (params.n_kv > 1 && params.n_tensors > 1) {
+        assert(gguf_remove_key(gctx, key_name(0).c_str()) >= 0);
+        assert(gguf_find_key(gctx, key_name(0).c_str()) == -1);
+        assert(gguf_get_val_i64(gctx, gguf_find_key(gctx, key_name(1).c_str())) == 1);
+
+        struct ggml_tensor * t0 = ggml_get_tensor(ctx, tensor_name(0).c_str());
+        ggml_set_name(t0, "renamed");
+        assert(ggml_get_tensor(ctx, "renamed") == t0);
+        assert(ggml_get_tensor(ctx, tensor_name(0).c_str()) == NULL);
+
+        struct ggml_tensor * t1 = ggml_get_tensor(ctx, tensor_name(1).c_str());
+        ggml_set_name(t1, "");
+        assert(ggml_get_tensor(ctx, tensor_name(1).c_str()) == NULL);
+        ggml_set_name(t1, tensor_name(1).c_str());
+        assert(ggml_get_tensor(ctx, tensor_name(1).c_str()) == t1);
+    }
+
+    gguf_free(gctx);
+    ggml_free(ctx);
+
+    if (!test_get_tensor_threads(4, std::min<int64_t>(params.n_tensors, 4096))) {
+        fprintf(stderr, "error: ggml_get_tensor from several threads returned wrong tensors\n");
+        return 1;
+    }
+
+    return 0;
+}
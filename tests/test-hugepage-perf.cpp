@@ -0,0 +1,229 @@
+// Benchmark the decoding speed of a stack of matrix-vector products with the weights and the compute buffer
+// in the CPU buffer type and in the huge page backed CPU buffer type, and check that both give the same results
+
+#include "ggml.h"
+#include "ggml-alloc.h"
+#include "ggml-backend.h"
+#include "ggml-cpu.h"
+
+#undef NDEBUG
+#include <algorithm>
+#include <assert.h>
+#include <chrono>
+#include <cinttypes>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct hugepage_perf_params {
+    int            n_threads = 4;
+    int            n_iter    = 10;
+    int64_t        size_mb   = 256;
+    int64_t        n_embd    = 4096;
+    enum ggml_type type      = GGML_TYPE_Q4_0;
+};
+
+struct decode_result {
+    double             tokens_per_s;
+    std::vector<float> out;
+};
+
+static int64_t time_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// huge pages in use by the process, -1 if unknown
+static int64_t hugepage_kb() {
+    FILE * f = fopen("/proc/self/smaps_rollup", "r");
+    if (f == NULL) {
+        return -1;
+    }
+    int64_t total = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        long long kb;
+        if (sscanf(line, "AnonHugePages: %lld kB", &kb) == 1 ||
+            sscanf(line, "Private_Hugetlb: %lld kB", &kb) == 1 ||
+            sscanf(line, "Shared_Hugetlb: %lld kB", &kb) == 1) {
+            total += kb;
+        }
+    }
+    fclose(f);
+    return total;
+}
+
+// one token of a decoder reduced to its weight reads: x = rms_norm(W_l x) for every layer
+static decode_result decode(const hugepage_perf_params & params, ggml_backend_buffer_type_t buft) {
+    const int64_t row_size = ggml_row_size(params.type, params.n_embd);
+    const int64_t n_layer  = std::max<int64_t>(1, params.size_mb*1024*1024/(row_size*params.n_embd));
+
+    struct ggml_init_params ip = {
+        /*.mem_size   =*/ (size_t) (n_layer + 1)*ggml_tensor_overhead(),
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ true,
+    };
+    struct ggml_context * ctx_w = ggml_init(ip);
+
+    std::vector<struct ggml_tensor *> w(n_layer);
+    for (int64_t il = 0; il < n_layer; ++il) {
+        w[il] = ggml_new_tensor_2d(ctx_w, params.type, params.n_embd, params.n_embd);
+    }
+
+    const int64_t hp0 = hugepage_kb();
+    ggml_backend_buffer_t buf_w = ggml_backend_alloc_ctx_tensors_from_buft(ctx_w, buft);
+    assert(buf_w != NULL);
+    assert(ggml_backend_buffer_get_type(buf_w) == buft && ggml_backend_buffer_is_host(buf_w));
+
+    // every row of the weights is a shifted copy of one quantized row
+    {
+        std::vector<float> src(params.n_embd);
+        for (int64_t i = 0; i < params.n_embd; ++i) {
+            src[i] = sinf((float) i*0.37f);
+        }
+        std::vector<uint8_t> row(row_size);
+        ggml_quantize_chunk(params.type, src.data(), row.data(), 0, 1, params.n_embd, NULL);
+
+        std::vector<uint8_t> data(row_size*params.n_embd);
+        for (int64_t ir = 0; ir < params.n_embd; ++ir) {
+            const int64_t shift = (ir*ggml_type_size(params.type)) % row_size;
+            memcpy(data.data() + ir*row_size, row.data() + shift, row_size - shift);
+            memcpy(data.data() + ir*row_size + row_size - shift, row.data(), shift);
+        }
+        for (int64_t il = 0; il < n_layer; ++il) {
+            ggml_backend_tensor_set(w[il], data.data(), 0, data.size());
+        }
+    }
+
+    struct ggml_init_params ip_graph = {
+        /*.mem_size   =*/ (size_t) (3*n_layer + 8)*ggml_tensor_overhead() + ggml_graph_overhead_custom(4*n_layer + 8, false),
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ true,
+    };
+    struct ggml_context * ctx = ggml_init(ip_graph);
+
+    struct ggml_tensor * inp = ggml_new_tensor_1d(ctx, GGML_TYPE_F32, params.n_embd);
+    ggml_set_input(inp);
+
+    struct ggml_tensor * cur = inp;
+    for (int64_t il = 0; il < n_layer; ++il) {
+        cur = ggml_rms_norm(ctx, ggml_mul_mat(ctx, w[il], cur), 1e-6f);
+    }
+    ggml_set_output(cur);
+
+    struct ggml_cgraph * gf = ggml_new_graph_custom(ctx, 4*n_layer + 8, false);
+    ggml_build_forward_expand(gf, cur);
+
+    ggml_gallocr_t galloc = ggml_gallocr_new(buft);
+    const bool ok = ggml_gallocr_alloc_graph(galloc, gf);
+    assert(ok);
+    const int64_t hp1 = hugepage_kb();
+
+    std::vector<float> x(params.n_embd);
+    for (int64_t i = 0; i < params.n_embd; ++i) {
+        x[i] = cosf((float) i*0.11f);
+    }
+    ggml_backend_tensor_set(inp, x.data(), 0, ggml_nbytes(inp));
+
+    ggml_backend_t backend = ggml_backend_cpu_init();
+    ggml_backend_cpu_set_n_threads(backend, params.n_threads);
+
+    ggml_backend_graph_compute(backend, gf); // warmup
+
+    int64_t t_best = INT64_MAX;
+    for (int it = 0; it < params.n_iter; ++it) {
+        const int64_t t0 = time_us();
+        ggml_backend_graph_compute(backend, gf);
+        t_best = std::min(t_best, time_us() - t0);
+    }
+
+    decode_result res;
+    res.tokens_per_s = 1e6/(double) t_best;
+    res.out.resize(params.n_embd);
+    ggml_backend_tensor_get(cur, res.out.data(), 0, ggml_nbytes(cur));
+
+    printf("%-14s %6" PRId64 " layers %10.2f MB %10.2f tokens/s", ggml_backend_buft_name(buft), n_layer,
+        ggml_backend_buffer_get_size(buf_w)/1024.0/1024.0, res.tokens_per_s);
+    if (hp0 >= 0 && hp1 >= 0) {
+        printf(" %10.2f MB in huge pages", (hp1 - hp0)/1024.0);
+    }
+    printf("\n");
+
+    ggml_backend_free(backend);
+    ggml_gallocr_free(galloc);
+    ggml_free(ctx);
+    ggml_backend_buffer_free(buf_w);
+    ggml_free(ctx_w);
+
+    return res;
+}
+
+static void usage(char * argv[]) {
+    printf("Benchmark the decoding speed with the weights and the compute buffer in huge pages\n");
+    printf("\n");
+    printf("usage: %s [options]\n", argv[0]);
+    printf("\n");
+    printf("options: (default)\n");
+    printf("  -h, --help            show this help message and exit\n");
+    printf("  -t N, --threads N     number of threads (4)\n");
+    printf("  -i N, --iterations N  number of timed tokens (10)\n");
+    printf("  -s N, --size N        size of the weights in MB (256)\n");
+    printf("  -e N, --embd N        size of the square weight matrices (4096)\n");
+    printf("  --type TYPE           type of the weights (q4_0)\n");
+}
+
+int main(int argc, char * argv[]) {
+    hugepage_perf_params params;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            usage(argv);
+            return 0;
+        } else if ((arg == "-t" || arg == "--threads") && i + 1 < argc) {
+            params.n_threads = std::max(1, atoi(argv[++i]));
+        } else if ((arg == "-i" || arg == "--iterations") && i + 1 < argc) {
+            params.n_iter = std::max(1, atoi(argv[++i]));
+        } else if ((arg == "-s" || arg == "--size") && i + 1 < argc) {
+            params.size_mb = std::max<int64_t>(1, atoll(argv[++i]));
+        } else if ((arg == "-e" || arg == "--embd") && i + 1 < argc) {
+            params.n_embd = std::max<int64_t>(256, atoll(argv[++i]) / 256 * 256);
+        } else if (arg == "--type" && i + 1 < argc) {
+            const std::string name = argv[++i];
+            bool found = false;
+            for (int t = 0; t < GGML_TYPE_COUNT; ++t) {
+                const char * type_name = ggml_type_name((enum ggml_type) t);
+                if (type_name && name == type_name && ggml_get_type_traits_cpu((enum ggml_type) t)->from_float) {
+                    params.type = (enum ggml_type) t;
+                    found = true;
+                }
+            }
+            if (!found) {
+                fprintf(stderr, "error: unsupported type: %s\n", name.c_str());
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "error: unknown argument: %s\n", arg.c_str());
+            usage(argv);
+            return 1;
+        }
+    }
+
+    ggml_cpu_init();
+
+    const decode_result ref = decode(params, ggml_backend_cpu_buffer_type());
+    const decode_result hp  = decode(params, ggml_backend_cpu_hugepage_buffer_type());
+
+    printf("\nspeedup: %.3f\n", hp.tokens_per_s/ref.tokens_per_s);
+
+    // the buffer type must not change the result
+    if (memcmp(ref.out.data(), hp.out.data(), ref.out.size()*sizeof(float)) != 0) {
+        fprintf(stderr, "error: results differ between the buffer types\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,290 @@
+// Check that the result of a graph does not depend on how many threads work on each node, that the abort callback stops a
+// chain of single-threaded nodes, and measure the node size at which using all the threads becomes faster than using one (--calibrate)
+
+#include "ggml.h"
+#include "ggml-cpu.h"
+
+#include "test-cpu-common.h"
+
+#undef NDEBUG
+#include <algorithm>
+#include <assert.h>
+#include <chrono>
+#include <cinttypes>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// one thread per node, larger than the work of any node
+static const int64_t NODE_MIN_WORK_ONE_THREAD = INT64_C(1) << 60;
+
+struct node_threads_params {
+    int  n_threads = 4;
+    int  n_iter    = 10;
+    bool calibrate = false;
+};
+
+static int64_t time_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void compute(struct ggml_cgraph * gf, int n_threads, int64_t node_min_work, std::vector<uint8_t> & work) {
+    struct ggml_cplan cplan = ggml_graph_plan(gf, n_threads, nullptr);
+    cplan.node_min_work = node_min_work;
+
+    work.resize(cplan.work_size);
+    cplan.work_data = work.data();
+
+    const enum ggml_status status = ggml_graph_compute(gf, &cplan);
+    assert(status == GGML_STATUS_SUCCESS);
+}
+
+// small and large nodes mixed as in a decoder layer at batch size 1, so that consecutive nodes use different numbers of threads
+static bool test_mixed(const node_threads_params & params) {
+    struct ggml_init_params ip = {
+        /*.mem_size   =*/ 256*1024*1024,
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ false,
+    };
+    struct ggml_context * ctx = ggml_init(ip);
+
+    const int n_embd = 512;
+    const int n_head = 8;
+    const int n_tokens = 3;
+    const int n_kv = 96;
+
+    struct ggml_tensor * x    = ggml_new_tensor_2d(ctx, GGML_TYPE_F32, n_embd, n_tokens);
+    struct ggml_tensor * wq   = ggml_new_tensor_2d(ctx, GGML_TYPE_F32, n_embd, n_embd);
+    struct ggml_tensor * wup  = ggml_new_tensor_2d(ctx, GGML_TYPE_F32, n_embd, 4*n_embd);
+    struct ggml_tensor * wdn  = ggml_new_tensor_2d(ctx, GGML_TYPE_F32, 4*n_embd, n_embd);
+    struct ggml_tensor * k    = ggml_new_tensor_3d(ctx, GGML_TYPE_F32, n_embd/n_head, n_kv, n_head);
+    struct ggml_tensor * norm = ggml_new_tensor_1d(ctx, GGML_TYPE_F32, n_embd);
+    struct ggml_tensor * pos  = ggml_new_tensor_1d(ctx, GGML_TYPE_I32, n_tokens);
+
+    test_fill(x, 1, 0.5f); test_fill(wq, 2, 0.5f); test_fill(wup, 3, 0.5f); test_fill(wdn, 4, 0.5f); test_fill(k, 5, 0.5f); test_fill(norm, 6, 0.5f);
+    for (int i = 0; i < n_tokens; ++i) {
+        ((int32_t *) pos->data)[i] = 10 + i;
+    }
+
+    struct ggml_tensor * cur = x;
+    for (int il = 0; il < 4; ++il) {
+        struct ggml_tensor * inp = cur;
+
+        cur = ggml_mul(ctx, ggml_rms_norm(ctx, cur, 1e-6f), norm);
+
+        struct ggml_tensor * q = ggml_reshape_3d(ctx, ggml_mul_mat(ctx, wq, cur), n_embd/n_head, n_head, n_tokens);
+        q = ggml_rope(ctx, q, pos, n_embd/n_head, 0);
+        q = ggml_cont(ctx, ggml_permute(ctx, q, 0, 2, 1, 3));
+
+        struct ggml_tensor * kq = ggml_mul_mat(ctx, k, q);
+        kq = ggml_soft_max_ext(ctx, kq, nullptr, 0.125f, 0.0f);
+
+        // summary of the attention scores added to every feature
+        struct ggml_tensor * s = ggml_sum_rows(ctx, ggml_cont(ctx, ggml_permute(ctx, kq, 1, 2, 0, 3)));
+        cur = ggml_add(ctx, inp, ggml_scale(ctx, ggml_sum(ctx, s), 1e-3f));
+
+        struct ggml_tensor * ffn = ggml_silu(ctx, ggml_mul_mat(ctx, wup, cur));
+        cur = ggml_add(ctx, cur, ggml_mul_mat(ctx, wdn, ffn));
+    }
+
+    struct ggml_cgraph * gf = ggml_new_graph(ctx);
+    ggml_build_forward_expand(gf, cur);
+
+    std::vector<uint8_t> work;
+
+    // reference: every node on all the threads
+    compute(gf, params.n_threads, 0, work);
+    const std::vector<float> ref((float *) cur->data, (float *) cur->data + ggml_nelements(cur));
+
+    bool ok = true;
+
+    const int64_t node_min_works[] = { -1, 64, 1024, 16384, 65536, 262144, NODE_MIN_WORK_ONE_THREAD };
+    for (int64_t node_min_work : node_min_works) {
+        compute(gf, params.n_threads, node_min_work, work);
+
+        if (memcmp(ref.data(), cur->data, ggml_nbytes(cur)) != 0) {
+            fprintf(stderr, "%s: node_min_work = %" PRId64 ": result differs from all threads on every node\n", __func__, node_min_work);
+            ok = false;
+        }
+    }
+
+    ggml_free(ctx);
+
+    return ok;
+}
+
+static bool abort_after(void * data) {
+    int * n_calls = (int *) data;
+    return ++n_calls[0] >= n_calls[1];
+}
+
+// a chain of single-threaded nodes, computed by thread 0 without barriers in between, stops at the first node after the abort
+static bool test_abort(const node_threads_params & params) {
+    struct ggml_init_params ip = {
+        /*.mem_size   =*/ 16*1024*1024,
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ false,
+    };
+    struct ggml_context * ctx = ggml_init(ip);
+
+    const int n_nodes = 16;
+
+    struct ggml_tensor * cur = ggml_new_tensor_1d(ctx, GGML_TYPE_F32, 64);
+    test_fill(cur, 1, 0.5f);
+    for (int i = 0; i < n_nodes; ++i) {
+        cur = ggml_scale(ctx, cur, 0.5f);
+    }
+
+    struct ggml_cgraph * gf = ggml_new_graph(ctx);
+    ggml_build_forward_expand(gf, cur);
+
+    // abort when the third node is done
+    int n_calls[2] = { 0, 3 };
+
+    struct ggml_cplan cplan = ggml_graph_plan(gf, params.n_threads, nullptr);
+    std::vector<uint8_t> work(cplan.work_size);
+    cplan.work_data           = work.data();
+    cplan.node_min_work       = NODE_MIN_WORK_ONE_THREAD;
+    cplan.abort_callback      = abort_after;
+    cplan.abort_callback_data = n_calls;
+
+    const enum ggml_status status = ggml_graph_compute(gf, &cplan);
+
+    const bool ok = status == GGML_STATUS_ABORTED && n_calls[0] == n_calls[1];
+    if (!ok) {
+        fprintf(stderr, "%s: status = %d, %d calls of the abort callback, expected %d\n", __func__, (int) status, n_calls[0], n_calls[1]);
+    }
+
+    ggml_free(ctx);
+
+    return ok;
+}
+
+// time a chain of element-wise nodes of n elements computed by all the threads and by one thread
+static void calibrate(const node_threads_params & params) {
+    const int n_nodes = 32;
+
+    printf("%-8s %10s %14s %14s\n", "op", "n", "1 thread us", "all threads us");
+
+    std::vector<int64_t> crossover;
+
+    const char * ops[] = { "add", "mul", "cpy" };
+    for (const char * op : ops) {
+        int64_t n_cross = -1;
+
+        for (int64_t n = 1024; n <= 4*1024*1024; n *= 2) {
+            struct ggml_init_params ip = {
+                /*.mem_size   =*/ (n_nodes + 2)*(n*sizeof(float) + GGML_MEM_ALIGN + 2*ggml_tensor_overhead()) + ggml_graph_overhead(),
+                /*.mem_buffer =*/ NULL,
+                /*.no_alloc   =*/ false,
+            };
+            struct ggml_context * ctx = ggml_init(ip);
+
+            struct ggml_tensor * a = ggml_new_tensor_1d(ctx, GGML_TYPE_F32, n);
+            struct ggml_tensor * b = ggml_new_tensor_1d(ctx, GGML_TYPE_F32, n);
+            test_fill(a, 1, 0.5f);
+            test_fill(b, 2, 0.5f);
+
+            struct ggml_tensor * cur = a;
+            for (int i = 0; i < n_nodes; ++i) {
+                if (strcmp(op, "add") == 0) {
+                    cur = ggml_add(ctx, cur, b);
+                } else if (strcmp(op, "mul") == 0) {
+                    cur = ggml_mul(ctx, cur, b);
+                } else {
+                    cur = ggml_cpy(ctx, cur, ggml_new_tensor_1d(ctx, GGML_TYPE_F32, n));
+                }
+            }
+
+            struct ggml_cgraph * gf = ggml_new_graph(ctx);
+            ggml_build_forward_expand(gf, cur);
+
+            std::vector<uint8_t> work;
+
+            int64_t t[2];
+            const int64_t node_min_works[2] = { NODE_MIN_WORK_ONE_THREAD, 0 };
+            for (int j = 0; j < 2; ++j) {
+                compute(gf, params.n_threads, node_min_works[j], work); // warmup
+                t[j] = INT64_MAX;
+                for (int it = 0; it < params.n_iter; ++it) {
+                    const int64_t t0 = time_us();
+                    compute(gf, params.n_threads, node_min_works[j], work);
+                    t[j] = std::min(t[j], time_us() - t0);
+                }
+            }
+
+            printf("%-8s %10" PRId64 " %14.1f %14.1f\n", op, n, (double) t[0]/n_nodes, (double) t[1]/n_nodes);
+
+            // smallest n from which all the threads are always faster
+            if (t[1] >= t[0]) {
+                n_cross = -1;
+            } else if (n_cross < 0) {
+                n_cross = n;
+            }
+
+            ggml_free(ctx);
+        }
+
+        if (n_cross > 0) {
+            crossover.push_back(n_cross);
+        }
+    }
+
+    if (crossover.empty()) {
+        printf("\nall the threads were never faster than one thread, try fewer threads\n");
+        return;
+    }
+
+    // at the crossover two threads should be used
+    std::sort(crossover.begin(), crossover.end());
+    printf("\nsuggested: GGML_CPU_NODE_MIN_WORK=%" PRId64 "\n", crossover[crossover.size()/2]/2);
+}
+
+static void usage(char * argv[]) {
+    printf("Check that the result of a graph does not depend on how many threads work on each node\n");
+    printf("\n");
+    printf("usage: %s [options]\n", argv[0]);
+    printf("\n");
+    printf("options: (default)\n");
+    printf("  -h, --help            show this help message and exit\n");
+    printf("  -t N, --threads N     number of threads (4)\n");
+    printf("  -i N, --iterations N  number of iterations of each timing in --calibrate (10)\n");
+    printf("  --calibrate           measure a suitable GGML_CPU_NODE_MIN_WORK for this machine,\n");
+    printf("                        use as many threads as in normal use\n");
+}
+
+int main(int argc, char * argv[]) {
+    node_threads_params params;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            usage(argv);
+            return 0;
+        } else if ((arg == "-t" || arg == "--threads") && i + 1 < argc) {
+            params.n_threads = std::max(1, atoi(argv[++i]));
+        } else if ((arg == "-i" || arg == "--iterations") && i + 1 < argc) {
+            params.n_iter = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--calibrate") {
+            params.calibrate = true;
+        } else {
+            fprintf(stderr, "error: unknown argument: %s\n", arg.c_str());
+            usage(argv);
+            return 1;
+        }
+    }
+
+    if (!test_mixed(params) || !test_abort(params)) {
+        return 1;
+    }
+
+    if (params.calibrate) {
+        calibrate(params);
+    }
+
+    return 0;
+}
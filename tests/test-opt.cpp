@@ -5,6 +5,7 @@
 #include "ggml-backend.h"
 #include "ggml-opt.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cinttypes>
 #include <cstring>
@@ -280,6 +281,88 @@ static std::pair<int, int> test_dataset(
     return std::make_pair(npass, ntest);
 }
 
+static void helper_read_shard(int64_t ishard, void * data, void * labels, void * userdata) {
+    ggml_opt_dataset_t dataset = (ggml_opt_dataset_t) userdata;
+    struct ggml_tensor * data_src   = ggml_opt_dataset_data(dataset);
+    struct ggml_tensor * labels_src = ggml_opt_dataset_labels(dataset);
+    const size_t nbs_data   = ggml_nbytes(data_src)   / ggml_opt_dataset_ndata(dataset);
+    const size_t nbs_labels = ggml_nbytes(labels_src) / ggml_opt_dataset_ndata(dataset);
+    // the test datasets for the out-of-core variants use ndata_shard == 1
+    memcpy(data, (const char *) data_src->data + ishard*nbs_data, nbs_data);
+    if (labels) {
+        memcpy(labels, (const char *) labels_src->data + ishard*nbs_labels, nbs_labels);
+    }
+}
+
+static std::pair<int, int> test_dataset_out_of_core(
+    enum ggml_opt_optimizer_type optim,
+    ggml_backend_sched_t backend_sched, ggml_backend_t backend) {
+    int ntest = 0;
+    int npass = 0;
+
+    struct helper_ctx_data cd = helper_get_ctx_data(optim, backend_sched, backend);
+    ggml_opt_dataset_t dataset_ref = cd.datasets_supervised[0];
+
+    const char * fname_data   = "test-opt-dataset-data.bin";
+    const char * fname_labels = "test-opt-dataset-labels.bin";
+    for (const char * fname : {fname_data, fname_labels}) {
+        struct ggml_tensor * t = fname == fname_data ? ggml_opt_dataset_data(dataset_ref) : ggml_opt_dataset_labels(dataset_ref);
+        FILE * f = fopen(fname, "wb");
+        GGML_ASSERT(f);
+        GGML_ASSERT(fwrite(t->data, 1, ggml_nbytes(t), f) == ggml_nbytes(t));
+        fclose(f);
+    }
+
+    for (bool mmap : {true, false}) {
+        ggml_opt_dataset_t dataset = mmap ?
+            ggml_opt_dataset_init_mmap(GGML_TYPE_F32, GGML_TYPE_F32, ne_datapoint, ne_label, ndata, /*ndata_shard =*/ 1, fname_data, fname_labels) :
+            ggml_opt_dataset_init_callback(GGML_TYPE_F32, GGML_TYPE_F32, ne_datapoint, ne_label, ndata, /*ndata_shard =*/ 1,
+                helper_read_shard, nullptr, dataset_ref);
+        GGML_ASSERT(dataset);
+
+        bool subtest_ok = true;
+        for (int64_t ndata_batch = 1; ndata_batch <= ndata; ++ndata_batch) {
+            struct ggml_tensor *   data_batch =   cd.data_batch[ndata_batch-1];
+            struct ggml_tensor * labels_batch = cd.labels_batch[ndata_batch-1];
+
+            std::vector<float>   data_ref(ggml_nelements(  data_batch));
+            std::vector<float> labels_ref(ggml_nelements(labels_batch));
+            std::vector<float>   data(ggml_nelements(  data_batch));
+            std::vector<float> labels(ggml_nelements(labels_batch));
+
+            for (int64_t ibatch = 0; ibatch < ndata/ndata_batch; ++ibatch) {
+                ggml_opt_dataset_get_batch(dataset_ref, data_batch, labels_batch, ibatch);
+                ggml_backend_tensor_get(  data_batch,   data_ref.data(), 0, ggml_nbytes(  data_batch));
+                ggml_backend_tensor_get(labels_batch, labels_ref.data(), 0, ggml_nbytes(labels_batch));
+
+                ggml_opt_dataset_get_batch(dataset, data_batch, labels_batch, ibatch);
+                ggml_backend_tensor_get(  data_batch,   data.data(), 0, ggml_nbytes(  data_batch));
+                ggml_backend_tensor_get(labels_batch, labels.data(), 0, ggml_nbytes(labels_batch));
+                subtest_ok = subtest_ok && data == data_ref && labels == labels_ref;
+
+                std::fill(data.begin(),   data.end(),   NAN);
+                std::fill(labels.begin(), labels.end(), NAN);
+                ggml_opt_dataset_get_batch_host(dataset, data.data(), ggml_nbytes(data_batch), labels.data(), ibatch);
+                subtest_ok = subtest_ok && data == data_ref && labels == labels_ref;
+            }
+        }
+
+        printf("  %s(variant=%s): ", __func__, mmap ? "mmap" : "callback");
+        print_ok(subtest_ok);
+        npass += subtest_ok;
+        ntest++;
+
+        ggml_opt_dataset_free(dataset);
+    }
+
+    remove(fname_data);
+    remove(fname_labels);
+
+    helper_free_ctx_data(cd);
+
+    return std::make_pair(npass, ntest);
+}
+
 static std::pair<int, int> test_grad(
     enum ggml_opt_optimizer_type optim,
     ggml_backend_sched_t backend_sched, ggml_backend_t backend) {
@@ -602,6 +685,105 @@ static std::pair<int, int> test_idata_split(
     return std::make_pair(npass, ntest);
 }
 
+struct helper_epoch_callback_record {
+    bool    train;
+    int64_t ibatch;
+    int64_t ibatch_max;
+    int64_t ndata;
+    double  loss;
+    float   loss_batch;
+    float   grad_acc;
+    float   weights;
+
+    bool operator==(const helper_epoch_callback_record & other) const {
+        return train == other.train && ibatch == other.ibatch && ibatch_max == other.ibatch_max && ndata == other.ndata &&
+            loss == other.loss && loss_batch == other.loss_batch && grad_acc == other.grad_acc && weights == other.weights;
+    }
+};
+
+static std::vector<helper_epoch_callback_record> helper_epoch_callback_records;
+static struct ggml_tensor *                       helper_epoch_callback_weights = nullptr;
+
+// records the state that a callback of ggml_opt_epoch sees
+static void helper_epoch_callback(
+        bool               train,
+        ggml_opt_context_t opt_ctx,
+        ggml_opt_dataset_t dataset,
+        ggml_opt_result_t  result,
+        int64_t            ibatch,
+        int64_t            ibatch_max,
+        int64_t            t_start_us) {
+    helper_epoch_callback_record record;
+    record.train      = train;
+    record.ibatch     = ibatch;
+    record.ibatch_max = ibatch_max;
+    ggml_opt_result_ndata(result, &record.ndata);
+    ggml_opt_result_loss(result, &record.loss, nullptr);
+    ggml_backend_tensor_get(ggml_opt_loss(opt_ctx), &record.loss_batch, 0, sizeof(float));
+    ggml_backend_tensor_get(ggml_opt_grad_acc(opt_ctx, helper_epoch_callback_weights), &record.grad_acc, 0, sizeof(float));
+    ggml_backend_tensor_get(helper_epoch_callback_weights, &record.weights, 0, sizeof(float));
+
+    helper_epoch_callback_records.push_back(record);
+
+    GGML_UNUSED(dataset);
+    GGML_UNUSED(t_start_us);
+}
+
+static std::pair<int, int> test_epoch_callbacks(
+    enum ggml_opt_optimizer_type optim,
+    ggml_backend_sched_t backend_sched, ggml_backend_t backend) {
+    int ntest = 0;
+    int npass = 0;
+
+    const int64_t idata_split = ndata * 2/3;
+
+    // ggml_opt_epoch prefetches the next batch while the current one is evaluated,
+    // its callbacks must see the same results and the same context as after a synchronous evaluation of each batch,
+    // with gradient accumulation so that the accumulators are cleared by the allocation of every other batch
+    std::vector<helper_epoch_callback_record> records_epoch;
+    {
+        struct helper_ctx_data cd = helper_get_ctx_data(
+            optim, backend_sched, backend, /*init_opt_ctx =*/ true, /*optimizer_defaults =*/ false, /*nbatch_logical =*/ 2);
+
+        helper_epoch_callback_records.clear();
+        helper_epoch_callback_weights = cd.weights;
+        for (int epoch = 0; epoch < 2; ++epoch) {
+            ggml_opt_epoch(cd.opt_ctx, cd.dataset_unsupervised, cd.result, cd.result2, idata_split,
+                helper_epoch_callback, helper_epoch_callback);
+        }
+        records_epoch = helper_epoch_callback_records;
+
+        helper_free_ctx_data(cd);
+    }
+
+    std::vector<helper_epoch_callback_record> records_sync;
+    {
+        struct helper_ctx_data cd = helper_get_ctx_data(
+            optim, backend_sched, backend, /*init_opt_ctx =*/ true, /*optimizer_defaults =*/ false, /*nbatch_logical =*/ 2);
+
+        helper_epoch_callback_records.clear();
+        helper_epoch_callback_weights = cd.weights;
+        for (int epoch = 0; epoch < 2; ++epoch) {
+            for (int64_t ibatch = 0; ibatch < ndata; ++ibatch) {
+                const bool train = ibatch < idata_split;
+                ggml_opt_alloc(cd.opt_ctx, /*backward =*/ train);
+                ggml_opt_dataset_get_batch(cd.dataset_unsupervised, cd.inputs, nullptr, ibatch);
+                ggml_opt_eval(cd.opt_ctx, train ? cd.result : cd.result2);
+                helper_epoch_callback(train, cd.opt_ctx, cd.dataset_unsupervised, train ? cd.result : cd.result2,
+                    train ? ibatch + 1 : ibatch + 1 - idata_split, train ? idata_split : ndata - idata_split, 0);
+            }
+        }
+        records_sync = helper_epoch_callback_records;
+
+        helper_free_ctx_data(cd);
+    }
+
+    const bool subtest_ok = records_epoch.size() == size_t(2*ndata) && records_epoch == records_sync;
+    print_ok(__func__, subtest_ok, npass, ntest);
+
+    return std::make_pair(npass, ntest);
+}
+
 static void helper_after_test_gradient_accumulation(
         enum ggml_opt_optimizer_type optim,
         const char * func, const int nbatch_physical, const enum ggml_opt_loss_type loss_type, const int epoch,
@@ -839,6 +1021,265 @@ static std::pair<int, int> test_regression(
     return std::make_pair(npass, ntest);
 }
 
+static ggml_opt_optimizer_params helper_get_momenta_opt_pars(void * userdata) {
+    ggml_opt_optimizer_params result = ggml_opt_get_default_optimizer_params(userdata);
+    result.adamw.alpha = 0.05f;
+    return result;
+}
+
+static std::pair<int, int> test_momenta_type(
+        ggml_backend_sched_t backend_sched, ggml_backend_t backend) {
+    int ntest = 0;
+    int npass = 0;
+
+    // Fit f(x) = a*x + b elementwise with BF16 and Q8_0 AdamW momenta and compare against F32 momenta
+
+    constexpr int64_t ne_momenta    = 64; // multiple of the Q8_0 block size
+    constexpr int64_t ndata_momenta = 128;
+    constexpr int64_t nbatch        = 16;
+    constexpr int64_t n_epoch       = 3; // 24 steps, before convergence
+
+    ggml_opt_dataset_t dataset = ggml_opt_dataset_init(
+        GGML_TYPE_F32, GGML_TYPE_F32, ne_momenta, ne_momenta, ndata_momenta, 1);
+    {
+        float * data   = ggml_get_data_f32(ggml_opt_dataset_data(  dataset));
+        float * labels = ggml_get_data_f32(ggml_opt_dataset_labels(dataset));
+
+        for (int64_t idata = 0; idata < ndata_momenta; ++idata) {
+            for (int64_t i = 0; i < ne_momenta; ++i) {
+                const float x = sinf(0.37f*idata + 0.11f*i);
+                data[  idata*ne_momenta + i] = x;
+                labels[idata*ne_momenta + i] = (0.5f + 0.03f*i)*x + 0.25f - 0.01f*i;
+            }
+        }
+    }
+
+    std::vector<float> params_ref;
+    for (enum ggml_type type_momenta : { GGML_TYPE_F32, GGML_TYPE_BF16, GGML_TYPE_Q8_0 }) {
+        bool skip;
+        {
+            // non-F32 momenta are not supported by every backend
+            struct ggml_init_params params = {
+                /*.mem_size   =*/ 6*ggml_tensor_overhead(),
+                /*.mem_buffer =*/ nullptr,
+                /*.no_alloc   =*/ true,
+            };
+            ggml_context * ctx = ggml_init(params);
+            ggml_tensor * a = ggml_new_tensor_1d(ctx, GGML_TYPE_F32, ne_momenta);
+            ggml_set_param(a);
+            ggml_tensor * g = ggml_new_tensor_1d(ctx, GGML_TYPE_F32, ne_momenta);
+            ggml_tensor * m = ggml_new_tensor_1d(ctx, type_momenta, ne_momenta);
+            ggml_tensor * v = ggml_new_tensor_1d(ctx, type_momenta, ne_momenta);
+            ggml_tensor * p = ggml_new_tensor_1d(ctx, GGML_TYPE_F32, 7);
+            skip = !ggml_backend_supports_op(backend, ggml_opt_step_adamw(ctx, a, g, m, v, p));
+            ggml_free(ctx);
+        }
+        if (skip) {
+            continue;
+        }
+
+        struct ggml_context * ctx_static;
+        struct ggml_context * ctx_compute;
+        {
+            struct ggml_init_params params = {
+                /*.mem_size   =*/ 3*ggml_tensor_overhead(),
+                /*.mem_buffer =*/ nullptr,
+                /*.no_alloc   =*/ true,
+            };
+            ctx_static = ggml_init(params);
+        }
+        {
+            struct ggml_init_params params = {
+                /*.mem_size   =*/ GGML_DEFAULT_GRAPH_SIZE*ggml_tensor_overhead() + 3*ggml_graph_overhead(),
+                /*.mem_buffer =*/ nullptr,
+                /*.no_alloc   =*/ true,
+            };
+            ctx_compute = ggml_init(params);
+        }
+
+        struct ggml_tensor * x = ggml_new_tensor_2d(ctx_static, GGML_TYPE_F32, ne_momenta, nbatch);
+        ggml_set_name(x, "x");
+
+        struct ggml_tensor * a = ggml_new_tensor_1d(ctx_static, GGML_TYPE_F32, ne_momenta);
+        ggml_set_name(a, "a");
+        ggml_set_param(a);
+
+        struct ggml_tensor * b = ggml_new_tensor_1d(ctx_static, GGML_TYPE_F32, ne_momenta);
+        ggml_set_name(b, "b");
+        ggml_set_param(b);
+
+        struct ggml_tensor * f = ggml_add(ctx_compute, ggml_mul(ctx_compute, x, a), b);
+        ggml_set_name(f, "f");
+
+        ggml_backend_buffer_t buf = ggml_backend_alloc_ctx_tensors(ctx_static, backend);
+        {
+            std::vector<float> tmp(ne_momenta, 0.0f);
+            ggml_backend_tensor_set(a, tmp.data(), 0, ggml_nbytes(a));
+            ggml_backend_tensor_set(b, tmp.data(), 0, ggml_nbytes(b));
+        }
+
+        struct ggml_opt_params opt_params = ggml_opt_default_params(backend_sched, GGML_OPT_LOSS_TYPE_MEAN_SQUARED_ERROR);
+        opt_params.ctx_compute  = ctx_compute;
+        opt_params.inputs       = x;
+        opt_params.outputs      = f;
+        opt_params.get_opt_pars = helper_get_momenta_opt_pars;
+        opt_params.optimizer    = GGML_OPT_OPTIMIZER_TYPE_ADAMW;
+        opt_params.type_momenta = type_momenta;
+        ggml_opt_context_t opt_ctx = ggml_opt_init(opt_params);
+
+        for (int64_t epoch = 0; epoch < n_epoch; ++epoch) {
+            ggml_opt_epoch(opt_ctx, dataset, nullptr, nullptr, ndata_momenta, nullptr, nullptr);
+        }
+
+        std::vector<float> params(2*ne_momenta);
+        ggml_backend_tensor_get(a, params.data(),              0, ggml_nbytes(a));
+        ggml_backend_tensor_get(b, params.data() + ne_momenta, 0, ggml_nbytes(b));
+
+        if (type_momenta == GGML_TYPE_F32) {
+            params_ref = params;
+        } else if (!params_ref.empty()) {
+            // the momenta are rounded but the updates should stay close to the ones with F32 momenta,
+            //     the tolerance is smaller than one step of size alpha
+            const double tol = type_momenta == GGML_TYPE_BF16 ? 2e-2 : 4e-2;
+            bool subtest_ok = true;
+            for (size_t i = 0; i < params.size(); ++i) {
+                subtest_ok = subtest_ok && std::isfinite(params[i]) && almost_equal(params[i], params_ref[i], tol);
+            }
+            char args[32];
+            snprintf(args, sizeof(args), "type_momenta=%s", ggml_type_name(type_momenta));
+            print_ok(__func__, subtest_ok, npass, ntest, args);
+        }
+
+        ggml_opt_free(opt_ctx);
+        ggml_backend_buffer_free(buf);
+        ggml_free(ctx_static);
+        ggml_free(ctx_compute);
+    }
+
+    ggml_opt_dataset_free(dataset);
+
+    return std::make_pair(npass, ntest);
+}
+
+static std::pair<int, int> test_checkpointing(
+    enum ggml_opt_optimizer_type optim, ggml_backend_t backend) {
+    int ntest = 0;
+    int npass = 0;
+
+    constexpr int     n_layers = 8;
+    constexpr int64_t ne_layer = 4;
+
+    // the compute buffers of a scheduler only grow, so each run gets its own scheduler to compare their sizes
+    std::vector<ggml_backend_t> backends = { backend };
+    if (ggml_backend_dev_type(ggml_backend_get_device(backend)) != GGML_BACKEND_DEVICE_TYPE_CPU) {
+        backends.push_back(ggml_backend_init_by_type(GGML_BACKEND_DEVICE_TYPE_CPU, nullptr));
+    }
+
+    std::vector<float> grads_ref;
+    size_t buf_size_ref = 0;
+    for (int32_t checkpoint_interval : {0, 3}) {
+        ggml_backend_sched_t backend_sched = ggml_backend_sched_new(
+            backends.data(), nullptr, backends.size(), GGML_DEFAULT_GRAPH_SIZE, false, true);
+
+        struct ggml_context * ctx_static;
+        struct ggml_context * ctx_compute;
+        {
+            struct ggml_init_params params = {
+                /*.mem_size   =*/ (n_layers + 1)*ggml_tensor_overhead(),
+                /*.mem_buffer =*/ nullptr,
+                /*.no_alloc   =*/ true,
+            };
+            ctx_static = ggml_init(params);
+        }
+        {
+            struct ggml_init_params params = {
+                /*.mem_size   =*/ GGML_DEFAULT_GRAPH_SIZE*ggml_tensor_overhead() + 3*ggml_graph_overhead(),
+                /*.mem_buffer =*/ nullptr,
+                /*.no_alloc   =*/ true,
+            };
+            ctx_compute = ggml_init(params);
+        }
+
+        struct ggml_tensor * inputs = ggml_new_tensor_2d(ctx_static, GGML_TYPE_F32, ne_layer, 1);
+        ggml_set_name(inputs, "inputs");
+
+        std::vector<struct ggml_tensor *> weights(n_layers);
+        struct ggml_tensor * cur = inputs;
+        for (int il = 0; il < n_layers; ++il) {
+            weights[il] = ggml_new_tensor_1d(ctx_static, GGML_TYPE_F32, ne_layer);
+            ggml_format_name(weights[il], "weights_%d", il);
+            ggml_set_param(weights[il]);
+            cur = ggml_silu(ctx_compute, ggml_mul(ctx_compute, cur, weights[il]));
+        }
+        struct ggml_tensor * outputs = cur;
+        ggml_set_name(outputs, "outputs");
+
+        ggml_backend_buffer_t buf = ggml_backend_alloc_ctx_tensors(ctx_static, backend);
+        {
+            std::vector<float> tmp(ne_layer);
+            for (int64_t i = 0; i < ne_layer; ++i) {
+                tmp[i] = 0.5f + 0.25f*i;
+            }
+            ggml_backend_tensor_set(inputs, tmp.data(), 0, ggml_nbytes(inputs));
+            for (int il = 0; il < n_layers; ++il) {
+                for (int64_t i = 0; i < ne_layer; ++i) {
+                    tmp[i] = 1.0f + 0.125f*((il + i) % 3);
+                }
+                ggml_backend_tensor_set(weights[il], tmp.data(), 0, ggml_nbytes(weights[il]));
+            }
+        }
+
+        struct ggml_opt_params opt_params = ggml_opt_default_params(backend_sched, GGML_OPT_LOSS_TYPE_SUM);
+        opt_params.ctx_compute         = ctx_compute;
+        opt_params.inputs              = inputs;
+        opt_params.outputs             = outputs;
+        opt_params.opt_period          = 2; // so that gradient accumulators exist
+        opt_params.optimizer           = optim;
+        opt_params.checkpoint_interval = checkpoint_interval;
+        ggml_opt_context_t opt_ctx = ggml_opt_init(opt_params);
+
+        ggml_opt_alloc(opt_ctx, /*backward =*/ true);
+        ggml_opt_eval(opt_ctx, nullptr);
+
+        std::vector<float> grads(n_layers*ne_layer);
+        for (int il = 0; il < n_layers; ++il) {
+            ggml_backend_tensor_get(ggml_opt_grad_acc(opt_ctx, weights[il]), grads.data() + il*ne_layer, 0, ggml_nbytes(weights[il]));
+        }
+
+        const size_t buf_size = ggml_backend_sched_get_buffer_size(backend_sched, backend);
+
+        if (checkpoint_interval == 0) {
+            grads_ref    = grads;
+            buf_size_ref = buf_size;
+        } else {
+            bool any_remat = false;
+            for (struct ggml_tensor * t = ggml_get_first_tensor(ctx_compute); t; t = ggml_get_next_tensor(ctx_compute, t)) {
+                any_remat = any_remat || strstr(ggml_get_name(t), "(remat)") != nullptr;
+            }
+            bool subtest_ok = any_remat;
+            for (size_t i = 0; i < grads.size(); ++i) {
+                subtest_ok = subtest_ok && std::isfinite(grads[i]) && almost_equal(grads[i], grads_ref[i], 1e-5);
+            }
+            print_ok(__func__, subtest_ok, npass, ntest, "subtest=grads");
+
+            // the activations between the checkpoints are not kept for the backward pass
+            print_ok(__func__, buf_size < buf_size_ref, npass, ntest, "subtest=buffer_size");
+        }
+
+        ggml_opt_free(opt_ctx);
+        ggml_backend_sched_free(backend_sched);
+        ggml_backend_buffer_free(buf);
+        ggml_free(ctx_static);
+        ggml_free(ctx_compute);
+    }
+
+    for (size_t i = 1; i < backends.size(); ++i) {
+        ggml_backend_free(backends[i]);
+    }
+
+    return std::make_pair(npass, ntest);
+}
+
 static std::pair<int, int> test_backend(
     ggml_backend_sched_t backend_sched, ggml_backend_t backend, enum ggml_opt_optimizer_type optim) {
     int npass = 0;
@@ -849,6 +1290,11 @@ static std::pair<int, int> test_backend(
         npass += partial.first;
         ntest += partial.second;
     }
+    {
+        std::pair<int, int> partial = test_dataset_out_of_core(optim, backend_sched, backend);
+        npass += partial.first;
+        ntest += partial.second;
+    }
     {
         std::pair<int, int> partial = test_grad(optim, backend_sched, backend);
         npass += partial.first;
@@ -875,6 +1321,11 @@ static std::pair<int, int> test_backend(
         npass += partial.first;
         ntest += partial.second;
     }
+    {
+        std::pair<int, int> partial = test_epoch_callbacks(optim, backend_sched, backend);
+        npass += partial.first;
+        ntest += partial.second;
+    }
     bool const adamw = optim == GGML_OPT_OPTIMIZER_TYPE_ADAMW;
     if (adamw) {
         for (int32_t nbatch_physical : { 2, 1 }) {
@@ -886,6 +1337,16 @@ static std::pair<int, int> test_backend(
             }
         }
     }
+    if (adamw) {
+        std::pair<int, int> partial = test_momenta_type(backend_sched, backend);
+        npass += partial.first;
+        ntest += partial.second;
+    }
+    {
+        std::pair<int, int> partial = test_checkpointing(optim, backend);
+        npass += partial.first;
+        ntest += partial.second;
+    }
     {
         std::pair<int, int> partial = test_regression(optim, backend_sched, backend);
         npass += partial.first;
@@ -70,6 +70,33 @@ static float reference_quantization_error(const ggml_type_traits * qfns, const g
     return array_rmse(tmp_out.data(), tmp_out_ref.data(), test_size);
 }
 
+// The K-quant quantizers of the CPU backend, also used by ggml_quantize_chunk without imatrix, must match the reference bit for bit
+static bool reference_quantization_identical(ggml_type type, const ggml_type_traits * qfns, const ggml_type_traits_cpu * qfns_cpu, size_t test_size, const float * test_data) {
+    std::vector<uint8_t> tmp_q(2*test_size);
+    std::vector<uint8_t> tmp_q_chunk(2*test_size);
+    std::vector<uint8_t> tmp_q_ref(2*test_size);
+
+    qfns_cpu->from_float(test_data, tmp_q.data(), test_size);
+    ggml_quantize_chunk(type, test_data, tmp_q_chunk.data(), 0, test_size/256, 256, nullptr);
+    qfns->from_float_ref(test_data, tmp_q_ref.data(), test_size);
+
+    return tmp_q == tmp_q_ref && tmp_q_chunk == tmp_q_ref;
+}
+
+// Multi-threaded quantization must match the single-threaded result bit for bit
+static bool quantize_mt_identical(ggml_type type, size_t test_size, const float * test_data) {
+    const int64_t n_per_row = 256;
+    const int64_t nrows     = test_size / n_per_row;
+
+    std::vector<uint8_t> tmp_q(ggml_row_size(type, n_per_row) * nrows);
+    std::vector<uint8_t> tmp_q_mt(ggml_row_size(type, n_per_row) * nrows);
+
+    ggml_quantize_chunk(type, test_data, tmp_q.data(), 0, nrows, n_per_row, nullptr);
+    ggml_quantize_chunk_mt(type, test_data, tmp_q_mt.data(), 0, nrows, n_per_row, nullptr, 4);
+
+    return tmp_q == tmp_q_mt;
+}
+
 static float dot_product(const float * a1, const float * a2, size_t test_size) {
     double sum = 0;
     for (size_t i = 0; i < test_size; i++) {
@@ -83,7 +110,7 @@ static float dot_product_error(const ggml_type_traits * qfns, const ggml_type_tr
     GGML_UNUSED(qfns);
 
     std::vector<uint8_t> tmp_q1(2*test_size);
-    std::vector<uint8_t> tmp_q2(2*test_size);
+    std::vector<uint8_t> tmp_q2(sizeof(float)*test_size);
 
     const auto * vdot = ggml_get_type_traits_cpu(qfns_cpu->vec_dot_type);
 
@@ -163,6 +190,20 @@ int main(int argc, char * argv[]) {
                 printf("%5s reference implementation error: %s (%f)\n", ggml_type_name(type), RESULT_STR[failed], reference_error);
             }
 
+            if (type == GGML_TYPE_Q4_K || type == GGML_TYPE_Q5_K || type == GGML_TYPE_Q6_K) {
+                failed = !reference_quantization_identical(type, qfns, qfns_cpu, test_size, test_data.data());
+                num_failed += failed;
+                if (failed || verbose) {
+                    printf("%5s reference implementation match: %s\n", ggml_type_name(type), RESULT_STR[failed]);
+                }
+            }
+
+            failed = !quantize_mt_identical(type, test_size, test_data.data());
+            num_failed += failed;
+            if (failed || verbose) {
+                printf("%5s multi-threaded quantization:    %s\n", ggml_type_name(type), RESULT_STR[failed]);
+            }
+
             const float vec_dot_error = dot_product_error(qfns, qfns_cpu, test_size, test_data.data(), test_data2.data());
             const float max_allowed_error = type == GGML_TYPE_Q2_K || type == GGML_TYPE_IQ2_XS || type == GGML_TYPE_IQ2_XXS ||
                                             type == GGML_TYPE_IQ3_XXS || type == GGML_TYPE_IQ3_S || type == GGML_TYPE_IQ2_S
@@ -0,0 +1,133 @@
+// Check that SUM, SUM_ROWS, MEAN and ARGMAX give bitwise identical results for any number of threads,
+// and that they agree with a reference
+
+#include "ggml.h"
+#include "ggml-cpu.h"
+
+#include "test-cpu-common.h"
+
+#undef NDEBUG
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+struct test_case {
+    int64_t ne[4];
+    bool    ties; // few distinct values, so that ARGMAX has to pick one of several maxima
+};
+
+// results of the graph, the outputs concatenated as raw bytes
+static std::vector<uint8_t> compute(const test_case & tc, int n_threads, bool & ok_ref) {
+    struct ggml_init_params ip = {
+        /*.mem_size   =*/ 64*1024*1024,
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ false,
+    };
+    struct ggml_context * ctx = ggml_init(ip);
+
+    struct ggml_tensor * a = ggml_new_tensor(ctx, GGML_TYPE_F32, 4, tc.ne);
+    test_fill(a, 1, 1.0f, 0.25f);
+
+    float * a_data = (float *) a->data;
+    if (tc.ties) {
+        for (int64_t i = 0; i < ggml_nelements(a); ++i) {
+            a_data[i] = floorf(4.0f*a_data[i]);
+        }
+    }
+
+    struct ggml_tensor * outs[] = {
+        ggml_sum     (ctx, a),
+        ggml_sum_rows(ctx, a),
+        ggml_mean    (ctx, a),
+        ggml_argmax  (ctx, ggml_reshape_2d(ctx, a, tc.ne[0], ggml_nrows(a))),
+    };
+
+    struct ggml_cgraph * gf = ggml_new_graph(ctx);
+    for (struct ggml_tensor * out : outs) {
+        ggml_set_output(out);
+        ggml_build_forward_expand(gf, out);
+    }
+
+    const enum ggml_status status = test_graph_compute(gf, n_threads);
+    assert(status == GGML_STATUS_SUCCESS);
+
+    std::vector<uint8_t> res;
+    for (struct ggml_tensor * out : outs) {
+        res.insert(res.end(), (const uint8_t *) out->data, (const uint8_t *) out->data + ggml_nbytes(out));
+    }
+
+    // reference in double precision, ARGMAX returns the last of the maxima as ggml_vec_argmax_f32
+    const int64_t ne0 = tc.ne[0];
+    const int64_t nr  = ggml_nrows(a);
+
+    double sum = 0.0;
+    double nrm = 0.0;
+    for (int64_t ir = 0; ir < nr; ++ir) {
+        const float * x = a_data + ir*ne0;
+
+        double  sum_row = 0.0;
+        double  nrm_row = 0.0;
+        int32_t imax    = 0;
+        for (int64_t i = 0; i < ne0; ++i) {
+            sum_row += x[i];
+            nrm_row += fabs(x[i]);
+            imax = x[i] >= x[imax] ? (int32_t) i : imax;
+        }
+        sum += sum_row;
+        nrm += nrm_row;
+
+        const float sum_rows = ((const float   *) outs[1]->data)[ir];
+        const float mean     = ((const float   *) outs[2]->data)[ir];
+        const int32_t argmax = ((const int32_t *) outs[3]->data)[ir];
+
+        ok_ref = ok_ref && fabs(sum_rows - sum_row) <= 1e-5*nrm_row;
+        ok_ref = ok_ref && fabs(mean - sum_row/ne0) <= 1e-5*nrm_row/ne0;
+        ok_ref = ok_ref && argmax == imax;
+    }
+    ok_ref = ok_ref && fabs(((const float *) outs[0]->data)[0] - sum) <= 1e-5*nrm;
+
+    ggml_free(ctx);
+
+    return res;
+}
+
+static bool test_reduce_threads(const test_case & tc) {
+    bool ok_ref = true;
+
+    const std::vector<uint8_t> res_1 = compute(tc, 1, ok_ref);
+
+    bool ok = ok_ref;
+    for (int n_threads : { 3, 8 }) {
+        const std::vector<uint8_t> res = compute(tc, n_threads, ok_ref);
+        ok = ok && ok_ref && res == res_1;
+    }
+
+    printf("%s: ne = [%6d, %4d, %d, %d], ties = %d: %s\n",
+            __func__, (int) tc.ne[0], (int) tc.ne[1], (int) tc.ne[2], (int) tc.ne[3], tc.ties, ok ? "OK" : "FAIL");
+
+    return ok;
+}
+
+int main(void) {
+    ggml_cpu_init();
+
+    const test_case cases[] = {
+        { {      7,    1, 1, 1 }, false },
+        { {    100,  300, 1, 1 }, false },
+        { {   1000,   33, 2, 3 }, true  },
+        { {   4097,    2, 2, 2 }, false }, // a chunk and a few elements per row
+        { {  50000,    3, 1, 1 }, true  },
+        { { 151936,    1, 1, 1 }, false }, // a vocabulary-sized row
+        { { 151936,    2, 1, 1 }, true  },
+        { {  20000,  300, 1, 1 }, false }, // enough rows to not split them
+    };
+
+    bool ok = true;
+    for (const test_case & tc : cases) {
+        ok = test_reduce_threads(tc) && ok;
+    }
+
+    return ok ? 0 : 1;
+}
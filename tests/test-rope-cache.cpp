@@ -0,0 +1,123 @@
+// Check that the RoPE sin/cos tables shared between the ROPE nodes of a graph survive the ops computed between them,
+// in particular the ops that clear or fill their whole work buffer
+
+#include "ggml.h"
+#include "ggml-cpu.h"
+
+#include "test-cpu-common.h"
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <vector>
+
+enum test_op {
+    TEST_OP_CONV_TRANSPOSE_1D,
+    TEST_OP_CONV_TRANSPOSE_2D,
+    TEST_OP_CONV_2D,
+};
+
+static const char * test_op_name(test_op op) {
+    switch (op) {
+        case TEST_OP_CONV_TRANSPOSE_1D: return "conv_transpose_1d";
+        case TEST_OP_CONV_TRANSPOSE_2D: return "conv_transpose_2d";
+        case TEST_OP_CONV_2D:           return "conv_2d";
+    }
+    return "?";
+}
+
+// ROPE -> op -> ROPE, the two ROPE nodes share a table
+static bool test_rope_cache(test_op op, int mode, int n_threads) {
+    struct ggml_init_params ip = {
+        /*.mem_size   =*/ 128*1024*1024,
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ false,
+    };
+    struct ggml_context * ctx = ggml_init(ip);
+
+    const int n_dims   = 64;
+    const int n_head   = 4;
+    const int n_tokens = 37;
+
+    struct ggml_tensor * pos = ggml_new_tensor_1d(ctx, GGML_TYPE_I32, n_tokens);
+    for (int i = 0; i < n_tokens; ++i) {
+        ((int32_t *) pos->data)[i] = 3*i + 1;
+    }
+
+    struct ggml_tensor * q = ggml_new_tensor_3d(ctx, GGML_TYPE_F32, n_dims, n_head, n_tokens);
+    struct ggml_tensor * k = ggml_new_tensor_3d(ctx, GGML_TYPE_F32, n_dims, n_head, n_tokens);
+    test_fill(q, 1, 1.0f);
+    test_fill(k, 2, 1.0f);
+
+    struct ggml_tensor * q_rope = ggml_rope_ext(ctx, q, pos, NULL, n_dims, mode, 0, 10000.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+
+    // the op depends on the first ROPE node so that it is computed between the two
+    struct ggml_tensor * cur = NULL;
+    switch (op) {
+        case TEST_OP_CONV_TRANSPOSE_1D:
+            {
+                struct ggml_tensor * a = ggml_new_tensor_3d(ctx, GGML_TYPE_F32, 5, 16, n_dims);
+                test_fill(a, 3, 0.5f);
+                cur = ggml_conv_transpose_1d(ctx, a, ggml_cont(ctx, ggml_transpose(ctx, ggml_view_2d(ctx, q_rope, n_dims, n_tokens, q_rope->nb[2], 0))), 1, 0, 1);
+            } break;
+        case TEST_OP_CONV_TRANSPOSE_2D:
+            {
+                struct ggml_tensor * a = ggml_new_tensor_4d(ctx, GGML_TYPE_F16, 3, 3, 8, n_head);
+                for (int64_t i = 0; i < ggml_nelements(a); ++i) {
+                    ((ggml_fp16_t *) a->data)[i] = ggml_fp32_to_fp16(0.1f*(i % 7));
+                }
+                cur = ggml_conv_transpose_2d_p0(ctx, a, ggml_reshape_4d(ctx, q_rope, 16, 4, n_head, n_tokens), 2);
+            } break;
+        case TEST_OP_CONV_2D:
+            {
+                // im2col with more patches than fit in its work buffer, so that it uses all of it
+                struct ggml_tensor * a = ggml_new_tensor_4d(ctx, GGML_TYPE_F32, 5, 5, 4, 16);
+                struct ggml_tensor * b = ggml_new_tensor_4d(ctx, GGML_TYPE_F32, 200, 200, 4, 1);
+                test_fill(a, 3, 0.5f);
+                test_fill(b, 4, 1.0f);
+                cur = ggml_conv_2d_direct(ctx, a, ggml_add(ctx, b, ggml_sum(ctx, q_rope)), 1, 1, 2, 2, 1, 1);
+            } break;
+    }
+    ggml_set_output(cur);
+
+    struct ggml_tensor * k_rope = ggml_rope_ext(ctx, k, pos, NULL, n_dims, mode, 0, 10000.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+    ggml_set_output(k_rope);
+
+    struct ggml_cgraph * gf = ggml_new_graph(ctx);
+    ggml_build_forward_expand(gf, cur);
+    ggml_build_forward_expand(gf, k_rope);
+
+    const std::vector<float> res = test_graph_compute_f32(gf, k_rope, n_threads);
+
+    // the reference ROPE node is alone in its graph, so it does not use a shared table
+    struct ggml_tensor * k_ref = ggml_rope_ext(ctx, k, pos, NULL, n_dims, mode, 0, 10000.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+
+    struct ggml_cgraph * gf_ref = ggml_new_graph(ctx);
+    ggml_build_forward_expand(gf_ref, k_ref);
+
+    const std::vector<float> ref = test_graph_compute_f32(gf_ref, k_ref, n_threads);
+
+    const double nmse = test_nmse(ref, res);
+
+    const bool ok = nmse < 1e-12;
+    printf("%s: %-17s mode = %d, n_threads = %d: nmse = %.3e %s\n", __func__, test_op_name(op), mode, n_threads, nmse, ok ? "OK" : "FAIL");
+
+    ggml_free(ctx);
+
+    return ok;
+}
+
+int main(void) {
+    ggml_cpu_init();
+
+    bool ok = true;
+    for (test_op op : { TEST_OP_CONV_TRANSPOSE_1D, TEST_OP_CONV_TRANSPOSE_2D, TEST_OP_CONV_2D }) {
+        for (int mode : { GGML_ROPE_TYPE_NORMAL, GGML_ROPE_TYPE_NEOX }) {
+            for (int n_threads : { 1, 3 }) {
+                ok = test_rope_cache(op, mode, n_threads) && ok;
+            }
+        }
+    }
+
+    return ok ? 0 : 1;
+}
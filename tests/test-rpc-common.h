@@ -0,0 +1,138 @@
+// Helpers of the tests that compute a graph with the scheduler on the CPU backend and a second backend:
+// an RPC server started in this process when the RPC backend is available, otherwise a second CPU backend
+//
+// the endpoint of the server is taken from GGML_TEST_RPC_ENDPOINT, or from --rpc, otherwise the server listens on a free port
+
+#pragma once
+
+#include "ggml.h"
+#include "ggml-backend.h"
+#include "ggml-cpu.h"
+
+#ifdef _WIN32
+#    define WIN32_LEAN_AND_MEAN
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <winsock2.h>
+#    ifdef _MSC_VER
+#        pragma comment(lib, "ws2_32.lib")
+#    endif
+#else
+#    include <arpa/inet.h>
+#    include <netinet/in.h>
+#    include <sys/socket.h>
+#    include <unistd.h>
+#endif
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef void               (*rpc_start_server_t)(const char * endpoint, const char * cache_dir, size_t n_threads, size_t n_devices, ggml_backend_dev_t * devices);
+typedef ggml_backend_reg_t (*rpc_add_server_t)(const char * endpoint);
+
+static inline int64_t time_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// deterministic data of a tensor of any buffer: sin(7*i + seed)*0.1
+static inline void fill(struct ggml_tensor * t, int seed) {
+    std::vector<float> data(ggml_nelements(t));
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = sinf((float) (i*7 + seed)) * 0.1f;
+    }
+    ggml_backend_tensor_set(t, data.data(), 0, ggml_nbytes(t));
+}
+
+// a port of 127.0.0.1 that no socket is bound to, 0 if none could be found
+static inline int test_rpc_free_port() {
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        return 0;
+    }
+    SOCKET fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == INVALID_SOCKET) {
+        return 0;
+    }
+    typedef int socklen_t;
+#else
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return 0;
+    }
+#endif
+
+    struct sockaddr_in addr = {};
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port        = 0;
+
+    int port = 0;
+    socklen_t len = sizeof(addr);
+    if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) == 0 && getsockname(fd, (struct sockaddr *) &addr, &len) == 0) {
+        port = ntohs(addr.sin_port);
+    }
+
+#ifdef _WIN32
+    closesocket(fd);
+#else
+    close(fd);
+#endif
+    return port;
+}
+
+// the second backend of the test: a device of the RPC server at endpoint, started in this process with the CPU device if endpoint
+// is empty, or a second CPU backend if the RPC backend or the server is not available
+static inline ggml_backend_t test_rpc_init_backend(std::string & endpoint, int n_threads) {
+    ggml_backend_t backend = nullptr;
+
+    ggml_backend_reg_t rpc_reg = ggml_backend_reg_by_name("RPC");
+    if (rpc_reg) {
+        auto start_server = (rpc_start_server_t) ggml_backend_reg_get_proc_address(rpc_reg, "ggml_backend_rpc_start_server");
+        auto add_server   = (rpc_add_server_t)   ggml_backend_reg_get_proc_address(rpc_reg, "ggml_backend_rpc_add_server");
+
+        const char * env = getenv("GGML_TEST_RPC_ENDPOINT");
+        if (endpoint.empty() && env != nullptr && env[0] != '\0') {
+            endpoint = env;
+        }
+
+        if (endpoint.empty() && start_server) {
+            const int port = test_rpc_free_port();
+            if (port != 0) {
+                endpoint = "127.0.0.1:" + std::to_string(port);
+                ggml_backend_dev_t dev = ggml_backend_dev_by_type(GGML_BACKEND_DEVICE_TYPE_CPU);
+                const std::string ep = endpoint;
+                const size_t nt = n_threads;
+                // the server runs until the process exits
+                std::thread([=]() mutable { start_server(ep.c_str(), nullptr, nt, 1, &dev); }).detach();
+            }
+        }
+
+        ggml_backend_reg_t reg = nullptr;
+        for (int attempt = 0; add_server && !endpoint.empty() && reg == nullptr && attempt < 50; ++attempt) {
+            reg = add_server(endpoint.c_str());
+            if (reg == nullptr) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        }
+        if (reg != nullptr && ggml_backend_reg_dev_count(reg) > 0) {
+            backend = ggml_backend_dev_init(ggml_backend_reg_dev_get(reg, 0), nullptr);
+        }
+        if (backend == nullptr) {
+            printf("RPC server %s not available, using a second CPU backend\n", endpoint.empty() ? "(none)" : endpoint.c_str());
+        }
+    }
+
+    if (backend == nullptr) {
+        backend = ggml_backend_cpu_init();
+        ggml_backend_cpu_set_n_threads(backend, n_threads);
+    }
+    return backend;
+}
@@ -0,0 +1,316 @@
+// Check the cost model placement of ggml_backend_sched and compare its speed with the default placement
+//
+// the scheduler uses a second backend with the weights on the CPU: an RPC server started in this process
+// when the RPC backend is available (or the server given with --rpc), otherwise a second CPU backend
+
+#include "ggml.h"
+#include "ggml-alloc.h"
+#include "ggml-backend.h"
+#include "ggml-cpu.h"
+
+#include "test-rpc-common.h"
+
+#undef NDEBUG
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct sched_cost_params {
+    int         n_threads = 2;
+    int         n_iter    = 5;
+    int64_t     n_embd    = 512;
+    int64_t     n_tokens  = 8;
+    int         n_layer   = 4;
+    std::string rpc;
+};
+
+struct model {
+    struct ggml_context * ctx = nullptr;
+    ggml_backend_buffer_t buf = nullptr;
+    std::vector<struct ggml_tensor *> w_up;
+    std::vector<struct ggml_tensor *> w_down;
+    std::vector<struct ggml_tensor *> norm;
+};
+
+static void model_init(model & m, const sched_cost_params & params) {
+    struct ggml_init_params ip = {
+        /*.mem_size   =*/ (size_t) 3*params.n_layer*ggml_tensor_overhead(),
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ true,
+    };
+    m.ctx = ggml_init(ip);
+
+    for (int il = 0; il < params.n_layer; ++il) {
+        m.w_up.push_back  (ggml_new_tensor_2d(m.ctx, GGML_TYPE_F32, params.n_embd, 4*params.n_embd));
+        m.w_down.push_back(ggml_new_tensor_2d(m.ctx, GGML_TYPE_F32, 4*params.n_embd, params.n_embd));
+        m.norm.push_back  (ggml_new_tensor_1d(m.ctx, GGML_TYPE_F32, params.n_embd));
+    }
+
+    m.buf = ggml_backend_alloc_ctx_tensors_from_buft(m.ctx, ggml_backend_cpu_buffer_type());
+    ggml_backend_buffer_set_usage(m.buf, GGML_BACKEND_BUFFER_USAGE_WEIGHTS);
+
+    for (int il = 0; il < params.n_layer; ++il) {
+        fill(m.w_up[il],   3*il + 1);
+        fill(m.w_down[il], 3*il + 2);
+        fill(m.norm[il],   3*il + 3);
+    }
+}
+
+// a stack of feed-forward blocks, a new graph for every use since the scheduler modifies the graph
+static struct ggml_cgraph * build_graph(struct ggml_context * ctx, const model & m, const sched_cost_params & params, struct ggml_tensor ** out) {
+    struct ggml_tensor * inp = ggml_new_tensor_2d(ctx, GGML_TYPE_F32, params.n_embd, params.n_tokens);
+    ggml_set_name(inp, "inp");
+    ggml_set_input(inp);
+
+    struct ggml_tensor * cur = inp;
+    for (int il = 0; il < params.n_layer; ++il) {
+        struct ggml_tensor * x = ggml_mul(ctx, ggml_rms_norm(ctx, cur, 1e-6f), m.norm[il]);
+        x = ggml_silu(ctx, ggml_mul_mat(ctx, m.w_up[il], x));
+        cur = ggml_add(ctx, cur, ggml_mul_mat(ctx, m.w_down[il], x));
+    }
+    ggml_set_output(cur);
+
+    struct ggml_cgraph * gf = ggml_new_graph(ctx);
+    ggml_build_forward_expand(gf, cur);
+    *out = cur;
+    return gf;
+}
+
+struct run_result {
+    std::vector<float> out;
+    double us;                                 // average time of a graph
+    double est_us;                             // estimated time of the graph
+    int    n_splits;
+    std::vector<ggml_backend_t> mul_mat_backends;
+    std::vector<ggml_backend_t> other_backends;
+};
+
+static run_result run(ggml_backend_sched_t sched, const model & m, const sched_cost_params & params, int n_iter) {
+    run_result res;
+
+    std::vector<float> x(params.n_embd*params.n_tokens);
+    for (size_t i = 0; i < x.size(); ++i) {
+        x[i] = cosf((float) i*0.11f);
+    }
+
+    res.us = 0.0;
+    for (int it = 0; it < n_iter + 1; ++it) {
+        struct ggml_init_params ip = {
+            /*.mem_size   =*/ ggml_tensor_overhead()*GGML_DEFAULT_GRAPH_SIZE + ggml_graph_overhead(),
+            /*.mem_buffer =*/ NULL,
+            /*.no_alloc   =*/ true,
+        };
+        struct ggml_context * ctx = ggml_init(ip);
+
+        struct ggml_tensor * out = nullptr;
+        struct ggml_cgraph * gf = build_graph(ctx, m, params, &out);
+
+        ggml_backend_sched_reset(sched);
+        const bool ok = ggml_backend_sched_alloc_graph(sched, gf);
+        assert(ok);
+        ggml_backend_tensor_set(ggml_graph_get_tensor(gf, "inp"), x.data(), 0, x.size()*sizeof(float));
+
+        const int64_t t0 = time_us();
+        const enum ggml_status status = ggml_backend_sched_graph_compute(sched, gf);
+        assert(status == GGML_STATUS_SUCCESS);
+        if (it > 0) { // the first run is a warmup
+            res.us += (double) (time_us() - t0)/n_iter;
+        }
+
+        if (it == n_iter) {
+            res.out.resize(ggml_nelements(out));
+            ggml_backend_tensor_get(out, res.out.data(), 0, ggml_nbytes(out));
+            res.est_us   = ggml_backend_sched_get_estimated_time(sched);
+            res.n_splits = ggml_backend_sched_get_n_splits(sched);
+            for (int i = 0; i < ggml_graph_n_nodes(gf); ++i) {
+                struct ggml_tensor * node = ggml_graph_node(gf, i);
+                if (node->op == GGML_OP_MUL_MAT) {
+                    res.mul_mat_backends.push_back(ggml_backend_sched_get_tensor_backend(sched, node));
+                } else if (node->op != GGML_OP_NONE) {
+                    res.other_backends.push_back(ggml_backend_sched_get_tensor_backend(sched, node));
+                }
+            }
+        }
+
+        ggml_free(ctx);
+    }
+
+    return res;
+}
+
+// the matrix multiplications are fast on the first backend, everything else on the CPU
+static double op_cost_split(ggml_backend_t backend, const struct ggml_tensor * op, void * user_data) {
+    const bool first = backend == (ggml_backend_t) user_data;
+    if (op->op == GGML_OP_MUL_MAT) {
+        return first ? 1.0 : 1000.0;
+    }
+    return first ? 1000.0 : 1.0;
+}
+
+static bool all_on(const std::vector<ggml_backend_t> & backends, ggml_backend_t backend) {
+    return std::all_of(backends.begin(), backends.end(), [&](ggml_backend_t b) { return b == backend; });
+}
+
+static void usage(char * argv[]) {
+    printf("Check the cost model placement of the scheduler and compare its speed with the default placement\n");
+    printf("\n");
+    printf("usage: %s [options]\n", argv[0]);
+    printf("\n");
+    printf("options: (default)\n");
+    printf("  -h, --help            show this help message and exit\n");
+    printf("  -t N, --threads N     number of threads of the CPU backends (2)\n");
+    printf("  -i N, --iterations N  number of timed graphs (5)\n");
+    printf("  -e N, --embd N        size of the model (512)\n");
+    printf("  -n N, --tokens N      number of tokens (8)\n");
+    printf("  --rpc HOST:PORT       use this RPC server instead of starting one\n");
+}
+
+int main(int argc, char * argv[]) {
+    sched_cost_params params;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            usage(argv);
+            return 0;
+        } else if ((arg == "-t" || arg == "--threads") && i + 1 < argc) {
+            params.n_threads = std::max(1, atoi(argv[++i]));
+        } else if ((arg == "-i" || arg == "--iterations") && i + 1 < argc) {
+            params.n_iter = std::max(1, atoi(argv[++i]));
+        } else if ((arg == "-e" || arg == "--embd") && i + 1 < argc) {
+            params.n_embd = std::max<int64_t>(32, atoll(argv[++i]));
+        } else if ((arg == "-n" || arg == "--tokens") && i + 1 < argc) {
+            params.n_tokens = std::max<int64_t>(1, atoll(argv[++i]));
+        } else if (arg == "--rpc" && i + 1 < argc) {
+            params.rpc = argv[++i];
+        } else {
+            fprintf(stderr, "error: unknown argument: %s\n", arg.c_str());
+            usage(argv);
+            return 1;
+        }
+    }
+
+    ggml_backend_t backend_cpu = ggml_backend_cpu_init();
+    ggml_backend_cpu_set_n_threads(backend_cpu, params.n_threads);
+
+    ggml_backend_t backend = test_rpc_init_backend(params.rpc, params.n_threads);
+    printf("backends: %s, %s\n", ggml_backend_name(backend), ggml_backend_name(backend_cpu));
+
+    model m;
+    model_init(m, params);
+
+    ggml_backend_t backends[2] = { backend, backend_cpu };
+    const bool copies = !ggml_backend_supports_buft(backend, ggml_backend_cpu_buffer_type());
+
+    bool ok = true;
+
+    // reference: everything on the CPU
+    run_result ref;
+    {
+        ggml_backend_sched_t sched = ggml_backend_sched_new(&backend_cpu, NULL, 1, GGML_DEFAULT_GRAPH_SIZE, false, false);
+        ref = run(sched, m, params, 1);
+        ggml_backend_sched_free(sched);
+    }
+
+    // the default placement
+    run_result def;
+    {
+        ggml_backend_sched_t sched = ggml_backend_sched_new(backends, NULL, 2, GGML_DEFAULT_GRAPH_SIZE, false, false);
+        def = run(sched, m, params, params.n_iter);
+        ggml_backend_sched_free(sched);
+    }
+    printf("default:    %10.1f us, %d splits\n", def.us, def.n_splits);
+
+    // op costs from a callback: the matrix multiplications go to the first backend in new splits
+    {
+        ggml_backend_sched_t sched = ggml_backend_sched_new(backends, NULL, 2, GGML_DEFAULT_GRAPH_SIZE, false, false);
+        ggml_backend_sched_set_op_cost(sched, op_cost_split, backend);
+        ggml_backend_sched_set_copy_cost(sched, backend_cpu, backend, 1.0, 1e6);
+        ggml_backend_sched_set_copy_cost(sched, backend, backend_cpu, 1.0, 1e6);
+
+        run_result res = run(sched, m, params, 1);
+        printf("callback:   %10.1f us, %d splits, estimated %.1f us\n", res.us, res.n_splits, res.est_us);
+
+        if (!all_on(res.mul_mat_backends, backend) || !all_on(res.other_backends, backend_cpu)) {
+            fprintf(stderr, "error: the ops are not placed on their fastest backend\n");
+            ok = false;
+        }
+        if (res.est_us < 0.0) {
+            fprintf(stderr, "error: no estimated time with the cost model\n");
+            ok = false;
+        }
+        if (res.out != ref.out) {
+            fprintf(stderr, "error: results differ with the cost model placement\n");
+            ok = false;
+        }
+
+        // copies more expensive than any gain: nothing moves to the first backend
+        if (copies) {
+            ggml_backend_sched_set_copy_cost(sched, backend_cpu, backend, 1e6, 1.0);
+            ggml_backend_sched_set_copy_cost(sched, backend, backend_cpu, 1e6, 1.0);
+
+            res = run(sched, m, params, 1);
+            if (!all_on(res.mul_mat_backends, backend_cpu) || !all_on(res.other_backends, backend_cpu)) {
+                fprintf(stderr, "error: ops moved despite the cost of the copies\n");
+                ok = false;
+            }
+        }
+
+        // disabled: the default placement
+        ggml_backend_sched_set_cost_model(sched, false);
+        res = run(sched, m, params, 1);
+        if (res.mul_mat_backends != def.mul_mat_backends || res.other_backends != def.other_backends) {
+            fprintf(stderr, "error: disabling the cost model does not restore the default placement\n");
+            ok = false;
+        }
+
+        ggml_backend_sched_free(sched);
+    }
+
+    // calibrated costs
+    {
+        ggml_backend_sched_t sched = ggml_backend_sched_new(backends, NULL, 2, GGML_DEFAULT_GRAPH_SIZE, false, false);
+
+        struct ggml_init_params ip = {
+            /*.mem_size   =*/ ggml_tensor_overhead()*GGML_DEFAULT_GRAPH_SIZE + ggml_graph_overhead(),
+            /*.mem_buffer =*/ NULL,
+            /*.no_alloc   =*/ true,
+        };
+        struct ggml_context * ctx = ggml_init(ip);
+        struct ggml_tensor * out = nullptr;
+        struct ggml_cgraph * gf = build_graph(ctx, m, params, &out);
+
+        const int64_t t0 = time_us();
+        const bool calibrated = ggml_backend_sched_calibrate(sched, gf, 3);
+        printf("calibrate:  %10.1f ms\n", (time_us() - t0)/1e3);
+        ggml_free(ctx);
+
+        if (!calibrated) {
+            fprintf(stderr, "error: calibration failed\n");
+            ok = false;
+        }
+
+        run_result res = run(sched, m, params, params.n_iter);
+        printf("calibrated: %10.1f us, %d splits, estimated %.1f us\n", res.us, res.n_splits, res.est_us);
+        printf("\nspeedup: %.3f\n", def.us/res.us);
+
+        if (res.out != ref.out) {
+            fprintf(stderr, "error: results differ with the calibrated placement\n");
+            ok = false;
+        }
+
+        ggml_backend_sched_free(sched);
+    }
+
+    ggml_backend_buffer_free(m.buf);
+    ggml_free(m.ctx);
+    ggml_backend_free(backend);
+    ggml_backend_free(backend_cpu);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,240 @@
+// Check the reuse of the splits of ggml_backend_sched between graphs with the same structure and measure the time saved
+//
+// the layers are assigned alternately to the CPU backend and to a second backend: an RPC server started in this process when the RPC backend is
+// available (or the server given with --rpc), otherwise a second CPU backend
+// the splits are reused while the number of tokens stays the same, and computed again when it changes
+
+#include "ggml.h"
+#include "ggml-alloc.h"
+#include "ggml-backend.h"
+#include "ggml-cpu.h"
+
+#include "test-rpc-common.h"
+
+#undef NDEBUG
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct sched_reuse_params {
+    int         n_threads = 2;
+    int         n_iter    = 20;
+    int64_t     n_embd    = 64;
+    int         n_layer   = 32;
+    std::string rpc;
+};
+
+struct model {
+    struct ggml_context * ctx = nullptr;
+    ggml_backend_buffer_t buf = nullptr;
+    std::vector<struct ggml_tensor *> w;
+    std::vector<struct ggml_tensor *> norm;
+};
+
+static void model_init(model & m, const sched_reuse_params & params) {
+    struct ggml_init_params ip = {
+        /*.mem_size   =*/ (size_t) 2*params.n_layer*ggml_tensor_overhead(),
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ true,
+    };
+    m.ctx = ggml_init(ip);
+
+    for (int il = 0; il < params.n_layer; ++il) {
+        m.w.push_back   (ggml_new_tensor_2d(m.ctx, GGML_TYPE_F32, params.n_embd, params.n_embd));
+        m.norm.push_back(ggml_new_tensor_1d(m.ctx, GGML_TYPE_F32, params.n_embd));
+    }
+
+    m.buf = ggml_backend_alloc_ctx_tensors_from_buft(m.ctx, ggml_backend_cpu_buffer_type());
+    ggml_backend_buffer_set_usage(m.buf, GGML_BACKEND_BUFFER_USAGE_WEIGHTS);
+
+    for (int il = 0; il < params.n_layer; ++il) {
+        fill(m.w[il],    2*il + 1);
+        fill(m.norm[il], 2*il + 2);
+    }
+}
+
+// a new graph for every step, as done for the tokens of a decoder
+static struct ggml_cgraph * build_graph(struct ggml_context * ctx, ggml_backend_sched_t sched, ggml_backend_t * backends,
+        const model & m, const sched_reuse_params & params, int64_t n_tokens, struct ggml_tensor ** out) {
+    struct ggml_tensor * inp = ggml_new_tensor_2d(ctx, GGML_TYPE_F32, params.n_embd, n_tokens);
+    ggml_set_name(inp, "inp");
+    ggml_set_input(inp);
+
+    struct ggml_tensor * cur = inp;
+    for (int il = 0; il < params.n_layer; ++il) {
+        struct ggml_tensor * x = ggml_mul(ctx, ggml_rms_norm(ctx, cur, 1e-6f), m.norm[il]);
+        struct ggml_tensor * y = ggml_mul_mat(ctx, m.w[il], x);
+        cur = ggml_add(ctx, cur, ggml_silu(ctx, y));
+        if (backends != nullptr) {
+            ggml_backend_sched_set_tensor_backend(sched, x, backends[il % 2]);
+            ggml_backend_sched_set_tensor_backend(sched, y, backends[il % 2]);
+        }
+    }
+    ggml_set_output(cur);
+
+    struct ggml_cgraph * gf = ggml_new_graph(ctx);
+    ggml_build_forward_expand(gf, cur);
+    *out = cur;
+    return gf;
+}
+
+struct step_result {
+    std::vector<float> out;
+    int64_t split_us; // time of ggml_backend_sched_alloc_graph
+    int     n_splits;
+};
+
+static step_result step(ggml_backend_sched_t sched, ggml_backend_t * backends, const model & m, const sched_reuse_params & params,
+        int64_t n_tokens, int seed) {
+    struct ggml_init_params ip = {
+        /*.mem_size   =*/ ggml_tensor_overhead()*GGML_DEFAULT_GRAPH_SIZE + ggml_graph_overhead(),
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ true,
+    };
+    struct ggml_context * ctx = ggml_init(ip);
+
+    ggml_backend_sched_reset(sched);
+
+    struct ggml_tensor * out = nullptr;
+    struct ggml_cgraph * gf = build_graph(ctx, sched, backends, m, params, n_tokens, &out);
+
+    step_result res;
+
+    const int64_t t0 = time_us();
+    const bool ok = ggml_backend_sched_alloc_graph(sched, gf);
+    res.split_us = time_us() - t0;
+    assert(ok);
+
+    std::vector<float> x(params.n_embd*n_tokens);
+    for (size_t i = 0; i < x.size(); ++i) {
+        x[i] = cosf((float) (i + seed)*0.11f);
+    }
+    ggml_backend_tensor_set(ggml_graph_get_tensor(gf, "inp"), x.data(), 0, x.size()*sizeof(float));
+
+    const enum ggml_status status = ggml_backend_sched_graph_compute(sched, gf);
+    assert(status == GGML_STATUS_SUCCESS);
+
+    res.out.resize(ggml_nelements(out));
+    ggml_backend_tensor_get(out, res.out.data(), 0, ggml_nbytes(out));
+    res.n_splits = ggml_backend_sched_get_n_splits(sched);
+
+    ggml_free(ctx);
+
+    return res;
+}
+
+static void usage(char * argv[]) {
+    printf("Check the reuse of the splits of the scheduler between graphs with the same structure\n");
+    printf("\n");
+    printf("usage: %s [options]\n", argv[0]);
+    printf("\n");
+    printf("options: (default)\n");
+    printf("  -h, --help            show this help message and exit\n");
+    printf("  -t N, --threads N     number of threads of the CPU backends (2)\n");
+    printf("  -i N, --iterations N  number of graphs (20)\n");
+    printf("  -e N, --embd N        size of the model (64)\n");
+    printf("  -l N, --layers N      number of layers (32)\n");
+    printf("  --rpc HOST:PORT       use this RPC server instead of starting one\n");
+}
+
+int main(int argc, char * argv[]) {
+    sched_reuse_params params;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            usage(argv);
+            return 0;
+        } else if ((arg == "-t" || arg == "--threads") && i + 1 < argc) {
+            params.n_threads = std::max(1, atoi(argv[++i]));
+        } else if ((arg == "-i" || arg == "--iterations") && i + 1 < argc) {
+            params.n_iter = std::max(4, atoi(argv[++i]));
+        } else if ((arg == "-e" || arg == "--embd") && i + 1 < argc) {
+            params.n_embd = std::max<int64_t>(32, atoll(argv[++i]));
+        } else if ((arg == "-l" || arg == "--layers") && i + 1 < argc) {
+            params.n_layer = std::max(2, atoi(argv[++i]));
+        } else if (arg == "--rpc" && i + 1 < argc) {
+            params.rpc = argv[++i];
+        } else {
+            fprintf(stderr, "error: unknown argument: %s\n", arg.c_str());
+            usage(argv);
+            return 1;
+        }
+    }
+
+    ggml_backend_t backend_cpu = ggml_backend_cpu_init();
+    ggml_backend_cpu_set_n_threads(backend_cpu, params.n_threads);
+
+    ggml_backend_t backend = test_rpc_init_backend(params.rpc, params.n_threads);
+    const bool copies = !ggml_backend_supports_buft(backend, ggml_backend_cpu_buffer_type());
+    printf("backends: %s, %s, %s\n", ggml_backend_name(backend), ggml_backend_name(backend_cpu),
+        copies ? "with copies" : "without copies");
+
+    model m;
+    model_init(m, params);
+
+    ggml_backend_t backends[2] = { backend, backend_cpu };
+
+    // two CPU backends need different buffer types, otherwise all the ops are moved to the first one
+    ggml_backend_buffer_type_t bufts[2] = {
+        copies ? ggml_backend_get_default_buffer_type(backend) : ggml_backend_cpu_hugepage_buffer_type(),
+        ggml_backend_cpu_buffer_type(),
+    };
+
+    ggml_backend_sched_t sched_ref = ggml_backend_sched_new(&backend_cpu, NULL, 1, GGML_DEFAULT_GRAPH_SIZE, false, false);
+    ggml_backend_sched_t sched     = ggml_backend_sched_new(backends, bufts, 2, GGML_DEFAULT_GRAPH_SIZE, false, false);
+
+    bool ok = true;
+
+    // the first half of the steps changes the number of tokens every time, the second half keeps it
+    const int n_half = params.n_iter/2;
+    int64_t t_miss = 0;
+    int64_t t_hit  = 0;
+    int n_splits = -1;
+    for (int it = 0; it < 2*n_half; ++it) {
+        const int64_t n_tokens = it < n_half ? 4 + 4*(it % 2) : 8;
+
+        const step_result ref = step(sched_ref, nullptr, m, params, n_tokens, it);
+        const step_result res = step(sched, backends, m, params, n_tokens, it);
+
+        if (it < n_half) {
+            t_miss += res.split_us;
+        } else if (it > n_half) { // the first graph with 8 tokens after a graph with 4 tokens is split again
+            t_hit += res.split_us;
+        }
+
+        if (res.out != ref.out) {
+            fprintf(stderr, "error: results differ from the reference at step %d (%d tokens)\n", it, (int) n_tokens);
+            ok = false;
+        }
+        if (n_tokens == 8) {
+            if (n_splits != -1 && res.n_splits != n_splits) {
+                fprintf(stderr, "error: %d splits at step %d instead of %d\n", res.n_splits, it, n_splits);
+                ok = false;
+            }
+            n_splits = res.n_splits;
+        }
+    }
+    printf("splits: %d\n", n_splits);
+    printf("alloc_graph: %8.1f us new splits, %8.1f us reused splits\n", (double) t_miss/n_half, (double) t_hit/(n_half - 1));
+
+    if (n_splits < params.n_layer) {
+        fprintf(stderr, "error: the layers are not split between the backends\n");
+        ok = false;
+    }
+
+    ggml_backend_sched_free(sched);
+    ggml_backend_sched_free(sched_ref);
+
+    ggml_backend_buffer_free(m.buf);
+    ggml_free(m.ctx);
+    ggml_backend_free(backend);
+    ggml_backend_free(backend_cpu);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,337 @@
+// Check the split buffer type: the weights of a stack of matrix multiplications are split by rows between two backends, the partial
+// products are computed concurrently and concatenated, and the result is compared with a single CPU backend
+// two graphs using the same weights are computed alternately with the same scheduler, which must not modify them
+//
+// the second backend is an RPC server started in this process when the RPC backend is available (or the server given with --rpc),
+// otherwise a second CPU backend
+
+#include "ggml.h"
+#include "ggml-alloc.h"
+#include "ggml-backend.h"
+#include "ggml-cpu.h"
+
+#include "test-rpc-common.h"
+
+#undef NDEBUG
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct split_buffer_params {
+    int         n_threads = 2;
+    int         n_iter    = 10;
+    int64_t     n_embd    = 256;
+    int64_t     n_tokens  = 8;
+    int         n_layer   = 8;
+    float       split[2]  = { 1.0f, 3.0f };
+    std::string rpc;
+};
+
+struct model {
+    struct ggml_context * ctx = nullptr;
+    ggml_backend_buffer_t buf = nullptr;
+    std::vector<struct ggml_tensor *> w; // [n_embd, n_embd] split between the backends
+    std::vector<struct ggml_tensor *> b; // [n_embd, 1] in a single part
+};
+
+static std::vector<float> data(const struct ggml_tensor * t, int seed) {
+    std::vector<float> res(ggml_nelements(t));
+    for (size_t i = 0; i < res.size(); ++i) {
+        res[i] = sinf((float) (i*7 + seed)) * 0.1f;
+    }
+    return res;
+}
+
+static bool model_init(model & m, const split_buffer_params & params, ggml_backend_buffer_type_t buft) {
+    struct ggml_init_params ip = {
+        /*.mem_size   =*/ (size_t) 2*params.n_layer*ggml_tensor_overhead(),
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ true,
+    };
+    m.ctx = ggml_init(ip);
+
+    for (int il = 0; il < params.n_layer; ++il) {
+        m.w.push_back(ggml_new_tensor_2d(m.ctx, GGML_TYPE_F32, params.n_embd, params.n_embd));
+        m.b.push_back(ggml_new_tensor_1d(m.ctx, GGML_TYPE_F32, params.n_embd));
+        ggml_format_name(m.w[il], "w%d", il);
+        ggml_format_name(m.b[il], "b%d", il);
+    }
+
+    m.buf = ggml_backend_alloc_ctx_tensors_from_buft(m.ctx, buft);
+    ggml_backend_buffer_set_usage(m.buf, GGML_BACKEND_BUFFER_USAGE_WEIGHTS);
+
+    bool ok = true;
+    const char * base = (const char *) ggml_backend_buffer_get_base(m.buf);
+    for (int il = 0; il < params.n_layer; ++il) {
+        for (struct ggml_tensor * t : { m.w[il], m.b[il] }) {
+            // the tensors have a valid address in the buffer, even if their data is in other buffers
+            if ((const char *) t->data < base || (const char *) t->data + ggml_nbytes(t) > base + ggml_backend_buffer_get_size(m.buf)) {
+                fprintf(stderr, "error: %s: the address of %s is not in the buffer\n", t->name, ggml_backend_buft_name(buft));
+                ok = false;
+            }
+
+            const std::vector<float> src = data(t, 2*il + (t == m.b[il]));
+            ggml_backend_tensor_set(t, src.data(), 0, ggml_nbytes(t));
+
+            std::vector<float> dst(src.size());
+            ggml_backend_tensor_get(t, dst.data(), 0, ggml_nbytes(t));
+            if (dst != src) {
+                fprintf(stderr, "error: %s: the data read from %s differs from the data written\n", t->name, ggml_backend_buft_name(buft));
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+static void model_free(model & m) {
+    ggml_backend_buffer_free(m.buf);
+    ggml_free(m.ctx);
+}
+
+struct run_result {
+    std::vector<float> out[2];    // outputs of the two graphs
+    double             compute_us; // best time of ggml_backend_sched_graph_compute of the first graph
+    int                n_splits;
+    bool               unchanged;  // the graphs of the user are not modified by the scheduler
+};
+
+// ops and sources of the nodes of a graph
+struct node_state {
+    enum ggml_op         op;
+    struct ggml_tensor * src[GGML_MAX_SRC];
+};
+
+static std::vector<node_state> graph_state(struct ggml_cgraph * gf) {
+    std::vector<node_state> state;
+    for (int i = 0; i < ggml_graph_n_nodes(gf); ++i) {
+        struct ggml_tensor * node = ggml_graph_node(gf, i);
+        node_state ns;
+        ns.op = node->op;
+        for (int j = 0; j < GGML_MAX_SRC; ++j) {
+            ns.src[j] = node->src[j];
+        }
+        state.push_back(ns);
+    }
+    return state;
+}
+
+// the scheduler may only replace a source with its copy in another backend
+static bool graph_unchanged(struct ggml_cgraph * gf, const std::vector<node_state> & state) {
+    if (ggml_graph_n_nodes(gf) != (int) state.size()) {
+        return false;
+    }
+    for (int i = 0; i < ggml_graph_n_nodes(gf); ++i) {
+        struct ggml_tensor * node = ggml_graph_node(gf, i);
+        if (node->op != state[i].op) {
+            return false;
+        }
+        for (int j = 0; j < GGML_MAX_SRC; ++j) {
+            struct ggml_tensor * src  = node->src[j];
+            struct ggml_tensor * orig = state[i].src[j];
+            if (src != orig && (src == nullptr || orig == nullptr || src->type != orig->type || !ggml_are_same_shape(src, orig))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// the second graph uses the layers in the reverse order
+static struct ggml_cgraph * build_graph(struct ggml_context * ctx, const model & m, const split_buffer_params & params, int ig,
+        struct ggml_tensor ** inp, struct ggml_tensor ** out) {
+    *inp = ggml_new_tensor_2d(ctx, GGML_TYPE_F32, params.n_embd, params.n_tokens);
+    ggml_format_name(*inp, "inp%d", ig);
+    ggml_set_input(*inp);
+
+    struct ggml_tensor * cur = *inp;
+    for (int k = 0; k < params.n_layer; ++k) {
+        const int il = ig == 0 ? k : params.n_layer - 1 - k;
+        cur = ggml_mul_mat(ctx, m.w[il], ggml_rms_norm(ctx, cur, 1e-6f));
+        cur = ig == 0 ? ggml_silu(ctx, ggml_add(ctx, cur, m.b[il])) : ggml_gelu(ctx, ggml_mul(ctx, cur, m.b[il]));
+    }
+    *out = cur;
+    ggml_set_output(*out);
+
+    struct ggml_cgraph * gf = ggml_new_graph(ctx);
+    ggml_build_forward_expand(gf, *out);
+    return gf;
+}
+
+// two different graphs are computed alternately with the same scheduler
+// the graphs are built again for each computation: the scheduler replaces the sources of the nodes with their copies in the
+// other backends, so a graph that needs copies cannot be split twice
+static run_result run(ggml_backend_sched_t sched, const model & m, const split_buffer_params & params) {
+    struct ggml_init_params ip = {
+        /*.mem_size   =*/ ggml_tensor_overhead()*GGML_DEFAULT_GRAPH_SIZE + ggml_graph_overhead(),
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ true,
+    };
+
+    std::vector<float> x(params.n_embd*params.n_tokens);
+    for (size_t i = 0; i < x.size(); ++i) {
+        x[i] = cosf((float) i*0.11f);
+    }
+
+    run_result res;
+    res.compute_us = INFINITY;
+    res.unchanged  = true;
+    for (int it = 0; it < params.n_iter; ++it) {
+        for (int ig = 0; ig < 2; ++ig) {
+            struct ggml_context * ctx = ggml_init(ip);
+
+            struct ggml_tensor * inp;
+            struct ggml_tensor * out;
+            struct ggml_cgraph * gf = build_graph(ctx, m, params, ig, &inp, &out);
+            const std::vector<node_state> state = graph_state(gf);
+
+            ggml_backend_sched_reset(sched);
+            const bool ok = ggml_backend_sched_alloc_graph(sched, gf);
+            assert(ok);
+
+            // the memory of the input can be reused by the graph
+            ggml_backend_tensor_set(inp, x.data(), 0, x.size()*sizeof(float));
+
+            const int64_t t0 = time_us();
+            const enum ggml_status status = ggml_backend_sched_graph_compute(sched, gf);
+            if (ig == 0) {
+                res.compute_us = std::min(res.compute_us, (double) (time_us() - t0));
+                res.n_splits   = ggml_backend_sched_get_n_splits(sched);
+            }
+            assert(status == GGML_STATUS_SUCCESS);
+
+            res.out[ig].resize(ggml_nelements(out));
+            ggml_backend_tensor_get(out, res.out[ig].data(), 0, ggml_nbytes(out));
+            res.unchanged = res.unchanged && graph_unchanged(gf, state);
+
+            ggml_free(ctx);
+        }
+    }
+
+    return res;
+}
+
+static void usage(char * argv[]) {
+    printf("Check the matrix multiplications with the weights split between two backends\n");
+    printf("\n");
+    printf("usage: %s [options]\n", argv[0]);
+    printf("\n");
+    printf("options: (default)\n");
+    printf("  -h, --help            show this help message and exit\n");
+    printf("  -t N, --threads N     number of threads of each CPU backend (2)\n");
+    printf("  -i N, --iterations N  number of timed graphs (10)\n");
+    printf("  -e N, --embd N        size of the weights (256)\n");
+    printf("  -n N, --tokens N      number of tokens (8)\n");
+    printf("  -l N, --layers N      number of layers (8)\n");
+    printf("  -s A,B, --split A,B   proportion of the rows of each backend (1,3)\n");
+    printf("  --rpc HOST:PORT       use this RPC server instead of starting one\n");
+}
+
+int main(int argc, char * argv[]) {
+    split_buffer_params params;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            usage(argv);
+            return 0;
+        } else if ((arg == "-t" || arg == "--threads") && i + 1 < argc) {
+            params.n_threads = std::max(1, atoi(argv[++i]));
+        } else if ((arg == "-i" || arg == "--iterations") && i + 1 < argc) {
+            params.n_iter = std::max(1, atoi(argv[++i]));
+        } else if ((arg == "-e" || arg == "--embd") && i + 1 < argc) {
+            params.n_embd = std::max<int64_t>(4, atoll(argv[++i]));
+        } else if ((arg == "-n" || arg == "--tokens") && i + 1 < argc) {
+            params.n_tokens = std::max<int64_t>(1, atoll(argv[++i]));
+        } else if ((arg == "-l" || arg == "--layers") && i + 1 < argc) {
+            params.n_layer = std::max(1, atoi(argv[++i]));
+        } else if ((arg == "-s" || arg == "--split") && i + 1 < argc) {
+            if (sscanf(argv[++i], "%f,%f", &params.split[0], &params.split[1]) != 2 ||
+                params.split[0] < 0.0f || params.split[1] < 0.0f || params.split[0] + params.split[1] <= 0.0f) {
+                fprintf(stderr, "error: invalid split: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (arg == "--rpc" && i + 1 < argc) {
+            params.rpc = argv[++i];
+        } else {
+            fprintf(stderr, "error: unknown argument: %s\n", arg.c_str());
+            usage(argv);
+            return 1;
+        }
+    }
+
+    ggml_backend_t backend_cpu = ggml_backend_cpu_init();
+    ggml_backend_cpu_set_n_threads(backend_cpu, params.n_threads);
+
+    ggml_backend_t backend = test_rpc_init_backend(params.rpc, params.n_threads);
+
+    ggml_backend_t backends[2] = { backend, backend_cpu };
+
+    // two CPU backends need different buffer types, otherwise all the ops are moved to the first one
+    const bool is_cpu = ggml_backend_supports_buft(backend, ggml_backend_cpu_buffer_type());
+    ggml_backend_buffer_type_t bufts[2] = {
+        is_cpu ? ggml_backend_cpu_hugepage_buffer_type() : ggml_backend_get_default_buffer_type(backend),
+        ggml_backend_cpu_buffer_type(),
+    };
+
+    ggml_backend_buffer_type_t buft_split = ggml_backend_split_buffer_type(bufts, params.split, 2);
+    assert(ggml_backend_buft_is_split(buft_split));
+    assert(!ggml_backend_buft_is_split(ggml_backend_cpu_buffer_type()));
+    assert(ggml_backend_split_buffer_type(bufts, params.split, 2) == buft_split);
+    printf("backends: %s, %s\n", ggml_backend_name(backend), ggml_backend_name(backend_cpu));
+    printf("buffer type: %s, split %g,%g\n", ggml_backend_buft_name(buft_split), params.split[0], params.split[1]);
+
+    bool ok = true;
+
+    model m_ref;
+    model m;
+    ok = model_init(m_ref, params, ggml_backend_cpu_buffer_type()) && ok;
+    ok = model_init(m, params, buft_split) && ok;
+
+    ggml_backend_sched_t sched_ref = ggml_backend_sched_new(&backend_cpu, NULL, 1, GGML_DEFAULT_GRAPH_SIZE, false, false);
+    ggml_backend_sched_t sched     = ggml_backend_sched_new(backends, bufts, 2, GGML_DEFAULT_GRAPH_SIZE, false, false);
+
+    const run_result ref = run(sched_ref, m_ref, params);
+    const run_result res = run(sched, m, params);
+
+    printf("splits: %d\n", res.n_splits);
+    printf("compute: %10.1f us single backend, %10.1f us split, speedup %.3f\n", ref.compute_us, res.compute_us, ref.compute_us/res.compute_us);
+
+    for (int ig = 0; ig < 2; ++ig) {
+        double max_err = 0.0;
+        for (size_t i = 0; i < ref.out[ig].size(); ++i) {
+            max_err = std::max(max_err, (double) fabsf(res.out[ig][i] - ref.out[ig][i]));
+        }
+        printf("graph %d: max error: %g\n", ig, max_err);
+        if (!(max_err < 1e-4)) {
+            fprintf(stderr, "error: results of graph %d differ from the single backend\n", ig);
+            ok = false;
+        }
+    }
+    if (!res.unchanged) {
+        fprintf(stderr, "error: the graphs were modified by the scheduler\n");
+        ok = false;
+    }
+
+    // the partial products of every layer are in splits of their own when both parts have rows
+    const bool both = (int64_t) (params.n_embd*params.split[0]/(params.split[0] + params.split[1])) > 0 && params.split[1] > 0.0f;
+    if (both && res.n_splits < 2*params.n_layer) {
+        fprintf(stderr, "error: %d splits, the matrix multiplications are not split between the backends\n", res.n_splits);
+        ok = false;
+    }
+
+    ggml_backend_sched_free(sched);
+    ggml_backend_sched_free(sched_ref);
+
+    model_free(m);
+    model_free(m_ref);
+    ggml_backend_free(backend);
+    ggml_backend_free(backend_cpu);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+// Check that the chunked multi-threaded Mamba-2 SSM_SCAN matches the sequential scan
+
+#include "ggml.h"
+#include "ggml-cpu.h"
+
+#include "test-cpu-common.h"
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <vector>
+
+struct test_case {
+    int64_t d_state;
+    int64_t head_dim;
+    int64_t n_head;
+    int64_t n_group;
+    int64_t n_seq_tokens;
+    int64_t n_seqs;
+};
+
+static bool test_ssm_scan(const test_case & tc, int n_threads) {
+    struct ggml_init_params ip = {
+        /*.mem_size   =*/ 64*1024*1024,
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ false,
+    };
+    struct ggml_context * ctx = ggml_init(ip);
+
+    struct ggml_tensor * s   = ggml_new_tensor_4d(ctx, GGML_TYPE_F32, tc.d_state, tc.head_dim, tc.n_head, tc.n_seqs);
+    struct ggml_tensor * x   = ggml_new_tensor_4d(ctx, GGML_TYPE_F32, tc.head_dim, tc.n_head, tc.n_seq_tokens, tc.n_seqs);
+    struct ggml_tensor * dt  = ggml_new_tensor_3d(ctx, GGML_TYPE_F32, tc.n_head, tc.n_seq_tokens, tc.n_seqs);
+    struct ggml_tensor * A   = ggml_new_tensor_2d(ctx, GGML_TYPE_F32, 1, tc.n_head);
+    struct ggml_tensor * B   = ggml_new_tensor_4d(ctx, GGML_TYPE_F32, tc.d_state, tc.n_group, tc.n_seq_tokens, tc.n_seqs);
+    struct ggml_tensor * C   = ggml_new_tensor_4d(ctx, GGML_TYPE_F32, tc.d_state, tc.n_group, tc.n_seq_tokens, tc.n_seqs);
+    struct ggml_tensor * ids = ggml_new_tensor_1d(ctx, GGML_TYPE_I32, tc.n_seqs);
+
+    test_fill(s, 1, 0.5f, 0.0f);
+    test_fill(x, 2, 1.0f, 0.0f);
+    test_fill(dt, 3, 2.0f, -2.0f);
+    test_fill(A, 4, 0.4f, -0.5f);
+    test_fill(B, 5, 0.5f, 0.0f);
+    test_fill(C, 6, 0.5f, 0.0f);
+    for (int64_t i = 0; i < tc.n_seqs; ++i) {
+        ((int32_t *) ids->data)[i] = (int32_t) (tc.n_seqs - 1 - i);
+    }
+
+    struct ggml_tensor * out = ggml_ssm_scan(ctx, s, x, dt, A, B, C, ids);
+
+    struct ggml_cgraph * gf = ggml_new_graph(ctx);
+    ggml_build_forward_expand(gf, out);
+
+    // a single thread always runs the sequential scan
+    const std::vector<float> ref = test_graph_compute_f32(gf, out, 1);
+    const std::vector<float> res = test_graph_compute_f32(gf, out, n_threads);
+
+    const double nmse = test_nmse(ref, res);
+
+    const bool ok = nmse < 1e-9;
+    printf("%s: d_state = %3d, head_dim = %3d, n_head = %2d, n_group = %d, n_seq_tokens = %4d, n_seqs = %d, n_threads = %d: nmse = %.3e %s\n",
+            __func__, (int) tc.d_state, (int) tc.head_dim, (int) tc.n_head, (int) tc.n_group, (int) tc.n_seq_tokens, (int) tc.n_seqs,
+            n_threads, nmse, ok ? "OK" : "FAIL");
+
+    ggml_free(ctx);
+
+    return ok;
+}
+
+int main(void) {
+    ggml_cpu_init();
+
+    const test_case cases[] = {
+        { 16,  8, 1, 1,  700, 1 },
+        { 16,  8, 2, 1,  700, 2 },
+        { 32, 16, 4, 2, 1000, 1 },
+        { 64, 16, 2, 2,  300, 3 },
+        { 16,  8, 2, 1,   64, 1 }, // too short to be split
+    };
+
+    bool ok = true;
+    for (const test_case & tc : cases) {
+        ok = test_ssm_scan(tc, 8) && ok;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+// Check GGML_OP_TOP_K against a stable sort of each row and against ggml_top_k (argsort + view)
+
+#include "ggml.h"
+#include "ggml-cpu.h"
+
+#include "test-cpu-common.h"
+
+#undef NDEBUG
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+#include <numeric>
+#include <stdio.h>
+#include <vector>
+
+enum test_data {
+    TEST_DATA_DISTINCT,
+    TEST_DATA_TIES,  // few distinct values
+    TEST_DATA_EQUAL, // all the values of a row are equal
+};
+
+struct test_case {
+    int64_t   ne0;
+    int64_t   nrows;
+    int       k;
+    test_data data;
+};
+
+static bool test_top_k(const test_case & tc, int n_threads) {
+    struct ggml_init_params ip = {
+        /*.mem_size   =*/ 64*1024*1024,
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ false,
+    };
+    struct ggml_context * ctx = ggml_init(ip);
+
+    struct ggml_tensor * a = ggml_new_tensor_2d(ctx, GGML_TYPE_F32, tc.ne0, tc.nrows);
+    test_fill(a, 1, 1.0f);
+
+    float * a_data = (float *) a->data;
+    for (int64_t i = 0; i < ggml_nelements(a); ++i) {
+        switch (tc.data) {
+            case TEST_DATA_DISTINCT: break;
+            case TEST_DATA_TIES:     a_data[i] = floorf(4.0f*a_data[i]); break;
+            case TEST_DATA_EQUAL:    a_data[i] = 0.5f; break;
+        }
+    }
+
+    struct ggml_tensor * values = NULL;
+    struct ggml_tensor * ids    = ggml_top_k_ext(ctx, a, tc.k, &values);
+    struct ggml_tensor * ids_as = ggml_top_k(ctx, a, tc.k);
+
+    ggml_set_output(ids);
+    ggml_set_output(values);
+
+    struct ggml_cgraph * gf = ggml_new_graph(ctx);
+    ggml_build_forward_expand(gf, values);
+    ggml_build_forward_expand(gf, ids_as);
+
+    const enum ggml_status status = test_graph_compute(gf, n_threads);
+    assert(status == GGML_STATUS_SUCCESS);
+
+    bool ok = true;
+
+    std::vector<int32_t> ref(tc.ne0);
+    for (int64_t ir = 0; ir < tc.nrows && ok; ++ir) {
+        const float * x = a_data + ir*tc.ne0;
+
+        // the k largest values, ties in the order of the indices
+        std::iota(ref.begin(), ref.end(), 0);
+        std::stable_sort(ref.begin(), ref.end(), [x](int32_t i, int32_t j) { return x[i] > x[j]; });
+
+        const int32_t * res    = (const int32_t *) ((const char *) ids->data    + ir*ids->nb[1]);
+        const float   * res_v  = (const float   *) ((const char *) values->data + ir*values->nb[1]);
+        const int32_t * res_as = (const int32_t *) ((const char *) ids_as->data + ir*ids_as->nb[1]);
+
+        for (int j = 0; j < tc.k; ++j) {
+            // argsort does not order the ties, so only the values are compared
+            ok = ok && res[j] == ref[j] && res_v[j] == x[ref[j]] && x[res_as[j]] == x[ref[j]];
+        }
+    }
+
+    static const char * data_names[] = { "distinct", "ties", "equal" };
+    printf("%s: ne0 = %6d, nrows = %3d, k = %4d, %-8s n_threads = %d: %s\n",
+            __func__, (int) tc.ne0, (int) tc.nrows, tc.k, data_names[tc.data], n_threads, ok ? "OK" : "FAIL");
+
+    ggml_free(ctx);
+
+    return ok;
+}
+
+int main(void) {
+    ggml_cpu_init();
+
+    const test_case cases[] = {
+        {     10,   7,   10, TEST_DATA_DISTINCT }, // k == ne0
+        {     10,   7,   10, TEST_DATA_TIES     },
+        {     33,   5,   33, TEST_DATA_EQUAL    },
+        {    100, 300,    8, TEST_DATA_DISTINCT },
+        {    100, 300,    8, TEST_DATA_TIES     },
+        {   1000,  16,  100, TEST_DATA_TIES     },
+        {   1000,   4,    1, TEST_DATA_EQUAL    },
+        // few wide rows, split into chunks
+        { 100000,   1,   40, TEST_DATA_DISTINCT },
+        { 100000,   2,   40, TEST_DATA_TIES     },
+        {  50000,   3,  500, TEST_DATA_TIES     },
+        {  20000,   1,   64, TEST_DATA_EQUAL    },
+        {   8192,   1, 8192, TEST_DATA_TIES     }, // k == ne0
+    };
+
+    bool ok = true;
+    for (const test_case & tc : cases) {
+        for (int n_threads : { 1, 4 }) {
+            ok = test_top_k(tc, n_threads) && ok;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
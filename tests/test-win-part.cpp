@@ -0,0 +1,81 @@
+// Check WIN_PART and WIN_UNPART on batches of images against a reference partition
+
+#include "ggml.h"
+#include "ggml-cpu.h"
+
+#include "test-cpu-common.h"
+
+#undef NDEBUG
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static bool test_win_part(int64_t c, int64_t w0, int64_t h0, int64_t n, int w, int n_threads) {
+    struct ggml_init_params ip = {
+        /*.mem_size   =*/ 64*1024*1024,
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ false,
+    };
+    struct ggml_context * ctx = ggml_init(ip);
+
+    struct ggml_tensor * a = ggml_new_tensor_4d(ctx, GGML_TYPE_F32, c, w0, h0, n);
+    test_fill(a, 0, 1.0f);
+
+    struct ggml_tensor * part   = ggml_win_part(ctx, a, w);
+    struct ggml_tensor * unpart = ggml_win_unpart(ctx, part, (int) w0, (int) h0, w);
+
+    struct ggml_cgraph * gf = ggml_new_graph(ctx);
+    ggml_build_forward_expand(gf, unpart);
+
+    const enum ggml_status status = test_graph_compute(gf, n_threads);
+    assert(status == GGML_STATUS_SUCCESS);
+
+    const int64_t npx = (w0 + w - 1)/w;
+    const int64_t npy = (h0 + w - 1)/w;
+
+    bool ok = part->ne[3] == npx*npy*n && ggml_are_same_shape(a, unpart);
+
+    // window (px, py) of image i3 is window (i3*npy + py)*npx + px, padded with zeros
+    for (int64_t i3 = 0; i3 < n && ok; ++i3) {
+        for (int64_t py = 0; py < npy; ++py) {
+            for (int64_t px = 0; px < npx; ++px) {
+                const int64_t iw = (i3*npy + py)*npx + px;
+                for (int64_t y = 0; y < w; ++y) {
+                    for (int64_t x = 0; x < w; ++x) {
+                        for (int64_t i0 = 0; i0 < c; ++i0) {
+                            const int64_t ix = px*w + x;
+                            const int64_t iy = py*w + y;
+                            const float ref = ix < w0 && iy < h0 ? ((const float *) a->data)[((i3*h0 + iy)*w0 + ix)*c + i0] : 0.0f;
+                            const float res = ((const float *) part->data)[((iw*w + y)*w + x)*c + i0];
+                            ok = ok && res == ref;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    ok = ok && memcmp(a->data, unpart->data, ggml_nbytes(a)) == 0;
+
+    printf("%s: c = %d, image = %dx%dx%d, w = %d, n_threads = %d: %s\n",
+            __func__, (int) c, (int) w0, (int) h0, (int) n, w, n_threads, ok ? "OK" : "FAIL");
+
+    ggml_free(ctx);
+
+    return ok;
+}
+
+int main(void) {
+    bool ok = true;
+
+    for (int n_threads : { 1, 3 }) {
+        ok = test_win_part(16, 64, 64, 1, 14, n_threads) && ok;
+        ok = test_win_part(16, 64, 64, 3, 14, n_threads) && ok;
+        ok = test_win_part( 5, 17, 23, 2,  7, n_threads) && ok;
+        ok = test_win_part( 8, 21, 14, 4,  7, n_threads) && ok;
+    }
+
+    return ok ? 0 : 1;
+}
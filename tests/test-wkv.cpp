@@ -0,0 +1,165 @@
+// Check that the RWKV_WKV6, GATED_LINEAR_ATTN and RWKV_WKV7 scans split over the sequence match the sequential scans
+
+#include "ggml.h"
+#include "ggml-cpu.h"
+
+#include "test-cpu-common.h"
+
+#undef NDEBUG
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+enum wkv_op {
+    WKV_OP_RWKV_WKV6,
+    WKV_OP_GLA,
+    WKV_OP_RWKV_WKV7,
+};
+
+static const char * wkv_op_name(wkv_op op) {
+    switch (op) {
+        case WKV_OP_RWKV_WKV6: return "rwkv_wkv6";
+        case WKV_OP_GLA:       return "gla";
+        case WKV_OP_RWKV_WKV7: return "rwkv_wkv7";
+    }
+    return "?";
+}
+
+struct test_case {
+    wkv_op  op;
+    int64_t head_size;
+    int64_t n_head;
+    int64_t n_seq_tokens;
+    int64_t n_seqs;
+};
+
+// decays in (0, 1)
+static void fill_decay(struct ggml_tensor * t, int seed) {
+    test_fill(t, seed, 2.0f, -1.0f);
+    float * data = (float *) t->data;
+    for (int64_t i = 0; i < ggml_nelements(t); ++i) {
+        data[i] = expf(-expf(data[i]));
+    }
+}
+
+static bool test_wkv(const test_case & tc, int n_threads) {
+    struct ggml_init_params ip = {
+        /*.mem_size   =*/ 64*1024*1024,
+        /*.mem_buffer =*/ NULL,
+        /*.no_alloc   =*/ false,
+    };
+    struct ggml_context * ctx = ggml_init(ip);
+
+    const int64_t n_tokens = tc.n_seq_tokens*tc.n_seqs;
+
+    auto new_tensor = [&]() {
+        return ggml_new_tensor_3d(ctx, GGML_TYPE_F32, tc.head_size, tc.n_head, n_tokens);
+    };
+
+    struct ggml_tensor * s = ggml_new_tensor_2d(ctx, GGML_TYPE_F32, tc.head_size*tc.head_size*tc.n_head, tc.n_seqs);
+    test_fill(s, 1, 0.5f, 0.0f);
+
+    struct ggml_tensor * out = NULL;
+
+    switch (tc.op) {
+        case WKV_OP_RWKV_WKV6:
+            {
+                struct ggml_tensor * k  = new_tensor();
+                struct ggml_tensor * v  = new_tensor();
+                struct ggml_tensor * r  = new_tensor();
+                struct ggml_tensor * tf = ggml_new_tensor_2d(ctx, GGML_TYPE_F32, tc.head_size, tc.n_head);
+                struct ggml_tensor * td = new_tensor();
+                test_fill(k, 2, 0.5f, 0.0f);
+                test_fill(v, 3, 1.0f, 0.0f);
+                test_fill(r, 4, 0.5f, 0.0f);
+                test_fill(tf, 5, 0.5f, 0.0f);
+                fill_decay(td, 6);
+                out = ggml_rwkv_wkv6(ctx, k, v, r, tf, td, s);
+            } break;
+        case WKV_OP_GLA:
+            {
+                struct ggml_tensor * k = new_tensor();
+                struct ggml_tensor * v = new_tensor();
+                struct ggml_tensor * q = new_tensor();
+                struct ggml_tensor * g = new_tensor();
+                test_fill(k, 2, 0.5f, 0.0f);
+                test_fill(v, 3, 1.0f, 0.0f);
+                test_fill(q, 4, 0.5f, 0.0f);
+                fill_decay(g, 5);
+                out = ggml_gated_linear_attn(ctx, k, v, q, g, s, 1.0f/sqrtf((float) tc.head_size));
+            } break;
+        case WKV_OP_RWKV_WKV7:
+            {
+                struct ggml_tensor * r = new_tensor();
+                struct ggml_tensor * w = new_tensor();
+                struct ggml_tensor * k = new_tensor();
+                struct ggml_tensor * v = new_tensor();
+                struct ggml_tensor * a = new_tensor();
+                struct ggml_tensor * b = new_tensor();
+                test_fill(r, 2, 0.5f, 0.0f);
+                fill_decay(w, 3);
+                test_fill(k, 4, 0.5f, 0.0f);
+                test_fill(v, 5, 1.0f, 0.0f);
+                test_fill(a, 6, 1.0f, 0.0f);
+
+                // a = -kappa, b = kappa * alpha with kappa normalized, as in RWKV v7
+                float * a_data = (float *) a->data;
+                float * b_data = (float *) b->data;
+                for (int64_t i = 0; i < ggml_nelements(a); i += tc.head_size) {
+                    float sum = 0.0f;
+                    for (int64_t j = 0; j < tc.head_size; ++j) {
+                        sum += a_data[i + j]*a_data[i + j];
+                    }
+                    const float norm = 1.0f/sqrtf(sum);
+                    for (int64_t j = 0; j < tc.head_size; ++j) {
+                        const float kappa = a_data[i + j]*norm;
+                        a_data[i + j] = -kappa;
+                        b_data[i + j] = kappa*(0.5f + 0.4f*sinf((float) (i + j)));
+                    }
+                }
+                out = ggml_rwkv_wkv7(ctx, r, w, k, v, a, b, s);
+            } break;
+    }
+
+    struct ggml_cgraph * gf = ggml_new_graph(ctx);
+    ggml_build_forward_expand(gf, out);
+
+    // a single thread always runs the sequential scan
+    const std::vector<float> ref = test_graph_compute_f32(gf, out, 1);
+    const std::vector<float> res = test_graph_compute_f32(gf, out, n_threads);
+
+    const double nmse = test_nmse(ref, res);
+
+    const bool ok = nmse < 1e-9;
+    printf("%s: %-9s head_size = %3d, n_head = %d, n_seq_tokens = %4d, n_seqs = %d, n_threads = %d: nmse = %.3e %s\n",
+            __func__, wkv_op_name(tc.op), (int) tc.head_size, (int) tc.n_head, (int) tc.n_seq_tokens, (int) tc.n_seqs,
+            n_threads, nmse, ok ? "OK" : "FAIL");
+
+    ggml_free(ctx);
+
+    return ok;
+}
+
+int main(void) {
+    ggml_cpu_init();
+
+    const test_case cases[] = {
+        { WKV_OP_RWKV_WKV6, 64, 1,  500, 1 },
+        { WKV_OP_RWKV_WKV6, 64, 2,  300, 2 },
+        { WKV_OP_RWKV_WKV6, 32, 4, 1000, 1 },
+        { WKV_OP_GLA,       64, 1,  500, 1 },
+        { WKV_OP_GLA,       64, 2,  300, 2 },
+        { WKV_OP_GLA,       32, 3,  777, 1 },
+        { WKV_OP_RWKV_WKV7, 64, 1,  600, 1 },
+        { WKV_OP_RWKV_WKV7, 64, 2,  300, 2 },
+        { WKV_OP_RWKV_WKV6, 64, 2,   60, 1 }, // too short to be split
+    };
+
+    bool ok = true;
+    for (const test_case & tc : cases) {
+        ok = test_wkv(tc, 8) && ok;
+    }
+
+    return ok ? 0 : 1;
+}